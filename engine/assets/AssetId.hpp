@@ -0,0 +1,39 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_ASSETS_ASSETID_HPP
+#define OUZEL_ASSETS_ASSETID_HPP
+
+#include <cstdint>
+#include <string_view>
+#include "../hash/Fnv1.hpp"
+
+namespace ouzel::assets
+{
+    // FNV-1 hash of the name of an asset, the ids of literals can be computed at compile time, so that
+    // the lookups with them do not have to hash the name
+    class AssetId final
+    {
+    public:
+        constexpr explicit AssetId(const std::string_view name) noexcept:
+            value(hash::fnv1::hashString<std::uint64_t>(name))
+        {
+        }
+
+        constexpr auto getValue() const noexcept { return value; }
+
+        constexpr bool operator==(const AssetId& other) const noexcept
+        {
+            return value == other.value;
+        }
+
+        constexpr bool operator!=(const AssetId& other) const noexcept
+        {
+            return value != other.value;
+        }
+
+    private:
+        std::uint64_t value;
+    };
+}
+
+#endif // OUZEL_ASSETS_ASSETID_HPP
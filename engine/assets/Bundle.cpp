@@ -1,14 +1,41 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
 #include <cctype>
 #include <stdexcept>
 #include "Bundle.hpp"
 #include "Cache.hpp"
 #include "Loader.hpp"
+#include "../core/Engine.hpp"
 #include "../formats/Json.hpp"
 
 namespace ouzel::assets
 {
+    namespace
+    {
+        std::vector<Asset> parseAssets(const std::vector<std::byte>& manifest)
+        {
+            const auto data = json::parse(manifest);
+
+            std::vector<Asset> assets;
+
+            for (const auto& asset : data["assets"])
+            {
+                const auto file = asset["filename"].as<std::string>();
+                const auto name = asset.hasMember("name") ? asset["name"].as<std::string>() : file;
+                const auto mipmaps = asset.hasMember("mipmaps") ? asset["mipmaps"].as<bool>() : true;
+                assets.emplace_back(static_cast<Loader::Type>(asset["type"].as<std::uint32_t>()), name, file, mipmaps);
+            }
+
+            return assets;
+        }
+    }
+
+    void AsyncLoad::wait()
+    {
+        engine->getJobSystem().wait(counter);
+    }
+
     Bundle::Bundle(Cache& initCache, storage::FileSystem& initFileSystem):
         cache(initCache), fileSystem(initFileSystem)
     {
@@ -17,6 +44,7 @@ namespace ouzel::assets
 
     Bundle::~Bundle()
     {
+        cancelAsyncLoads();
         cache.removeBundle(this);
     }
 
@@ -40,15 +68,7 @@ namespace ouzel::assets
 
     void Bundle::loadAssets(const std::string& filename)
     {
-        const auto data = json::parse(fileSystem.readFile(filename));
-
-        for (const auto& asset : data["assets"])
-        {
-            const auto file = asset["filename"].as<std::string>();
-            const auto name = asset.hasMember("name") ? asset["name"].as<std::string>() : file;
-            const auto mipmaps = asset.hasMember("mipmaps") ? asset["mipmaps"].as<bool>() : true;
-            loadAsset(static_cast<Loader::Type>(asset["type"].as<std::uint32_t>()), name, file, mipmaps);
-        }
+        loadAssets(parseAssets(fileSystem.readFile(filename)));
     }
 
     void Bundle::loadAssets(const std::vector<Asset>& assets)
@@ -57,6 +77,144 @@ namespace ouzel::assets
             loadAsset(asset.type, asset.name, asset.filename, asset.mipmaps);
     }
 
+    std::shared_ptr<AsyncLoad> Bundle::loadAssetsAsync(const std::string& filename)
+    {
+        return loadAssetsAsync(parseAssets(fileSystem.readFile(filename)));
+    }
+
+    std::shared_ptr<AsyncLoad> Bundle::loadAssetsAsync(const std::vector<Asset>& assets)
+    {
+        auto asyncLoad = std::make_shared<AsyncLoad>(assets);
+        if (assets.empty()) return asyncLoad;
+
+        asyncLoads.push_back(asyncLoad);
+
+        auto& jobSystem = engine->getJobSystem();
+
+        // the jobs keep the load alive, because the bundle drops it when it completes
+        for (std::size_t i = 0; i < assets.size(); ++i)
+            jobSystem.run([this, asyncLoad, i]() {
+                prepareAsset(asyncLoad, i);
+            }, &asyncLoad->counter);
+
+        return asyncLoad;
+    }
+
+    void Bundle::cancelAsyncLoads()
+    {
+        // the jobs of the loads use the bundle, a load is removed from the list by its last job
+        while (!asyncLoads.empty())
+        {
+            const auto asyncLoad = asyncLoads.back();
+            asyncLoad->cancel();
+
+            try
+            {
+                asyncLoad->wait();
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
+    void Bundle::prepareAsset(const std::shared_ptr<AsyncLoad>& asyncLoad, std::size_t index)
+    {
+        auto& slot = asyncLoad->slots[index];
+        const auto& asset = asyncLoad->assets[index];
+
+        if (!asyncLoad->cancelled)
+        {
+            try
+            {
+                slot.data = fileSystem.mapFile(asset.filename);
+
+                const auto& loaders = cache.getLoaders();
+
+                for (; slot.loaderIndex < loaders.size(); ++slot.loaderIndex)
+                {
+                    Loader* loader = loaders[loaders.size() - slot.loaderIndex - 1].get();
+                    if (loader->getType() == asset.type &&
+                        (slot.finish = loader->prepareAsset(asset.name, slot.data, asset.mipmaps)))
+                        break;
+                }
+            }
+            catch (...)
+            {
+                slot.exception = std::current_exception();
+            }
+        }
+
+        slot.ready.store(true, std::memory_order_release);
+
+        // the assets are added in order, so this one can also finish the assets after it that are ready
+        engine->getJobSystem().runOnMainThread([this, asyncLoad]() {
+            finishAssets(*asyncLoad);
+        }, &asyncLoad->counter);
+    }
+
+    void Bundle::finishAssets(AsyncLoad& asyncLoad)
+    {
+        std::exception_ptr exception;
+
+        while (asyncLoad.nextSlot < asyncLoad.slots.size())
+        {
+            auto& slot = asyncLoad.slots[asyncLoad.nextSlot];
+            if (!slot.ready.load(std::memory_order_acquire)) break;
+
+            const auto& asset = asyncLoad.assets[asyncLoad.nextSlot];
+            ++asyncLoad.nextSlot;
+
+            if (!asyncLoad.cancelled)
+            {
+                try
+                {
+                    if (slot.exception) std::rethrow_exception(slot.exception);
+
+                    bool loaded = slot.finish && slot.finish(*this);
+
+                    // the loaders after the one that prepared the asset are tried like in loadAsset
+                    const auto& loaders = cache.getLoaders();
+
+                    if (!loaded && slot.loaderIndex + 1 < loaders.size())
+                    {
+                        const std::vector<std::byte> data(slot.data.begin(), slot.data.end());
+
+                        for (auto i = slot.loaderIndex + 1; !loaded && i < loaders.size(); ++i)
+                        {
+                            Loader* loader = loaders[loaders.size() - i - 1].get();
+                            loaded = loader->getType() == asset.type &&
+                                loader->loadAsset(*this, asset.name, data, asset.mipmaps);
+                        }
+                    }
+
+                    if (!loaded)
+                        throw std::runtime_error("Failed to load asset " + asset.filename);
+
+                    ++asyncLoad.loadedCount;
+                }
+                catch (...)
+                {
+                    // the assets after the one that failed are not loaded, like in loadAssets, but their slots
+                    // are still released here, because this can be the last job of the load
+                    asyncLoad.cancelled = true;
+                    exception = std::current_exception();
+                }
+            }
+
+            slot.finish = nullptr;
+            slot.data = storage::FileView();
+        }
+
+        // the load is complete, the job that runs this keeps it alive until it finishes
+        if (asyncLoad.nextSlot == asyncLoad.slots.size())
+            asyncLoads.erase(std::remove_if(asyncLoads.begin(), asyncLoads.end(),
+                                            [&asyncLoad](const auto& load) noexcept { return load.get() == &asyncLoad; }),
+                             asyncLoads.end());
+
+        if (exception) std::rethrow_exception(exception);
+    }
+
     std::shared_ptr<graphics::Texture> Bundle::getTexture(const std::string& name) const
     {
         const auto i = textures.find(name);
@@ -69,11 +227,13 @@ namespace ouzel::assets
 
     void Bundle::setTexture(const std::string& name, const std::shared_ptr<graphics::Texture>& texture)
     {
-        textures[name] = texture;
+        const auto i = textures.insert_or_assign(name, texture).first;
+        cache.addAsset(Cache::AssetType::texture, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseTextures()
     {
+        cache.removeAssets(Cache::AssetType::texture, this);
         textures.clear();
     }
 
@@ -89,11 +249,13 @@ namespace ouzel::assets
 
     void Bundle::setShader(const std::string& name, std::unique_ptr<graphics::Shader> shader)
     {
-        shaders[name] = std::move(shader);
+        const auto i = shaders.insert_or_assign(name, std::move(shader)).first;
+        cache.addAsset(Cache::AssetType::shader, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseShaders()
     {
+        cache.removeAssets(Cache::AssetType::shader, this);
         shaders.clear();
     }
 
@@ -109,11 +271,13 @@ namespace ouzel::assets
 
     void Bundle::setBlendState(const std::string& name, std::unique_ptr<graphics::BlendState> blendState)
     {
-        blendStates[name] = std::move(blendState);
+        const auto i = blendStates.insert_or_assign(name, std::move(blendState)).first;
+        cache.addAsset(Cache::AssetType::blendState, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseBlendStates()
     {
+        cache.removeAssets(Cache::AssetType::blendState, this);
         blendStates.clear();
     }
 
@@ -129,11 +293,13 @@ namespace ouzel::assets
 
     void Bundle::setDepthStencilState(const std::string& name, std::unique_ptr<graphics::DepthStencilState> depthStencilState)
     {
-        depthStencilStates[name] = std::move(depthStencilState);
+        const auto i = depthStencilStates.insert_or_assign(name, std::move(depthStencilState)).first;
+        cache.addAsset(Cache::AssetType::depthStencilState, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseDepthStencilStates()
     {
+        cache.removeAssets(Cache::AssetType::depthStencilState, this);
         depthStencilStates.clear();
     }
 
@@ -181,7 +347,7 @@ namespace ouzel::assets
 
                 newSpriteData.animations[""] = std::move(animation);
 
-                spriteData[filename] = newSpriteData;
+                setSpriteData(filename, newSpriteData);
             }
         }
         else
@@ -200,11 +366,13 @@ namespace ouzel::assets
 
     void Bundle::setSpriteData(const std::string& name, const scene::SpriteData& newSpriteData)
     {
-        spriteData[name] = newSpriteData;
+        const auto i = spriteData.insert_or_assign(name, newSpriteData).first;
+        cache.addAsset(Cache::AssetType::spriteData, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseSpriteData()
     {
+        cache.removeAssets(Cache::AssetType::spriteData, this);
         spriteData.clear();
     }
 
@@ -220,11 +388,13 @@ namespace ouzel::assets
 
     void Bundle::setParticleSystemData(const std::string& name, const scene::ParticleSystemData& newParticleSystemData)
     {
-        particleSystemData[name] = newParticleSystemData;
+        const auto i = particleSystemData.insert_or_assign(name, newParticleSystemData).first;
+        cache.addAsset(Cache::AssetType::particleSystemData, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseParticleSystemData()
     {
+        cache.removeAssets(Cache::AssetType::particleSystemData, this);
         particleSystemData.clear();
     }
 
@@ -240,11 +410,13 @@ namespace ouzel::assets
 
     void Bundle::setFont(const std::string& name, std::unique_ptr<gui::Font> font)
     {
-        fonts[name] = std::move(font);
+        const auto i = fonts.insert_or_assign(name, std::move(font)).first;
+        cache.addAsset(Cache::AssetType::font, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseFonts()
     {
+        cache.removeAssets(Cache::AssetType::font, this);
         fonts.clear();
     }
 
@@ -260,11 +432,13 @@ namespace ouzel::assets
 
     void Bundle::setCue(const std::string& name, std::unique_ptr<audio::Cue> cue)
     {
-        cues[name] = std::move(cue);
+        const auto i = cues.insert_or_assign(name, std::move(cue)).first;
+        cache.addAsset(Cache::AssetType::cue, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseCues()
     {
+        cache.removeAssets(Cache::AssetType::cue, this);
         cues.clear();
     }
 
@@ -280,11 +454,13 @@ namespace ouzel::assets
 
     void Bundle::setSound(const std::string& name, std::unique_ptr<audio::Sound> sound)
     {
-        sounds[name] = std::move(sound);
+        const auto i = sounds.insert_or_assign(name, std::move(sound)).first;
+        cache.addAsset(Cache::AssetType::sound, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseSounds()
     {
+        cache.removeAssets(Cache::AssetType::sound, this);
         sounds.clear();
     }
 
@@ -300,11 +476,13 @@ namespace ouzel::assets
 
     void Bundle::setMaterial(const std::string& name, std::unique_ptr<graphics::Material> material)
     {
-        materials[name] = std::move(material);
+        const auto i = materials.insert_or_assign(name, std::move(material)).first;
+        cache.addAsset(Cache::AssetType::material, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseMaterials()
     {
+        cache.removeAssets(Cache::AssetType::material, this);
         materials.clear();
     }
 
@@ -320,11 +498,13 @@ namespace ouzel::assets
 
     void Bundle::setSkinnedMeshData(const std::string& name, scene::SkinnedMeshData&& newSkinnedMeshData)
     {
-        skinnedMeshData[name] = std::move(newSkinnedMeshData);
+        const auto i = skinnedMeshData.insert_or_assign(name, std::move(newSkinnedMeshData)).first;
+        cache.addAsset(Cache::AssetType::skinnedMeshData, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseSkinnedMeshData()
     {
+        cache.removeAssets(Cache::AssetType::skinnedMeshData, this);
         skinnedMeshData.clear();
     }
 
@@ -340,11 +520,13 @@ namespace ouzel::assets
 
     void Bundle::setStaticMeshData(const std::string& name, scene::StaticMeshData&& newStaticMeshData)
     {
-        staticMeshData[name] = std::move(newStaticMeshData);
+        const auto i = staticMeshData.insert_or_assign(name, std::move(newStaticMeshData)).first;
+        cache.addAsset(Cache::AssetType::staticMeshData, i->first, Cache::getAsset(i->second), this);
     }
 
     void Bundle::releaseStaticMeshData()
     {
+        cache.removeAssets(Cache::AssetType::staticMeshData, this);
         staticMeshData.clear();
     }
 }
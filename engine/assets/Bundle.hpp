@@ -3,9 +3,13 @@
 #ifndef OUZEL_ASSETS_BUNDLE_HPP
 #define OUZEL_ASSETS_BUNDLE_HPP
 
+#include <atomic>
+#include <exception>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 #include "Loader.hpp"
 #include "../audio/Cue.hpp"
 #include "../audio/Sound.hpp"
@@ -20,6 +24,7 @@
 #include "../scene/SpriteRenderer.hpp"
 #include "../scene/ParticleSystem.hpp"
 #include "../storage/FileSystem.hpp"
+#include "../thread/JobSystem.hpp"
 
 namespace ouzel::assets
 {
@@ -45,6 +50,59 @@ namespace ouzel::assets
         bool mipmaps;
     };
 
+    // Assets that are loaded by Bundle::loadAssetsAsync. The files are read and decoded on the workers of
+    // the job system and the assets are added to the bundle on the main thread in the order of the list.
+    class AsyncLoad final
+    {
+        friend Bundle;
+    public:
+        explicit AsyncLoad(const std::vector<Asset>& initAssets):
+            assets(initAssets),
+            slots(initAssets.size())
+        {
+        }
+
+        AsyncLoad(const AsyncLoad&) = delete;
+        AsyncLoad& operator=(const AsyncLoad&) = delete;
+
+        AsyncLoad(AsyncLoad&&) = delete;
+        AsyncLoad& operator=(AsyncLoad&&) = delete;
+
+        auto getAssetCount() const noexcept { return assets.size(); }
+        auto getLoadedCount() const noexcept { return loadedCount.load(std::memory_order_acquire); }
+        float getProgress() const noexcept
+        {
+            return assets.empty() ? 1.0F :
+                static_cast<float>(getLoadedCount()) / static_cast<float>(assets.size());
+        }
+
+        bool isDone() const noexcept { return counter.isDone(); }
+
+        // runs the jobs until all of the assets are loaded and rethrows the error of the first asset that
+        // failed to load, the assets after it are not loaded
+        void wait();
+
+        // the assets that are not added to the bundle yet are skipped
+        void cancel() noexcept { cancelled = true; }
+
+    private:
+        struct Slot final
+        {
+            storage::FileView data;
+            std::size_t loaderIndex = 0; // index in the reversed list of the loaders
+            std::function<bool(Bundle&)> finish;
+            std::exception_ptr exception;
+            std::atomic<bool> ready{false};
+        };
+
+        std::vector<Asset> assets;
+        std::vector<Slot> slots;
+        std::size_t nextSlot = 0; // used only on the main thread
+        std::atomic<std::size_t> loadedCount{0};
+        std::atomic<bool> cancelled{false};
+        thread::JobSystem::Counter counter;
+    };
+
     class Bundle final
     {
         friend Cache;
@@ -63,6 +121,13 @@ namespace ouzel::assets
         void loadAssets(const std::string& filename);
         void loadAssets(const std::vector<Asset>& assets);
 
+        // returns immediately, the assets are added to the bundle while the main thread runs its jobs
+        std::shared_ptr<AsyncLoad> loadAssetsAsync(const std::string& filename);
+        std::shared_ptr<AsyncLoad> loadAssetsAsync(const std::vector<Asset>& assets);
+
+        // cancels the loads that are not complete and waits for their jobs
+        void cancelAsyncLoads();
+
         std::shared_ptr<graphics::Texture> getTexture(const std::string& name) const;
         void setTexture(const std::string& name, const std::shared_ptr<graphics::Texture>& texture);
         void releaseTextures();
@@ -115,9 +180,14 @@ namespace ouzel::assets
         void releaseStaticMeshData();
 
     private:
+        void prepareAsset(const std::shared_ptr<AsyncLoad>& asyncLoad, std::size_t index);
+        void finishAssets(AsyncLoad& asyncLoad);
+
         Cache& cache;
         storage::FileSystem& fileSystem;
 
+        std::vector<std::shared_ptr<AsyncLoad>> asyncLoads; // the loads that are not complete
+
         std::map<std::string, std::shared_ptr<graphics::Texture>> textures;
         std::map<std::string, std::unique_ptr<graphics::Shader>> shaders;
         std::map<std::string, scene::ParticleSystemData> particleSystemData;
@@ -1,6 +1,8 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
 #include <algorithm>
+#include <stdexcept>
+#include <utility>
 #include "Cache.hpp"
 #include "BmfLoader.hpp"
 #include "ColladaLoader.hpp"
@@ -11,6 +13,7 @@
 #include "ObjLoader.hpp"
 #include "ParticleSystemLoader.hpp"
 #include "SpriteLoader.hpp"
+#include "TextureLoader.hpp"
 #include "TtfLoader.hpp"
 #include "VorbisLoader.hpp"
 #include "WaveLoader.hpp"
@@ -20,6 +23,17 @@
 
 namespace ouzel::assets
 {
+    namespace
+    {
+        constexpr std::size_t minEntryCount = 64;
+
+        // the type is mixed in, so that the entries of assets with the same name are not next to each other
+        std::size_t getHash(std::uint64_t id, std::uint8_t type) noexcept
+        {
+            return static_cast<std::size_t>(((id ^ type) * 0x9E3779B97F4A7C15ULL) >> 32);
+        }
+    }
+
     Cache::Cache()
     {
         addLoader(std::make_unique<BmfLoader>(*this));
@@ -31,6 +45,7 @@ namespace ouzel::assets
         addLoader(std::make_unique<ObjLoader>(*this));
         addLoader(std::make_unique<ParticleSystemLoader>(*this));
         addLoader(std::make_unique<SpriteLoader>(*this));
+        addLoader(std::make_unique<TextureLoader>(*this));
         addLoader(std::make_unique<TtfLoader>(*this));
         addLoader(std::make_unique<VorbisLoader>(*this));
         addLoader(std::make_unique<WaveLoader>(*this));
@@ -48,6 +63,8 @@ namespace ouzel::assets
         const auto i = std::find(bundles.begin(), bundles.end(), bundle);
         if (i != bundles.end())
             bundles.erase(i);
+
+        removeEntries(bundle, [](AssetType) noexcept { return true; });
     }
 
     void Cache::addLoader(std::unique_ptr<Loader> loader)
@@ -66,111 +83,306 @@ namespace ouzel::assets
             loaders.erase(i);
     }
 
-    std::shared_ptr<graphics::Texture> Cache::getTexture(const std::string& name) const
+    template <class T>
+    const T* Cache::findAsset(AssetType type, std::string_view name) const noexcept
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto texture = bundle->getTexture(name))
-                return texture;
+        const auto entry = findEntry(type, AssetId(name).getValue());
+        return (entry && *entry->name == name) ? static_cast<const T*>(entry->asset) : nullptr;
+    }
 
-        return nullptr;
+    template <class T>
+    const T* Cache::findAsset(AssetType type, AssetId id) const noexcept
+    {
+        const auto entry = findEntry(type, id.getValue());
+        return entry ? static_cast<const T*>(entry->asset) : nullptr;
     }
 
-    const graphics::Shader* Cache::getShader(const std::string& name) const
+    void Cache::addAsset(AssetType type, const std::string& name, const void* asset, const Bundle* bundle)
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto shader = bundle->getShader(name))
-                return shader;
+        if (!asset)
+        {
+            removeAsset(type, name, bundle);
+            return;
+        }
+
+        const auto id = AssetId(name).getValue();
+
+        if (!entries.empty())
+        {
+            Entry& entry = entries[getEntryIndex(type, id)];
+
+            if (entry.bundle)
+            {
+                if (*entry.name != name)
+                    throw std::runtime_error("Asset " + name + " has the same id as " + *entry.name);
 
-        return nullptr;
+                // the asset of the bundle that was added first is used
+                if (entry.bundle != bundle &&
+                    std::find(bundles.begin(), bundles.end(), entry.bundle) <
+                    std::find(bundles.begin(), bundles.end(), bundle))
+                    return;
+
+                entry.name = &name;
+                entry.bundle = bundle;
+                entry.asset = asset;
+                return;
+            }
+        }
+
+        insertEntry(Entry{id, &name, bundle, asset, type});
     }
 
-    const graphics::BlendState* Cache::getBlendState(const std::string& name) const
+    void Cache::removeAsset(AssetType type, const std::string& name, const Bundle* bundle)
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto blendState = bundle->getBlendState(name))
-                return blendState;
+        if (entries.empty()) return;
 
-        return nullptr;
+        const auto index = getEntryIndex(type, AssetId(name).getValue());
+        if (entries[index].bundle != bundle) return;
+
+        eraseEntry(index);
+        insertFromBundles(type, name, bundle);
     }
 
-    const graphics::DepthStencilState* Cache::getDepthStencilState(const std::string& name) const
+    void Cache::removeAssets(AssetType type, const Bundle* bundle)
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto depthStencilState = bundle->getDepthStencilState(name))
-                return depthStencilState;
+        removeEntries(bundle, [type](AssetType entryType) noexcept { return entryType == type; });
+    }
 
-        return nullptr;
+    template <class Predicate>
+    void Cache::removeEntries(const Bundle* bundle, Predicate predicate)
+    {
+        // the names are copied, because the entries move when the others are erased
+        std::vector<std::pair<AssetType, std::string>> removed;
+
+        for (const Entry& entry : entries)
+            if (entry.bundle == bundle && predicate(entry.type))
+                removed.emplace_back(entry.type, *entry.name);
+
+        for (const auto& [type, name] : removed)
+        {
+            eraseEntry(getEntryIndex(type, AssetId(name).getValue()));
+            insertFromBundles(type, name, bundle);
+        }
     }
 
-    const scene::SpriteData* Cache::getSpriteData(const std::string& name) const
+    const Cache::Entry* Cache::findEntry(AssetType type, std::uint64_t id) const noexcept
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto spriteData = bundle->getSpriteData(name))
-                return spriteData;
+        if (entries.empty()) return nullptr;
 
-        return nullptr;
+        const Entry& entry = entries[getEntryIndex(type, id)];
+        return entry.bundle ? &entry : nullptr;
     }
 
-    const scene::ParticleSystemData* Cache::getParticleSystemData(const std::string& name) const
+    std::size_t Cache::getEntryIndex(AssetType type, std::uint64_t id) const noexcept
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto particleSystemData = bundle->getParticleSystemData(name))
-                return particleSystemData;
+        // the index of the entry or of the empty entry where it would be inserted
+        const auto mask = entries.size() - 1;
 
-        return nullptr;
+        for (auto index = getHash(id, static_cast<std::uint8_t>(type)) & mask;; index = (index + 1) & mask)
+        {
+            const Entry& entry = entries[index];
+            if (!entry.bundle || (entry.id == id && entry.type == type))
+                return index;
+        }
     }
 
-    const gui::Font* Cache::getFont(const std::string& name) const
+    void Cache::insertEntry(const Entry& entry)
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto font = bundle->getFont(name))
-                return font;
+        if ((entryCount + 1) * 2 > entries.size())
+        {
+            std::vector<Entry> oldEntries(std::max(entries.size() * 2, minEntryCount));
+            oldEntries.swap(entries);
 
-        return nullptr;
+            for (const Entry& oldEntry : oldEntries)
+                if (oldEntry.bundle)
+                    entries[getEntryIndex(oldEntry.type, oldEntry.id)] = oldEntry;
+        }
+
+        Entry& newEntry = entries[getEntryIndex(entry.type, entry.id)];
+        if (!newEntry.bundle) ++entryCount;
+        newEntry = entry;
     }
 
-    const audio::Cue* Cache::getCue(const std::string& name) const
+    void Cache::eraseEntry(std::size_t index) noexcept
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto cue = bundle->getCue(name))
-                return cue;
+        // the following entries are moved back instead of leaving a tombstone, an entry can be moved to
+        // the hole if the hole is between its home index and its index
+        const auto mask = entries.size() - 1;
+        auto hole = index;
+
+        for (auto next = (hole + 1) & mask; entries[next].bundle; next = (next + 1) & mask)
+        {
+            const auto home = getHash(entries[next].id, static_cast<std::uint8_t>(entries[next].type)) & mask;
 
-        return nullptr;
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                entries[hole] = entries[next];
+                hole = next;
+            }
+        }
+
+        entries[hole] = Entry();
+        --entryCount;
     }
 
-    const audio::Sound* Cache::getSound(const std::string& name) const
+    void Cache::insertFromBundles(AssetType type, const std::string& name, const Bundle* excluded)
     {
         for (const Bundle* bundle : bundles)
-            if (const auto sound = bundle->getSound(name))
-                return sound;
+        {
+            if (bundle == excluded) continue;
+
+            const auto insert = [this, type, bundle](const auto& map, const std::string& assetName) {
+                const auto i = map.find(assetName);
+                if (i == map.end()) return false;
+
+                const auto asset = getAsset(i->second);
+                if (!asset) return false;
 
-        return nullptr;
+                insertEntry(Entry{AssetId(assetName).getValue(), &i->first, bundle, asset, type});
+                return true;
+            };
+
+            bool inserted = false;
+
+            switch (type)
+            {
+                case AssetType::texture: inserted = insert(bundle->textures, name); break;
+                case AssetType::shader: inserted = insert(bundle->shaders, name); break;
+                case AssetType::blendState: inserted = insert(bundle->blendStates, name); break;
+                case AssetType::depthStencilState: inserted = insert(bundle->depthStencilStates, name); break;
+                case AssetType::spriteData: inserted = insert(bundle->spriteData, name); break;
+                case AssetType::particleSystemData: inserted = insert(bundle->particleSystemData, name); break;
+                case AssetType::font: inserted = insert(bundle->fonts, name); break;
+                case AssetType::cue: inserted = insert(bundle->cues, name); break;
+                case AssetType::sound: inserted = insert(bundle->sounds, name); break;
+                case AssetType::material: inserted = insert(bundle->materials, name); break;
+                case AssetType::skinnedMeshData: inserted = insert(bundle->skinnedMeshData, name); break;
+                case AssetType::staticMeshData: inserted = insert(bundle->staticMeshData, name); break;
+            }
+
+            if (inserted) return;
+        }
     }
 
-    const graphics::Material* Cache::getMaterial(const std::string& name) const
+    std::shared_ptr<graphics::Texture> Cache::getTexture(std::string_view name) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto material = bundle->getMaterial(name))
-                return material;
+        const auto texture = findAsset<std::shared_ptr<graphics::Texture>>(AssetType::texture, name);
+        return texture ? *texture : nullptr;
+    }
+
+    std::shared_ptr<graphics::Texture> Cache::getTexture(AssetId id) const
+    {
+        const auto texture = findAsset<std::shared_ptr<graphics::Texture>>(AssetType::texture, id);
+        return texture ? *texture : nullptr;
+    }
 
-        return nullptr;
+    const graphics::Shader* Cache::getShader(std::string_view name) const
+    {
+        return findAsset<graphics::Shader>(AssetType::shader, name);
     }
 
-    const scene::SkinnedMeshData* Cache::getSkinnedMeshData(const std::string& name) const
+    const graphics::Shader* Cache::getShader(AssetId id) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto meshData = bundle->getSkinnedMeshData(name))
-                return meshData;
+        return findAsset<graphics::Shader>(AssetType::shader, id);
+    }
+
+    const graphics::BlendState* Cache::getBlendState(std::string_view name) const
+    {
+        return findAsset<graphics::BlendState>(AssetType::blendState, name);
+    }
 
-        return nullptr;
+    const graphics::BlendState* Cache::getBlendState(AssetId id) const
+    {
+        return findAsset<graphics::BlendState>(AssetType::blendState, id);
     }
 
-    const scene::StaticMeshData* Cache::getStaticMeshData(const std::string& name) const
+    const graphics::DepthStencilState* Cache::getDepthStencilState(std::string_view name) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto meshData = bundle->getStaticMeshData(name))
-                return meshData;
+        return findAsset<graphics::DepthStencilState>(AssetType::depthStencilState, name);
+    }
+
+    const graphics::DepthStencilState* Cache::getDepthStencilState(AssetId id) const
+    {
+        return findAsset<graphics::DepthStencilState>(AssetType::depthStencilState, id);
+    }
+
+    const scene::SpriteData* Cache::getSpriteData(std::string_view name) const
+    {
+        return findAsset<scene::SpriteData>(AssetType::spriteData, name);
+    }
+
+    const scene::SpriteData* Cache::getSpriteData(AssetId id) const
+    {
+        return findAsset<scene::SpriteData>(AssetType::spriteData, id);
+    }
+
+    const scene::ParticleSystemData* Cache::getParticleSystemData(std::string_view name) const
+    {
+        return findAsset<scene::ParticleSystemData>(AssetType::particleSystemData, name);
+    }
+
+    const scene::ParticleSystemData* Cache::getParticleSystemData(AssetId id) const
+    {
+        return findAsset<scene::ParticleSystemData>(AssetType::particleSystemData, id);
+    }
+
+    const gui::Font* Cache::getFont(std::string_view name) const
+    {
+        return findAsset<gui::Font>(AssetType::font, name);
+    }
+
+    const gui::Font* Cache::getFont(AssetId id) const
+    {
+        return findAsset<gui::Font>(AssetType::font, id);
+    }
+
+    const audio::Cue* Cache::getCue(std::string_view name) const
+    {
+        return findAsset<audio::Cue>(AssetType::cue, name);
+    }
+
+    const audio::Cue* Cache::getCue(AssetId id) const
+    {
+        return findAsset<audio::Cue>(AssetType::cue, id);
+    }
+
+    const audio::Sound* Cache::getSound(std::string_view name) const
+    {
+        return findAsset<audio::Sound>(AssetType::sound, name);
+    }
+
+    const audio::Sound* Cache::getSound(AssetId id) const
+    {
+        return findAsset<audio::Sound>(AssetType::sound, id);
+    }
+
+    const graphics::Material* Cache::getMaterial(std::string_view name) const
+    {
+        return findAsset<graphics::Material>(AssetType::material, name);
+    }
+
+    const graphics::Material* Cache::getMaterial(AssetId id) const
+    {
+        return findAsset<graphics::Material>(AssetType::material, id);
+    }
+
+    const scene::SkinnedMeshData* Cache::getSkinnedMeshData(std::string_view name) const
+    {
+        return findAsset<scene::SkinnedMeshData>(AssetType::skinnedMeshData, name);
+    }
+
+    const scene::SkinnedMeshData* Cache::getSkinnedMeshData(AssetId id) const
+    {
+        return findAsset<scene::SkinnedMeshData>(AssetType::skinnedMeshData, id);
+    }
+
+    const scene::StaticMeshData* Cache::getStaticMeshData(std::string_view name) const
+    {
+        return findAsset<scene::StaticMeshData>(AssetType::staticMeshData, name);
+    }
 
-        return nullptr;
+    const scene::StaticMeshData* Cache::getStaticMeshData(AssetId id) const
+    {
+        return findAsset<scene::StaticMeshData>(AssetType::staticMeshData, id);
     }
 }
@@ -3,8 +3,12 @@
 #ifndef OUZEL_ASSETS_CACHE_HPP
 #define OUZEL_ASSETS_CACHE_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "AssetId.hpp"
 #include "Bundle.hpp"
 
 namespace ouzel::assets
@@ -27,28 +31,100 @@ namespace ouzel::assets
         auto& getBundles() const noexcept { return bundles; }
         auto& getLoaders() const noexcept { return loaders; }
 
-        std::shared_ptr<graphics::Texture> getTexture(const std::string& name) const;
-        const graphics::Shader* getShader(const std::string& name) const;
-        const graphics::BlendState* getBlendState(const std::string& name) const;
-        const graphics::DepthStencilState* getDepthStencilState(const std::string& name) const;
-        const scene::SpriteData* getSpriteData(const std::string& name) const;
-        const scene::ParticleSystemData* getParticleSystemData(const std::string& name) const;
-        const gui::Font* getFont(const std::string& name) const;
-        const audio::Cue* getCue(const std::string& name) const;
-        const audio::Sound* getSound(const std::string& name) const;
-        const graphics::Material* getMaterial(const std::string& name) const;
-        const scene::SkinnedMeshData* getSkinnedMeshData(const std::string& name) const;
-        const scene::StaticMeshData* getStaticMeshData(const std::string& name) const;
+        // the loaders that are added later are tried first
+        void addLoader(std::unique_ptr<Loader> loader);
+        void removeLoader(const Loader* loader);
+
+        // the asset of the first bundle that has it, the lookups with an id do not compare the names
+        std::shared_ptr<graphics::Texture> getTexture(std::string_view name) const;
+        std::shared_ptr<graphics::Texture> getTexture(AssetId id) const;
+        const graphics::Shader* getShader(std::string_view name) const;
+        const graphics::Shader* getShader(AssetId id) const;
+        const graphics::BlendState* getBlendState(std::string_view name) const;
+        const graphics::BlendState* getBlendState(AssetId id) const;
+        const graphics::DepthStencilState* getDepthStencilState(std::string_view name) const;
+        const graphics::DepthStencilState* getDepthStencilState(AssetId id) const;
+        const scene::SpriteData* getSpriteData(std::string_view name) const;
+        const scene::SpriteData* getSpriteData(AssetId id) const;
+        const scene::ParticleSystemData* getParticleSystemData(std::string_view name) const;
+        const scene::ParticleSystemData* getParticleSystemData(AssetId id) const;
+        const gui::Font* getFont(std::string_view name) const;
+        const gui::Font* getFont(AssetId id) const;
+        const audio::Cue* getCue(std::string_view name) const;
+        const audio::Cue* getCue(AssetId id) const;
+        const audio::Sound* getSound(std::string_view name) const;
+        const audio::Sound* getSound(AssetId id) const;
+        const graphics::Material* getMaterial(std::string_view name) const;
+        const graphics::Material* getMaterial(AssetId id) const;
+        const scene::SkinnedMeshData* getSkinnedMeshData(std::string_view name) const;
+        const scene::SkinnedMeshData* getSkinnedMeshData(AssetId id) const;
+        const scene::StaticMeshData* getStaticMeshData(std::string_view name) const;
+        const scene::StaticMeshData* getStaticMeshData(AssetId id) const;
 
     private:
+        enum class AssetType: std::uint8_t
+        {
+            texture,
+            shader,
+            blendState,
+            depthStencilState,
+            spriteData,
+            particleSystemData,
+            font,
+            cue,
+            sound,
+            material,
+            skinnedMeshData,
+            staticMeshData
+        };
+
+        // the entries point to the values of the maps of the bundles, the std::map nodes do not move
+        template <class T>
+        static const void* getAsset(const std::shared_ptr<T>& asset) noexcept { return asset ? &asset : nullptr; }
+        template <class T>
+        static const void* getAsset(const std::unique_ptr<T>& asset) noexcept { return asset.get(); }
+        template <class T>
+        static const void* getAsset(const T& asset) noexcept { return &asset; }
+
+        struct Entry final
+        {
+            std::uint64_t id = 0;
+            const std::string* name = nullptr; // the key in the map of the bundle
+            const Bundle* bundle = nullptr; // null if the entry is empty
+            const void* asset = nullptr;
+            AssetType type = AssetType::texture;
+        };
+
         void addBundle(const Bundle* bundle);
         void removeBundle(const Bundle* bundle);
 
-        void addLoader(std::unique_ptr<Loader> loader);
-        void removeLoader(const Loader* loader);
+        // called by the bundles when they set or release their assets
+        void addAsset(AssetType type, const std::string& name, const void* asset, const Bundle* bundle);
+        void removeAsset(AssetType type, const std::string& name, const Bundle* bundle);
+        void removeAssets(AssetType type, const Bundle* bundle);
+
+        template <class T>
+        const T* findAsset(AssetType type, std::string_view name) const noexcept;
+        template <class T>
+        const T* findAsset(AssetType type, AssetId id) const noexcept;
+
+        template <class Predicate>
+        void removeEntries(const Bundle* bundle, Predicate predicate);
+        const Entry* findEntry(AssetType type, std::uint64_t id) const noexcept;
+        std::size_t getEntryIndex(AssetType type, std::uint64_t id) const noexcept;
+        void insertEntry(const Entry& entry);
+        void eraseEntry(std::size_t index) noexcept;
+
+        // the entry of the first bundle (other than the excluded one) that has the asset
+        void insertFromBundles(AssetType type, const std::string& name, const Bundle* excluded);
 
         std::vector<const Bundle*> bundles;
         std::vector<std::unique_ptr<Loader>> loaders;
+
+        // one entry for every name of every asset type of all bundles, open addressing with linear probing,
+        // the size is a power of two and at most half of the entries are used
+        std::vector<Entry> entries;
+        std::size_t entryCount = 0;
     };
 }
 
@@ -0,0 +1,55 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_ASSETS_COOKEDTEXTURE_HPP
+#define OUZEL_ASSETS_COOKEDTEXTURE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "../graphics/PixelFormat.hpp"
+#include "../math/Size.hpp"
+#include "../utils/Utils.hpp"
+
+namespace ouzel::assets
+{
+    // Textures that are cooked by the ouzel tool, so that they are not decoded and their mip levels are not
+    // generated when they are loaded. All the values are 32-bit little endian integers: the magic, the version,
+    // the pixel format and the level count followed by the width, the height and the pixels of every level.
+    constexpr std::uint32_t cookedTextureMagic = 0x5845544FU; // "OTEX"
+    constexpr std::uint32_t cookedTextureVersion = 1;
+    constexpr std::size_t cookedTextureHeaderSize = 16;
+    constexpr std::size_t cookedTextureLevelHeaderSize = 8;
+
+    inline std::vector<std::byte> encodeCookedTexture(graphics::PixelFormat pixelFormat,
+                                                      const std::vector<std::pair<Size2U, std::vector<std::uint8_t>>>& levels)
+    {
+        std::size_t size = cookedTextureHeaderSize;
+        for (const auto& level : levels)
+            size += cookedTextureLevelHeaderSize + level.second.size();
+
+        std::vector<std::byte> result(size);
+        auto buffer = reinterpret_cast<std::uint8_t*>(result.data());
+
+        encodeLittleEndian<std::uint32_t>(buffer, cookedTextureMagic);
+        encodeLittleEndian<std::uint32_t>(buffer + 4, cookedTextureVersion);
+        encodeLittleEndian<std::uint32_t>(buffer + 8, static_cast<std::uint32_t>(pixelFormat));
+        encodeLittleEndian<std::uint32_t>(buffer + 12, static_cast<std::uint32_t>(levels.size()));
+        buffer += cookedTextureHeaderSize;
+
+        for (const auto& [levelSize, data] : levels)
+        {
+            encodeLittleEndian<std::uint32_t>(buffer, levelSize.v[0]);
+            encodeLittleEndian<std::uint32_t>(buffer + 4, levelSize.v[1]);
+            buffer += cookedTextureLevelHeaderSize;
+
+            if (!data.empty()) std::memcpy(buffer, data.data(), data.size());
+            buffer += data.size();
+        }
+
+        return result;
+    }
+}
+
+#endif // OUZEL_ASSETS_COOKEDTEXTURE_HPP
@@ -5,7 +5,6 @@
 #include "ImageLoader.hpp"
 #include "Bundle.hpp"
 #include "../core/Engine.hpp"
-#include "../graphics/Image.hpp"
 #include "../graphics/Texture.hpp"
 
 #if defined(_MSC_VER)
@@ -53,6 +52,14 @@ namespace ouzel::assets
                                 const std::string& name,
                                 const std::vector<std::byte>& data,
                                 bool mipmaps)
+    {
+        const auto finish = prepareAsset(name, storage::FileView{data.data(), data.size()}, mipmaps);
+        return finish(bundle);
+    }
+
+    std::function<bool(Bundle&)> ImageLoader::prepareAsset(const std::string& name,
+                                                           const storage::FileView& data,
+                                                           bool mipmaps)
     {
         int width;
         int height;
@@ -147,20 +154,22 @@ namespace ouzel::assets
                 throw std::runtime_error("Unsupported pixel format");
         }
 
-        graphics::Image image(pixelFormat,
-                              Size2U(static_cast<std::uint32_t>(width),
-                                     static_cast<std::uint32_t>(height)),
-                              imageData);
+        const Size2U size(static_cast<std::uint32_t>(width),
+                          static_cast<std::uint32_t>(height));
+
+        // the decoding and the mip levels are the slow part, only the texture is created on the main thread
+        auto levels = graphics::Texture::generateLevels(size, imageData, mipmaps ? 0 : 1, pixelFormat);
 
-        auto texture = std::make_shared<graphics::Texture>(*engine->getGraphics(),
-                                                           image.getData(),
-                                                           image.getSize(),
-                                                           graphics::Flags::none,
-                                                           mipmaps ? 0 : 1,
-                                                           image.getPixelFormat());
+        return [name, size, pixelFormat, levels = std::move(levels)](Bundle& bundle) {
+            auto texture = std::make_shared<graphics::Texture>(*engine->getGraphics(),
+                                                               levels,
+                                                               size,
+                                                               graphics::Flags::none,
+                                                               pixelFormat);
 
-        bundle.setTexture(name, texture);
+            bundle.setTexture(name, texture);
 
-        return true;
+            return true;
+        };
     }
 }
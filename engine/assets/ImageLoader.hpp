@@ -15,6 +15,9 @@ namespace ouzel::assets
                        const std::string& name,
                        const std::vector<std::byte>& data,
                        bool mipmaps = true) final;
+        std::function<bool(Bundle&)> prepareAsset(const std::string& name,
+                                                  const storage::FileView& data,
+                                                  bool mipmaps = true) final;
     };
 }
 
@@ -4,8 +4,10 @@
 #define OUZEL_ASSETS_LOADER_HPP
 
 #include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
+#include "../storage/MappedFile.hpp"
 
 namespace ouzel::assets
 {
@@ -49,6 +51,20 @@ namespace ouzel::assets
                                const std::vector<std::byte>& data,
                                bool mipmaps = true) = 0;
 
+        // Called on a worker thread by Bundle::loadAssetsAsync, it can decode the data there (directly from the
+        // mapped file) and return the function that adds the asset to the bundle on the main thread (where the
+        // graphics and audio resources are created). The data stays valid until the returned function is called.
+        // An empty function means that the data is not in the format of the loader. By default the data is
+        // copied and the whole asset is loaded on the main thread.
+        virtual std::function<bool(Bundle&)> prepareAsset(const std::string& name,
+                                                          const storage::FileView& data,
+                                                          bool mipmaps = true)
+        {
+            return [this, name, buffer = std::vector<std::byte>(data.begin(), data.end()), mipmaps](Bundle& bundle) {
+                return loadAsset(bundle, name, buffer, mipmaps);
+            };
+        }
+
     protected:
         Cache& cache;
         Type type;
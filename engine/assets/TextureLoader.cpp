@@ -0,0 +1,87 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <memory>
+#include <stdexcept>
+#include "TextureLoader.hpp"
+#include "Bundle.hpp"
+#include "CookedTexture.hpp"
+#include "../core/Engine.hpp"
+#include "../graphics/Mipmaps.hpp"
+#include "../graphics/Texture.hpp"
+
+namespace ouzel::assets
+{
+    TextureLoader::TextureLoader(Cache& initCache):
+        Loader(initCache, Type::image)
+    {
+    }
+
+    bool TextureLoader::loadAsset(Bundle& bundle,
+                                  const std::string& name,
+                                  const std::vector<std::byte>& data,
+                                  bool mipmaps)
+    {
+        const auto finish = prepareAsset(name, storage::FileView{data.data(), data.size()}, mipmaps);
+        return finish && finish(bundle);
+    }
+
+    std::function<bool(Bundle&)> TextureLoader::prepareAsset(const std::string& name,
+                                                             const storage::FileView& data,
+                                                             bool mipmaps)
+    {
+        if (data.size() < cookedTextureHeaderSize ||
+            decodeLittleEndian<std::uint32_t>(data.begin()) != cookedTextureMagic)
+            return nullptr;
+
+        if (decodeLittleEndian<std::uint32_t>(data.begin() + 4) != cookedTextureVersion)
+            throw std::runtime_error("Unsupported texture version");
+
+        const auto pixelFormat = static_cast<graphics::PixelFormat>(decodeLittleEndian<std::uint32_t>(data.begin() + 8));
+        const std::uint32_t levelCount = decodeLittleEndian<std::uint32_t>(data.begin() + 12);
+        const std::size_t pixelSize = graphics::getPixelSize(pixelFormat);
+
+        if (pixelSize == 0)
+            throw std::runtime_error("Unsupported pixel format");
+
+        if (levelCount == 0)
+            throw std::runtime_error("Texture has no levels");
+
+        std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels;
+        std::size_t offset = cookedTextureHeaderSize;
+
+        // only the image is used if the texture should not have mip levels
+        for (std::uint32_t level = 0; level < (mipmaps ? levelCount : 1); ++level)
+        {
+            if (data.size() - offset < cookedTextureLevelHeaderSize)
+                throw std::runtime_error("Texture is too short");
+
+            const Size2U levelSize(decodeLittleEndian<std::uint32_t>(data.begin() + offset),
+                                   decodeLittleEndian<std::uint32_t>(data.begin() + offset + 4));
+            offset += cookedTextureLevelHeaderSize;
+
+            const std::size_t dataSize = std::size_t{levelSize.v[0]} * levelSize.v[1] * pixelSize;
+            if (data.size() - offset < dataSize)
+                throw std::runtime_error("Texture is too short");
+
+            const auto levelData = reinterpret_cast<const std::uint8_t*>(data.data() + offset);
+            levels.emplace_back(levelSize, std::vector<std::uint8_t>(levelData, levelData + dataSize));
+            offset += dataSize;
+        }
+
+        // the texture was cooked without mip levels
+        if (mipmaps && levelCount == 1)
+            levels = graphics::generateMipmaps(levels.front().first, levels.front().second, 0, pixelFormat);
+
+        return [name, pixelFormat, levels = std::move(levels)](Bundle& bundle) {
+            auto texture = std::make_shared<graphics::Texture>(*engine->getGraphics(),
+                                                               levels,
+                                                               levels.front().first,
+                                                               graphics::Flags::none,
+                                                               pixelFormat);
+
+            bundle.setTexture(name, texture);
+
+            return true;
+        };
+    }
+}
@@ -0,0 +1,25 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_ASSETS_TEXTURELOADER_HPP
+#define OUZEL_ASSETS_TEXTURELOADER_HPP
+
+#include "Loader.hpp"
+
+namespace ouzel::assets
+{
+    // loads the textures cooked by the ouzel tool, the other images are left to the ImageLoader
+    class TextureLoader final: public Loader
+    {
+    public:
+        explicit TextureLoader(Cache& initCache);
+        bool loadAsset(Bundle& bundle,
+                       const std::string& name,
+                       const std::vector<std::byte>& data,
+                       bool mipmaps = true) final;
+        std::function<bool(Bundle&)> prepareAsset(const std::string& name,
+                                                  const storage::FileView& data,
+                                                  bool mipmaps = true) final;
+    };
+}
+
+#endif // OUZEL_ASSETS_TEXTURELOADER_HPP
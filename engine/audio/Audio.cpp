@@ -136,19 +136,29 @@ namespace ouzel::audio
         device(createAudioDevice(driver,
                                  std::bind(&Audio::getSamples, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4),
                                  settings)),
-        mixer(device->getBufferSize(), device->getChannels(),
+        mixer(device->getBufferSize(), device->getChannels(), device->getSampleRate(),
+              settings.mixerBufferCount, settings.mixerWorkerCount, settings.resamplerQuality,
               std::bind(&Audio::eventCallback, this, std::placeholders::_1)),
         masterMix(*this),
-        rootNode(*this) // mixer.getRootObjectId()
+        rootNode(*this), // mixer.getRootObjectId()
+        voiceManager(*this, settings.maxRealVoices)
     {
         addCommand(std::make_unique<mixer::SetMasterBusCommand>(masterMix.getBusId()));
         device->start();
     }
 
+    Audio::~Audio()
+    {
+        // the device must not read from the mixer while it is being destroyed
+        device->stop();
+    }
+
     void Audio::update()
     {
         // TODO: handle events from the audio device
 
+        voiceManager.update();
+
         mixer.submitCommandBuffer(std::move(commandBuffer));
         commandBuffer = mixer::CommandBuffer();
     }
@@ -197,7 +207,11 @@ namespace ouzel::audio
         mixer.getSamples(frames, channels, sampleRate, samples);
     }
 
-    void Audio::eventCallback(const mixer::Mixer::Event&)
+    void Audio::eventCallback(const mixer::Mixer::Event& event)
     {
+        // called on the mixer thread
+        if (event.type == mixer::Mixer::Event::Type::starvation)
+            logger.log(Log::Level::warning) << "Audio device starved, " << event.starvedFrames <<
+                " frames of silence, " << event.starvationCount << " starvations in total";
     }
 }
@@ -13,6 +13,7 @@
 #include "Mix.hpp"
 #include "Node.hpp"
 #include "Settings.hpp"
+#include "VoiceManager.hpp"
 #include "mixer/Commands.hpp"
 #include "mixer/Processor.hpp"
 #include "mixer/Mixer.hpp"
@@ -27,6 +28,12 @@ namespace ouzel::audio
     {
     public:
         Audio(Driver driver, const Settings& settings);
+        ~Audio();
+
+        Audio(const Audio&) = delete;
+        Audio& operator=(const Audio&) = delete;
+        Audio(Audio&&) = delete;
+        Audio& operator=(Audio&&) = delete;
 
         static Driver getDriver(const std::string& driver);
         static std::set<Driver> getAvailableAudioDrivers();
@@ -34,6 +41,7 @@ namespace ouzel::audio
         auto getDevice() const noexcept { return device.get(); }
         mixer::Mixer& getMixer() { return mixer; }
         Mix& getMasterMix() { return masterMix; }
+        VoiceManager& getVoiceManager() { return voiceManager; }
 
         void update();
 
@@ -61,6 +69,7 @@ namespace ouzel::audio
         mixer::CommandBuffer commandBuffer;
         Mix masterMix;
         Node rootNode;
+        VoiceManager voiceManager;
     };
 }
 
@@ -1,6 +1,7 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
 #include "AudioDevice.hpp"
+#include "mixer/Kernels.hpp"
 
 namespace ouzel::audio
 {
@@ -27,29 +28,13 @@ namespace ouzel::audio
             case SampleFormat::signedInt16:
             {
                 result.resize(frames * channels * sizeof(std::int16_t));
-                auto resultPtr = reinterpret_cast<std::int16_t*>(result.data());
-
-                for (std::uint32_t channel = 0; channel < channels; ++channel)
-                {
-                    const auto bufferChannel = &buffer[channel * frames];
-
-                    for (std::uint32_t frame = 0; frame < frames; ++frame)
-                        resultPtr[frame * channels + channel] = static_cast<std::int16_t>(bufferChannel[frame] * 32767.0F);
-                }
+                mixer::interleave(buffer.data(), frames, channels, frames, reinterpret_cast<std::int16_t*>(result.data()));
                 break;
             }
             case SampleFormat::float32:
             {
                 result.resize(frames * channels * sizeof(float));
-                auto resultPtr = reinterpret_cast<float*>(result.data());
-
-                for (std::uint32_t channel = 0; channel < channels; ++channel)
-                {
-                    const auto bufferChannel = &buffer[channel * frames];
-
-                    for (std::uint32_t frame = 0; frame < frames; ++frame)
-                        resultPtr[frame * channels + channel] = bufferChannel[frame];
-                }
+                mixer::interleave(buffer.data(), frames, channels, frames, reinterpret_cast<float*>(result.data()));
                 break;
             }
             default:
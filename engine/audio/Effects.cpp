@@ -2,11 +2,13 @@
 
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 #include "Effects.hpp"
 #include "Audio.hpp"
+#include "mixer/Kernels.hpp"
+#include "mixer/PhaseVocoder.hpp"
 #include "../scene/Actor.hpp"
 #include "../math/MathUtils.hpp"
-#include "smbPitchShift.hpp"
 
 namespace ouzel::audio
 {
@@ -18,41 +20,60 @@ namespace ouzel::audio
         {
         }
 
-        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
-                     std::vector<float>& samples) final
+        void prepare(std::uint32_t, std::uint32_t channels, std::uint32_t sampleRate) final
         {
-            const auto delayFrames = static_cast<std::uint32_t>(delay * sampleRate);
-            const auto bufferFrames = frames + delayFrames;
+            // prepare is called on every graph change, so the delayed samples are kept if the format is the same
+            if (channels != bufferChannels || sampleRate != bufferSampleRate)
+            {
+                bufferChannels = channels;
+                bufferSampleRate = sampleRate;
+                resizeBuffer();
+            }
+        }
 
-            buffer.resize(bufferFrames * channels);
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t,
+                     std::vector<float>& samples) final
+        {
+            if (delayFrames == 0) return;
 
+            // the buffer is a ring of the last delayFrames input frames of every channel
             for (std::uint32_t channel = 0; channel < channels; ++channel)
             {
-                float* bufferChannel = &buffer[channel * bufferFrames];
+                float* bufferChannel = &buffer[channel * delayFrames];
                 float* outputChannel = &samples[channel * frames];
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    bufferChannel[frame + delayFrames] += outputChannel[frame];
-
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    outputChannel[frame] = bufferChannel[frame];
-
-                // erase frames from beginning
-                for (std::uint32_t frame = 0; frame < bufferFrames - frames; ++frame)
-                    bufferChannel[frame] = bufferChannel[frame + frames];
+                for (std::uint32_t frame = 0, bufferFrame = position; frame < frames; ++frame)
+                {
+                    const float sample = bufferChannel[bufferFrame];
+                    bufferChannel[bufferFrame] = outputChannel[frame];
+                    outputChannel[frame] = sample;
 
-                for (std::uint32_t frame = bufferFrames - frames; frame < bufferFrames; ++frame)
-                    bufferChannel[frame] = 0.0F;
+                    if (++bufferFrame == delayFrames) bufferFrame = 0;
+                }
             }
+
+            position = (position + frames) % delayFrames;
         }
 
         void setDelay(float newDelay)
         {
             delay = newDelay;
+            resizeBuffer();
         }
 
     private:
+        void resizeBuffer()
+        {
+            delayFrames = static_cast<std::uint32_t>(delay * bufferSampleRate);
+            buffer.assign(delayFrames * bufferChannels, 0.0F);
+            position = 0;
+        }
+
         float delay = 0.0F;
+        std::uint32_t bufferChannels = 0;
+        std::uint32_t bufferSampleRate = 0;
+        std::uint32_t delayFrames = 0;
+        std::uint32_t position = 0;
         std::vector<float> buffer;
     };
 
@@ -91,8 +112,7 @@ namespace ouzel::audio
         void process(std::uint32_t, std::uint32_t, std::uint32_t,
                      std::vector<float>& samples) final
         {
-            for (float& sample : samples)
-                sample *= gainFactor;
+            mixer::scale(samples.data(), samples.data(), samples.size(), gainFactor);
         }
 
         void setGain(float newGain)
@@ -233,15 +253,15 @@ namespace ouzel::audio
         {
         }
 
-        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
-                     std::vector<float>& samples) final
+        void prepare(std::uint32_t, std::uint32_t channels, std::uint32_t) final
         {
-            pitchShift.resize(channels);
+            phaseVocoder.prepare(channels);
+        }
 
-            for (std::uint32_t channel = 0; channel < channels; ++channel)
-                pitchShift[channel].process(scale, frames, sampleRate,
-                                            &samples[channel * frames],
-                                            &samples[channel * frames]);
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t,
+                     std::vector<float>& samples) final
+        {
+            phaseVocoder.process(scale, frames, channels, samples.data());
         }
 
         void setScale(float newScale)
@@ -251,7 +271,7 @@ namespace ouzel::audio
 
     private:
         float scale = 1.0f;
-        std::vector<smb::PitchShift<1024, 4>> pitchShift;
+        mixer::PhaseVocoder phaseVocoder;
     };
 
     PitchScale::PitchScale(Audio& initAudio, float initScale):
@@ -277,27 +297,111 @@ namespace ouzel::audio
         // TODO: pass to processor
     }
 
+    // Changes the pitch in the time domain, much cheaper than the phase vocoder of PitchScale, but sustained
+    // sounds get a slight flutter. Two taps read a delay line at the shifted rate, so that their delays sweep
+    // through a window of 50 ms, and they are half a window apart and crossfaded, so that the jump of a tap
+    // from one end of the window to the other is silent.
     class PitchShiftProcessor final: public mixer::Processor
     {
     public:
         explicit PitchShiftProcessor(float initShift):
-            shift(initShift)
+            shift(std::clamp(initShift, minPitch, maxPitch))
         {
         }
 
-        void process(std::uint32_t, std::uint32_t, std::uint32_t,
-                     std::vector<float>&) final
+        void prepare(std::uint32_t, std::uint32_t channels, std::uint32_t sampleRate) final
+        {
+            // prepare is called on every graph change, so the delay line is kept if the format is the same
+            if (channels == bufferChannels && sampleRate == bufferSampleRate) return;
+
+            bufferChannels = channels;
+            bufferSampleRate = sampleRate;
+
+            // even, so that the fades of the taps always add up to one
+            windowFrames = std::max(sampleRate / 40U, 1U) * 2U;
+
+            bufferFrames = 1;
+            while (bufferFrames < windowFrames + 2) bufferFrames *= 2;
+            buffer.assign(channels * bufferFrames, 0.0F);
+            position = 0;
+            delay = 0.0F;
+
+            const float pi = 3.14159265358979323846F;
+            // one more value for a delay that rounds up to the window
+            fade.resize(windowFrames + 1);
+            for (std::uint32_t i = 0; i <= windowFrames; ++i)
+            {
+                const auto s = std::sin(pi * static_cast<float>(i) / static_cast<float>(windowFrames));
+                fade[i] = s * s;
+            }
+        }
+
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t,
+                     std::vector<float>& samples) final
         {
-            // TODO: implement
+            if (channels != bufferChannels) return;
+
+            const auto window = static_cast<float>(windowFrames);
+            const auto halfWindow = static_cast<float>(windowFrames / 2);
+            const auto mask = bufferFrames - 1;
+            const auto step = 1.0F - shift; // delay change per frame
+
+            const auto read = [this, mask](const float* line, std::uint32_t writePosition, float tapDelay) noexcept {
+                const auto index = static_cast<std::uint32_t>(tapDelay);
+                const auto fraction = tapDelay - static_cast<float>(index);
+                const auto a = line[(writePosition - index) & mask];
+                const auto b = line[(writePosition - index - 1) & mask];
+                return (a + (b - a) * fraction) * fade[index];
+            };
+
+            // every channel starts from the same state, so that they stay in phase
+            auto channelPosition = position;
+            auto channelDelay = delay;
+
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+            {
+                float* line = &buffer[channel * bufferFrames];
+                float* channelSamples = &samples[channel * frames];
+                channelPosition = position;
+                channelDelay = delay;
+
+                for (std::uint32_t frame = 0; frame < frames; ++frame)
+                {
+                    line[channelPosition] = channelSamples[frame];
+
+                    auto otherDelay = channelDelay + halfWindow;
+                    if (otherDelay >= window) otherDelay -= window;
+
+                    channelSamples[frame] = read(line, channelPosition, channelDelay) +
+                        read(line, channelPosition, otherDelay);
+
+                    channelPosition = (channelPosition + 1) & mask;
+                    channelDelay += step;
+                    if (channelDelay >= window) channelDelay -= window;
+                    else if (channelDelay < 0.0F) channelDelay += window;
+                }
+            }
+
+            position = channelPosition;
+            delay = channelDelay;
         }
 
         void setShift(float newShift)
         {
-            shift = newShift;
+            shift = std::clamp(newShift, minPitch, maxPitch);
         }
 
     private:
         float shift = 1.0f;
+
+        std::uint32_t bufferChannels = 0;
+        std::uint32_t bufferSampleRate = 0;
+        std::uint32_t windowFrames = 0;
+        std::uint32_t bufferFrames = 0; // power of two, so that the positions wrap with a mask
+        std::vector<float> buffer;
+        std::vector<float> fade; // sin^2 crossfade over the window
+        std::uint32_t position = 0;
+        float delay = 0.0F;
     };
 
     PitchShift::PitchShift(Audio& initAudio, float initShift):
@@ -323,6 +427,9 @@ namespace ouzel::audio
         // TODO: pass to processor
     }
 
+    // Feedback delay network of eight delay lines of mutually prime lengths, mixed back into each other
+    // through an orthogonal Hadamard matrix. The input channels are summed into the lines and every
+    // output channel gets the lines with a different sign pattern, so that the channels are decorrelated.
     class ReverbProcessor final: public mixer::Processor
     {
     public:
@@ -331,39 +438,144 @@ namespace ouzel::audio
         {
         }
 
-        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+        void prepare(std::uint32_t, std::uint32_t, std::uint32_t sampleRate) final
+        {
+            // the lines do not depend on the channel count, so the tail is kept if only the sample rate stays
+            if (sampleRate != lineSampleRate)
+            {
+                lineSampleRate = sampleRate;
+                resizeLines();
+            }
+        }
+
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t,
                      std::vector<float>& samples) final
         {
-            const auto delayFrames = static_cast<std::uint32_t>(delay * sampleRate);
-            const auto bufferFrames = frames + delayFrames;
+            if (delayFrames == 0)
+            {
+                for (float& sample : samples)
+                    sample += sample * decay;
+                return;
+            }
 
-            buffers.resize(channels);
+            const float inputScale = lineScale / static_cast<float>(channels);
 
-            for (std::uint32_t channel = 0; channel < channels; ++channel)
+            for (std::uint32_t frame = 0; frame < frames;)
             {
-                std::vector<float>& buffer = buffers[channel];
-                buffer.resize(bufferFrames);
+                // none of the lines wraps around within a chunk
+                std::uint32_t chunkFrames = frames - frame;
+                float* lines[lineCount];
+                for (std::uint32_t line = 0; line < lineCount; ++line)
+                {
+                    chunkFrames = std::min(chunkFrames, lineLengths[line] - positions[line]);
+                    lines[line] = &buffer[lineOffsets[line] + positions[line]];
+                }
+
+                for (std::uint32_t i = 0; i < chunkFrames; ++i)
+                {
+                    float input = 0.0F;
+                    for (std::uint32_t channel = 0; channel < channels; ++channel)
+                        input += samples[channel * frames + frame + i];
+                    input *= inputScale;
+
+                    float values[lineCount];
+                    for (std::uint32_t line = 0; line < lineCount; ++line)
+                        values[line] = lines[line][i];
+
+                    for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    {
+                        const float* signs = hadamard[channel % lineCount];
+                        float output = 0.0F;
+                        for (std::uint32_t line = 0; line < lineCount; ++line)
+                            output += values[line] * signs[line];
+
+                        samples[channel * frames + frame + i] += output * lineScale;
+                    }
+
+                    // fast Walsh-Hadamard transform, scaled by lineScale in the gains to keep it orthogonal
+                    for (std::uint32_t half = 1; half < lineCount; half *= 2)
+                        for (std::uint32_t j = 0; j < lineCount; ++j)
+                            if ((j & half) == 0)
+                            {
+                                const float a = values[j];
+                                const float b = values[j + half];
+                                values[j] = a + b;
+                                values[j + half] = a - b;
+                            }
+
+                    for (std::uint32_t line = 0; line < lineCount; ++line)
+                        lines[line][i] = input + values[line] * gains[line];
+                }
+
+                for (std::uint32_t line = 0; line < lineCount; ++line)
+                {
+                    positions[line] += chunkFrames;
+                    if (positions[line] == lineLengths[line]) positions[line] = 0;
+                }
+
+                frame += chunkFrames;
+            }
+        }
 
-                float* outputChannel = &samples[channel * frames];
+    private:
+        static constexpr std::uint32_t lineCount = 8;
+        static constexpr float lineScale = 0.35355339F; // 1 / sqrt(lineCount)
+
+        // the rows of a Hadamard matrix are orthogonal
+        static constexpr float hadamard[lineCount][lineCount] = {
+            {1.0F, 1.0F, 1.0F, 1.0F, 1.0F, 1.0F, 1.0F, 1.0F},
+            {1.0F, -1.0F, 1.0F, -1.0F, 1.0F, -1.0F, 1.0F, -1.0F},
+            {1.0F, 1.0F, -1.0F, -1.0F, 1.0F, 1.0F, -1.0F, -1.0F},
+            {1.0F, -1.0F, -1.0F, 1.0F, 1.0F, -1.0F, -1.0F, 1.0F},
+            {1.0F, 1.0F, 1.0F, 1.0F, -1.0F, -1.0F, -1.0F, -1.0F},
+            {1.0F, -1.0F, 1.0F, -1.0F, -1.0F, 1.0F, -1.0F, 1.0F},
+            {1.0F, 1.0F, -1.0F, -1.0F, -1.0F, -1.0F, 1.0F, 1.0F},
+            {1.0F, -1.0F, -1.0F, 1.0F, -1.0F, 1.0F, 1.0F, -1.0F}
+        };
+
+        void resizeLines()
+        {
+            // spread between one and two times the delay, so that the echoes do not line up
+            static constexpr float lineRatios[lineCount] = {
+                1.0F, 1.1487F, 1.2974F, 1.4142F, 1.5422F, 1.6818F, 1.8340F, 1.9588F
+            };
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    buffer[frame] += outputChannel[frame];
+            delayFrames = static_cast<std::uint32_t>(delay * lineSampleRate);
+            std::uint32_t totalFrames = 0;
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    buffer[frame + delayFrames] += buffer[frame] * decay;
+            for (std::uint32_t line = 0; line < lineCount; ++line)
+            {
+                auto length = std::max(static_cast<std::uint32_t>(delayFrames * lineRatios[line]), 1U);
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    outputChannel[frame] = buffer[frame];
+                const auto isCoprime = [this, line](std::uint32_t value) noexcept {
+                    for (std::uint32_t previous = 0; previous < line; ++previous)
+                        if (std::gcd(value, lineLengths[previous]) != 1) return false;
+                    return true;
+                };
+
+                while (!isCoprime(length)) ++length;
 
-                // erase frames from beginning
-                buffer.erase(buffer.begin(), buffer.begin() + frames);
+                lineLengths[line] = length;
+                lineOffsets[line] = totalFrames;
+                positions[line] = 0;
+                totalFrames += length;
+
+                // every line loses the same energy per second
+                gains[line] = lineScale * std::pow(decay, static_cast<float>(length) / static_cast<float>(std::max(delayFrames, 1U)));
             }
+
+            buffer.assign(totalFrames, 0.0F);
         }
 
-    private:
         float delay = 0.1F;
         float decay = 0.5F;
-        std::vector<std::vector<float>> buffers;
+        std::uint32_t lineSampleRate = 0;
+        std::uint32_t delayFrames = 0;
+        std::uint32_t lineLengths[lineCount]{};
+        std::uint32_t lineOffsets[lineCount]{};
+        std::uint32_t positions[lineCount]{};
+        float gains[lineCount]{}; // feedback gains, including the scale of the Hadamard transform
+        std::vector<float> buffer; // the rings of all the lines one after another
     };
 
     Reverb::Reverb(Audio& initAudio, float initDelay, float initDecay):
@@ -374,33 +586,141 @@ namespace ouzel::audio
     {
     }
 
-    class LowPassProcessor final: public mixer::Processor
+    class BiquadProcessor final: public mixer::Processor
     {
     public:
-        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+        enum class Type
+        {
+            lowPass,
+            highPass
+        };
+
+        BiquadProcessor(Type initType, float initCutoffFrequency, float initResonance):
+            type(initType),
+            cutoffFrequency(initCutoffFrequency),
+            resonance(initResonance)
+        {
+        }
+
+        void prepare(std::uint32_t, std::uint32_t channels, std::uint32_t sampleRate) final
+        {
+            if (channels * 2 != state.size())
+                state.assign(channels * 2, 0.0F);
+
+            if (sampleRate != filterSampleRate)
+            {
+                filterSampleRate = sampleRate;
+                updateCoefficients();
+            }
+        }
+
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t,
                      std::vector<float>& samples) final
         {
+            mixer::biquad(coefficients, samples.data(), frames, channels, frames, state.data());
+        }
+
+        void setCutoffFrequency(float newCutoffFrequency)
+        {
+            cutoffFrequency = newCutoffFrequency;
+            updateCoefficients();
+        }
+
+        void setResonance(float newResonance)
+        {
+            resonance = newResonance;
+            updateCoefficients();
         }
+
+    private:
+        // from the Audio EQ Cookbook by Robert Bristow-Johnson
+        void updateCoefficients()
+        {
+            if (filterSampleRate == 0) return;
+
+            const double pi = 3.14159265358979323846;
+            const double nyquist = filterSampleRate / 2.0;
+            const double frequency = std::clamp(static_cast<double>(cutoffFrequency), 1.0, nyquist * 0.99);
+            const double omega = 2.0 * pi * frequency / filterSampleRate;
+            const double cosine = std::cos(omega);
+            const double alpha = std::sin(omega) / (2.0 * std::max(static_cast<double>(resonance), 0.01));
+            const double a0 = 1.0 + alpha;
+
+            const double b1 = (type == Type::lowPass) ? 1.0 - cosine : -(1.0 + cosine);
+            const double b0 = (type == Type::lowPass) ? b1 / 2.0 : -b1 / 2.0;
+
+            coefficients.b0 = static_cast<float>(b0 / a0);
+            coefficients.b1 = static_cast<float>(b1 / a0);
+            coefficients.b2 = static_cast<float>(b0 / a0);
+            coefficients.a1 = static_cast<float>(-2.0 * cosine / a0);
+            coefficients.a2 = static_cast<float>((1.0 - alpha) / a0);
+        }
+
+        Type type;
+        float cutoffFrequency;
+        float resonance;
+        std::uint32_t filterSampleRate = 0;
+        mixer::BiquadCoefficients coefficients;
+        std::vector<float> state;
     };
 
-    LowPass::LowPass(Audio& initAudio):
+    LowPass::LowPass(Audio& initAudio, float initCutoffFrequency, float initResonance):
         Effect(initAudio,
-               initAudio.initProcessor(std::unique_ptr<LowPassProcessor>()))
+               initAudio.initProcessor(std::make_unique<BiquadProcessor>(BiquadProcessor::Type::lowPass,
+                                                                         initCutoffFrequency,
+                                                                         initResonance))),
+        cutoffFrequency(initCutoffFrequency),
+        resonance(initResonance)
     {
     }
 
-    class HighPassProcessor final: public mixer::Processor
+    void LowPass::setCutoffFrequency(float newCutoffFrequency)
     {
-    public:
-        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
-                     std::vector<float>& samples) final
-        {
-        }
-    };
+        cutoffFrequency = newCutoffFrequency;
+
+        audio.updateProcessor(processorId, [newCutoffFrequency](mixer::Object* node) {
+            auto biquadProcessor = static_cast<BiquadProcessor*>(node);
+            biquadProcessor->setCutoffFrequency(newCutoffFrequency);
+        });
+    }
+
+    void LowPass::setResonance(float newResonance)
+    {
+        resonance = newResonance;
+
+        audio.updateProcessor(processorId, [newResonance](mixer::Object* node) {
+            auto biquadProcessor = static_cast<BiquadProcessor*>(node);
+            biquadProcessor->setResonance(newResonance);
+        });
+    }
 
-    HighPass::HighPass(Audio& initAudio):
+    HighPass::HighPass(Audio& initAudio, float initCutoffFrequency, float initResonance):
         Effect(initAudio,
-               initAudio.initProcessor(std::unique_ptr<HighPassProcessor>()))
+               initAudio.initProcessor(std::make_unique<BiquadProcessor>(BiquadProcessor::Type::highPass,
+                                                                         initCutoffFrequency,
+                                                                         initResonance))),
+        cutoffFrequency(initCutoffFrequency),
+        resonance(initResonance)
+    {
+    }
+
+    void HighPass::setCutoffFrequency(float newCutoffFrequency)
     {
+        cutoffFrequency = newCutoffFrequency;
+
+        audio.updateProcessor(processorId, [newCutoffFrequency](mixer::Object* node) {
+            auto biquadProcessor = static_cast<BiquadProcessor*>(node);
+            biquadProcessor->setCutoffFrequency(newCutoffFrequency);
+        });
+    }
+
+    void HighPass::setResonance(float newResonance)
+    {
+        resonance = newResonance;
+
+        audio.updateProcessor(processorId, [newResonance](mixer::Object* node) {
+            auto biquadProcessor = static_cast<BiquadProcessor*>(node);
+            biquadProcessor->setResonance(newResonance);
+        });
     }
 }
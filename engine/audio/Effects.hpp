@@ -101,7 +101,7 @@ namespace ouzel::audio
         void setScaleRandom(const std::pair<float, float>& newScaleRandom);
 
     private:
-        float scale = 1.0F;
+        float scale = 1.0F; // pitch ratio from 0.5 to 2, the duration is not changed
         std::pair<float, float> scaleRandom{0.0F, 0.0F};
     };
 
@@ -122,7 +122,7 @@ namespace ouzel::audio
         void setShiftRandom(const std::pair<float, float>& newShiftRandom);
 
     private:
-        float shift = 1.0f;
+        float shift = 1.0f; // pitch ratio from 0.5 to 2, cheaper but rougher than PitchScale
         std::pair<float, float> shiftRandom{0.0F, 0.0F};
     };
 
@@ -147,23 +147,45 @@ namespace ouzel::audio
     class LowPass final: public Effect
     {
     public:
-        explicit LowPass(Audio& initAudio);
+        LowPass(Audio& initAudio, float initCutoffFrequency = 1000.0F, float initResonance = 0.7071F);
 
         LowPass(const LowPass&) = delete;
         LowPass& operator=(const LowPass&) = delete;
         LowPass(LowPass&&) = delete;
         LowPass& operator=(LowPass&&) = delete;
+
+        auto getCutoffFrequency() const noexcept { return cutoffFrequency; }
+        void setCutoffFrequency(float newCutoffFrequency);
+
+        // Q factor, 0.7071 gives a flat pass band
+        auto getResonance() const noexcept { return resonance; }
+        void setResonance(float newResonance);
+
+    private:
+        float cutoffFrequency = 1000.0F; // Hz
+        float resonance = 0.7071F;
     };
 
     class HighPass final: public Effect
     {
     public:
-        explicit HighPass(Audio& initAudio);
+        HighPass(Audio& initAudio, float initCutoffFrequency = 1000.0F, float initResonance = 0.7071F);
 
         HighPass(const HighPass&) = delete;
         HighPass& operator=(const HighPass&) = delete;
         HighPass(HighPass&&) = delete;
         HighPass& operator=(HighPass&&) = delete;
+
+        auto getCutoffFrequency() const noexcept { return cutoffFrequency; }
+        void setCutoffFrequency(float newCutoffFrequency);
+
+        // Q factor, 0.7071 gives a flat pass band
+        auto getResonance() const noexcept { return resonance; }
+        void setResonance(float newResonance);
+
+    private:
+        float cutoffFrequency = 1000.0F; // Hz
+        float resonance = 0.7071F;
     };
 }
 
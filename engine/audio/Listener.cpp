@@ -17,6 +17,9 @@ namespace ouzel::audio
     Listener::~Listener()
     {
         if (mix) mix->removeListener(this);
+
+        auto& voiceManager = audio.getVoiceManager();
+        if (voiceManager.getListener() == this) voiceManager.setListener(nullptr);
     }
 
     void Listener::setMix(Mix* newMix)
@@ -22,6 +22,7 @@ namespace ouzel::audio
         }
 
         void getSamples(std::uint32_t frames, std::vector<float>& samples) final;
+        void skip(std::uint32_t frames) final;
 
     private:
         std::uint32_t position = 0;
@@ -91,6 +92,20 @@ namespace ouzel::audio
         }
     }
 
+    void PcmStream::skip(std::uint32_t frames)
+    {
+        const auto& pcmData = static_cast<PcmData&>(data);
+        const auto sourceFrames = static_cast<std::uint32_t>(pcmData.getSamples().size() / pcmData.getChannels());
+
+        position += (frames > sourceFrames - position) ? sourceFrames - position : frames;
+
+        if ((sourceFrames - position) == 0)
+        {
+            playing = false;
+            reset();
+        }
+    }
+
     PcmClip::PcmClip(Audio& initAudio, std::uint32_t channels, std::uint32_t sampleRate,
                       const std::vector<float>& samples):
         Sound(initAudio,
@@ -4,7 +4,9 @@
 #define OUZEL_AUDIO_SETTINGS_HPP
 
 #include <cstdint>
+#include <string>
 #include "SampleFormat.hpp"
+#include "mixer/Resampler.hpp"
 
 namespace ouzel::audio
 {
@@ -14,6 +16,15 @@ namespace ouzel::audio
         std::uint32_t bufferSize = 512;
         std::uint32_t sampleRate = 44100;
         std::uint32_t channels = 0;
+#if defined(__EMSCRIPTEN__)
+        std::uint32_t mixerBufferCount = 0; // mixed in the audio callback
+        std::uint32_t mixerWorkerCount = 0;
+#else
+        std::uint32_t mixerBufferCount = 3; // number of buffers mixed ahead of the audio device
+        std::uint32_t mixerWorkerCount = 2; // threads that help the mixer thread with independent buses
+#endif
+        mixer::Resampler::Quality resamplerQuality = mixer::Resampler::Quality::medium;
+        std::uint32_t maxRealVoices = 64; // the quieter voices are virtual
         SampleFormat sampleFormat = SampleFormat::float32;
         std::string audioDevice;
     };
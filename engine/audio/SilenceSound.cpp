@@ -20,6 +20,7 @@ namespace ouzel::audio
         }
 
         void getSamples(std::uint32_t frames, std::vector<float>& samples) final;
+        void skip(std::uint32_t frames) final;
 
     private:
         std::uint32_t position = 0;
@@ -53,31 +54,21 @@ namespace ouzel::audio
 
     void SilenceStream::getSamples(std::uint32_t frames, std::vector<float>& samples)
     {
-        auto& silenceData = static_cast<SilenceData&>(data);
-
         samples.resize(frames);
         std::fill(samples.begin(), samples.end(), 0.0F); // TODO: fill only the needed samples
 
-        const auto length = static_cast<SilenceData&>(silenceData).getLength();
+        skip(frames);
+    }
+
+    void SilenceStream::skip(std::uint32_t frames)
+    {
+        const auto length = static_cast<SilenceData&>(data).getLength();
 
         if (length > 0.0F)
         {
             const auto frameCount = static_cast<std::uint32_t>(length * data.getSampleRate());
-            auto neededSize = frames;
 
-            if (neededSize > 0)
-            {
-                if (frameCount - position < neededSize)
-                {
-                    neededSize -= frameCount - position;
-                    position = frameCount;
-                }
-                else
-                {
-                    position += neededSize;
-                    neededSize = 0;
-                }
-            }
+            position += (frameCount - position < frames) ? frameCount - position : frames;
 
             if ((frameCount - position) == 0)
             {
@@ -8,6 +8,7 @@
 #include "SilenceSound.hpp"
 #include "Sound.hpp"
 #include "Source.hpp"
+#include "VoiceManager.hpp"
 #include "WavePlayer.hpp"
 #include "../core/Engine.hpp"
 
@@ -111,10 +112,10 @@ namespace ouzel::audio
                     effects.push_back(std::make_unique<Reverb>(initAudio, effectDefinition.delay, effectDefinition.decay));
                     break;
                 case EffectDefinition::Type::lowPass:
-                    effects.push_back(std::make_unique<LowPass>(initAudio));
+                    effects.push_back(std::make_unique<LowPass>(initAudio, effectDefinition.cutoffFrequency, effectDefinition.resonance));
                     break;
                 case EffectDefinition::Type::highPass:
-                    effects.push_back(std::make_unique<HighPass>(initAudio));
+                    effects.push_back(std::make_unique<HighPass>(initAudio, effectDefinition.cutoffFrequency, effectDefinition.resonance));
                     break;
             }
         }
@@ -131,12 +132,23 @@ namespace ouzel::audio
         streamId(audio.initStream(initSound->getSourceId()))
     {
         sound = initSound;
+        audio.getVoiceManager().addVoice(this);
     }
 
     Voice::~Voice()
     {
         if (streamId)
+        {
+            audio.getVoiceManager().removeVoice(this);
             audio.deleteObject(streamId);
+        }
+    }
+
+    void Voice::setGain(float newGain)
+    {
+        gain = newGain;
+
+        audio.addCommand(std::make_unique<mixer::SetStreamGainCommand>(streamId, newGain));
     }
 
     void Voice::play()
@@ -144,11 +156,12 @@ namespace ouzel::audio
         audio.addCommand(std::make_unique<mixer::PlayStreamCommand>(streamId));
 
         playing = true;
+        ++playCount;
 
-        auto startEvent = std::make_unique<SoundEvent>();
-        startEvent->type = Event::Type::soundStart;
-        startEvent->voice = this;
-        engine->getEventDispatcher().postEvent(std::move(startEvent));
+        SoundEvent startEvent;
+        startEvent.type = Event::Type::soundStart;
+        startEvent.voice = this;
+        engine->getEventDispatcher().queueEvent(std::move(startEvent));
 
         // TODO: send PlayCommand
     }
@@ -174,22 +187,22 @@ namespace ouzel::audio
     // executed on audio thread
     /*void Voice::onReset()
     {
-        auto event = std::make_unique<SoundEvent>();
-        event->type = Event::Type::soundReset;
-        event->voice = this;
-        engine->getEventDispatcher().postEvent(std::move(event));
-    }
+        SoundEvent event;
+        event.type = Event::Type::soundReset;
+        event.voice = this;
+        engine->getEventDispatcher().queueEvent(std::move(event));
+    }*/
 
-    // executed on audio thread
+    // called by the voice manager when the mixer reports that the stream reached its end
     void Voice::onStop()
     {
         playing = false;
 
-        auto event = std::make_unique<SoundEvent>();
-        event->type = Event::Type::soundFinish;
-        event->voice = this;
-        engine->getEventDispatcher().postEvent(std::move(event));
-    }*/
+        SoundEvent event;
+        event.type = Event::Type::soundFinish;
+        event.voice = this;
+        engine->getEventDispatcher().queueEvent(std::move(event));
+    }
 
     void Voice::setOutput(Mix* newOutput)
     {
@@ -3,6 +3,8 @@
 #ifndef OUZEL_AUDIO_VOICE_HPP
 #define OUZEL_AUDIO_VOICE_HPP
 
+#include <cfloat>
+#include <cstdint>
 #include <memory>
 #include "Cue.hpp"
 #include "Node.hpp"
@@ -13,10 +15,12 @@ namespace ouzel::audio
     class Audio;
     class Mix;
     class Sound;
+    class VoiceManager;
 
     class Voice final: public Node
     {
         friend Mix;
+        friend VoiceManager;
     public:
         explicit Voice(Audio& initAudio);
         Voice(Audio& initAudio, const Cue& cue);
@@ -46,23 +50,62 @@ namespace ouzel::audio
         auto& getVelocity() const noexcept { return velocity; }
         void setVelocity(const Vector3F& newVelocity) { velocity = newVelocity; }
 
+        auto getGain() const noexcept { return gain; }
+        void setGain(float newGain);
+
+        // the voice manager keeps the voices with a higher priority real before the louder ones
+        auto getPriority() const noexcept { return priority; }
+        void setPriority(std::int32_t newPriority) { priority = newPriority; }
+
+        // the voice manager can limit the number of real voices per category
+        auto getCategory() const noexcept { return category; }
+        void setCategory(std::uint32_t newCategory) { category = newCategory; }
+
+        // distance attenuation used to estimate the loudness of the voice
+        auto getRolloffFactor() const noexcept { return rolloffFactor; }
+        void setRolloffFactor(float newRolloffFactor) { rolloffFactor = newRolloffFactor; }
+
+        auto getMinDistance() const noexcept { return minDistance; }
+        void setMinDistance(float newMinDistance) { minDistance = newMinDistance; }
+
+        auto getMaxDistance() const noexcept { return maxDistance; }
+        void setMaxDistance(float newMaxDistance) { maxDistance = newMaxDistance; }
+
         void play();
         void pause();
         void stop();
 
         auto isPlaying() const noexcept { return playing; }
 
+        // a virtual voice keeps playing without being decoded or mixed
+        auto isVirtual() const noexcept { return virtualized; }
+
+        // estimated loudness of the voice at the listener as of the last update of the voice manager
+        auto getAudibility() const noexcept { return audibility; }
+
         void setOutput(Mix* newOutput);
 
     private:
+        void onStop();
+
         Audio& audio;
-        std::size_t streamId;
+        std::size_t streamId = 0;
+        std::size_t playCount = 0; // number of play commands sent to the stream
 
         const Sound* sound = nullptr;
         Vector3F position;
         Vector3F velocity;
         bool playing = false;
 
+        float gain = 1.0F;
+        std::int32_t priority = 0;
+        std::uint32_t category = 0;
+        float rolloffFactor = 1.0F;
+        float minDistance = 1.0F;
+        float maxDistance = FLT_MAX;
+        bool virtualized = false;
+        float audibility = 0.0F;
+
         Mix* output = nullptr;
     };
 }
@@ -0,0 +1,131 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include "VoiceManager.hpp"
+#include "Audio.hpp"
+#include "Listener.hpp"
+#include "Voice.hpp"
+
+namespace ouzel::audio
+{
+    namespace
+    {
+        // a real voice stays real until a virtual voice is this much louder, so that voices of a similar
+        // loudness do not swap on every update
+        constexpr float hysteresis = 1.25F;
+
+        // inverse distance model clamped to the range of the voice, like the one of the panner
+        float getAttenuation(float distance, float minDistance, float maxDistance, float rolloffFactor) noexcept
+        {
+            const auto clampedDistance = std::min(distance, maxDistance);
+            if (clampedDistance <= minDistance) return 1.0F;
+
+            const auto denominator = minDistance + rolloffFactor * (clampedDistance - minDistance);
+            return (denominator > 0.0F) ? minDistance / denominator : 1.0F;
+        }
+    }
+
+    VoiceManager::VoiceManager(Audio& initAudio, std::uint32_t initMaxRealVoices):
+        audio(initAudio),
+        maxRealVoices(initMaxRealVoices)
+    {
+    }
+
+    std::uint32_t VoiceManager::getCategoryLimit(std::uint32_t category) const noexcept
+    {
+        return (category < categoryLimits.size()) ? categoryLimits[category] : unlimited;
+    }
+
+    void VoiceManager::setCategoryLimit(std::uint32_t category, std::uint32_t limit)
+    {
+        if (category >= categoryLimits.size())
+            categoryLimits.resize(category + 1, unlimited);
+
+        categoryLimits[category] = limit;
+    }
+
+    void VoiceManager::update()
+    {
+        stoppedStreams.clear();
+        audio.getMixer().getStoppedStreams(stoppedStreams);
+
+        for (const auto& stoppedStream : stoppedStreams)
+            for (Voice* voice : voices)
+                if (voice->streamId == stoppedStream.streamId)
+                {
+                    // the voice could have been started again after the stream stopped
+                    if (voice->playing && voice->playCount == stoppedStream.playCount)
+                        voice->onStop();
+                    break;
+                }
+
+        playingVoices.clear();
+
+        for (Voice* voice : voices)
+        {
+            if (!voice->playing) continue;
+
+            voice->audibility = voice->gain;
+            if (listener)
+                voice->audibility *= getAttenuation(listener->getPosition().distance(voice->position),
+                                                    voice->minDistance, voice->maxDistance, voice->rolloffFactor);
+
+            playingVoices.push_back(voice);
+        }
+
+        const auto getScore = [](const Voice* voice) noexcept {
+            return voice->virtualized ? voice->audibility : voice->audibility * hysteresis;
+        };
+
+        std::sort(playingVoices.begin(), playingVoices.end(),
+                  [&getScore](const Voice* a, const Voice* b) noexcept {
+                      if (a->priority != b->priority) return a->priority > b->priority;
+                      return getScore(a) > getScore(b);
+                  });
+
+        categoryCounts.assign(categoryLimits.size(), 0);
+        std::uint32_t realVoices = 0;
+
+        for (Voice* voice : playingVoices)
+        {
+            const auto category = voice->category;
+
+            const bool real = realVoices < maxRealVoices &&
+                voice->audibility >= audibilityThreshold &&
+                (category >= categoryLimits.size() || categoryCounts[category] < categoryLimits[category]);
+
+            if (real)
+            {
+                ++realVoices;
+                if (category < categoryCounts.size()) ++categoryCounts[category];
+            }
+
+            if (real == voice->virtualized)
+            {
+                voice->virtualized = !real;
+                audio.addCommand(std::make_unique<mixer::SetStreamVirtualCommand>(voice->streamId, !real));
+
+                if (real)
+                    ++statistics.restorations;
+                else
+                    ++statistics.virtualizations;
+            }
+        }
+
+        statistics.playingVoices = playingVoices.size();
+        statistics.realVoices = realVoices;
+        statistics.virtualVoices = playingVoices.size() - realVoices;
+    }
+
+    void VoiceManager::addVoice(Voice* voice)
+    {
+        const auto i = std::find(voices.begin(), voices.end(), voice);
+        if (i == voices.end()) voices.push_back(voice);
+    }
+
+    void VoiceManager::removeVoice(Voice* voice)
+    {
+        const auto i = std::find(voices.begin(), voices.end(), voice);
+        if (i != voices.end()) voices.erase(i);
+    }
+}
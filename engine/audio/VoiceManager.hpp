@@ -0,0 +1,81 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_VOICEMANAGER_HPP
+#define OUZEL_AUDIO_VOICEMANAGER_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "mixer/Mixer.hpp"
+
+namespace ouzel::audio
+{
+    class Audio;
+    class Listener;
+    class Voice;
+
+    // Keeps only the most important playing voices real. The other voices are virtual, the mixer
+    // advances their position without decoding or mixing them until they are made real again.
+    class VoiceManager final
+    {
+        friend Voice;
+    public:
+        struct Statistics final
+        {
+            std::size_t playingVoices = 0;
+            std::size_t realVoices = 0;
+            std::size_t virtualVoices = 0;
+            std::size_t virtualizations = 0; // total number of times a real voice was made virtual
+            std::size_t restorations = 0; // total number of times a virtual voice was made real
+        };
+
+        static constexpr std::uint32_t unlimited = std::numeric_limits<std::uint32_t>::max();
+
+        VoiceManager(Audio& initAudio, std::uint32_t initMaxRealVoices);
+
+        VoiceManager(const VoiceManager&) = delete;
+        VoiceManager& operator=(const VoiceManager&) = delete;
+        VoiceManager(VoiceManager&&) = delete;
+        VoiceManager& operator=(VoiceManager&&) = delete;
+
+        auto getMaxRealVoices() const noexcept { return maxRealVoices; }
+        void setMaxRealVoices(std::uint32_t newMaxRealVoices) { maxRealVoices = newMaxRealVoices; }
+
+        // maximum number of real voices of the category
+        std::uint32_t getCategoryLimit(std::uint32_t category) const noexcept;
+        void setCategoryLimit(std::uint32_t category, std::uint32_t limit);
+
+        // voices with a lower estimated loudness are virtual even if there are free real voices
+        auto getAudibilityThreshold() const noexcept { return audibilityThreshold; }
+        void setAudibilityThreshold(float newAudibilityThreshold) { audibilityThreshold = newAudibilityThreshold; }
+
+        // the distance attenuation is not taken into account without a listener
+        auto getListener() const noexcept { return listener; }
+        void setListener(const Listener* newListener) { listener = newListener; }
+
+        auto& getStatistics() const noexcept { return statistics; }
+
+        // stops the voices whose streams reached their end, estimates the loudness of the playing voices
+        // and makes the loudest voices of every priority real
+        void update();
+
+    private:
+        void addVoice(Voice* voice);
+        void removeVoice(Voice* voice);
+
+        Audio& audio;
+        std::uint32_t maxRealVoices;
+        std::vector<std::uint32_t> categoryLimits;
+        float audibilityThreshold = 0.001F; // -60 dB
+        const Listener* listener = nullptr;
+
+        std::vector<Voice*> voices;
+        std::vector<mixer::Mixer::StoppedStream> stoppedStreams;
+        std::vector<Voice*> playingVoices; // sorted by importance on every update
+        std::vector<std::uint32_t> categoryCounts;
+
+        Statistics statistics;
+    };
+}
+
+#endif // OUZEL_AUDIO_VOICEMANAGER_HPP
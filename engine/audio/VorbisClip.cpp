@@ -1,10 +1,19 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <istream>
+#include <mutex>
 #include <stdexcept>
 #include "VorbisClip.hpp"
 #include "Audio.hpp"
 #include "mixer/Data.hpp"
+#include "mixer/RingBuffer.hpp"
 #include "mixer/Stream.hpp"
+#include "../storage/FileSystem.hpp"
+#include "../thread/Thread.hpp"
+#include "../utils/Log.hpp"
 #include "../utils/Utils.hpp"
 
 #if defined(_MSC_VER)
@@ -59,12 +68,17 @@ namespace ouzel::audio
         void reset() final
         {
             stb_vorbis_seek_start(vorbisStream);
+            position = 0;
+            seekPending = false;
         }
 
         void getSamples(std::uint32_t frames, std::vector<float>& samples) final;
+        void skip(std::uint32_t frames) final;
 
     private:
         stb_vorbis* vorbisStream = nullptr;
+        std::uint32_t position = 0;
+        bool seekPending = false; // the skipped frames are sought only when the stream is mixed again
     };
 
     class VorbisData final: public mixer::Data
@@ -84,11 +98,13 @@ namespace ouzel::audio
 
             channels = static_cast<std::uint32_t>(info.channels);
             sampleRate = info.sample_rate;
+            frames = stb_vorbis_stream_length_in_samples(vorbisStream);
 
             stb_vorbis_close(vorbisStream);
         }
 
         auto& getData() const noexcept { return data; }
+        auto getFrames() const noexcept { return frames; }
 
         std::unique_ptr<mixer::Stream> createStream() final
         {
@@ -97,6 +113,7 @@ namespace ouzel::audio
 
     private:
         std::vector<std::byte> data;
+        std::uint32_t frames = 0;
     };
 
     VorbisStream::VorbisStream(VorbisData& vorbisData):
@@ -119,6 +136,12 @@ namespace ouzel::audio
             if (vorbisStream->eof)
                 reset();
 
+            if (seekPending)
+            {
+                stb_vorbis_seek_frame(vorbisStream, position);
+                seekPending = false;
+            }
+
             std::vector<float*> channelData(data.getChannels());
 
             switch (data.getChannels())
@@ -152,6 +175,7 @@ namespace ouzel::audio
                                                         static_cast<int>(data.getChannels()),
                                                         channelData.data(),
                                                         static_cast<int>(frames));
+            position += static_cast<std::uint32_t>(resultFrames);
         }
 
         if (vorbisStream->eof)
@@ -165,10 +189,501 @@ namespace ouzel::audio
                 samples[channel * frames + frame] = 0.0F;
     }
 
+    void VorbisStream::skip(std::uint32_t frames)
+    {
+        if (position + frames >= static_cast<VorbisData&>(data).getFrames())
+        {
+            playing = false;
+            reset();
+        }
+        else
+        {
+            position += frames;
+            seekPending = true;
+        }
+    }
+
+    namespace
+    {
+        constexpr std::size_t inputChunkSize = 16384;
+        constexpr std::size_t maxInputSize = 1024 * 1024; // limit for the headers and a single packet
+
+        // reads the next chunk of the file after the unconsumed input, returns false at the end of the file
+        bool readInput(std::istream& file, std::vector<unsigned char>& input, std::size_t& inputSize)
+        {
+            if (input.size() - inputSize < inputChunkSize)
+            {
+                if (inputSize + inputChunkSize > maxInputSize)
+                    throw std::runtime_error("Vorbis packet is too large");
+
+                input.resize(inputSize + inputChunkSize);
+            }
+
+            file.read(reinterpret_cast<char*>(input.data() + inputSize), static_cast<std::streamsize>(inputChunkSize));
+            if (file.bad())
+                throw std::runtime_error("Failed to read Vorbis stream");
+
+            const auto readSize = static_cast<std::size_t>(file.gcount());
+            inputSize += readSize;
+
+            return readSize > 0;
+        }
+
+        void consumeInput(std::vector<unsigned char>& input, std::size_t& inputSize, std::size_t size) noexcept
+        {
+            std::copy(input.begin() + static_cast<std::ptrdiff_t>(size),
+                      input.begin() + static_cast<std::ptrdiff_t>(inputSize),
+                      input.begin());
+            inputSize -= size;
+        }
+
+        // parses the headers from the beginning of the file
+        stb_vorbis* openDecoder(std::istream& file, std::vector<unsigned char>& input, std::size_t& inputSize)
+        {
+            for (;;)
+            {
+                if (!readInput(file, input, inputSize))
+                    throw std::runtime_error("Failed to load Vorbis stream");
+
+                int usedSize = 0;
+                int error = 0;
+                stb_vorbis* decoder = stb_vorbis_open_pushdata(input.data(), static_cast<int>(inputSize),
+                                                               &usedSize, &error, nullptr);
+
+                if (decoder)
+                {
+                    consumeInput(input, inputSize, static_cast<std::size_t>(usedSize));
+                    return decoder;
+                }
+
+                if (error != VORBIS_need_more_data)
+                    throw std::runtime_error("Failed to load Vorbis stream");
+            }
+        }
+
+        // maps the Vorbis channel order to the order of the mixer
+        constexpr std::uint32_t getChannel(std::uint32_t channels, std::uint32_t channel) noexcept
+        {
+            constexpr std::uint32_t sixChannels[] = {0, 2, 1, 4, 5, 3}; // L, C, R, SL, SR, LFE
+            return (channels == 6) ? sixChannels[channel] : channel;
+        }
+    }
+
+    class StreamingVorbisDecoder;
+
+    class StreamingVorbisData final: public mixer::Data
+    {
+    public:
+        StreamingVorbisData(storage::FileSystem& initFileSystem,
+                            const storage::Path& initFilename,
+                            std::uint32_t initBufferFrames):
+            fileSystem(initFileSystem),
+            filename(initFilename),
+            bufferFrames(initBufferFrames)
+        {
+            const auto file = fileSystem.openFile(filename);
+            std::vector<unsigned char> input;
+            std::size_t inputSize = 0;
+            stb_vorbis* decoder = openDecoder(*file, input, inputSize);
+
+            const stb_vorbis_info info = stb_vorbis_get_info(decoder);
+            stb_vorbis_close(decoder);
+
+            channels = static_cast<std::uint32_t>(info.channels);
+            sampleRate = info.sample_rate;
+
+            if (channels != 1 && channels != 2 && channels != 4 && channels != 6)
+                throw std::runtime_error("Unsupported channel count");
+
+            decoderThread = thread::Thread(&StreamingVorbisData::decoderMain, this);
+        }
+
+        ~StreamingVorbisData() override;
+
+        std::unique_ptr<mixer::Stream> createStream() final;
+
+        auto getBufferFrames() const noexcept { return bufferFrames; }
+
+        // the file is opened by the decoder thread, so that the mixer does not wait for it
+        std::unique_ptr<std::istream> openFile() const
+        {
+            return fileSystem.openFile(filename);
+        }
+
+        // the decoder belongs to the data until the stream releases it and the decoder thread destroys it
+        StreamingVorbisDecoder* addDecoder();
+
+        // can be called by the mixer, does not block
+        void requestDecode() noexcept
+        {
+            decoderCondition.notify_all();
+        }
+
+        // called only by the decoder thread
+        void recordDecode(std::chrono::nanoseconds time) noexcept
+        {
+            decodedBlocks.fetch_add(1, std::memory_order_relaxed);
+            decodeTime.fetch_add(time.count(), std::memory_order_relaxed);
+            if (time.count() > maxDecodeTime.load(std::memory_order_relaxed))
+                maxDecodeTime.store(time.count(), std::memory_order_relaxed);
+        }
+
+        // called only by the mixer
+        void recordUnderrun(std::uint32_t frames) noexcept
+        {
+            underruns.fetch_add(1, std::memory_order_relaxed);
+            underrunFrames.fetch_add(frames, std::memory_order_relaxed);
+        }
+
+        VorbisClip::Statistics getStatistics() const noexcept
+        {
+            VorbisClip::Statistics statistics;
+            statistics.decodedBlocks = decodedBlocks.load(std::memory_order_relaxed);
+            statistics.decodeTime = std::chrono::nanoseconds(decodeTime.load(std::memory_order_relaxed));
+            statistics.maxDecodeTime = std::chrono::nanoseconds(maxDecodeTime.load(std::memory_order_relaxed));
+            statistics.underruns = underruns.load(std::memory_order_relaxed);
+            statistics.underrunFrames = underrunFrames.load(std::memory_order_relaxed);
+            return statistics;
+        }
+
+    private:
+        void decoderMain();
+
+        storage::FileSystem& fileSystem;
+        storage::Path filename;
+        std::uint32_t bufferFrames;
+
+        std::atomic<std::size_t> decodedBlocks{0};
+        std::atomic<std::chrono::nanoseconds::rep> decodeTime{0};
+        std::atomic<std::chrono::nanoseconds::rep> maxDecodeTime{0};
+        std::atomic<std::size_t> underruns{0};
+        std::atomic<std::size_t> underrunFrames{0};
+
+        std::vector<std::unique_ptr<StreamingVorbisDecoder>> decoders;
+        // used only by the decoder thread
+        std::vector<StreamingVorbisDecoder*> decodingDecoders;
+        std::vector<std::unique_ptr<StreamingVorbisDecoder>> releasedDecoders;
+        std::mutex decoderMutex;
+        std::condition_variable decoderCondition;
+        bool running = true;
+        thread::Thread decoderThread;
+    };
+
+    // The decoder thread writes the decoded frames into the ring buffer and the stream reads them on the mixer.
+    // A reset is requested by the stream and carried out by the decoder thread, the stream does not
+    // touch the ring buffer until it is done.
+    class StreamingVorbisDecoder final
+    {
+    public:
+        explicit StreamingVorbisDecoder(StreamingVorbisData& initStreamingData):
+            streamingData(initStreamingData),
+            buffer(initStreamingData.getBufferFrames(), initStreamingData.getChannels())
+        {
+        }
+
+        ~StreamingVorbisDecoder()
+        {
+            if (decoder) stb_vorbis_close(decoder);
+        }
+
+        StreamingVorbisDecoder(const StreamingVorbisDecoder&) = delete;
+        StreamingVorbisDecoder& operator=(const StreamingVorbisDecoder&) = delete;
+
+        StreamingVorbisDecoder(StreamingVorbisDecoder&&) = delete;
+        StreamingVorbisDecoder& operator=(StreamingVorbisDecoder&&) = delete;
+
+        auto& getBuffer() noexcept { return buffer; }
+
+        auto isResetRequested() const noexcept { return resetRequested.load(std::memory_order_acquire); }
+        void requestReset() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+        // the decoder thread sets the flag after it has written the last frames
+        auto isEnded() const noexcept { return ended.load(std::memory_order_acquire); }
+
+        // called by the stream when it is destroyed, it does not access the decoder afterwards
+        auto isReleased() const noexcept { return released.load(std::memory_order_acquire); }
+        void release() noexcept { released.store(true, std::memory_order_release); }
+
+        // called by the decoder thread, decodes until the buffer is full or the file ends
+        void decode()
+        {
+            if (resetRequested.load(std::memory_order_acquire))
+            {
+                if (decoder) stb_vorbis_close(decoder);
+                decoder = nullptr;
+                buffer.discard();
+                ended.store(false, std::memory_order_relaxed);
+                resetRequested.store(false, std::memory_order_release);
+            }
+
+            if (ended.load(std::memory_order_relaxed)) return;
+
+            try
+            {
+                if (!decoder) open();
+
+                while (buffer.getWritableFrames() > 0)
+                {
+                    if (outputOffset == outputFrames && !decodeBlock())
+                    {
+                        ended.store(true, std::memory_order_release);
+                        break;
+                    }
+
+                    const auto channels = streamingData.getChannels();
+                    const auto frames = std::min(buffer.getWritableFrames(),
+                                                 static_cast<std::uint32_t>(outputFrames - outputOffset));
+
+                    blockSamples.resize(frames * channels);
+                    for (std::uint32_t channel = 0; channel < channels; ++channel)
+                        std::copy(output[channel] + outputOffset,
+                                  output[channel] + outputOffset + frames,
+                                  blockSamples.begin() + getChannel(channels, channel) * frames);
+
+                    buffer.write(frames, blockSamples);
+                    outputOffset += static_cast<int>(frames);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                logger.log(Log::Level::error) << "Failed to decode Vorbis stream: " << e.what();
+                ended.store(true, std::memory_order_release);
+            }
+        }
+
+    private:
+        void open()
+        {
+            if (file)
+            {
+                file->clear();
+                file->seekg(0, std::ios::beg);
+            }
+            else
+                file = streamingData.openFile();
+
+            inputSize = 0;
+            outputOffset = 0;
+            outputFrames = 0;
+            decoder = openDecoder(*file, input, inputSize);
+        }
+
+        // returns false at the end of the file
+        bool decodeBlock()
+        {
+            for (;;)
+            {
+                float** blockOutput = nullptr;
+                int samples = 0;
+
+                const auto start = std::chrono::steady_clock::now();
+                const int usedSize = stb_vorbis_decode_frame_pushdata(decoder, input.data(), static_cast<int>(inputSize),
+                                                                      nullptr, &blockOutput, &samples);
+                const auto time = std::chrono::steady_clock::now() - start;
+
+                if (usedSize == 0 && samples == 0)
+                {
+                    // the packet continues in the next chunk
+                    if (!readInput(*file, input, inputSize)) return false;
+                    continue;
+                }
+
+                consumeInput(input, inputSize, static_cast<std::size_t>(usedSize));
+
+                if (samples > 0) // the first packet and resynchronization do not produce samples
+                {
+                    streamingData.recordDecode(std::chrono::duration_cast<std::chrono::nanoseconds>(time));
+                    output = blockOutput;
+                    outputOffset = 0;
+                    outputFrames = samples;
+                    return true;
+                }
+            }
+        }
+
+        StreamingVorbisData& streamingData;
+        mixer::RingBuffer buffer;
+        std::atomic<bool> resetRequested{false};
+        std::atomic<bool> ended{false};
+        std::atomic<bool> released{false};
+
+        // used only by the decoder thread
+        std::unique_ptr<std::istream> file;
+        stb_vorbis* decoder = nullptr;
+        std::vector<unsigned char> input;
+        std::size_t inputSize = 0;
+        float** output = nullptr; // the decoded block, valid until the next block is decoded
+        int outputOffset = 0;
+        int outputFrames = 0;
+        std::vector<float> blockSamples;
+    };
+
+    // the stream is destroyed on the mixer, so it only releases its decoder and does not wait for the decoder thread
+    class StreamingVorbisStream final: public mixer::Stream
+    {
+    public:
+        explicit StreamingVorbisStream(StreamingVorbisData& initStreamingData):
+            Stream(initStreamingData),
+            streamingData(initStreamingData),
+            decoder(*initStreamingData.addDecoder())
+        {
+        }
+
+        ~StreamingVorbisStream() override
+        {
+            decoder.release();
+            streamingData.requestDecode();
+        }
+
+        void reset() final
+        {
+            decoder.requestReset();
+            streamingData.requestDecode();
+        }
+
+        void getSamples(std::uint32_t frames, std::vector<float>& samples) final
+        {
+            samples.resize(frames * data.getChannels());
+
+            std::uint32_t readFrames = 0;
+
+            if (!decoder.isResetRequested())
+            {
+                auto& buffer = decoder.getBuffer();
+                readFrames = buffer.read(frames, samples);
+
+                if (readFrames < frames && decoder.isEnded() && buffer.getReadableFrames() == 0)
+                {
+                    playing = false;
+                    reset();
+                }
+                else if (buffer.getReadableFrames() < streamingData.getBufferFrames() / 2)
+                    streamingData.requestDecode();
+            }
+
+            if (readFrames < frames && playing)
+                streamingData.recordUnderrun(frames - readFrames);
+
+            for (std::uint32_t channel = 0; channel < data.getChannels(); ++channel)
+                std::fill(samples.begin() + channel * frames + readFrames,
+                          samples.begin() + (channel + 1) * frames, 0.0F);
+        }
+
+        void skip(std::uint32_t frames) final
+        {
+            // the decoder thread still decodes the skipped frames, but they are not copied or mixed
+            if (decoder.isResetRequested()) return;
+
+            auto& buffer = decoder.getBuffer();
+            const auto skippedFrames = buffer.skip(frames);
+
+            if (skippedFrames < frames && decoder.isEnded() && buffer.getReadableFrames() == 0)
+            {
+                playing = false;
+                reset();
+            }
+            else if (buffer.getReadableFrames() < streamingData.getBufferFrames() / 2)
+                streamingData.requestDecode();
+        }
+
+    private:
+        StreamingVorbisData& streamingData;
+        StreamingVorbisDecoder& decoder;
+    };
+
+    StreamingVorbisData::~StreamingVorbisData()
+    {
+        std::unique_lock lock(decoderMutex);
+        running = false;
+        lock.unlock();
+        decoderCondition.notify_all();
+
+        if (decoderThread.isJoinable())
+            decoderThread.join();
+    }
+
+    std::unique_ptr<mixer::Stream> StreamingVorbisData::createStream()
+    {
+        return std::make_unique<StreamingVorbisStream>(*this);
+    }
+
+    StreamingVorbisDecoder* StreamingVorbisData::addDecoder()
+    {
+        auto decoder = std::make_unique<StreamingVorbisDecoder>(*this);
+        auto result = decoder.get();
+
+        std::unique_lock lock(decoderMutex);
+        decoders.push_back(std::move(decoder));
+        lock.unlock();
+        decoderCondition.notify_all();
+
+        return result;
+    }
+
+    void StreamingVorbisData::decoderMain()
+    {
+        try
+        {
+            thread::setCurrentThreadName("Vorbis decoder");
+        }
+        catch (...)
+        {
+        }
+
+        // wakes up periodically, because the mixer notifies without locking the mutex and the wakeup can be lost
+        const auto period = std::chrono::microseconds(250000ULL * bufferFrames / sampleRate);
+
+        std::unique_lock lock(decoderMutex);
+        while (running)
+        {
+            // only this thread destroys the decoders, so it does not hold the mutex while decoding or destroying
+            // them and the mixer does not wait for it in addDecoder
+            decodingDecoders.clear();
+            for (auto i = decoders.begin(); i != decoders.end();)
+                if ((*i)->isReleased())
+                {
+                    releasedDecoders.push_back(std::move(*i));
+                    i = decoders.erase(i);
+                }
+                else
+                {
+                    decodingDecoders.push_back(i->get());
+                    ++i;
+                }
+
+            lock.unlock();
+
+            releasedDecoders.clear();
+
+            for (StreamingVorbisDecoder* decoder : decodingDecoders)
+                if (!decoder->isReleased()) decoder->decode();
+
+            lock.lock();
+            decoderCondition.wait_for(lock, period);
+        }
+    }
+
     VorbisClip::VorbisClip(Audio& initAudio, const std::vector<std::byte>& initData):
         Sound(initAudio,
               initAudio.initData(std::unique_ptr<mixer::Data>(data = new VorbisData(initData))),
-              Sound::Format::vorbis)
+              Sound::Format::vorbis),
+        streamingData(nullptr)
+    {
+    }
+
+    VorbisClip::VorbisClip(Audio& initAudio,
+                           storage::FileSystem& fileSystem,
+                           const storage::Path& filename,
+                           std::uint32_t bufferFrames):
+        Sound(initAudio,
+              initAudio.initData(std::unique_ptr<mixer::Data>(streamingData = new StreamingVorbisData(fileSystem, filename, bufferFrames))),
+              Sound::Format::vorbis),
+        data(nullptr)
+    {
+    }
+
+    VorbisClip::Statistics VorbisClip::getStatistics() const noexcept
     {
+        return streamingData ? streamingData->getStatistics() : Statistics{};
     }
 }
@@ -3,21 +3,52 @@
 #ifndef OUZEL_AUDIO_VORBISCLIP_HPP
 #define OUZEL_AUDIO_VORBISCLIP_HPP
 
+#include <chrono>
 #include <cstdint>
 #include <vector>
 #include "Sound.hpp"
+#include "../storage/Path.hpp"
+
+namespace ouzel::storage
+{
+    class FileSystem;
+}
 
 namespace ouzel::audio
 {
     class VorbisData;
+    class StreamingVorbisData;
 
     class VorbisClip final: public Sound
     {
     public:
+        struct Statistics final
+        {
+            std::size_t decodedBlocks = 0;
+            std::chrono::nanoseconds decodeTime{0}; // total time spent decoding the blocks
+            std::chrono::nanoseconds maxDecodeTime{0}; // time of the slowest block
+            std::size_t underruns = 0; // mixer blocks that were not fully decoded in time
+            std::size_t underrunFrames = 0; // frames filled with silence
+        };
+
         VorbisClip(Audio& initAudio, const std::vector<std::byte>& initData);
 
+        // reads the file in chunks instead of keeping it in memory, a background thread
+        // decodes ahead of the mixer into a buffer of bufferFrames frames per stream
+        VorbisClip(Audio& initAudio,
+                   storage::FileSystem& fileSystem,
+                   const storage::Path& filename,
+                   std::uint32_t bufferFrames = 32768);
+
+        auto isStreaming() const noexcept { return streamingData != nullptr; }
+
+        // empty for the clips that are decoded from memory
+        Statistics getStatistics() const noexcept;
+
     private:
+        // assigned while constructing the base class, so they must not have default member initializers
         VorbisData* data;
+        StreamingVorbisData* streamingData;
     };
 }
 
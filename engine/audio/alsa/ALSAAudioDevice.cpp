@@ -76,6 +76,9 @@ namespace ouzel::audio::alsa
         if (const auto result = snd_pcm_hw_params(playbackHandle, hwParams); result < 0)
             throw std::system_error(-result, std::system_category(), "Failed to set hardware parameters");
 
+        // the mixer renders ahead in buffers of one period
+        bufferSize = static_cast<std::uint32_t>(periodSize);
+
         snd_pcm_hw_params_free(hwParams);
         hwParams = nullptr;
 
@@ -158,6 +161,9 @@ namespace ouzel::audio::alsa
                 if (static_cast<snd_pcm_uframes_t>(frames) < periodSize)
                     continue;
 
+                // one period at a time, so that the mixer always has a full buffer ready
+                frames = static_cast<snd_pcm_sframes_t>(periodSize);
+
                 getData(frames, data);
 
                 if (const auto result = snd_pcm_writei(playbackHandle, data.data(), frames); result < 0)
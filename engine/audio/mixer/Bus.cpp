@@ -3,9 +3,9 @@
 #include <algorithm>
 #include "Bus.hpp"
 #include "Data.hpp"
+#include "Kernels.hpp"
 #include "Processor.hpp"
 #include "Stream.hpp"
-#include "../../math/MathUtils.hpp"
 
 namespace ouzel::audio::mixer
 {
@@ -30,52 +30,21 @@ namespace ouzel::audio::mixer
         if (output) output->addInput(this);
     }
 
-    static void resample(std::uint32_t channels, std::uint32_t sourceFrames, const std::vector<float>& sourceSamples,
-                         std::uint32_t frames, std::vector<float>& samples)
+    static void convert(std::uint32_t frames, std::uint32_t sourceChannels, const float* sourceSamples,
+                        std::uint32_t channels, float* samples)
     {
-        if (sourceFrames != frames)
-        {
-            auto sourceIncrement = static_cast<float>(sourceFrames - 1) / static_cast<float>(frames - 1);
-            auto sourcePosition = 0.0F;
-
-            samples.resize(frames * channels);
-
-            for (std::uint32_t frame = 0; frame < frames - 1; ++frame)
-            {
-                auto sourceCurrentFrame = static_cast<std::uint32_t>(sourcePosition);
-                auto fraction = sourcePosition - sourceCurrentFrame;
-
-                std::uint32_t sourceNextFrame = sourceCurrentFrame + 1;
-
-                for (std::uint32_t channel = 0; channel < channels; ++channel)
-                {
-                    const auto sourceChannel = &sourceSamples[channel * sourceFrames];
-                    auto outputChannel = &samples[channel * frames];
-
-                    outputChannel[frame] = ouzel::lerp(sourceChannel[sourceCurrentFrame],
-                                                       sourceChannel[sourceNextFrame],
-                                                       fraction);
-                }
-
-                sourcePosition += sourceIncrement;
-            }
-
-            // fill the last frame of the destination with the last frame of the source
-            for (std::uint32_t channel = 0; channel < channels; ++channel)
-            {
-                const auto sourceChannel = &sourceSamples[channel * sourceFrames];
-                auto outputChannel = &samples[channel * frames];
-                outputChannel[frames - 1] = sourceChannel[sourceFrames - 1];
-            }
-        }
-        else
-            samples = sourceSamples;
-    }
-
-    static void convert(std::uint32_t frames, std::uint32_t sourceChannels, const std::vector<float>& sourceSamples,
-                        std::uint32_t channels, std::vector<float>& samples)
-    {
-        samples.resize(frames * channels);
+        const auto input = [sourceSamples, frames](std::uint32_t channel) noexcept {
+            return sourceSamples + channel * frames;
+        };
+        const auto output = [samples, frames](std::uint32_t channel) noexcept {
+            return samples + channel * frames;
+        };
+        const auto copy = [frames](const float* source, float* destination) noexcept {
+            std::copy(source, source + frames, destination);
+        };
+        const auto clear = [frames](float* destination) noexcept {
+            std::fill(destination, destination + frames, 0.0F);
+        };
 
         if (sourceChannels != channels)
         {
@@ -86,31 +55,22 @@ namespace ouzel::audio::mixer
                     switch (channels)
                     {
                         case 2: // upmix 1 to 2
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[frame]; // L = M
-                                samples[1 * frames + frame] = sourceSamples[frame]; // R = M
-                            }
+                            copy(input(0), output(0)); // L = M
+                            copy(input(0), output(1)); // R = M
                             break;
                         case 4: // upmix 1 to 4
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[frame]; // L = M
-                                samples[1 * frames + frame] = sourceSamples[frame]; // R = M
-                                samples[2 * frames + frame] = 0.0F; // SL = 0
-                                samples[3 * frames + frame] = 0.0F; // SR = 0
-                            }
+                            copy(input(0), output(0)); // L = M
+                            copy(input(0), output(1)); // R = M
+                            clear(output(2)); // SL = 0
+                            clear(output(3)); // SR = 0
                             break;
                         case 6: // upmix 1 to 6
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = 0.0F; // L = 0
-                                samples[1 * frames + frame] = 0.0F; // R = 0
-                                samples[2 * frames + frame] = sourceSamples[frame]; // C = M
-                                samples[3 * frames + frame] = 0.0F; // LFE = 0
-                                samples[4 * frames + frame] = 0.0F; // SL = 0
-                                samples[5 * frames + frame] = 0.0F; // SR = 0
-                            }
+                            clear(output(0)); // L = 0
+                            clear(output(1)); // R = 0
+                            copy(input(0), output(2)); // C = M
+                            clear(output(3)); // LFE = 0
+                            clear(output(4)); // SL = 0
+                            clear(output(5)); // SR = 0
                             break;
                     }
                     break;
@@ -120,29 +80,22 @@ namespace ouzel::audio::mixer
                     switch (channels)
                     {
                         case 1: // downmix 2 to 1
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                                samples[frame] = (sourceSamples[0 * frames + frame] +
-                                                  sourceSamples[1 * frames + frame]) * 0.5F; // M = (L + R) * 0.5
+                            scale(input(0), output(0), frames, 0.5F); // M = (L + R) * 0.5
+                            addScaled(input(1), output(0), frames, 0.5F);
                             break;
                         case 4: // upmix 2 to 4
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[0 * frames + frame]; // L = L
-                                samples[1 * frames + frame] = sourceSamples[1 * frames + frame]; // R = R
-                                samples[2 * frames + frame] = 0.0F; // SL = 0
-                                samples[3 * frames + frame] = 0.0F; // SR = 0
-                            }
+                            copy(input(0), output(0)); // L = L
+                            copy(input(1), output(1)); // R = R
+                            clear(output(2)); // SL = 0
+                            clear(output(3)); // SR = 0
                             break;
                         case 6: // upmix 2 to 6
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[0 * frames + frame]; // L = L
-                                samples[1 * frames + frame] = sourceSamples[1 * frames + frame]; // R = R
-                                samples[2 * frames + frame] = 0.0F; // C = 0
-                                samples[3 * frames + frame] = 0.0F; // LFE = 0
-                                samples[4 * frames + frame] = 0.0F; // SL = 0
-                                samples[5 * frames + frame] = 0.0F; // SR = 0
-                            }
+                            copy(input(0), output(0)); // L = L
+                            copy(input(1), output(1)); // R = R
+                            clear(output(2)); // C = 0
+                            clear(output(3)); // LFE = 0
+                            clear(output(4)); // SL = 0
+                            clear(output(5)); // SR = 0
                             break;
                     }
                     break;
@@ -152,31 +105,24 @@ namespace ouzel::audio::mixer
                     switch (channels)
                     {
                         case 1: // downmix 4 to 1
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                                samples[frame] = (sourceSamples[0 * frames + frame] +
-                                                  sourceSamples[1 * frames + frame] +
-                                                  sourceSamples[2 * frames + frame] +
-                                                  sourceSamples[3 * frames + frame]) * 0.25F; // M = (L + R + SL + SR) * 0.25
+                            scale(input(0), output(0), frames, 0.25F); // M = (L + R + SL + SR) * 0.25
+                            addScaled(input(1), output(0), frames, 0.25F);
+                            addScaled(input(2), output(0), frames, 0.25F);
+                            addScaled(input(3), output(0), frames, 0.25F);
                             break;
                         case 2: // downmix 4 to 2
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = (sourceSamples[0 * frames + frame] +
-                                                               sourceSamples[2 * frames + frame]) * 0.5F; // L = (L + SL) * 0.5
-                                samples[1 * frames + frame] = (sourceSamples[1 * frames + frame] +
-                                                               sourceSamples[3 * frames + frame]) * 0.5F; // R = (R + RL) * 0.5
-                            }
+                            scale(input(0), output(0), frames, 0.5F); // L = (L + SL) * 0.5
+                            addScaled(input(2), output(0), frames, 0.5F);
+                            scale(input(1), output(1), frames, 0.5F); // R = (R + SR) * 0.5
+                            addScaled(input(3), output(1), frames, 0.5F);
                             break;
                         case 6: // upmix 4 to 6
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[0 * frames + frame] = sourceSamples[0 * frames + frame]; // L = L
-                                samples[1 * frames + frame] = sourceSamples[1 * frames + frame]; // R = R
-                                samples[2 * frames + frame] = 0.0F; // C = 0
-                                samples[3 * frames + frame] = 0.0F; // LFE = 0
-                                samples[4 * frames + frame] = sourceSamples[2 * frames + frame]; // SL = SL
-                                samples[5 * frames + frame] = sourceSamples[3 * frames + frame]; // SR = SR
-                            }
+                            copy(input(0), output(0)); // L = L
+                            copy(input(1), output(1)); // R = R
+                            clear(output(2)); // C = 0
+                            clear(output(3)); // LFE = 0
+                            copy(input(2), output(4)); // SL = SL
+                            copy(input(3), output(5)); // SR = SR
                             break;
                     }
                     break;
@@ -186,34 +132,27 @@ namespace ouzel::audio::mixer
                     switch (channels)
                     {
                         case 1: // downmix 6 to 1
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                                samples[frame] = ((sourceSamples[0 * frames + frame] +
-                                                   sourceSamples[1 * frames + frame]) * 0.7071F +
-                                                  sourceSamples[2 * frames + frame] +
-                                                  (sourceSamples[4 * frames + frame] +
-                                                   sourceSamples[5 * frames + frame]) * 0.5F); // M = (L + R) * 0.7071 + C + (SL + SR) * 0.5
+                            scale(input(0), output(0), frames, 0.7071F); // M = (L + R) * 0.7071 + C + (SL + SR) * 0.5
+                            addScaled(input(1), output(0), frames, 0.7071F);
+                            add(input(2), output(0), frames);
+                            addScaled(input(4), output(0), frames, 0.5F);
+                            addScaled(input(5), output(0), frames, 0.5F);
                             break;
                         case 2: // downmix 6 to 2
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[frame * channels + 0] = (sourceSamples[0 * frames + frame] +
-                                                                 (sourceSamples[2 * frames + frame] +
-                                                                  sourceSamples[4 * frames + frame]) * 0.7071F); // L = L + (C + SL) * 0.7071
-                                samples[frame * channels + 1] = (sourceSamples[1 * frames + frame] +
-                                                                 (sourceSamples[2 * frames + frame] +
-                                                                  sourceSamples[5 * frames + frame]) * 0.7071F); // R = R + (C + SR) * 0.7071
-                            }
+                            copy(input(0), output(0)); // L = L + (C + SL) * 0.7071
+                            addScaled(input(2), output(0), frames, 0.7071F);
+                            addScaled(input(4), output(0), frames, 0.7071F);
+                            copy(input(1), output(1)); // R = R + (C + SR) * 0.7071
+                            addScaled(input(2), output(1), frames, 0.7071F);
+                            addScaled(input(5), output(1), frames, 0.7071F);
                             break;
                         case 4: // downmix 6 to 4
-                            for (std::uint32_t frame = 0; frame < frames; ++frame)
-                            {
-                                samples[frame * channels + 0] = (sourceSamples[0 * frames + frame] +
-                                                                 sourceSamples[2 * frames + frame] * 0.7071F); // L = L + C * 0.7071
-                                samples[frame * channels + 1] = (sourceSamples[1 * frames + frame] +
-                                                                 sourceSamples[2 * frames + frame] * 0.7071F); // R = R + C * 0.7071
-                                samples[frame * channels + 2] = sourceSamples[4 * frames + frame]; // SL = SL
-                                samples[frame * channels + 3] = sourceSamples[5 * frames + frame]; // SR = SR
-                            }
+                            copy(input(0), output(0)); // L = L + C * 0.7071
+                            addScaled(input(2), output(0), frames, 0.7071F);
+                            copy(input(1), output(1)); // R = R + C * 0.7071
+                            addScaled(input(2), output(1), frames, 0.7071F);
+                            copy(input(4), output(2)); // SL = SL
+                            copy(input(5), output(3)); // SR = SR
                             break;
                     }
                     break;
@@ -221,53 +160,155 @@ namespace ouzel::audio::mixer
             }
         }
         else
-            samples = sourceSamples;
+            std::copy(sourceSamples, sourceSamples + frames * channels, samples);
     }
 
-    void Bus::getSamples(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
-                         const Vector3F& listenerPosition, const QuaternionF& listenerRotation,
-                         std::vector<float>& samples)
+    void Bus::prepare(std::uint32_t maxFrames, std::uint32_t channels, std::uint32_t sampleRate,
+                      Resampler::Quality resamplerQuality)
     {
-        samples.resize(frames * channels);
-        std::fill(samples.begin(), samples.end(), 0.0F);
+        outputSamples.reserve(maxFrames * channels);
+        buffer.reserve(maxFrames * channels);
+        stoppedStreams.reserve(inputStreams.size());
 
-        for (Bus* bus : inputBuses)
+        for (Stream* stream : inputStreams)
         {
-            bus->getSamples(frames, channels, sampleRate, listenerPosition, listenerRotation, buffer);
+            const auto& data = stream->getData();
+
+            if (data.getSampleRate() != sampleRate)
+            {
+                stream->resampler.prepare(data.getSampleRate(), sampleRate, data.getChannels(), maxFrames, resamplerQuality);
+                resampleBuffer.reserve(stream->resampler.getMaxSourceFrames(maxFrames) * data.getChannels());
+            }
 
-            for (std::size_t s = 0; s < samples.size(); ++s)
-                samples[s] += buffer[s];
+            mixBuffer.reserve(maxFrames * data.getChannels());
+        }
+
+        for (Processor* processor : processors)
+            processor->prepare(maxFrames, channels, sampleRate);
+    }
+
+    void Bus::mix(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+                  const Vector3F&, const QuaternionF&)
+    {
+        // all the resizes stay within the capacity reserved by prepare
+        outputSamples.resize(frames * channels);
+        std::fill(outputSamples.begin(), outputSamples.end(), 0.0F);
+        stoppedStreams.clear();
+
+        for (const Bus* bus : inputBuses)
+        {
+            // a bus in a cycle can be mixed after its output, its samples are then from the previous block
+            if (bus->outputSamples.size() != outputSamples.size()) continue;
+
+            add(bus->outputSamples.data(), outputSamples.data(), outputSamples.size());
         }
 
         for (Stream* stream : inputStreams)
         {
-            if (stream->isPlaying())
-            {
-                const std::uint32_t sourceSampleRate = stream->getData().getSampleRate();
-                const std::uint32_t sourceChannels = stream->getData().getChannels();
+            if (!stream->isPlaying()) continue;
 
-                if (sourceSampleRate != sampleRate)
+            const std::uint32_t sourceSampleRate = stream->getData().getSampleRate();
+            const std::uint32_t sourceChannels = stream->getData().getChannels();
+
+            if (stream->virtualized && stream->lastBlock != Stream::Block::mixed)
+            {
+                // keep the position in sync with the time that has passed, without decoding or mixing anything
+                const auto offset = stream->skipOffset + static_cast<std::int64_t>(frames) * sourceSampleRate;
+                if (offset > 0)
                 {
-                    std::uint32_t sourceFrames = (frames * sourceSampleRate + sampleRate - 1) / sampleRate; // round up
-                    stream->getSamples(sourceFrames, resampleBuffer);
-                    resample(sourceChannels, sourceFrames, resampleBuffer, frames, mixBuffer);
+                    stream->skipOffset = offset % sampleRate;
+                    stream->skip(static_cast<std::uint32_t>(offset / sampleRate));
                 }
                 else
-                    stream->getSamples(frames, mixBuffer);
+                    stream->skipOffset = offset;
 
-                if (sourceChannels != channels)
-                    convert(frames, sourceChannels, mixBuffer, channels, buffer);
-                else
-                    buffer = mixBuffer;
+                if (stream->isPlaying())
+                    stream->lastBlock = Stream::Block::skipped;
+                else // reached the end
+                {
+                    stream->resampler.reset();
+                    stream->lastBlock = Stream::Block::none;
+                    stream->skipOffset = 0;
+                    stoppedStreams.push_back(stream);
+                }
+                continue;
+            }
 
-                for (std::size_t s = 0; s < samples.size(); ++s)
-                    samples[s] += buffer[s];
+            float startGain = stream->gain;
+            float endGain = stream->gain;
+
+            if (stream->virtualized)
+            {
+                // mix one more block that fades out and skip the following ones
+                endGain = 0.0F;
+                stream->lastBlock = Stream::Block::skipped;
+            }
+            else
+            {
+                if (stream->lastBlock == Stream::Block::skipped)
+                {
+                    // the filter history is from before the skipped frames, unless none were skipped
+                    if (stream->skipOffset >= 0)
+                        stream->resampler.reset(static_cast<std::uint32_t>(stream->skipOffset));
+                    stream->skipOffset = 0;
+                    startGain = 0.0F;
+                }
+
+                stream->lastBlock = Stream::Block::mixed;
             }
+
+            if (sourceSampleRate != sampleRate)
+            {
+                // the resampler keeps the fraction of the position, so it asks for exactly the frames it still needs
+                const auto sourceFrames = stream->resampler.getSourceFrames(frames);
+                stream->getSamples(sourceFrames, resampleBuffer);
+                mixBuffer.resize(frames * sourceChannels);
+                stream->resampler.process(resampleBuffer.data(), sourceFrames, frames, mixBuffer.data());
+            }
+            else
+                stream->getSamples(frames, mixBuffer);
+
+            // the last samples of the stream are still mixed
+            if (!stream->isPlaying()) stoppedStreams.push_back(stream);
+
+            // the skipped frames start after the ones that the resampler has already read
+            if (stream->virtualized)
+                stream->skipOffset = (sourceSampleRate != sampleRate) ?
+                    -static_cast<std::int64_t>(stream->resampler.getReadAhead()) : 0;
+
+            const float* streamSamples = mixBuffer.data();
+
+            if (sourceChannels != channels)
+            {
+                buffer.resize(frames * channels);
+                convert(frames, sourceChannels, mixBuffer.data(), channels, buffer.data());
+                streamSamples = buffer.data();
+            }
+
+            if (startGain == 1.0F && endGain == 1.0F)
+                add(streamSamples, outputSamples.data(), outputSamples.size());
+            else if (startGain == endGain)
+                addScaled(streamSamples, outputSamples.data(), outputSamples.size(), startGain);
+            else
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    addRamped(streamSamples + channel * frames, outputSamples.data() + channel * frames,
+                              frames, startGain, endGain);
         }
 
         for (Processor* processor : processors)
             if (processor->isEnabled())
-                processor->process(frames, channels, sampleRate, samples);
+                processor->process(frames, channels, sampleRate, outputSamples);
+    }
+
+    std::size_t Bus::getCapacity() const noexcept
+    {
+        std::size_t capacity = resampleBuffer.capacity() + mixBuffer.capacity() +
+            buffer.capacity() + outputSamples.capacity() + stoppedStreams.capacity();
+
+        for (const Stream* stream : inputStreams)
+            capacity += stream->resampler.getCapacity();
+
+        return capacity;
     }
 
     void Bus::addProcessor(Processor* processor)
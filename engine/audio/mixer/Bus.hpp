@@ -5,6 +5,7 @@
 
 #include <vector>
 #include "Object.hpp"
+#include "Resampler.hpp"
 
 namespace ouzel::audio::mixer
 {
@@ -26,9 +27,23 @@ namespace ouzel::audio::mixer
 
         void setOutput(Bus* newOutput);
 
-        void getSamples(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
-                        const Vector3F& listenerPosition, const QuaternionF& listenerRotation,
-                        std::vector<float>& samples);
+        auto& getInputBuses() const noexcept { return inputBuses; }
+
+        // reserves the buffers for blocks of up to maxFrames, must be called again when the inputs change
+        void prepare(std::uint32_t maxFrames, std::uint32_t channels, std::uint32_t sampleRate,
+                     Resampler::Quality resamplerQuality);
+
+        // mixes the inputs into the output samples, the input buses have to be mixed before
+        void mix(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+                 const Vector3F& listenerPosition, const QuaternionF& listenerRotation);
+
+        auto& getOutputSamples() const noexcept { return outputSamples; }
+
+        // the streams that reached their end in the last mixed block
+        auto& getStoppedStreams() const noexcept { return stoppedStreams; }
+
+        // total capacity of the buffers, used to check that mixing does not allocate
+        std::size_t getCapacity() const noexcept;
 
         void addProcessor(Processor* processor);
         void removeProcessor(Processor* processor);
@@ -43,10 +58,12 @@ namespace ouzel::audio::mixer
         std::vector<Bus*> inputBuses;
         std::vector<Stream*> inputStreams;
         std::vector<Processor*> processors;
+        std::vector<Stream*> stoppedStreams;
 
         std::vector<float> resampleBuffer;
         std::vector<float> mixBuffer;
         std::vector<float> buffer;
+        std::vector<float> outputSamples;
     };
 }
 
@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <queue>
 
 #include "Processor.hpp"
 #include "Source.hpp"
@@ -36,6 +37,8 @@ namespace ouzel::audio::mixer
             playStream,
             stopStream,
             setStreamOutput,
+            setStreamGain,
+            setStreamVirtual,
             initData,
             initProcessor,
             updateProcessor
@@ -247,6 +250,34 @@ namespace ouzel::audio::mixer
         const ObjectId busId;
     };
 
+    class SetStreamGainCommand final: public Command
+    {
+    public:
+        constexpr SetStreamGainCommand(ObjectId initStreamId,
+                                       float initGain) noexcept:
+            Command(Command::Type::setStreamGain),
+            streamId(initStreamId),
+            gain(initGain)
+        {}
+
+        const ObjectId streamId;
+        const float gain;
+    };
+
+    class SetStreamVirtualCommand final: public Command
+    {
+    public:
+        constexpr SetStreamVirtualCommand(ObjectId initStreamId,
+                                          bool initVirtual) noexcept:
+            Command(Command::Type::setStreamVirtual),
+            streamId(initStreamId),
+            isVirtual(initVirtual)
+        {}
+
+        const ObjectId streamId;
+        const bool isVirtual;
+    };
+
     class InitDataCommand final: public Command
     {
     public:
@@ -319,6 +350,13 @@ namespace ouzel::audio::mixer
             return commands;
         }
 
+        // unlike a move, a swap does not allocate a new queue for the other buffer
+        void swap(CommandBuffer& other) noexcept
+        {
+            name.swap(other.name);
+            commands.swap(other.commands);
+        }
+
     private:
         std::string name;
         std::queue<std::unique_ptr<Command>> commands;
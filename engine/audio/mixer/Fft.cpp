@@ -0,0 +1,282 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#elif defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include "Fft.hpp"
+#include "../../core/Engine.hpp"
+
+namespace ouzel::audio::mixer
+{
+    namespace
+    {
+        constexpr double tau = 6.28318530717958647692;
+
+        std::shared_ptr<const Fft::Tables> createTables(std::uint32_t size)
+        {
+            auto tables = std::make_shared<Fft::Tables>();
+            tables->size = size;
+
+            const std::uint32_t complexSize = size / 2;
+
+            for (std::uint32_t half = 4; half < complexSize; half *= 2)
+                for (std::uint32_t k = 0; k < half; ++k)
+                {
+                    const auto angle = -tau * k / (half * 2);
+                    tables->twiddleReal.push_back(static_cast<float>(std::cos(angle)));
+                    tables->twiddleImag.push_back(static_cast<float>(std::sin(angle)));
+                }
+
+            tables->realTwiddles.resize(complexSize + 2);
+            for (std::uint32_t k = 0; k <= complexSize / 2; ++k)
+            {
+                const auto angle = -tau * k / size;
+                tables->realTwiddles[k * 2 + 0] = static_cast<float>(std::cos(angle));
+                tables->realTwiddles[k * 2 + 1] = static_cast<float>(std::sin(angle));
+            }
+
+            std::uint32_t bits = 0;
+            while ((1U << bits) < complexSize) ++bits;
+
+            tables->reversed.resize(complexSize);
+            for (std::uint32_t i = 0; i < complexSize; ++i)
+            {
+                std::uint32_t reversed = 0;
+                for (std::uint32_t bit = 0; bit < bits; ++bit)
+                    if (i & (1U << bit)) reversed |= 1U << (bits - bit - 1);
+
+                tables->reversed[i] = reversed;
+            }
+
+            return tables;
+        }
+    }
+
+    Fft::Fft(std::uint32_t initSize):
+        size(initSize),
+        real(initSize / 2),
+        imag(initSize / 2)
+    {
+        if (size < 8 || (size & (size - 1)) != 0)
+            throw std::runtime_error("FFT size must be a power of two of at least 8");
+
+        tables = getTables(size);
+    }
+
+    std::shared_ptr<const Fft::Tables> Fft::getTables(std::uint32_t size)
+    {
+        static std::mutex mutex;
+        static std::map<std::uint32_t, std::shared_ptr<const Tables>> cache;
+
+        std::lock_guard lock(mutex);
+
+        auto& tables = cache[size];
+        if (!tables) tables = createTables(size);
+
+        return tables;
+    }
+
+    void Fft::transform(bool inverse) noexcept
+    {
+        const std::uint32_t complexSize = size / 2;
+        float* re = real.data();
+        float* im = imag.data();
+
+        // the first two radix-2 passes combined, their only twiddle factors are 1 and -i (i for the inverse)
+        const float sign = inverse ? -1.0F : 1.0F;
+        for (std::uint32_t i = 0; i < complexSize; i += 4)
+        {
+            const float r0 = re[i + 0] + re[i + 1];
+            const float i0 = im[i + 0] + im[i + 1];
+            const float r1 = re[i + 0] - re[i + 1];
+            const float i1 = im[i + 0] - im[i + 1];
+            const float r2 = re[i + 2] + re[i + 3];
+            const float i2 = im[i + 2] + im[i + 3];
+            const float r3 = sign * (im[i + 2] - im[i + 3]);
+            const float i3 = sign * (re[i + 3] - re[i + 2]);
+
+            re[i + 0] = r0 + r2;
+            im[i + 0] = i0 + i2;
+            re[i + 1] = r1 + r3;
+            im[i + 1] = i1 + i3;
+            re[i + 2] = r0 - r2;
+            im[i + 2] = i0 - i2;
+            re[i + 3] = r1 - r3;
+            im[i + 3] = i1 - i3;
+        }
+
+        const float* twiddleReal = tables->twiddleReal.data();
+        const float* twiddleImag = tables->twiddleImag.data();
+
+        for (std::uint32_t half = 4; half < complexSize; half *= 2)
+        {
+            for (std::uint32_t start = 0; start < complexSize; start += half * 2)
+            {
+                float* aReal = re + start;
+                float* aImag = im + start;
+                float* bReal = aReal + half;
+                float* bImag = aImag + half;
+
+                std::uint32_t k = 0;
+
+                // half is a multiple of four
+                if (core::isSimdAvailable)
+                {
+#if defined(__ARM_NEON__)
+                    const auto s = vdupq_n_f32(sign);
+                    for (; k < half; k += 4)
+                    {
+                        const auto wr = vld1q_f32(twiddleReal + k);
+                        const auto wi = vmulq_f32(s, vld1q_f32(twiddleImag + k));
+                        const auto br = vld1q_f32(bReal + k);
+                        const auto bi = vld1q_f32(bImag + k);
+                        const auto tr = vsubq_f32(vmulq_f32(br, wr), vmulq_f32(bi, wi));
+                        const auto ti = vaddq_f32(vmulq_f32(br, wi), vmulq_f32(bi, wr));
+                        const auto ar = vld1q_f32(aReal + k);
+                        const auto ai = vld1q_f32(aImag + k);
+                        vst1q_f32(aReal + k, vaddq_f32(ar, tr));
+                        vst1q_f32(aImag + k, vaddq_f32(ai, ti));
+                        vst1q_f32(bReal + k, vsubq_f32(ar, tr));
+                        vst1q_f32(bImag + k, vsubq_f32(ai, ti));
+                    }
+#elif defined(__SSE__)
+                    const auto s = _mm_set1_ps(sign);
+                    for (; k < half; k += 4)
+                    {
+                        const auto wr = _mm_loadu_ps(twiddleReal + k);
+                        const auto wi = _mm_mul_ps(s, _mm_loadu_ps(twiddleImag + k));
+                        const auto br = _mm_loadu_ps(bReal + k);
+                        const auto bi = _mm_loadu_ps(bImag + k);
+                        const auto tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+                        const auto ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+                        const auto ar = _mm_loadu_ps(aReal + k);
+                        const auto ai = _mm_loadu_ps(aImag + k);
+                        _mm_storeu_ps(aReal + k, _mm_add_ps(ar, tr));
+                        _mm_storeu_ps(aImag + k, _mm_add_ps(ai, ti));
+                        _mm_storeu_ps(bReal + k, _mm_sub_ps(ar, tr));
+                        _mm_storeu_ps(bImag + k, _mm_sub_ps(ai, ti));
+                    }
+#endif
+                }
+
+                for (; k < half; ++k)
+                {
+                    const float wr = twiddleReal[k];
+                    const float wi = sign * twiddleImag[k];
+                    const float tr = bReal[k] * wr - bImag[k] * wi;
+                    const float ti = bReal[k] * wi + bImag[k] * wr;
+                    const float ar = aReal[k];
+                    const float ai = aImag[k];
+                    aReal[k] = ar + tr;
+                    aImag[k] = ai + ti;
+                    bReal[k] = ar - tr;
+                    bImag[k] = ai - ti;
+                }
+            }
+
+            twiddleReal += half;
+            twiddleImag += half;
+        }
+    }
+
+    void Fft::forward(const float* input, float* outputReal, float* outputImag) noexcept
+    {
+        const std::uint32_t complexSize = size / 2;
+        const std::uint32_t* reversed = tables->reversed.data();
+
+        // the even samples are the real and the odd samples the imaginary parts
+        for (std::uint32_t i = 0; i < complexSize; ++i)
+        {
+            real[i] = input[reversed[i] * 2 + 0];
+            imag[i] = input[reversed[i] * 2 + 1];
+        }
+
+        transform(false);
+
+        // split the spectra of the even and the odd samples and combine them, bins k and complexSize - k
+        // need the same values, so they are computed together
+        const float* realTwiddles = tables->realTwiddles.data();
+
+        outputReal[0] = real[0] + imag[0];
+        outputImag[0] = 0.0F;
+        outputReal[complexSize] = real[0] - imag[0];
+        outputImag[complexSize] = 0.0F;
+
+        for (std::uint32_t k = 1; k <= complexSize / 2; ++k)
+        {
+            const std::uint32_t j = complexSize - k;
+            const float zr = real[k];
+            const float zi = imag[k];
+            const float yr = real[j];
+            const float yi = imag[j];
+
+            // even = (z + conj(y)) / 2, odd = q = (z - conj(y)) / 2i
+            const float er = 0.5F * (zr + yr);
+            const float ei = 0.5F * (zi - yi);
+            const float qr = 0.5F * (zi + yi);
+            const float qi = -0.5F * (zr - yr);
+
+            const float wr = realTwiddles[k * 2 + 0];
+            const float wi = realTwiddles[k * 2 + 1];
+            const float tr = qr * wr - qi * wi;
+            const float ti = qr * wi + qi * wr;
+
+            // bin j is the conjugate symmetric counterpart, its twiddle is -conj(w)
+            outputReal[k] = er + tr;
+            outputImag[k] = ei + ti;
+            outputReal[j] = er - tr;
+            outputImag[j] = ti - ei;
+        }
+    }
+
+    void Fft::inverse(const float* inputReal, const float* inputImag, float* output) noexcept
+    {
+        const std::uint32_t complexSize = size / 2;
+        const std::uint32_t* reversed = tables->reversed.data();
+        const float* realTwiddles = tables->realTwiddles.data();
+
+        // the imaginary parts of the first and the last bin are ignored, they are zero for real samples
+        real[0] = inputReal[0] + inputReal[complexSize];
+        imag[0] = inputReal[0] - inputReal[complexSize];
+
+        for (std::uint32_t k = 1; k <= complexSize / 2; ++k)
+        {
+            const std::uint32_t j = complexSize - k;
+            const float xr = inputReal[k];
+            const float xi = inputImag[k];
+            const float yr = inputReal[j];
+            const float yi = inputImag[j];
+
+            // even = x + conj(y), odd = q = (x - conj(y)) * conj(w), z = even + i * odd
+            const float er = xr + yr;
+            const float ei = xi - yi;
+            const float dr = xr - yr;
+            const float di = xi + yi;
+
+            const float wr = realTwiddles[k * 2 + 0];
+            const float wi = realTwiddles[k * 2 + 1];
+            const float qr = dr * wr + di * wi;
+            const float qi = di * wr - dr * wi;
+
+            // for bin j the even and the odd parts are conjugated
+            real[reversed[k]] = er - qi;
+            imag[reversed[k]] = ei + qr;
+            real[reversed[j]] = er + qi;
+            imag[reversed[j]] = qr - ei;
+        }
+
+        transform(true);
+
+        for (std::uint32_t i = 0; i < complexSize; ++i)
+        {
+            output[i * 2 + 0] = real[i];
+            output[i * 2 + 1] = imag[i];
+        }
+    }
+}
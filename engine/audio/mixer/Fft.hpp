@@ -0,0 +1,53 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_MIXER_FFT_HPP
+#define OUZEL_AUDIO_MIXER_FFT_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ouzel::audio::mixer
+{
+    // Fast Fourier transform of real samples, the size must be a power of two. The even and odd samples
+    // are transformed together with a complex FFT of half the size, which starts with a radix-4 pass and
+    // continues with radix-2 passes. The real and imaginary parts are kept in separate arrays and every pass
+    // has its own contiguous twiddle factors, so that the butterflies can be vectorized. The twiddle factors
+    // and the bit-reversal permutation are computed once for every size and shared.
+    class Fft final
+    {
+    public:
+        struct Tables final
+        {
+            std::uint32_t size;
+            // e^(-2 pi i k / (half * 2)) for k < half of the radix-2 passes, one after another starting with half = 4
+            std::vector<float> twiddleReal;
+            std::vector<float> twiddleImag;
+            std::vector<float> realTwiddles; // e^(-2 pi i k / size) that split the complex result, interleaved
+            std::vector<std::uint32_t> reversed; // bit-reversal permutation of the complex FFT
+        };
+
+        explicit Fft(std::uint32_t initSize);
+
+        auto getSize() const noexcept { return size; }
+
+        // transforms size real samples into the real and imaginary parts of size / 2 + 1 bins
+        void forward(const float* input, float* outputReal, float* outputImag) noexcept;
+
+        // transforms size / 2 + 1 bins back into size real samples, the samples are scaled by size
+        void inverse(const float* inputReal, const float* inputImag, float* output) noexcept;
+
+    private:
+        static std::shared_ptr<const Tables> getTables(std::uint32_t size);
+
+        // complex FFT of the size / 2 values in real and imag, the inverse one is not scaled
+        void transform(bool inverse) noexcept;
+
+        std::uint32_t size;
+        std::shared_ptr<const Tables> tables;
+        std::vector<float> real;
+        std::vector<float> imag;
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_FFT_HPP
@@ -0,0 +1,419 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#elif defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
+#include <algorithm>
+#include "Kernels.hpp"
+#include "../../core/Engine.hpp"
+
+namespace ouzel::audio::mixer
+{
+    void add(const float* source, float* destination, std::size_t count) noexcept
+    {
+        std::size_t i = 0;
+
+        if (core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__)
+            for (; i + 4 <= count; i += 4)
+                vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), vld1q_f32(source + i)));
+#elif defined(__SSE__)
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_loadu_ps(source + i)));
+#endif
+        }
+
+        for (; i < count; ++i)
+            destination[i] += source[i];
+    }
+
+    void addScaled(const float* source, float* destination, std::size_t count, float gain) noexcept
+    {
+        std::size_t i = 0;
+
+        // multiplication and addition are not fused, so that the results match the scalar code
+        if (core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__)
+            const auto g = vdupq_n_f32(gain);
+            for (; i + 4 <= count; i += 4)
+                vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), vmulq_f32(vld1q_f32(source + i), g)));
+#elif defined(__SSE__)
+            const auto g = _mm_set1_ps(gain);
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), g)));
+#endif
+        }
+
+        for (; i < count; ++i)
+            destination[i] += source[i] * gain;
+    }
+
+    void addRamped(const float* source, float* destination, std::size_t count, float startGain, float endGain) noexcept
+    {
+        // mixed only in the blocks where a stream starts or stops being virtual, so it is not vectorized
+        const float step = (count > 0) ? (endGain - startGain) / static_cast<float>(count) : 0.0F;
+
+        for (std::size_t i = 0; i < count; ++i)
+            destination[i] += source[i] * (startGain + step * static_cast<float>(i));
+    }
+
+    void scale(const float* source, float* destination, std::size_t count, float gain) noexcept
+    {
+        std::size_t i = 0;
+
+        if (core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__)
+            const auto g = vdupq_n_f32(gain);
+            for (; i + 4 <= count; i += 4)
+                vst1q_f32(destination + i, vmulq_f32(vld1q_f32(source + i), g));
+#elif defined(__SSE__)
+            const auto g = _mm_set1_ps(gain);
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_loadu_ps(source + i), g));
+#endif
+        }
+
+        for (; i < count; ++i)
+            destination[i] = source[i] * gain;
+    }
+
+    void clamp(const float* source, float* destination, std::size_t count, float minimum, float maximum) noexcept
+    {
+        std::size_t i = 0;
+
+        if (core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__)
+            const auto low = vdupq_n_f32(minimum);
+            const auto high = vdupq_n_f32(maximum);
+            for (; i + 4 <= count; i += 4)
+                vst1q_f32(destination + i, vminq_f32(vmaxq_f32(vld1q_f32(source + i), low), high));
+#elif defined(__SSE__)
+            // the sample is the second operand, so that NaNs are passed through like with std::clamp
+            const auto low = _mm_set1_ps(minimum);
+            const auto high = _mm_set1_ps(maximum);
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(destination + i, _mm_min_ps(high, _mm_max_ps(low, _mm_loadu_ps(source + i))));
+#endif
+        }
+
+        for (; i < count; ++i)
+            destination[i] = std::clamp(source[i], minimum, maximum);
+    }
+
+    float dot(const float* a, const float* b, std::size_t count) noexcept
+    {
+        std::size_t i = 0;
+        float result = 0.0F;
+
+        if (core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__)
+            auto sum = vdupq_n_f32(0.0F);
+            for (; i + 4 <= count; i += 4)
+                sum = vmlaq_f32(sum, vld1q_f32(a + i), vld1q_f32(b + i));
+            const auto pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+            result = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#elif defined(__SSE__)
+            auto sum = _mm_setzero_ps();
+            for (; i + 4 <= count; i += 4)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+            result = _mm_cvtss_f32(sum);
+#endif
+        }
+
+        for (; i < count; ++i)
+            result += a[i] * b[i];
+
+        return result;
+    }
+
+    namespace
+    {
+        void biquad(const BiquadCoefficients& coefficients, float* samples, std::size_t frames,
+                    float& z1, float& z2) noexcept
+        {
+            for (std::size_t frame = 0; frame < frames; ++frame)
+            {
+                const float input = samples[frame];
+                const float output = coefficients.b0 * input + z1;
+                z1 = coefficients.b1 * input - coefficients.a1 * output + z2;
+                z2 = coefficients.b2 * input - coefficients.a2 * output;
+                samples[frame] = output;
+            }
+        }
+
+#if defined(__ARM_NEON__)
+        inline void transpose(float32x4_t& r0, float32x4_t& r1, float32x4_t& r2, float32x4_t& r3) noexcept
+        {
+            const auto t01 = vtrnq_f32(r0, r1);
+            const auto t23 = vtrnq_f32(r2, r3);
+            r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+            r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+            r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+            r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+        }
+#endif
+    }
+
+    void biquad(const BiquadCoefficients& coefficients, float* samples, std::size_t stride,
+                std::uint32_t channels, std::size_t frames, float* state) noexcept
+    {
+        std::uint32_t channel = 0;
+
+        if (core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__) || defined(__SSE__)
+            // every lane filters one channel, four frames at a time are transposed so that a vector holds one
+            // frame of every lane; the unused lanes of a group of two or three channels repeat its last channel
+            // and store the same samples again
+            while (channels - channel >= 2)
+            {
+                const std::uint32_t lanes = std::min(channels - channel, 4U);
+                float* lane[4];
+                float z1Values[4];
+                float z2Values[4];
+
+                for (std::uint32_t i = 0; i < 4; ++i)
+                {
+                    const auto laneChannel = channel + std::min(i, lanes - 1);
+                    lane[i] = samples + laneChannel * stride;
+                    z1Values[i] = state[laneChannel * 2];
+                    z2Values[i] = state[laneChannel * 2 + 1];
+                }
+
+                std::size_t frame = 0;
+#  if defined(__ARM_NEON__)
+                const auto b0 = vdupq_n_f32(coefficients.b0);
+                const auto b1 = vdupq_n_f32(coefficients.b1);
+                const auto b2 = vdupq_n_f32(coefficients.b2);
+                const auto a1 = vdupq_n_f32(coefficients.a1);
+                const auto a2 = vdupq_n_f32(coefficients.a2);
+                auto z1 = vld1q_f32(z1Values);
+                auto z2 = vld1q_f32(z2Values);
+
+                const auto step = [&](float32x4_t input) noexcept {
+                    const auto output = vaddq_f32(vmulq_f32(b0, input), z1);
+                    z1 = vaddq_f32(vsubq_f32(vmulq_f32(b1, input), vmulq_f32(a1, output)), z2);
+                    z2 = vsubq_f32(vmulq_f32(b2, input), vmulq_f32(a2, output));
+                    return output;
+                };
+
+                for (; frame + 4 <= frames; frame += 4)
+                {
+                    auto r0 = vld1q_f32(lane[0] + frame);
+                    auto r1 = vld1q_f32(lane[1] + frame);
+                    auto r2 = vld1q_f32(lane[2] + frame);
+                    auto r3 = vld1q_f32(lane[3] + frame);
+                    transpose(r0, r1, r2, r3);
+                    r0 = step(r0);
+                    r1 = step(r1);
+                    r2 = step(r2);
+                    r3 = step(r3);
+                    transpose(r0, r1, r2, r3);
+                    vst1q_f32(lane[0] + frame, r0);
+                    vst1q_f32(lane[1] + frame, r1);
+                    vst1q_f32(lane[2] + frame, r2);
+                    vst1q_f32(lane[3] + frame, r3);
+                }
+
+                vst1q_f32(z1Values, z1);
+                vst1q_f32(z2Values, z2);
+#  elif defined(__SSE__)
+                const auto b0 = _mm_set1_ps(coefficients.b0);
+                const auto b1 = _mm_set1_ps(coefficients.b1);
+                const auto b2 = _mm_set1_ps(coefficients.b2);
+                const auto a1 = _mm_set1_ps(coefficients.a1);
+                const auto a2 = _mm_set1_ps(coefficients.a2);
+                auto z1 = _mm_loadu_ps(z1Values);
+                auto z2 = _mm_loadu_ps(z2Values);
+
+                const auto step = [&](__m128 input) noexcept {
+                    const auto output = _mm_add_ps(_mm_mul_ps(b0, input), z1);
+                    z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, input), _mm_mul_ps(a1, output)), z2);
+                    z2 = _mm_sub_ps(_mm_mul_ps(b2, input), _mm_mul_ps(a2, output));
+                    return output;
+                };
+
+                for (; frame + 4 <= frames; frame += 4)
+                {
+                    auto r0 = _mm_loadu_ps(lane[0] + frame);
+                    auto r1 = _mm_loadu_ps(lane[1] + frame);
+                    auto r2 = _mm_loadu_ps(lane[2] + frame);
+                    auto r3 = _mm_loadu_ps(lane[3] + frame);
+                    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                    r0 = step(r0);
+                    r1 = step(r1);
+                    r2 = step(r2);
+                    r3 = step(r3);
+                    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                    _mm_storeu_ps(lane[0] + frame, r0);
+                    _mm_storeu_ps(lane[1] + frame, r1);
+                    _mm_storeu_ps(lane[2] + frame, r2);
+                    _mm_storeu_ps(lane[3] + frame, r3);
+                }
+
+                _mm_storeu_ps(z1Values, z1);
+                _mm_storeu_ps(z2Values, z2);
+#  endif
+                for (std::uint32_t i = 0; i < lanes; ++i)
+                {
+                    biquad(coefficients, lane[i] + frame, frames - frame, z1Values[i], z2Values[i]);
+                    state[(channel + i) * 2] = z1Values[i];
+                    state[(channel + i) * 2 + 1] = z2Values[i];
+                }
+
+                channel += lanes;
+            }
+#endif
+        }
+
+        for (; channel < channels; ++channel)
+            biquad(coefficients, samples + channel * stride, frames, state[channel * 2], state[channel * 2 + 1]);
+    }
+
+    void interleave(const float* source, std::size_t sourceStride,
+                    std::uint32_t channels, std::size_t frames,
+                    float* destination) noexcept
+    {
+        if (channels == 1)
+        {
+            std::copy(source, source + frames, destination);
+            return;
+        }
+
+        std::size_t frame = 0;
+
+        if (channels == 2 && core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__)
+            const float* left = source;
+            const float* right = source + sourceStride;
+            for (; frame + 4 <= frames; frame += 4)
+            {
+                const float32x4x2_t samples = {{vld1q_f32(left + frame), vld1q_f32(right + frame)}};
+                vst2q_f32(destination + frame * 2, samples);
+            }
+#elif defined(__SSE__)
+            const float* left = source;
+            const float* right = source + sourceStride;
+            for (; frame + 4 <= frames; frame += 4)
+            {
+                const auto l = _mm_loadu_ps(left + frame);
+                const auto r = _mm_loadu_ps(right + frame);
+                _mm_storeu_ps(destination + frame * 2, _mm_unpacklo_ps(l, r));
+                _mm_storeu_ps(destination + frame * 2 + 4, _mm_unpackhi_ps(l, r));
+            }
+#endif
+        }
+
+        for (; frame < frames; ++frame)
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                destination[frame * channels + channel] = source[channel * sourceStride + frame];
+    }
+
+    void deinterleave(const float* source,
+                      std::uint32_t channels, std::size_t frames,
+                      float* destination, std::size_t destinationStride) noexcept
+    {
+        if (channels == 1)
+        {
+            std::copy(source, source + frames, destination);
+            return;
+        }
+
+        std::size_t frame = 0;
+
+        if (channels == 2 && core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__)
+            float* left = destination;
+            float* right = destination + destinationStride;
+            for (; frame + 4 <= frames; frame += 4)
+            {
+                const auto samples = vld2q_f32(source + frame * 2);
+                vst1q_f32(left + frame, samples.val[0]);
+                vst1q_f32(right + frame, samples.val[1]);
+            }
+#elif defined(__SSE__)
+            float* left = destination;
+            float* right = destination + destinationStride;
+            for (; frame + 4 <= frames; frame += 4)
+            {
+                const auto a = _mm_loadu_ps(source + frame * 2); // l0 r0 l1 r1
+                const auto b = _mm_loadu_ps(source + frame * 2 + 4); // l2 r2 l3 r3
+                _mm_storeu_ps(left + frame, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(right + frame, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+#endif
+        }
+
+        for (; frame < frames; ++frame)
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                destination[channel * destinationStride + frame] = source[frame * channels + channel];
+    }
+
+    void interleave(const float* source, std::size_t sourceStride,
+                    std::uint32_t channels, std::size_t frames,
+                    std::int16_t* destination) noexcept
+    {
+        std::size_t frame = 0;
+
+        // conversion truncates towards zero like static_cast
+        if (channels <= 2 && core::isSimdAvailable)
+        {
+#if defined(__ARM_NEON__)
+            const float* left = source;
+            const float* right = source + sourceStride;
+            const auto factor = vdupq_n_f32(32767.0F);
+
+            if (channels == 1)
+                for (; frame + 4 <= frames; frame += 4)
+                    vst1_s16(destination + frame, vqmovn_s32(vcvtq_s32_f32(vmulq_f32(vld1q_f32(left + frame), factor))));
+            else
+                for (; frame + 4 <= frames; frame += 4)
+                {
+                    const int16x4x2_t samples = {{
+                        vqmovn_s32(vcvtq_s32_f32(vmulq_f32(vld1q_f32(left + frame), factor))),
+                        vqmovn_s32(vcvtq_s32_f32(vmulq_f32(vld1q_f32(right + frame), factor)))
+                    }};
+                    vst2_s16(destination + frame * 2, samples);
+                }
+#elif defined(__SSE2__)
+            const float* left = source;
+            const float* right = source + sourceStride;
+            const auto factor = _mm_set1_ps(32767.0F);
+
+            if (channels == 1)
+                for (; frame + 8 <= frames; frame += 8)
+                {
+                    const auto a = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(left + frame), factor));
+                    const auto b = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(left + frame + 4), factor));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + frame), _mm_packs_epi32(a, b));
+                }
+            else
+                for (; frame + 4 <= frames; frame += 4)
+                {
+                    const auto l = _mm_mul_ps(_mm_loadu_ps(left + frame), factor);
+                    const auto r = _mm_mul_ps(_mm_loadu_ps(right + frame), factor);
+                    const auto a = _mm_cvttps_epi32(_mm_unpacklo_ps(l, r));
+                    const auto b = _mm_cvttps_epi32(_mm_unpackhi_ps(l, r));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + frame * 2), _mm_packs_epi32(a, b));
+                }
+#endif
+        }
+
+        for (; frame < frames; ++frame)
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                destination[frame * channels + channel] = static_cast<std::int16_t>(source[channel * sourceStride + frame] * 32767.0F);
+    }
+}
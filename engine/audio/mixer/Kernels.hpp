@@ -0,0 +1,62 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_MIXER_KERNELS_HPP
+#define OUZEL_AUDIO_MIXER_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Sample loops of the mixer, vectorized with NEON or SSE if the CPU supports it.
+// Planar buffers store the channels one after another (channel * stride + frame),
+// interleaved buffers store the frames one after another (frame * channels + channel).
+namespace ouzel::audio::mixer
+{
+    // destination += source
+    void add(const float* source, float* destination, std::size_t count) noexcept;
+
+    // destination += source * gain
+    void addScaled(const float* source, float* destination, std::size_t count, float gain) noexcept;
+
+    // destination += source * gain, where the gain goes linearly from startGain towards endGain,
+    // used to fade the streams in and out without clicks
+    void addRamped(const float* source, float* destination, std::size_t count, float startGain, float endGain) noexcept;
+
+    // destination = source * gain, the buffers can be the same
+    void scale(const float* source, float* destination, std::size_t count, float gain) noexcept;
+
+    // destination = clamp(source, minimum, maximum), the buffers can be the same
+    void clamp(const float* source, float* destination, std::size_t count, float minimum, float maximum) noexcept;
+
+    // sum of a[i] * b[i]
+    float dot(const float* a, const float* b, std::size_t count) noexcept;
+
+    // normalized coefficients of a second order IIR filter
+    struct BiquadCoefficients final
+    {
+        float b0 = 1.0F;
+        float b1 = 0.0F;
+        float b2 = 0.0F;
+        float a1 = 0.0F;
+        float a2 = 0.0F;
+    };
+
+    // filters the planar channels in place with the transposed direct form II, state holds two values
+    // per channel; the recursion can not be vectorized over the frames, so the channels are filtered in parallel
+    void biquad(const BiquadCoefficients& coefficients, float* samples, std::size_t stride,
+                std::uint32_t channels, std::size_t frames, float* state) noexcept;
+
+    void interleave(const float* source, std::size_t sourceStride,
+                    std::uint32_t channels, std::size_t frames,
+                    float* destination) noexcept;
+
+    void deinterleave(const float* source,
+                      std::uint32_t channels, std::size_t frames,
+                      float* destination, std::size_t destinationStride) noexcept;
+
+    // interleaves and converts the samples to 16-bit integers, the samples must be in the range [-1, 1]
+    void interleave(const float* source, std::size_t sourceStride,
+                    std::uint32_t channels, std::size_t frames,
+                    std::int16_t* destination) noexcept;
+}
+
+#endif // OUZEL_AUDIO_MIXER_KERNELS_HPP
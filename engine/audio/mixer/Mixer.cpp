@@ -1,6 +1,7 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
 #include <algorithm>
+#include <cassert>
 #include "Mixer.hpp"
 #include "Bus.hpp"
 #include "Data.hpp"
@@ -11,44 +12,78 @@ namespace ouzel::audio::mixer
 {
     Mixer::Mixer(std::uint32_t initBufferSize,
                  std::uint32_t initChannels,
+                 std::uint32_t initSampleRate,
+                 std::uint32_t initBufferCount,
+                 std::uint32_t initWorkerCount,
+                 Resampler::Quality initResamplerQuality,
                  const std::function<void(const Event&)>& initCallback):
         bufferSize(initBufferSize),
         channels(initChannels),
+        sampleRate(initSampleRate),
+        bufferCount(initBufferCount),
+        resamplerQuality(initResamplerQuality),
         callback(initCallback),
-        mixerThread(&Mixer::mixerMain, this),
-        buffer(initBufferSize * 3, initChannels)
+        buffer(initBufferSize * initBufferCount, initChannels)
     {
-        //mixerThread.setPriority(20.0F, true);
-
         rootObjectId = getObjectId();
         objects.resize(rootObjectId);
         auto object = std::make_unique<RootObject>();
         rootObject = object.get();
         objects[rootObjectId - 1] = std::move(object);
+
+        if (bufferCount > 0)
+        {
+            // start with a full buffer of silence, so that the device is not starved before the mixer thread catches up
+            renderBuffer.resize(bufferSize * channels);
+            for (std::uint32_t i = 0; i < bufferCount; ++i)
+                buffer.write(bufferSize, renderBuffer);
+
+            // only the mixer thread uses the workers, the audio callback must not wait for them
+            workers.reserve(initWorkerCount);
+            for (std::uint32_t i = 0; i < initWorkerCount; ++i)
+                workers.emplace_back(&Mixer::workerMain, this);
+
+            running = true;
+            mixerThread = thread::Thread(&Mixer::mixerMain, this);
+            //mixerThread.setPriority(20.0F, true);
+        }
     }
 
     Mixer::~Mixer()
     {
+        std::unique_lock lock(bufferMutex);
+        running = false;
+        lock.unlock();
+        bufferCondition.notify_all();
+
         if (mixerThread.isJoinable())
             mixerThread.join();
+
+        std::unique_lock workerLock(workerMutex);
+        workersRunning = false;
+        workerLock.unlock();
+        workerCondition.notify_all();
+
+        for (auto& worker : workers)
+            worker.join();
     }
 
     void Mixer::process()
     {
-        CommandBuffer commandBuffer;
-        std::unique_ptr<Command> command;
-
         for (;;)
         {
-            std::unique_lock lock(commandQueueMutex);
-            if (commandQueue.empty()) break;
-            commandBuffer = std::move(commandQueue.front());
+            // the audio callback must never wait for the game thread, so the commands are left for the next block if it holds the lock
+            std::unique_lock lock(commandQueueMutex, std::try_to_lock);
+            if (!lock.owns_lock() || commandQueue.empty()) break;
+
+            // swapped with the buffer allocated by the constructor, because moving a command buffer allocates
+            processedCommands.swap(commandQueue.front());
             commandQueue.pop();
             lock.unlock();
 
-            while (!commandBuffer.isEmpty())
+            while (!processedCommands.isEmpty())
             {
-                command = commandBuffer.popCommand();
+                const auto command = processedCommands.popCommand();
 
                 switch (command->type)
                 {
@@ -56,12 +91,14 @@ namespace ouzel::audio::mixer
                     {
                         auto initObjectCommand = static_cast<InitObjectCommand*>(command.get());
                         objects[initObjectCommand->objectId - 1] = std::make_unique<Object>(std::move(initObjectCommand->source));
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::deleteObject:
                     {
                         auto deleteObjectCommand = static_cast<const DeleteObjectCommand*>(command.get());
                         objects[deleteObjectCommand->objectId - 1].reset();
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::addChild:
@@ -70,6 +107,7 @@ namespace ouzel::audio::mixer
                         Object* object = objects[addChildCommand->objectId - 1].get();
                         Object* child = objects[addChildCommand->objectId - 1].get();
                         object->addChild(*child);
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::removeChild:
@@ -78,6 +116,7 @@ namespace ouzel::audio::mixer
                         Object* object = objects[removeChildCommand->objectId - 1].get();
                         Object* child = objects[removeChildCommand->objectId - 1].get();
                         object->removeChild(*child);
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::play:
@@ -102,6 +141,7 @@ namespace ouzel::audio::mixer
                             objects.resize(initBusCommand->busId);
 
                         objects[initBusCommand->busId - 1] = std::make_unique<Bus>();
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::setBusOutput:
@@ -110,6 +150,7 @@ namespace ouzel::audio::mixer
 
                         auto bus = static_cast<Bus*>(objects[setBusOutputCommand->busId - 1].get());
                         bus->setOutput(setBusOutputCommand->outputBusId ? static_cast<Bus*>(objects[setBusOutputCommand->outputBusId - 1].get()) : nullptr);
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::addProcessor:
@@ -119,6 +160,7 @@ namespace ouzel::audio::mixer
                         auto bus = static_cast<Bus*>(objects[addProcessorCommand->busId - 1].get());
                         auto processor = static_cast<Processor*>(objects[addProcessorCommand->processorId - 1].get());
                         bus->addProcessor(processor);
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::removeProcessor:
@@ -128,6 +170,7 @@ namespace ouzel::audio::mixer
                         auto bus = static_cast<Bus*>(objects[removeProcessorCommand->busId - 1].get());
                         auto processor = static_cast<Processor*>(objects[removeProcessorCommand->processorId - 1].get());
                         bus->removeProcessor(processor);
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::setMasterBus:
@@ -135,6 +178,7 @@ namespace ouzel::audio::mixer
                         auto setMasterBusCommand = static_cast<const SetMasterBusCommand*>(command.get());
 
                         masterBus = setMasterBusCommand->busId ? static_cast<Bus*>(objects[setMasterBusCommand->busId - 1].get()) : nullptr;
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::initStream:
@@ -145,7 +189,10 @@ namespace ouzel::audio::mixer
                             objects.resize(initStreamCommand->streamId);
 
                         auto data = static_cast<Data*>(objects[initStreamCommand->dataId - 1].get());
-                        objects[initStreamCommand->streamId - 1] = data->createStream();
+                        auto stream = data->createStream();
+                        stream->objectId = initStreamCommand->streamId;
+                        objects[initStreamCommand->streamId - 1] = std::move(stream);
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::playStream:
@@ -170,6 +217,23 @@ namespace ouzel::audio::mixer
 
                         auto stream = static_cast<Stream*>(objects[setStreamOutputCommand->streamId - 1].get());
                         stream->setOutput(setStreamOutputCommand->busId ? static_cast<Bus*>(objects[setStreamOutputCommand->busId - 1].get()) : nullptr);
+                        graphDirty = true;
+                        break;
+                    }
+                    case Command::Type::setStreamGain:
+                    {
+                        auto setStreamGainCommand = static_cast<const SetStreamGainCommand*>(command.get());
+
+                        auto stream = static_cast<Stream*>(objects[setStreamGainCommand->streamId - 1].get());
+                        stream->setGain(setStreamGainCommand->gain);
+                        break;
+                    }
+                    case Command::Type::setStreamVirtual:
+                    {
+                        auto setStreamVirtualCommand = static_cast<const SetStreamVirtualCommand*>(command.get());
+
+                        auto stream = static_cast<Stream*>(objects[setStreamVirtualCommand->streamId - 1].get());
+                        stream->setVirtual(setStreamVirtualCommand->isVirtual);
                         break;
                     }
                     case Command::Type::initData:
@@ -180,6 +244,7 @@ namespace ouzel::audio::mixer
                             objects.resize(initDataCommand->dataId);
 
                         objects[initDataCommand->dataId - 1] = std::move(initDataCommand->data);
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::initProcessor:
@@ -190,6 +255,7 @@ namespace ouzel::audio::mixer
                             objects.resize(initProcessorCommand->processorId);
 
                         objects[initProcessorCommand->processorId - 1] = std::move(initProcessorCommand->processor);
+                        graphDirty = true;
                         break;
                     }
                     case Command::Type::updateProcessor:
@@ -207,47 +273,247 @@ namespace ouzel::audio::mixer
         }
     }
 
-    void Mixer::getSamples(std::uint32_t frames, std::uint32_t channelCount, std::uint32_t sampleRate, std::vector<float>& samples)
+    void Mixer::getSamples(std::uint32_t frames, std::uint32_t channelCount, std::uint32_t rate, std::vector<float>& samples)
+    {
+        if (bufferCount == 0)
+        {
+            render(frames, channelCount, rate, samples);
+            return;
+        }
+
+        assert(channelCount == channels);
+
+        samples.resize(frames * channelCount);
+
+        if (const auto readFrames = buffer.read(frames, samples); readFrames < frames)
+        {
+            for (std::uint32_t channel = 0; channel < channelCount; ++channel)
+                std::fill(samples.begin() + channel * frames + readFrames,
+                          samples.begin() + (channel + 1) * frames, 0.0F);
+
+            // reported by the mixer thread, because the callbacks can allocate or block
+            starvedFrames.fetch_add(frames - readFrames, std::memory_order_relaxed);
+            starvationTime.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            starvationCount.fetch_add(1, std::memory_order_release);
+        }
+
+        // the mixer thread also wakes up periodically, so a lost notification only delays it
+        bufferCondition.notify_one();
+    }
+
+    void Mixer::render(std::uint32_t frames, std::uint32_t channelCount, std::uint32_t rate, std::vector<float>& samples)
     {
         process();
 
+        if (graphDirty ||
+            frames > compiledFrames ||
+            channelCount != compiledChannels ||
+            rate != compiledSampleRate)
+            compile(std::max(frames, bufferSize), channelCount, rate);
+
         samples.resize(frames * channelCount);
 
+#ifndef NDEBUG
+        const auto capacity = getCapacity();
+#endif
+
         if (masterBus)
         {
             Vector3F listenerPosition;
             QuaternionF listenerRotation;
 
-            masterBus->getSamples(frames, channelCount, sampleRate, listenerPosition, listenerRotation, samples);
+            // the deepest level first, the buses of a level depend only on the deeper levels
+            for (auto level = levelOffsets.size() - 1; level-- > 0;)
+            {
+                const auto begin = levelOffsets[level];
+                const auto count = levelOffsets[level + 1] - begin;
+
+                // every bus sums its own inputs in the same order, so the result does not depend on the threads
+                if (count > 1 && !workers.empty())
+                    mixLevel(begin, begin + count, frames, channelCount, rate, listenerPosition, listenerRotation);
+                else
+                    for (auto i = begin; i < begin + count; ++i)
+                        schedule[i]->mix(frames, channelCount, rate, listenerPosition, listenerRotation);
+            }
+
+            clamp(masterBus->getOutputSamples().data(), samples.data(), samples.size(), -1.0F, 1.0F);
+
+            for (const Bus* bus : schedule)
+                for (const Stream* stream : bus->getStoppedStreams())
+                    pendingStoppedStreams.push_back(StoppedStream{stream->getObjectId(), stream->getPlayCount()});
+
+            reportStoppedStreams();
         }
+        else
+            std::fill(samples.begin(), samples.end(), 0.0F);
 
-        for (float& sample : samples)
-            sample = std::clamp(sample, -1.0F, 1.0F);
+        assert(getCapacity() == capacity); // mixing must not allocate memory
     }
 
-    void Mixer::mixerMain()
+    void Mixer::mixLevel(std::size_t begin, std::size_t end, std::uint32_t frames, std::uint32_t channelCount,
+                         std::uint32_t rate, const Vector3F& listenerPosition, const QuaternionF& listenerRotation)
     {
-        thread::setCurrentThreadName("Mixer");
+        std::unique_lock lock(workerMutex);
+
+        // a worker that woke up after the previous level was mixed may still be looking for a bus
+        levelCondition.wait(lock, [this]() noexcept { return activeWorkers == 0; });
+
+        currentLevel.end = end;
+        currentLevel.frames = frames;
+        currentLevel.channels = channelCount;
+        currentLevel.sampleRate = rate;
+        currentLevel.listenerPosition = listenerPosition;
+        currentLevel.listenerRotation = listenerRotation;
+        nextBus.store(begin, std::memory_order_relaxed);
+        ++levelGeneration;
+
+        lock.unlock();
+        workerCondition.notify_all();
+
+        mixBuses();
+
+        // all the buses are claimed, the workers that claimed them leave the level when they are mixed
+        lock.lock();
+        levelCondition.wait(lock, [this]() noexcept { return activeWorkers == 0; });
+    }
+
+    void Mixer::mixBuses()
+    {
+        for (auto i = nextBus.fetch_add(1, std::memory_order_relaxed); i < currentLevel.end;
+             i = nextBus.fetch_add(1, std::memory_order_relaxed))
+            schedule[i]->mix(currentLevel.frames, currentLevel.channels, currentLevel.sampleRate,
+                             currentLevel.listenerPosition, currentLevel.listenerRotation);
+    }
+
+    void Mixer::workerMain()
+    {
+        thread::setCurrentThreadName("Mixer worker");
+
+        std::uint64_t generation = 0;
+        std::unique_lock lock(workerMutex);
 
         for (;;)
         {
-            break; // TODO: remove
+            workerCondition.wait(lock, [this, &generation]() noexcept {
+                return !workersRunning || levelGeneration != generation;
+            });
 
-            /*process();
+            if (!workersRunning) break;
 
-            std::unique_lock lock(bufferMutex);
-            bufferCondition.wait(lock);
+            generation = levelGeneration;
+            ++activeWorkers;
+            lock.unlock();
+
+            mixBuses();
+
+            lock.lock();
+            if (--activeWorkers == 0) levelCondition.notify_one();
+        }
+    }
+
+    void Mixer::reportStoppedStreams()
+    {
+        if (pendingStoppedStreams.empty()) return;
+
+        // the audio callback must never wait for the game thread, so the streams are reported after a later block if it holds the lock
+        std::unique_lock lock(stoppedStreamMutex, std::try_to_lock);
+        if (!lock.owns_lock()) return;
+
+        stoppedStreams.insert(stoppedStreams.end(), pendingStoppedStreams.begin(), pendingStoppedStreams.end());
+        pendingStoppedStreams.clear();
+    }
+
+    void Mixer::compile(std::uint32_t maxFrames, std::uint32_t channelCount, std::uint32_t rate)
+    {
+        schedule.clear();
+        levelOffsets.clear();
+        levelOffsets.push_back(0);
+
+        if (masterBus)
+        {
+            // every bus has only one output, so the buses form a tree and the
+            // breadth-first order groups them by their depth
+            schedule.push_back(masterBus);
+
+            for (std::size_t begin = 0; begin < schedule.size();)
+            {
+                const auto end = schedule.size();
+                levelOffsets.push_back(end);
+
+                for (auto i = begin; i < end; ++i)
+                    for (Bus* inputBus : schedule[i]->getInputBuses())
+                        if (std::find(schedule.begin(), schedule.end(), inputBus) == schedule.end()) // skip cycles
+                            schedule.push_back(inputBus);
+
+                begin = end;
+            }
+        }
 
-            if (masterBus)
+        std::size_t streamCount = 0;
+        for (Bus* bus : schedule)
+        {
+            bus->prepare(maxFrames, channelCount, rate, resamplerQuality);
+            streamCount += bus->getStoppedStreams().capacity();
+        }
+
+        // every stream stops at most once per block
+        pendingStoppedStreams.reserve(streamCount);
+
+        graphDirty = false;
+        compiledFrames = maxFrames;
+        compiledChannels = channelCount;
+        compiledSampleRate = rate;
+    }
+
+    std::size_t Mixer::getCapacity() const noexcept
+    {
+        std::size_t capacity = 0;
+        for (const Bus* bus : schedule)
+            capacity += bus->getCapacity();
+        return capacity;
+    }
+
+    void Mixer::reportStarvation()
+    {
+        const auto count = starvationCount.load(std::memory_order_acquire);
+        if (count == reportedStarvationCount) return;
+
+        Event event(Event::Type::starvation);
+        event.starvationCount = count;
+        event.starvedFrames = starvedFrames.exchange(0, std::memory_order_relaxed);
+        event.time = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(starvationTime.load(std::memory_order_relaxed)));
+        reportedStarvationCount = count;
+
+        callback(event);
+    }
+
+    void Mixer::mixerMain()
+    {
+        thread::setCurrentThreadName("Mixer");
+
+        // wake up twice per buffer in case a notification from the audio device is missed
+        const auto period = std::chrono::microseconds(500000ULL * bufferSize / sampleRate);
+
+        while (running)
+        {
+            // commands are applied even if the device is not reading
+            process();
+
+            while (running && buffer.getWritableFrames() >= bufferSize)
             {
-                //Vector3F listenerPosition;
-                //QuaternionF listenerRotation;
+                render(bufferSize, channels, sampleRate, renderBuffer);
+                buffer.write(bufferSize, renderBuffer);
 
-                //masterBus->getData(frames, channels, sampleRate, listenerPosition, listenerRotation, samples);
-            }*/
+                // when the mixer can not keep up it never leaves this loop
+                reportStarvation();
+            }
+
+            reportStarvation();
 
-            //for (float& f : samples)
-            //    f = std::clamp(f, -1.0F, 1.0F);
+            std::unique_lock lock(bufferMutex);
+            bufferCondition.wait_for(lock, period, [this]() noexcept {
+                return !running || buffer.getWritableFrames() >= bufferSize;
+            });
         }
     }
 }
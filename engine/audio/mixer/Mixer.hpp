@@ -3,6 +3,9 @@
 #ifndef OUZEL_AUDIO_MIXER_MIXER_HPP
 #define OUZEL_AUDIO_MIXER_MIXER_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
@@ -12,8 +15,13 @@
 #include <thread>
 #include <vector>
 #include "Commands.hpp"
+#include "Kernels.hpp"
 #include "Object.hpp"
 #include "Processor.hpp"
+#include "Resampler.hpp"
+#include "RingBuffer.hpp"
+#include "../../math/Quaternion.hpp"
+#include "../../math/Vector.hpp"
 #include "../../thread/Thread.hpp"
 
 namespace ouzel::audio::mixer
@@ -59,10 +67,22 @@ namespace ouzel::audio::mixer
 
             Type type;
             std::size_t objectId;
+
+            // starvation
+            std::size_t starvationCount = 0; // total number of blocks the device got without enough samples
+            std::size_t starvedFrames = 0; // frames filled with silence since the previous starvation event
+            std::chrono::steady_clock::time_point time; // time of the last starvation
         };
 
+        // with a non-zero buffer count the mixer thread renders that many buffers ahead of the audio device,
+        // otherwise the samples are mixed in the audio callback;
+        // the workers help the mixer thread to mix independent buses
         Mixer(std::uint32_t initBufferSize,
               std::uint32_t initChannels,
+              std::uint32_t initSampleRate,
+              std::uint32_t initBufferCount,
+              std::uint32_t initWorkerCount,
+              Resampler::Quality initResamplerQuality,
               const std::function<void(const Event&)>& initCallback);
 
         ~Mixer();
@@ -74,7 +94,11 @@ namespace ouzel::audio::mixer
         Mixer& operator=(Mixer&&) = delete;
 
         void process();
-        void getSamples(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate, std::vector<float>& samples);
+
+        // called by the audio device, only copies the rendered samples if the mixer thread is running
+        void getSamples(std::uint32_t frames, std::uint32_t channelCount, std::uint32_t sampleRate, std::vector<float>& samples);
+
+        auto getStarvationCount() const noexcept { return starvationCount.load(std::memory_order_relaxed); }
 
         using ObjectId = std::size_t;
         ObjectId getObjectId()
@@ -96,6 +120,21 @@ namespace ouzel::audio::mixer
             deletedObjectIds.insert(objectId);
         }
 
+        // a stream that reached its end, the play count tells which play of the stream it was
+        struct StoppedStream final
+        {
+            ObjectId streamId = 0;
+            std::size_t playCount = 0;
+        };
+
+        // appends the streams that stopped by themselves since the previous call
+        void getStoppedStreams(std::vector<StoppedStream>& result)
+        {
+            std::lock_guard lock(stoppedStreamMutex);
+            result.insert(result.end(), stoppedStreams.begin(), stoppedStreams.end());
+            stoppedStreams.clear();
+        }
+
         void submitCommandBuffer(CommandBuffer&& commandBuffer)
         {
             std::unique_lock lock(commandQueueMutex);
@@ -109,10 +148,27 @@ namespace ouzel::audio::mixer
         }
 
     private:
+        // orders the buses reachable from the master bus by their depth, so that every bus is mixed after its inputs
+        // and the buses of the same depth can be mixed in parallel, and reserves all the buffers for blocks of up to maxFrames
+        void compile(std::uint32_t maxFrames, std::uint32_t channelCount, std::uint32_t rate);
+        std::size_t getCapacity() const noexcept;
+
+        void render(std::uint32_t frames, std::uint32_t channelCount, std::uint32_t rate, std::vector<float>& samples);
+        void reportStoppedStreams();
+        void reportStarvation();
         void mixerMain();
 
+        // mixes the buses of the schedule in [begin, end) on the calling thread and the workers and waits for them
+        void mixLevel(std::size_t begin, std::size_t end, std::uint32_t frames, std::uint32_t channelCount,
+                      std::uint32_t rate, const Vector3F& listenerPosition, const QuaternionF& listenerRotation);
+        void mixBuses();
+        void workerMain();
+
         std::uint32_t bufferSize;
         std::uint32_t channels;
+        std::uint32_t sampleRate;
+        std::uint32_t bufferCount;
+        Resampler::Quality resamplerQuality;
         std::function<void(const Event&)> callback;
 
         ObjectId lastObjectId = 0;
@@ -124,34 +180,53 @@ namespace ouzel::audio::mixer
 
         Bus* masterBus = nullptr;
 
-        class Buffer final
-        {
-        public:
-            Buffer(std::size_t size, std::uint32_t initChannels):
-                maxFrames(size),
-                channels(initChannels),
-                buffer(size * channels)
-            {
-            }
-
-            bool canRead() const { return frames > 0; }
-            bool canWrite() const { return frames < maxFrames; }
-
-        private:
-            std::size_t frames = 0;
-            std::size_t maxFrames;
-            std::uint32_t channels;
-            std::size_t readPosition = 0;
-            std::size_t writePosition = 0;
-            std::vector<float> buffer;
-        };
+        std::vector<Bus*> schedule;
+        std::vector<std::size_t> levelOffsets; // the buses of a level start at levelOffsets[level] in the schedule
+        bool graphDirty = true; // set only by the commands that change the buses, their inputs or processors
+        std::uint32_t compiledFrames = 0;
+        std::uint32_t compiledChannels = 0;
+        std::uint32_t compiledSampleRate = 0;
 
         thread::Thread mixerThread;
         std::mutex bufferMutex;
         std::condition_variable bufferCondition;
-        Buffer buffer;
+        std::atomic<bool> running{false};
+        RingBuffer buffer; // the mixer thread writes and the audio device reads without locks
+        std::vector<float> renderBuffer;
+
+        std::atomic<std::size_t> starvationCount{0};
+        std::atomic<std::size_t> starvedFrames{0};
+        std::atomic<std::chrono::steady_clock::rep> starvationTime{0};
+        std::size_t reportedStarvationCount = 0;
+
+        std::vector<StoppedStream> pendingStoppedStreams; // used only by the thread that renders
+        std::vector<StoppedStream> stoppedStreams;
+        std::mutex stoppedStreamMutex;
+
+        // the workers are started with the mixer and claim the buses of a level with the atomic index,
+        // so mixing a level does not allocate
+        struct Level final
+        {
+            std::size_t end = 0;
+            std::uint32_t frames = 0;
+            std::uint32_t channels = 0;
+            std::uint32_t sampleRate = 0;
+            Vector3F listenerPosition;
+            QuaternionF listenerRotation;
+        };
+
+        std::vector<thread::Thread> workers;
+        std::mutex workerMutex;
+        std::condition_variable workerCondition; // wakes up the workers for a new level
+        std::condition_variable levelCondition; // wakes up the mixer thread when the last worker leaves the level
+        bool workersRunning = true;
+        std::uint64_t levelGeneration = 0;
+        std::size_t activeWorkers = 0;
+        Level currentLevel; // written only while no worker is active
+        std::atomic<std::size_t> nextBus{0};
 
         std::queue<CommandBuffer> commandQueue;
+        CommandBuffer processedCommands; // only used by process
         std::mutex commandQueueMutex;
     };
 }
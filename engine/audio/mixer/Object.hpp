@@ -3,6 +3,7 @@
 #ifndef OUZEL_AUDIO_MIXER_OBJECT_HPP
 #define OUZEL_AUDIO_MIXER_OBJECT_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -0,0 +1,194 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "PhaseVocoder.hpp"
+#include "../../math/MathUtils.hpp"
+
+namespace ouzel::audio::mixer
+{
+    namespace
+    {
+        // the phases are only needed with a precision of about 1e-5 radians, so polynomial approximations
+        // (with errors under 2e-6) are used instead of the standard library functions, they do not branch,
+        // so that the loops over the bins are vectorized
+        float fastAtan2(float y, float x) noexcept
+        {
+            const float absX = std::fabs(x);
+            const float absY = std::fabs(y);
+            // zero for the zero vector
+            const float a = std::min(absX, absY) / std::max(std::max(absX, absY), std::numeric_limits<float>::min());
+            const float s = a * a;
+            const float r = a * (0.99997726F + s * (-0.33262347F + s * (0.19354346F + s * (-0.11643287F +
+                s * (0.05265332F + s * -0.01172120F)))));
+
+            // the octant and the quadrant are selected with signs instead of comparisons, because compilers
+            // turn the comparisons into floating point operations that are executed conditionally and do not
+            // vectorize them, r is mirrored to pi / 2 - r if absY > absX and to pi - r if x < 0
+            const float octantSign = std::copysign(1.0F, absX - absY);
+            const float firstQuadrant = (pi<float> / 4.0F) * (1.0F - octantSign) + octantSign * r;
+            const float quadrantSign = std::copysign(1.0F, x);
+            const float halfPlane = (pi<float> / 2.0F) * (1.0F - quadrantSign) + quadrantSign * firstQuadrant;
+            return std::copysign(halfPlane, y);
+        }
+    }
+
+    PhaseVocoder::PhaseVocoder(std::uint32_t initFrameSize, std::uint32_t initOversampling):
+        frameSize(initFrameSize),
+        oversampling(initOversampling),
+        hopSize(initFrameSize / initOversampling),
+        binCount(initFrameSize / 2 + 1),
+        fft(initFrameSize),
+        window(initFrameSize),
+        frame(initFrameSize),
+        spectrumReal(binCount),
+        spectrumImag(binCount),
+        magnitudes(binCount),
+        frequencies(binCount),
+        shiftedMagnitudes(binCount),
+        shiftedFrequencies(binCount)
+    {
+        if (oversampling < 4 || frameSize % oversampling != 0)
+            throw std::runtime_error("Invalid oversampling");
+
+        // periodic Hann window, applied before the analysis and after the synthesis, the squared windows
+        // of overlapping frames add up to 3 / 8 of the oversampling
+        for (std::uint32_t i = 0; i < frameSize; ++i)
+            window[i] = 0.5F - 0.5F * std::cos(tau<float> * static_cast<float>(i) / static_cast<float>(frameSize));
+
+        // the inverse FFT is scaled by the frame size
+        outputScale = 8.0F / (3.0F * static_cast<float>(oversampling) * static_cast<float>(frameSize));
+    }
+
+    void PhaseVocoder::prepare(std::uint32_t channels)
+    {
+        if (channels == channelStates.size()) return;
+
+        channelStates.resize(channels);
+        for (auto& channel : channelStates)
+        {
+            channel.input.resize(frameSize);
+            channel.output.resize(frameSize);
+            channel.lastPhase.resize(binCount);
+            channel.phaseSum.resize(binCount);
+        }
+
+        reset();
+    }
+
+    void PhaseVocoder::reset() noexcept
+    {
+        for (auto& channel : channelStates)
+        {
+            std::fill(channel.input.begin(), channel.input.end(), 0.0F);
+            std::fill(channel.output.begin(), channel.output.end(), 0.0F);
+            std::fill(channel.lastPhase.begin(), channel.lastPhase.end(), 0.0F);
+            std::fill(channel.phaseSum.begin(), channel.phaseSum.end(), 0.0F);
+        }
+
+        position = 0;
+    }
+
+    void PhaseVocoder::process(float pitch, std::uint32_t frames, std::uint32_t channels, float* samples) noexcept
+    {
+        const auto count = std::min(channels, static_cast<std::uint32_t>(channelStates.size()));
+        const auto inputOffset = frameSize - hopSize;
+
+        for (std::uint32_t done = 0; done < frames;)
+        {
+            const auto chunk = std::min(frames - done, hopSize - position);
+
+            for (std::uint32_t c = 0; c < count; ++c)
+            {
+                auto& channel = channelStates[c];
+                float* channelSamples = samples + c * frames + done;
+
+                std::copy(channelSamples, channelSamples + chunk, channel.input.begin() + inputOffset + position);
+                std::copy(channel.output.begin() + position, channel.output.begin() + position + chunk, channelSamples);
+            }
+
+            position += chunk;
+            done += chunk;
+
+            if (position == hopSize)
+            {
+                for (std::uint32_t c = 0; c < count; ++c)
+                {
+                    auto& channel = channelStates[c];
+
+                    // the played hop is dropped and a new frame is added to the rest
+                    std::copy(channel.output.begin() + hopSize, channel.output.end(), channel.output.begin());
+                    std::fill(channel.output.end() - hopSize, channel.output.end(), 0.0F);
+
+                    processFrame(channel, pitch);
+
+                    std::copy(channel.input.begin() + hopSize, channel.input.end(), channel.input.begin());
+                }
+
+                position = 0;
+            }
+        }
+    }
+
+    void PhaseVocoder::processFrame(Channel& channel, float pitch) noexcept
+    {
+        for (std::uint32_t i = 0; i < frameSize; ++i)
+            frame[i] = channel.input[i] * window[i];
+
+        fft.forward(frame.data(), spectrumReal.data(), spectrumImag.data());
+
+        // phase advance of every bin per hop
+        const float expectedPhase = tau<float> / static_cast<float>(oversampling);
+        const float oversamplingFactor = static_cast<float>(oversampling) / tau<float>;
+
+        // the frequencies are in bins, so they do not depend on the sample rate
+        for (std::uint32_t k = 0; k < binCount; ++k)
+        {
+            const float real = spectrumReal[k];
+            const float imag = spectrumImag[k];
+            const float phase = fastAtan2(imag, real);
+
+            const float difference = wrapAngle(phase - channel.lastPhase[k] - static_cast<float>(k) * expectedPhase);
+            channel.lastPhase[k] = phase;
+
+            frequencies[k] = static_cast<float>(k) + difference * oversamplingFactor;
+        }
+
+        // std::sqrt can set errno, which keeps the loop above from being vectorized
+        for (std::uint32_t k = 0; k < binCount; ++k)
+            magnitudes[k] = std::sqrt(spectrumReal[k] * spectrumReal[k] + spectrumImag[k] * spectrumImag[k]);
+
+        std::fill(shiftedMagnitudes.begin(), shiftedMagnitudes.end(), 0.0F);
+        std::fill(shiftedFrequencies.begin(), shiftedFrequencies.end(), 0.0F);
+
+        for (std::uint32_t k = 0; k < binCount; ++k)
+        {
+            const auto index = static_cast<std::uint32_t>(static_cast<float>(k) * pitch);
+            if (index >= binCount) break;
+
+            shiftedMagnitudes[index] += magnitudes[k];
+            shiftedFrequencies[index] = frequencies[k] * pitch;
+        }
+
+        for (std::uint32_t k = 0; k < binCount; ++k)
+        {
+            const float deviation = shiftedFrequencies[k] - static_cast<float>(k);
+            const float phase = wrapAngle(channel.phaseSum[k] + static_cast<float>(k) * expectedPhase +
+                                          deviation * expectedPhase);
+            channel.phaseSum[k] = phase;
+
+            float sine;
+            float cosine;
+            fastSinCos(phase, sine, cosine);
+            spectrumReal[k] = shiftedMagnitudes[k] * cosine;
+            spectrumImag[k] = shiftedMagnitudes[k] * sine;
+        }
+
+        fft.inverse(spectrumReal.data(), spectrumImag.data(), frame.data());
+
+        for (std::uint32_t i = 0; i < frameSize; ++i)
+            channel.output[i] += frame[i] * window[i] * outputScale;
+    }
+}
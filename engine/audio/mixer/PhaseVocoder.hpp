@@ -0,0 +1,65 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_MIXER_PHASEVOCODER_HPP
+#define OUZEL_AUDIO_MIXER_PHASEVOCODER_HPP
+
+#include <cstdint>
+#include <vector>
+#include "Fft.hpp"
+
+namespace ouzel::audio::mixer
+{
+    // Changes the pitch without changing the duration, like smbPitchShift of Stephan M. Bernsee.
+    // Overlapping frames of every channel are analysed with a real FFT, the bins are moved by the pitch
+    // and the frames are resynthesized with the phases of the moved bins. The frames are processed once
+    // per hop for all channels, so only the sample FIFOs and the phases are kept per channel and the
+    // spectra share the same scratch memory.
+    class PhaseVocoder final
+    {
+    public:
+        explicit PhaseVocoder(std::uint32_t initFrameSize = 1024, std::uint32_t initOversampling = 4);
+
+        // the output is delayed by this many frames
+        auto getLatency() const noexcept { return frameSize; }
+
+        // clears the history if the channel count changes
+        void prepare(std::uint32_t channels);
+        void reset() noexcept;
+
+        // processes the planar samples in place
+        void process(float pitch, std::uint32_t frames, std::uint32_t channels, float* samples) noexcept;
+
+    private:
+        struct Channel final
+        {
+            std::vector<float> input; // frameSize samples, the last hop is being filled
+            std::vector<float> output; // the overlap-added frames, the first hop is being played
+            std::vector<float> lastPhase;
+            std::vector<float> phaseSum;
+        };
+
+        void processFrame(Channel& channel, float pitch) noexcept;
+
+        std::uint32_t frameSize;
+        std::uint32_t oversampling;
+        std::uint32_t hopSize;
+        std::uint32_t binCount;
+        float outputScale;
+        Fft fft;
+        std::vector<float> window;
+
+        std::vector<Channel> channelStates;
+        std::uint32_t position = 0; // position in the hop that is being filled and played
+
+        // shared by all the channels
+        std::vector<float> frame;
+        std::vector<float> spectrumReal;
+        std::vector<float> spectrumImag;
+        std::vector<float> magnitudes;
+        std::vector<float> frequencies;
+        std::vector<float> shiftedMagnitudes;
+        std::vector<float> shiftedFrequencies;
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_PHASEVOCODER_HPP
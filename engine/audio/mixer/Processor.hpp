@@ -24,6 +24,10 @@ namespace ouzel::audio::mixer
         Processor(Processor&&) = delete;
         Processor& operator=(Processor&&) = delete;
 
+        // called when the graph or the output format changes before the next block is processed,
+        // processors allocate their buffers here, so that process does not have to
+        virtual void prepare(std::uint32_t, std::uint32_t, std::uint32_t) {}
+
         virtual void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
                              std::vector<float>& samples) = 0;
 
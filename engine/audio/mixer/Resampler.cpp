@@ -0,0 +1,245 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+#include "Resampler.hpp"
+#include "Kernels.hpp"
+
+namespace ouzel::audio::mixer
+{
+    namespace
+    {
+        // phases of ratios with a larger interpolation factor are rounded to the nearest one
+        constexpr std::uint32_t maxPhases = 1024;
+
+        struct Design final
+        {
+            std::uint32_t taps;
+            double beta; // Kaiser window parameter
+            double cutoff; // relative to the Nyquist frequency of the lower rate
+        };
+
+        constexpr Design getDesign(Resampler::Quality quality) noexcept
+        {
+            switch (quality)
+            {
+                case Resampler::Quality::low: return Design{16, 5.0, 0.80};
+                case Resampler::Quality::medium: return Design{32, 7.0, 0.88};
+                case Resampler::Quality::high: return Design{64, 9.0, 0.93};
+            }
+
+            return Design{32, 7.0, 0.88};
+        }
+
+        // zeroth order modified Bessel function of the first kind
+        double besselI0(double x) noexcept
+        {
+            double sum = 1.0;
+            double term = 1.0;
+            const double y = x * x / 4.0;
+
+            for (std::uint32_t k = 1; term > sum * 1e-12; ++k)
+            {
+                term *= y / (static_cast<double>(k) * static_cast<double>(k));
+                sum += term;
+            }
+
+            return sum;
+        }
+
+        std::shared_ptr<const Resampler::FilterBank> createFilterBank(std::uint32_t interpolation,
+                                                                      std::uint32_t decimation,
+                                                                      Resampler::Quality quality)
+        {
+            const auto design = getDesign(quality);
+            const double pi = 3.14159265358979323846;
+
+            // when decimating, the filter is stretched to stay below the Nyquist frequency of the target rate
+            const double ratio = std::min(1.0, static_cast<double>(interpolation) / static_cast<double>(decimation));
+            const auto stretchedTaps = static_cast<std::uint32_t>(std::ceil(design.taps / ratio));
+            const std::uint32_t taps = (stretchedTaps + 3) & ~3U; // multiple of the vector size
+            const std::uint32_t phases = std::min(interpolation, maxPhases);
+            const double bandwidth = design.cutoff * ratio; // cutoff relative to the Nyquist frequency of the source
+            const double halfTaps = taps / 2;
+            const double windowScale = 1.0 / besselI0(design.beta);
+
+            auto filterBank = std::make_shared<Resampler::FilterBank>();
+            filterBank->taps = taps;
+            filterBank->phases = phases;
+
+            // an extra phase for the rounded phases that reach the next source frame
+            filterBank->coefficients.resize((phases + 1) * taps);
+
+            std::vector<double> values(taps);
+
+            for (std::uint32_t phase = 0; phase <= phases; ++phase)
+            {
+                float* coefficients = &filterBank->coefficients[phase * taps];
+                double sum = 0.0;
+
+                for (std::uint32_t tap = 0; tap < taps; ++tap)
+                {
+                    // distance of the tap from the output frame in source frames
+                    const double t = static_cast<double>(tap) - (halfTaps - 1.0) -
+                        static_cast<double>(phase) / static_cast<double>(phases);
+
+                    const double x = bandwidth * t;
+                    const double sinc = (x == 0.0) ? 1.0 : std::sin(pi * x) / (pi * x);
+
+                    const double w = t / halfTaps;
+                    const double window = (w * w < 1.0) ? besselI0(design.beta * std::sqrt(1.0 - w * w)) * windowScale : 0.0;
+
+                    values[tap] = bandwidth * sinc * window;
+                    sum += values[tap];
+                }
+
+                // normalize every phase to unity gain, so that DC does not ripple
+                for (std::uint32_t tap = 0; tap < taps; ++tap)
+                    coefficients[tap] = static_cast<float>(values[tap] / sum);
+            }
+
+            return filterBank;
+        }
+    }
+
+    std::shared_ptr<const Resampler::FilterBank> Resampler::getFilterBank(std::uint32_t interpolation,
+                                                                          std::uint32_t decimation,
+                                                                          Quality quality)
+    {
+        static std::mutex mutex;
+        static std::map<std::tuple<std::uint32_t, std::uint32_t, Quality>, std::shared_ptr<const FilterBank>> filterBanks;
+
+        std::lock_guard lock(mutex);
+
+        auto& filterBank = filterBanks[std::make_tuple(interpolation, decimation, quality)];
+        if (!filterBank) filterBank = createFilterBank(interpolation, decimation, quality);
+
+        return filterBank;
+    }
+
+    void Resampler::prepare(std::uint32_t sourceSampleRate, std::uint32_t targetSampleRate,
+                            std::uint32_t channels, std::uint32_t maxFrames, Quality quality)
+    {
+        if (sourceSampleRate != sourceRate || targetSampleRate != targetRate || quality != filterQuality)
+        {
+            const auto divisor = std::gcd(sourceSampleRate, targetSampleRate);
+            interpolation = targetSampleRate / divisor;
+            decimation = sourceSampleRate / divisor;
+            filterBank = getFilterBank(interpolation, decimation, quality);
+
+            sourceRate = sourceSampleRate;
+            targetRate = targetSampleRate;
+            filterQuality = quality;
+            channelCount = 0; // the history does not match the filter anymore
+        }
+
+        // the history holds at most one filter length of old frames and the frames of one block
+        const auto requiredCapacity = filterBank->taps + getMaxSourceFrames(maxFrames);
+
+        if (channels != channelCount)
+        {
+            capacity = requiredCapacity;
+            history.assign(capacity * channels, 0.0F);
+            channelCount = channels;
+            reset();
+        }
+        else if (requiredCapacity > capacity)
+        {
+            std::vector<float> newHistory(requiredCapacity * channels, 0.0F);
+            for (std::uint32_t channel = 0; channel < channelCount; ++channel)
+                std::copy(history.begin() + channel * capacity,
+                          history.begin() + channel * capacity + historyFrames,
+                          newHistory.begin() + channel * requiredCapacity);
+
+            history = std::move(newHistory);
+            capacity = requiredCapacity;
+        }
+    }
+
+    void Resampler::reset(std::uint32_t offset) noexcept
+    {
+        if (!filterBank) return;
+
+        // the first output frame is aligned with the first source frame, preceded by silence
+        const auto halfTaps = filterBank->taps / 2;
+        std::fill(history.begin(), history.end(), 0.0F);
+        historyFrames = halfTaps - 1;
+        position = halfTaps - 1;
+        phase = static_cast<std::uint32_t>(static_cast<std::uint64_t>(offset) * interpolation / targetRate);
+    }
+
+    std::uint64_t Resampler::getReadAhead() const noexcept
+    {
+        return ((historyFrames - position) * static_cast<std::uint64_t>(interpolation) - phase) * (targetRate / interpolation);
+    }
+
+    std::uint32_t Resampler::getSourceFrames(std::uint32_t frames) const noexcept
+    {
+        if (frames == 0) return 0;
+
+        // the last output frame reads up to half of the filter length past its position
+        const auto lastPosition = position + (phase + static_cast<std::uint64_t>(frames - 1) * decimation) / interpolation;
+        const auto requiredFrames = lastPosition + filterBank->taps / 2 + 1;
+
+        return (requiredFrames > historyFrames) ? static_cast<std::uint32_t>(requiredFrames - historyFrames) : 0;
+    }
+
+    std::uint32_t Resampler::getMaxSourceFrames(std::uint32_t maxFrames) const noexcept
+    {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(maxFrames) * decimation + interpolation - 1) / interpolation) +
+            filterBank->taps / 2 + 1;
+    }
+
+    void Resampler::process(const float* source, std::uint32_t sourceFrames,
+                            std::uint32_t frames, float* output) noexcept
+    {
+        const auto taps = filterBank->taps;
+        const auto phases = filterBank->phases;
+        const float* coefficients = filterBank->coefficients.data();
+        const auto halfTaps = taps / 2;
+        const auto totalFrames = historyFrames + sourceFrames;
+
+        for (std::uint32_t channel = 0; channel < channelCount; ++channel)
+        {
+            float* channelHistory = &history[channel * capacity];
+            const float* sourceChannel = &source[channel * sourceFrames];
+            float* outputChannel = &output[channel * frames];
+
+            std::copy(sourceChannel, sourceChannel + sourceFrames, channelHistory + historyFrames);
+
+            auto currentPosition = position;
+            auto currentPhase = phase;
+
+            for (std::uint32_t frame = 0; frame < frames; ++frame)
+            {
+                const auto filter = (phases == interpolation) ? currentPhase :
+                    static_cast<std::uint32_t>((static_cast<std::uint64_t>(currentPhase) * phases * 2 + interpolation) / (interpolation * 2));
+
+                outputChannel[frame] = dot(channelHistory + currentPosition - (halfTaps - 1),
+                                           coefficients + filter * taps, taps);
+
+                currentPhase += decimation;
+                currentPosition += currentPhase / interpolation;
+                currentPhase %= interpolation;
+            }
+        }
+
+        const auto nextPosition = position + static_cast<std::uint32_t>((phase + static_cast<std::uint64_t>(frames) * decimation) / interpolation);
+        phase = static_cast<std::uint32_t>((phase + static_cast<std::uint64_t>(frames) * decimation) % interpolation);
+
+        // keep only the frames that the next output frames still read
+        const auto firstFrame = std::min(nextPosition - (halfTaps - 1), totalFrames);
+        for (std::uint32_t channel = 0; channel < channelCount; ++channel)
+        {
+            float* channelHistory = &history[channel * capacity];
+            std::copy(channelHistory + firstFrame, channelHistory + totalFrames, channelHistory);
+        }
+
+        historyFrames = totalFrames - firstFrame;
+        position = nextPosition - firstFrame;
+    }
+}
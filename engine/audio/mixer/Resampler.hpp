@@ -0,0 +1,77 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_MIXER_RESAMPLER_HPP
+#define OUZEL_AUDIO_MIXER_RESAMPLER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ouzel::audio::mixer
+{
+    // Streaming polyphase resampler with a windowed-sinc filter. The position
+    // between the source frames is kept across blocks as an exact fraction, so
+    // consecutive blocks continue without discontinuities.
+    class Resampler final
+    {
+    public:
+        enum class Quality
+        {
+            low, // 16 taps
+            medium, // 32 taps
+            high // 64 taps
+        };
+
+        // filters of all the phases for a ratio, shared by all the resamplers with the same ratio and quality
+        struct FilterBank final
+        {
+            std::uint32_t taps;
+            std::uint32_t phases;
+            std::vector<float> coefficients; // taps coefficients for every phase
+        };
+
+        static std::shared_ptr<const FilterBank> getFilterBank(std::uint32_t interpolation,
+                                                               std::uint32_t decimation,
+                                                               Quality quality);
+
+        // allocates the filters and the buffers for blocks of up to maxFrames,
+        // keeps the state if the parameters did not change
+        void prepare(std::uint32_t sourceSampleRate, std::uint32_t targetSampleRate,
+                     std::uint32_t channels, std::uint32_t maxFrames, Quality quality);
+
+        // starts from the beginning of the source, the first output frame is offset from the first
+        // source frame by less than a source frame, in units of 1 / target sample rate
+        void reset(std::uint32_t offset = 0) noexcept;
+
+        // source frames that were already read past the next output frame, in units of 1 / target sample rate
+        std::uint64_t getReadAhead() const noexcept;
+
+        // number of source frames that process needs to produce the given number of frames
+        std::uint32_t getSourceFrames(std::uint32_t frames) const noexcept;
+        std::uint32_t getMaxSourceFrames(std::uint32_t maxFrames) const noexcept;
+
+        // source must contain getSourceFrames(frames) planar frames, the output is planar
+        void process(const float* source, std::uint32_t sourceFrames,
+                     std::uint32_t frames, float* output) noexcept;
+
+        auto getCapacity() const noexcept { return history.capacity(); }
+
+    private:
+        std::uint32_t sourceRate = 0;
+        std::uint32_t targetRate = 0;
+        Quality filterQuality = Quality::medium;
+
+        std::uint32_t interpolation = 1; // L, the target rate divided by the greatest common divisor of the rates
+        std::uint32_t decimation = 1; // M, the source rate divided by the greatest common divisor of the rates
+        std::shared_ptr<const FilterBank> filterBank;
+
+        std::uint32_t channelCount = 0;
+        std::uint32_t capacity = 0; // frames per channel in the history
+        std::vector<float> history; // the last source frames of every channel
+        std::uint32_t historyFrames = 0;
+        std::uint32_t position = 0; // index of the source frame before the next output frame
+        std::uint32_t phase = 0; // distance from the source frame to the next output frame in 1/interpolation
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_RESAMPLER_HPP
@@ -0,0 +1,100 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_MIXER_RINGBUFFER_HPP
+#define OUZEL_AUDIO_MIXER_RINGBUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "Kernels.hpp"
+
+namespace ouzel::audio::mixer
+{
+    // Single-producer single-consumer ring of interleaved frames, one thread
+    // writes and another one reads without locks.
+    class RingBuffer final
+    {
+    public:
+        RingBuffer(std::uint32_t initMaxFrames, std::uint32_t initChannels):
+            maxFrames(initMaxFrames),
+            channels(initChannels)
+        {
+            // the capacity is a power of two, so that the positions can wrap around
+            while (capacity < maxFrames) capacity *= 2;
+            buffer.resize(capacity * channels);
+        }
+
+        // must be called only by the producer
+        std::uint32_t getWritableFrames() const noexcept
+        {
+            return maxFrames - (writePosition.load(std::memory_order_relaxed) -
+                                readPosition.load(std::memory_order_acquire));
+        }
+
+        // must be called only by the consumer
+        std::uint32_t getReadableFrames() const noexcept
+        {
+            return writePosition.load(std::memory_order_acquire) -
+                readPosition.load(std::memory_order_relaxed);
+        }
+
+        // must be called only by the producer, the samples are not interleaved
+        void write(std::uint32_t frames, const std::vector<float>& samples) noexcept
+        {
+            const auto position = writePosition.load(std::memory_order_relaxed);
+            const auto index = position & (capacity - 1);
+            const auto firstFrames = std::min(frames, capacity - index); // frames before the end of the ring
+
+            interleave(samples.data(), frames, channels, firstFrames, &buffer[index * channels]);
+            interleave(samples.data() + firstFrames, frames, channels, frames - firstFrames, buffer.data());
+
+            writePosition.store(position + frames, std::memory_order_release);
+        }
+
+        // must be called only by the consumer, returns the number of frames read
+        std::uint32_t read(std::uint32_t frames, std::vector<float>& samples) noexcept
+        {
+            const auto position = readPosition.load(std::memory_order_relaxed);
+            const auto readFrames = std::min(frames, writePosition.load(std::memory_order_acquire) - position);
+            const auto index = position & (capacity - 1);
+            const auto firstFrames = std::min(readFrames, capacity - index);
+
+            deinterleave(&buffer[index * channels], channels, firstFrames, samples.data(), frames);
+            deinterleave(buffer.data(), channels, readFrames - firstFrames, samples.data() + firstFrames, frames);
+
+            readPosition.store(position + readFrames, std::memory_order_release);
+
+            return readFrames;
+        }
+
+        // must be called only by the consumer, drops up to the given number of frames and returns how many were dropped
+        std::uint32_t skip(std::uint32_t frames) noexcept
+        {
+            const auto position = readPosition.load(std::memory_order_relaxed);
+            const auto skippedFrames = std::min(frames, writePosition.load(std::memory_order_acquire) - position);
+
+            readPosition.store(position + skippedFrames, std::memory_order_release);
+
+            return skippedFrames;
+        }
+
+        // drops the unread frames, the consumer must not read at the same time
+        void discard() noexcept
+        {
+            readPosition.store(writePosition.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+
+    private:
+        std::uint32_t maxFrames;
+        std::uint32_t channels;
+        std::uint32_t capacity = 1;
+        std::vector<float> buffer;
+
+        // kept on separate cache lines, because they are written by different threads
+        alignas(64) std::atomic<std::uint32_t> readPosition{0};
+        alignas(64) std::atomic<std::uint32_t> writePosition{0};
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_RINGBUFFER_HPP
@@ -6,15 +6,18 @@
 #include "Object.hpp"
 #include "Bus.hpp"
 #include "Data.hpp"
+#include "Resampler.hpp"
 
 namespace ouzel::audio::mixer
 {
     class Bus;
     class Data;
+    class Mixer;
 
     class Stream: public Object
     {
         friend Bus;
+        friend Mixer;
     public:
         explicit Stream(Data& initData) noexcept:
             data(initData)
@@ -42,22 +45,68 @@ namespace ouzel::audio::mixer
         }
 
         auto isPlaying() const noexcept { return playing; }
-        void play() { playing = true; }
+        void play()
+        {
+            playing = true;
+            ++playCount;
+        }
+
+        auto getObjectId() const noexcept { return objectId; }
+
+        // number of times the stream was started, tells which play a stop reported by the mixer belongs to
+        auto getPlayCount() const noexcept { return playCount; }
 
         void stop(bool shouldReset)
         {
             playing = false;
-            if (shouldReset) reset();
+            if (shouldReset)
+            {
+                reset();
+                resampler.reset();
+                lastBlock = Block::none;
+                skipOffset = 0;
+            }
         }
 
+        auto getGain() const noexcept { return gain; }
+        void setGain(float newGain) { gain = newGain; }
+
+        // a virtual stream is not mixed, its position only advances with skip
+        auto isVirtual() const noexcept { return virtualized; }
+        void setVirtual(bool newVirtual) { virtualized = newVirtual; }
+
         virtual void reset() = 0;
 
         virtual void getSamples(std::uint32_t frames, std::vector<float>& samples) = 0;
 
+        // advances the position by the given number of frames without producing the samples
+        virtual void skip(std::uint32_t frames) = 0;
+
     protected:
         Data& data;
         Bus* output = nullptr;
         bool playing = false;
+
+    private:
+        std::size_t objectId = 0;
+        std::size_t playCount = 0;
+        Resampler resampler;
+        float gain = 1.0F;
+        bool virtualized = false;
+
+        // what happened to the stream in the last block it played, a mixed stream fades out when it becomes virtual
+        // and a skipped one fades in when it becomes real again
+        enum class Block
+        {
+            none,
+            mixed,
+            skipped
+        };
+
+        Block lastBlock = Block::none;
+        // position of the source past the next frame to mix, in units of 1 / target sample rate,
+        // negative until the frames that the resampler read ahead are used up
+        std::int64_t skipOffset = 0;
     };
 }
 
@@ -160,6 +160,9 @@ namespace ouzel::core
             const auto& debugRendererValue = userEngineSection.getValue("debugRenderer", defaultEngineSection.getValue("debugRenderer"));
             if (!debugRendererValue.empty()) settings.graphicsSettings.debugRenderer = (debugRendererValue == "true" || debugRendererValue == "1" || debugRendererValue == "yes");
 
+            const auto& framesInFlightValue = userEngineSection.getValue("framesInFlight", defaultEngineSection.getValue("framesInFlight"));
+            if (!framesInFlightValue.empty()) settings.graphicsSettings.framesInFlight = static_cast<std::uint32_t>(std::stoul(framesInFlightValue));
+
             const auto& highDpiValue = userEngineSection.getValue("highDpi", defaultEngineSection.getValue("highDpi"));
             if (!highDpiValue.empty()) settings.highDpi = (highDpiValue == "true" || highDpiValue == "1" || highDpiValue == "yes");
 
@@ -171,6 +174,28 @@ namespace ouzel::core
 
             settings.audioSettings.audioDevice = userEngineSection.getValue("audioDevice", defaultEngineSection.getValue("audioDevice"));
 
+            const auto& mixerBufferCountValue = userEngineSection.getValue("mixerBufferCount", defaultEngineSection.getValue("mixerBufferCount"));
+            if (!mixerBufferCountValue.empty()) settings.audioSettings.mixerBufferCount = static_cast<std::uint32_t>(std::stoul(mixerBufferCountValue));
+
+            const auto& mixerWorkerCountValue = userEngineSection.getValue("mixerWorkerCount", defaultEngineSection.getValue("mixerWorkerCount"));
+            if (!mixerWorkerCountValue.empty()) settings.audioSettings.mixerWorkerCount = static_cast<std::uint32_t>(std::stoul(mixerWorkerCountValue));
+
+            const auto& resamplerQualityValue = userEngineSection.getValue("resamplerQuality", defaultEngineSection.getValue("resamplerQuality"));
+            if (!resamplerQualityValue.empty())
+            {
+                if (resamplerQualityValue == "low")
+                    settings.audioSettings.resamplerQuality = audio::mixer::Resampler::Quality::low;
+                else if (resamplerQualityValue == "medium")
+                    settings.audioSettings.resamplerQuality = audio::mixer::Resampler::Quality::medium;
+                else if (resamplerQualityValue == "high")
+                    settings.audioSettings.resamplerQuality = audio::mixer::Resampler::Quality::high;
+                else
+                    throw std::runtime_error("Invalid resampler quality specified");
+            }
+
+            const auto& maxRealVoicesValue = userEngineSection.getValue("maxRealVoices", defaultEngineSection.getValue("maxRealVoices"));
+            if (!maxRealVoicesValue.empty()) settings.audioSettings.maxRealVoices = static_cast<std::uint32_t>(std::stoul(maxRealVoicesValue));
+
             return settings;
         }
     }
@@ -187,9 +212,9 @@ namespace ouzel::core
     {
         if (active)
         {
-            auto event = std::make_unique<SystemEvent>();
-            event->type = Event::Type::engineStop;
-            eventDispatcher.postEvent(std::move(event));
+            SystemEvent event;
+            event.type = Event::Type::engineStop;
+            eventDispatcher.queueEvent(std::move(event));
         }
 
         paused = true;
@@ -204,6 +229,10 @@ namespace ouzel::core
             updateThread.join();
         }
 #endif
+
+        // the job system is destroyed before the bundle, so the loads of the bundle are finished here on this thread
+        jobSystem.setMainThread();
+        assetBundle.cancelAsyncLoads();
     }
 
     void Engine::init()
@@ -636,9 +665,9 @@ namespace ouzel::core
     {
         if (!active)
         {
-            auto event = std::make_unique<SystemEvent>();
-            event->type = Event::Type::engineStart;
-            eventDispatcher.postEvent(std::move(event));
+            SystemEvent event;
+            event.type = Event::Type::engineStart;
+            eventDispatcher.queueEvent(std::move(event));
 
             active = true;
             paused = false;
@@ -646,6 +675,7 @@ namespace ouzel::core
 #if !defined(__EMSCRIPTEN__)
             updateThread = thread::Thread(&Engine::engineMain, this);
 #else
+            jobSystem.setMainThread();
             main(args);
 #endif
         }
@@ -655,9 +685,9 @@ namespace ouzel::core
     {
         if (active && !paused)
         {
-            auto event = std::make_unique<SystemEvent>();
-            event->type = Event::Type::enginePause;
-            eventDispatcher.postEvent(std::move(event));
+            SystemEvent event;
+            event.type = Event::Type::enginePause;
+            eventDispatcher.queueEvent(std::move(event));
 
             paused = true;
         }
@@ -667,9 +697,9 @@ namespace ouzel::core
     {
         if (active && paused)
         {
-            auto event = std::make_unique<SystemEvent>();
-            event->type = Event::Type::engineResume;
-            eventDispatcher.postEvent(std::move(event));
+            SystemEvent event;
+            event.type = Event::Type::engineResume;
+            eventDispatcher.queueEvent(std::move(event));
 
             paused = false;
 
@@ -685,9 +715,9 @@ namespace ouzel::core
 
         if (active)
         {
-            auto event = std::make_unique<SystemEvent>();
-            event->type = Event::Type::engineStop;
-            eventDispatcher.postEvent(std::move(event));
+            SystemEvent event;
+            event.type = Event::Type::engineStop;
+            eventDispatcher.queueEvent(std::move(event));
 
             active = false;
         }
@@ -706,6 +736,7 @@ namespace ouzel::core
 
     void Engine::update()
     {
+        jobSystem.executeMainThreadJobs();
         eventDispatcher.dispatchEvents();
 
         const auto currentTime = std::chrono::steady_clock::now();
@@ -743,6 +774,9 @@ namespace ouzel::core
     {
         thread::setCurrentThreadName("Application");
 
+        // the application can wait for the jobs on the main thread before the first update
+        jobSystem.setMainThread();
+
         try
         {
             std::unique_ptr<Application> application = ouzel::main(args);
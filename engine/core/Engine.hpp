@@ -27,6 +27,7 @@
 #include "../network/Network.hpp"
 #include "../formats/Ini.hpp"
 #include "../utils/Log.hpp"
+#include "../thread/JobSystem.hpp"
 #include "../thread/Thread.hpp"
 
 namespace ouzel::core
@@ -85,6 +86,9 @@ namespace ouzel::core
         auto& getNetwork() { return network; }
         auto& getNetwork() const { return network; }
 
+        auto& getJobSystem() { return jobSystem; }
+        auto& getJobSystem() const { return jobSystem; }
+
         void start();
         void pause();
         void resume();
@@ -135,6 +139,7 @@ namespace ouzel::core
         assets::Bundle assetBundle;
         scene::SceneManager sceneManager;
         network::Network network;
+        thread::JobSystem jobSystem; // destroyed first, because jobs can use the other subsystems
 
 #if !defined(__EMSCRIPTEN__)
         thread::Thread updateThread;
@@ -242,9 +242,9 @@ extern "C" JNIEXPORT void JNICALL Java_org_ouzel_OuzelLibJNIWrapper_onConfigurat
 
 extern "C" JNIEXPORT void JNICALL Java_org_ouzel_OuzelLibJNIWrapper_onLowMemory(JNIEnv*, jclass)
 {
-    auto event = std::make_unique<ouzel::SystemEvent>();
-    event->type = ouzel::Event::Type::lowMemory;
-    engine->getEventDispatcher().postEvent(std::move(event));
+    ouzel::SystemEvent event;
+    event.type = ouzel::Event::Type::lowMemory;
+    engine->getEventDispatcher().queueEvent(std::move(event));
 }
 
 extern "C" JNIEXPORT jboolean JNICALL Java_org_ouzel_OuzelLibJNIWrapper_onKeyDown(JNIEnv*, jclass, jint keyCode)
@@ -35,10 +35,10 @@
 {
     if (ouzel::engine)
     {
-        auto event = std::make_unique<ouzel::SystemEvent>();
-        event->type = ouzel::Event::Type::openFile;
-        event->filename = [filename cStringUsingEncoding:NSUTF8StringEncoding];
-        ouzel::engine->getEventDispatcher().postEvent(std::move(event));
+        ouzel::SystemEvent event;
+        event.type = ouzel::Event::Type::openFile;
+        event.filename = [filename cStringUsingEncoding:NSUTF8StringEncoding];
+        ouzel::engine->getEventDispatcher().queueEvent(std::move(event));
     }
 
     return YES;
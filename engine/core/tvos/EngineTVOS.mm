@@ -50,10 +50,10 @@
 {
     if (ouzel::engine)
     {
-        auto event = std::make_unique<ouzel::SystemEvent>();
-        event->type = ouzel::Event::Type::lowMemory;
+        ouzel::SystemEvent event;
+        event.type = ouzel::Event::Type::lowMemory;
 
-        ouzel::engine->getEventDispatcher().postEvent(std::move(event));
+        ouzel::engine->getEventDispatcher().queueEvent(std::move(event));
     }
 }
 @end
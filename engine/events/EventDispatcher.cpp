@@ -54,25 +54,24 @@ namespace ouzel
 
         eventHandlerAddSet.clear();
 
-        std::pair<std::promise<bool>, std::unique_ptr<Event>> event;
+        std::variant<QueuedEvent, PostedEvent> event;
 
-        for (;;)
+        while (eventQueue.pop(event))
         {
-            std::unique_lock lock(eventQueueMutex);
-            if (eventQueue.empty()) break;
-
-            event = std::move(eventQueue.front());
-            eventQueue.pop();
-            lock.unlock();
-
-            event.first.set_value(dispatchEvent(std::move(event.second)));
+            if (const auto postedEvent = std::get_if<PostedEvent>(&event))
+                postedEvent->promise.set_value(dispatchEvent(std::move(postedEvent->event)));
+            else
+                std::visit([this](const auto& e) { dispatch(e); }, std::get<QueuedEvent>(event));
         }
     }
 
     bool EventDispatcher::dispatchEvent(std::unique_ptr<Event> event)
     {
-        if (!event) return false;
+        return event ? dispatch(*event) : false;
+    }
 
+    bool EventDispatcher::dispatch(const Event& event)
+    {
         bool handled = false;
 
         for (const auto eventHandler : eventHandlers)
@@ -83,14 +82,14 @@ namespace ouzel
 
             if (i == eventHandlerDeleteSet.end())
             {
-                switch (event->type)
+                switch (event.type)
                 {
                     case Event::Type::keyboardConnect:
                     case Event::Type::keyboardDisconnect:
                     case Event::Type::keyboardKeyPress:
                     case Event::Type::keyboardKeyRelease:
                         if (eventHandler->keyboardHandler)
-                            handled = eventHandler->keyboardHandler(*static_cast<KeyboardEvent*>(event.get()));
+                            handled = eventHandler->keyboardHandler(static_cast<const KeyboardEvent&>(event));
                         break;
                     case Event::Type::mouseConnect:
                     case Event::Type::mouseDisconnect:
@@ -100,7 +99,7 @@ namespace ouzel
                     case Event::Type::mouseMove:
                     case Event::Type::mouseCursorLockChange:
                         if (eventHandler->mouseHandler)
-                            handled = eventHandler->mouseHandler(*static_cast<MouseEvent*>(event.get()));
+                            handled = eventHandler->mouseHandler(static_cast<const MouseEvent&>(event));
                         break;
                     case Event::Type::touchpadConnect:
                     case Event::Type::touchpadDisconnect:
@@ -109,13 +108,13 @@ namespace ouzel
                     case Event::Type::touchEnd:
                     case Event::Type::touchCancel:
                         if (eventHandler->touchHandler)
-                            handled = eventHandler->touchHandler(*static_cast<TouchEvent*>(event.get()));
+                            handled = eventHandler->touchHandler(static_cast<const TouchEvent&>(event));
                         break;
                     case Event::Type::gamepadConnect:
                     case Event::Type::gamepadDisconnect:
                     case Event::Type::gamepadButtonChange:
                         if (eventHandler->gamepadHandler)
-                            handled = eventHandler->gamepadHandler(*static_cast<GamepadEvent*>(event.get()));
+                            handled = eventHandler->gamepadHandler(static_cast<const GamepadEvent&>(event));
                         break;
                     case Event::Type::windowSizeChange:
                     case Event::Type::windowTitleChange:
@@ -123,7 +122,7 @@ namespace ouzel
                     case Event::Type::screenChange:
                     case Event::Type::resolutionChange:
                         if (eventHandler->windowHandler)
-                            handled = eventHandler->windowHandler(*static_cast<WindowEvent*>(event.get()));
+                            handled = eventHandler->windowHandler(static_cast<const WindowEvent&>(event));
                         break;
                     case Event::Type::engineStart:
                     case Event::Type::engineStop:
@@ -133,7 +132,7 @@ namespace ouzel
                     case Event::Type::lowMemory:
                     case Event::Type::openFile:
                         if (eventHandler->systemHandler)
-                            handled = eventHandler->systemHandler(*static_cast<SystemEvent*>(event.get()));
+                            handled = eventHandler->systemHandler(static_cast<const SystemEvent&>(event));
                         break;
                     case Event::Type::actorEnter:
                     case Event::Type::actorLeave:
@@ -143,27 +142,27 @@ namespace ouzel
                     case Event::Type::actorDrag:
                     case Event::Type::widgetChange:
                         if (eventHandler->uiHandler)
-                            handled = eventHandler->uiHandler(*static_cast<UIEvent*>(event.get()));
+                            handled = eventHandler->uiHandler(static_cast<const UIEvent&>(event));
                         break;
                     case Event::Type::animationStart:
                     case Event::Type::animationReset:
                     case Event::Type::animationFinish:
                         if (eventHandler->animationHandler)
-                            handled = eventHandler->animationHandler(*static_cast<AnimationEvent*>(event.get()));
+                            handled = eventHandler->animationHandler(static_cast<const AnimationEvent&>(event));
                         break;
                     case Event::Type::soundStart:
                     case Event::Type::soundReset:
                     case Event::Type::soundFinish:
                         if (eventHandler->soundHandler)
-                            handled = eventHandler->soundHandler(*static_cast<SoundEvent*>(event.get()));
+                            handled = eventHandler->soundHandler(static_cast<const SoundEvent&>(event));
                         break;
                     case Event::Type::update:
                         if (eventHandler->updateHandler)
-                            handled = eventHandler->updateHandler(*static_cast<UpdateEvent*>(event.get()));
+                            handled = eventHandler->updateHandler(static_cast<const UpdateEvent&>(event));
                         break;
                     case Event::Type::user:
                         if (eventHandler->userHandler)
-                            handled = eventHandler->userHandler(*static_cast<UserEvent*>(event.get()));
+                            handled = eventHandler->userHandler(static_cast<const UserEvent&>(event));
                         break;
                     default:
                         return false; // custom event should not be sent
@@ -212,10 +211,18 @@ namespace ouzel
 #if defined(__EMSCRIPTEN__)
         promise.set_value(dispatchEvent(std::move(event)));
 #else
-        std::lock_guard lock(eventQueueMutex);
-        eventQueue.push(std::pair<std::promise<bool>, std::unique_ptr<Event>>(std::move(promise), std::move(event)));
+        eventQueue.push(PostedEvent{std::move(promise), std::move(event)});
 #endif
 
         return future;
     }
+
+    void EventDispatcher::queueEvent(QueuedEvent event)
+    {
+#if defined(__EMSCRIPTEN__)
+        std::visit([this](const auto& e) { dispatch(e); }, event);
+#else
+        eventQueue.push(std::move(event));
+#endif
+    }
 }
@@ -6,10 +6,11 @@
 #include <cstdint>
 #include <future>
 #include <memory>
-#include <queue>
 #include <set>
+#include <variant>
 #include <vector>
 #include "Event.hpp"
+#include "EventQueue.hpp"
 
 namespace ouzel
 {
@@ -18,6 +19,18 @@ namespace ouzel
     class EventDispatcher final
     {
     public:
+        using QueuedEvent = std::variant<KeyboardEvent,
+                                         MouseEvent,
+                                         TouchEvent,
+                                         GamepadEvent,
+                                         WindowEvent,
+                                         SystemEvent,
+                                         UIEvent,
+                                         AnimationEvent,
+                                         SoundEvent,
+                                         UpdateEvent,
+                                         UserEvent>;
+
         EventDispatcher() = default;
         ~EventDispatcher();
 
@@ -35,16 +48,27 @@ namespace ouzel
         // posts the event for dispatching on the game thread
         std::future<bool> postEvent(std::unique_ptr<Event> event);
 
+        // posts the event for dispatching on the game thread without a result, does not allocate
+        // or lock once the pool has grown, the events of both calls are dispatched in the order they were posted
+        void queueEvent(QueuedEvent event);
+
         // dispatches all queued events on the game thread
         void dispatchEvents();
 
     private:
+        bool dispatch(const Event& event);
+
+        struct PostedEvent final
+        {
+            std::promise<bool> promise;
+            std::unique_ptr<Event> event;
+        };
+
         std::vector<EventHandler*> eventHandlers;
         std::set<EventHandler*> eventHandlerAddSet;
         std::set<EventHandler*> eventHandlerDeleteSet;
 
-        std::mutex eventQueueMutex;
-        std::queue<std::pair<std::promise<bool>, std::unique_ptr<Event>>> eventQueue;
+        EventQueue<std::variant<QueuedEvent, PostedEvent>> eventQueue;
     };
 }
 
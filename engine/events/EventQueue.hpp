@@ -0,0 +1,136 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_EVENTS_EVENTQUEUE_HPP
+#define OUZEL_EVENTS_EVENTQUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace ouzel
+{
+    // Unbounded multi-producer single-consumer queue (intrusive Vyukov queue).
+    // Nodes are recycled through a lock-free free list, so pushing only takes
+    // a lock when the pool has to grow.
+    template <class T>
+    class EventQueue final
+    {
+    public:
+        EventQueue() = default;
+
+        ~EventQueue()
+        {
+            for (auto& chunk : chunks)
+                delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        EventQueue(EventQueue&&) = delete;
+        EventQueue& operator=(EventQueue&&) = delete;
+
+        // can be called from any thread
+        void push(T value)
+        {
+            Node* node = allocateNode();
+            node->value = std::move(value);
+            node->next.store(nullptr, std::memory_order_relaxed);
+
+            Node* previous = head.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        // must be called only from the consumer thread
+        bool pop(T& value)
+        {
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (!next) return false; // empty or a producer is between the exchange and the link
+
+            value = std::move(next->value);
+
+            // the popped node becomes the new stub and the old stub is recycled
+            Node* previous = tail;
+            tail = next;
+            if (previous != &stub) freeNode(previous);
+
+            return true;
+        }
+
+    private:
+        static constexpr std::uint32_t chunkSize = 256;
+        static constexpr std::uint32_t maxChunks = 4096;
+
+        struct Node final
+        {
+            T value;
+            std::atomic<Node*> next{nullptr};
+            std::atomic<std::uint32_t> nextFree{0}; // index + 1 of the next free node, 0 for none
+            std::uint32_t index = 0;
+        };
+
+        Node* getNode(std::uint32_t index) const noexcept
+        {
+            return &chunks[index / chunkSize].load(std::memory_order_acquire)[index % chunkSize];
+        }
+
+        // the free list head holds a tag in the upper 32 bits to prevent the ABA problem
+        Node* allocateNode()
+        {
+            auto oldHead = freeHead.load(std::memory_order_acquire);
+            while (static_cast<std::uint32_t>(oldHead) != 0)
+            {
+                Node* node = getNode(static_cast<std::uint32_t>(oldHead) - 1);
+                const auto newHead = (((oldHead >> 32) + 1) << 32) |
+                    node->nextFree.load(std::memory_order_relaxed);
+
+                if (freeHead.compare_exchange_weak(oldHead, newHead,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire))
+                    return node;
+            }
+
+            std::lock_guard lock(growMutex);
+
+            if (nodeCount % chunkSize == 0)
+            {
+                if (nodeCount / chunkSize >= maxChunks)
+                    throw std::runtime_error("Event queue is full");
+
+                chunks[nodeCount / chunkSize].store(new Node[chunkSize], std::memory_order_release);
+            }
+
+            Node* node = getNode(nodeCount);
+            node->index = nodeCount++;
+            return node;
+        }
+
+        void freeNode(Node* node) noexcept
+        {
+            auto oldHead = freeHead.load(std::memory_order_relaxed);
+            std::uint64_t newHead;
+            do
+            {
+                node->nextFree.store(static_cast<std::uint32_t>(oldHead), std::memory_order_relaxed);
+                newHead = (((oldHead >> 32) + 1) << 32) | (node->index + 1);
+            }
+            while (!freeHead.compare_exchange_weak(oldHead, newHead,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed));
+        }
+
+        Node stub;
+        std::atomic<Node*> head{&stub};
+        Node* tail = &stub;
+
+        std::atomic<std::uint64_t> freeHead{0};
+        std::array<std::atomic<Node*>, maxChunks> chunks{};
+        std::mutex growMutex;
+        std::uint32_t nodeCount = 0;
+    };
+}
+
+#endif // OUZEL_EVENTS_EVENTQUEUE_HPP
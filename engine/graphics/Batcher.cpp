@@ -0,0 +1,106 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <limits>
+#include <stdexcept>
+#include "Batcher.hpp"
+#include "Graphics.hpp"
+
+namespace ouzel::graphics
+{
+    namespace
+    {
+        constexpr std::size_t maxBatchVertices = std::numeric_limits<std::uint16_t>::max() + 1U;
+    }
+
+    Batcher::Batcher(Graphics& initGraphics):
+        graphics(initGraphics)
+    {
+    }
+
+    void Batcher::draw(const State& newState,
+                       const Matrix4F& newViewProjection,
+                       const Matrix4F& transform,
+                       const std::vector<Vertex>& newVertices,
+                       const std::vector<std::uint16_t>& newIndices)
+    {
+        if (newVertices.size() > maxBatchVertices)
+            throw std::runtime_error("Too many vertices");
+
+        if (pending)
+        {
+            if (state != newState || viewProjection != newViewProjection)
+            {
+                ++frameStateBreakCount;
+                flush();
+            }
+            else if (vertices.size() + newVertices.size() > maxBatchVertices)
+                flush();
+        }
+
+        if (!pending)
+        {
+            state = newState;
+            viewProjection = newViewProjection;
+            pending = true;
+        }
+
+        const auto baseVertex = static_cast<std::uint16_t>(vertices.size());
+        for (const auto index : newIndices)
+            indices.push_back(static_cast<std::uint16_t>(baseVertex + index));
+
+        for (const auto& vertex : newVertices)
+        {
+            Vertex& batchVertex = vertices.emplace_back(vertex);
+            transform.transformPoint(batchVertex.position);
+        }
+
+        ++frameDrawCount;
+    }
+
+    void Batcher::flush()
+    {
+        if (!pending) return;
+
+        // commands issued below must not flush the batch again
+        pending = false;
+
+        if (currentBuffers >= buffers.size())
+            buffers.push_back(BatchBuffers{
+                Buffer(graphics, BufferType::index, Flags::dynamic),
+                Buffer(graphics, BufferType::vertex, Flags::dynamic)
+            });
+
+        BatchBuffers& batchBuffers = buffers[currentBuffers++];
+        batchBuffers.indexBuffer.setData(indices.data(), static_cast<std::uint32_t>(indices.size() * sizeof(std::uint16_t)));
+        batchBuffers.vertexBuffer.setData(vertices.data(), static_cast<std::uint32_t>(vertices.size() * sizeof(Vertex)));
+
+        graphics.setPipelineState(state.blendState,
+                                  state.shader,
+                                  state.cullMode,
+                                  state.fillMode);
+        graphics.setShaderConstants({state.color}, {viewProjection.m});
+        graphics.addCommand<SetTexturesCommand>(state.textures);
+        graphics.draw(batchBuffers.indexBuffer.getResource(),
+                      static_cast<std::uint32_t>(indices.size()),
+                      sizeof(std::uint16_t),
+                      batchBuffers.vertexBuffer.getResource(),
+                      DrawMode::triangleList,
+                      0);
+
+        indices.clear();
+        vertices.clear();
+        ++frameBatchCount;
+    }
+
+    void Batcher::finishFrame()
+    {
+        drawCount = frameDrawCount;
+        batchCount = frameBatchCount;
+        stateBreakCount = frameStateBreakCount;
+
+        frameDrawCount = 0;
+        frameBatchCount = 0;
+        frameStateBreakCount = 0;
+        currentBuffers = 0;
+    }
+}
@@ -0,0 +1,108 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GRAPHICS_BATCHER_HPP
+#define OUZEL_GRAPHICS_BATCHER_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "Buffer.hpp"
+#include "Commands.hpp"
+#include "RasterizerState.hpp"
+#include "Vertex.hpp"
+#include "../math/Matrix.hpp"
+
+namespace ouzel::graphics
+{
+    class Graphics;
+
+    // Merges consecutive draws with the same pipeline state, textures, color and
+    // view projection into a single draw from a dynamic vertex and index buffer.
+    // The shader must take a color fragment constant and a model view projection
+    // vertex constant (like the texture and color shaders), because the model
+    // transform is baked into the vertices. The color stays a shader constant,
+    // because baking it into the 8-bit vertex colors would lose precision.
+    class Batcher final
+    {
+    public:
+        using Textures = std::array<std::size_t, SetTexturesCommand::maxTextures>;
+
+        struct State final
+        {
+            std::size_t blendState = 0;
+            std::size_t shader = 0;
+            CullMode cullMode = CullMode::none;
+            FillMode fillMode = FillMode::solid;
+            Textures textures{};
+            std::array<float, 4> color{1.0F, 1.0F, 1.0F, 1.0F};
+
+            bool operator==(const State& other) const noexcept
+            {
+                return blendState == other.blendState &&
+                    shader == other.shader &&
+                    cullMode == other.cullMode &&
+                    fillMode == other.fillMode &&
+                    textures == other.textures &&
+                    color == other.color;
+            }
+
+            bool operator!=(const State& other) const noexcept
+            {
+                return !(*this == other);
+            }
+        };
+
+        explicit Batcher(Graphics& initGraphics);
+
+        Batcher(const Batcher&) = delete;
+        Batcher& operator=(const Batcher&) = delete;
+
+        Batcher(Batcher&&) = delete;
+        Batcher& operator=(Batcher&&) = delete;
+
+        void draw(const State& state,
+                  const Matrix4F& viewProjection,
+                  const Matrix4F& transform,
+                  const std::vector<Vertex>& vertices,
+                  const std::vector<std::uint16_t>& indices);
+
+        auto isPending() const noexcept { return pending; }
+        void flush();
+
+        // called after the frame is presented
+        void finishFrame();
+
+        // statistics of the last presented frame
+        auto getDrawCount() const noexcept { return drawCount; }
+        auto getBatchCount() const noexcept { return batchCount; }
+        auto getStateBreakCount() const noexcept { return stateBreakCount; }
+
+    private:
+        struct BatchBuffers final
+        {
+            Buffer indexBuffer;
+            Buffer vertexBuffer;
+        };
+
+        Graphics& graphics;
+
+        bool pending = false;
+        State state;
+        Matrix4F viewProjection;
+        std::vector<Vertex> vertices;
+        std::vector<std::uint16_t> indices;
+
+        std::vector<BatchBuffers> buffers;
+        std::size_t currentBuffers = 0;
+
+        std::uint32_t frameDrawCount = 0;
+        std::uint32_t frameBatchCount = 0;
+        std::uint32_t frameStateBreakCount = 0;
+
+        std::uint32_t drawCount = 0;
+        std::uint32_t batchCount = 0;
+        std::uint32_t stateBreakCount = 0;
+    };
+}
+
+#endif // OUZEL_GRAPHICS_BATCHER_HPP
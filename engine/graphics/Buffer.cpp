@@ -22,11 +22,11 @@ namespace ouzel::graphics
         flags(initFlags),
         size(initSize)
     {
-        initGraphics.addCommand(std::make_unique<InitBufferCommand>(resource,
-                                                                    initType,
-                                                                    initFlags,
-                                                                    std::vector<std::uint8_t>(),
-                                                                    initSize));
+        initGraphics.addCommand<InitBufferCommand>(resource,
+                                                   initType,
+                                                   initFlags,
+                                                   std::vector<std::uint8_t>(),
+                                                   initSize);
     }
 
     Buffer::Buffer(Graphics& initGraphics,
@@ -40,12 +40,12 @@ namespace ouzel::graphics
         flags(initFlags),
         size(initSize)
     {
-        initGraphics.addCommand(std::make_unique<InitBufferCommand>(resource,
-                                                                    initType,
-                                                                    initFlags,
-                                                                    std::vector<std::uint8_t>(static_cast<const std::uint8_t*>(initData),
-                                                                                              static_cast<const std::uint8_t*>(initData) + initSize),
-                                                                    initSize));
+        initGraphics.addCommand<InitBufferCommand>(resource,
+                                                   initType,
+                                                   initFlags,
+                                                   std::vector<std::uint8_t>(static_cast<const std::uint8_t*>(initData),
+                                                                             static_cast<const std::uint8_t*>(initData) + initSize),
+                                                   initSize);
     }
 
     Buffer::Buffer(Graphics& initGraphics,
@@ -62,19 +62,19 @@ namespace ouzel::graphics
         if (!initData.empty() && initSize != initData.size())
             throw std::runtime_error("Invalid buffer data");
 
-        initGraphics.addCommand(std::make_unique<InitBufferCommand>(resource,
-                                                                    initType,
-                                                                    initFlags,
-                                                                    initData,
-                                                                    initSize));
+        initGraphics.addCommand<InitBufferCommand>(resource,
+                                                   initType,
+                                                   initFlags,
+                                                   initData,
+                                                   initSize);
     }
 
     void Buffer::setData(const void* newData, std::uint32_t newSize)
     {
         if (resource)
-            graphics->addCommand(std::make_unique<SetBufferDataCommand>(resource,
-                                                                        std::vector<std::uint8_t>(static_cast<const std::uint8_t*>(newData),
-                                                                                                  static_cast<const std::uint8_t*>(newData) + newSize)));
+            graphics->addCommand<SetBufferDataCommand>(resource,
+                                                       std::vector<std::uint8_t>(static_cast<const std::uint8_t*>(newData),
+                                                                                 static_cast<const std::uint8_t*>(newData) + newSize));
     }
 
     void Buffer::setData(const std::vector<std::uint8_t>& newData)
@@ -88,6 +88,6 @@ namespace ouzel::graphics
         if (newData.size() > size) size = static_cast<std::uint32_t>(newData.size());
 
         if (resource)
-            graphics->addCommand(std::make_unique<SetBufferDataCommand>(resource, newData));
+            graphics->addCommand<SetBufferDataCommand>(resource, newData);
     }
 }
@@ -3,8 +3,15 @@
 #ifndef OUZEL_GRAPHICS_COMMANDS_HPP
 #define OUZEL_GRAPHICS_COMMANDS_HPP
 
-#include <queue>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <vector>
 #include "BlendFactor.hpp"
 #include "BlendOperation.hpp"
 #include "BufferType.hpp"
@@ -71,8 +78,6 @@ namespace ouzel::graphics
         {
         }
 
-        virtual ~Command() = default;
-
         const Type type;
     };
 
@@ -418,16 +423,24 @@ namespace ouzel::graphics
     class SetShaderConstantsCommand final: public Command
     {
     public:
-        SetShaderConstantsCommand(std::vector<std::vector<float>> initFragmentShaderConstants,
-                                  std::vector<std::vector<float>> initVertexShaderConstants) noexcept(false):
+        // range of the command buffer's constant data
+        struct Block final
+        {
+            std::uint32_t offset = 0; // in floats
+            std::uint32_t constantCount = 0;
+            std::uint32_t size = 0; // in floats
+        };
+
+        constexpr SetShaderConstantsCommand(const Block& initFragmentShaderConstants,
+                                            const Block& initVertexShaderConstants) noexcept:
             Command(Command::Type::setShaderConstants),
             fragmentShaderConstants(initFragmentShaderConstants),
             vertexShaderConstants(initVertexShaderConstants)
         {
         }
 
-        const std::vector<std::vector<float>> fragmentShaderConstants;
-        const std::vector<std::vector<float>> vertexShaderConstants;
+        const Block fragmentShaderConstants;
+        const Block vertexShaderConstants;
     };
 
     class InitTextureCommand final: public Command
@@ -523,48 +536,225 @@ namespace ouzel::graphics
     class SetTexturesCommand final: public Command
     {
     public:
+        static constexpr std::size_t maxTextures = 4;
+
         explicit SetTexturesCommand(const std::vector<ResourceId>& initTextures) noexcept(false):
+            Command(Command::Type::setTextures)
+        {
+            if (initTextures.size() > maxTextures)
+                throw std::runtime_error("Too many textures");
+
+            for (std::size_t i = 0; i < initTextures.size(); ++i)
+                textures[i] = initTextures[i];
+        }
+
+        explicit constexpr SetTexturesCommand(const std::array<ResourceId, maxTextures>& initTextures) noexcept:
             Command(Command::Type::setTextures),
             textures(initTextures)
         {
         }
 
-        const std::vector<ResourceId> textures;
+        std::array<ResourceId, maxTextures> textures{};
     };
 
+    // Linear command stream. Commands are constructed in place in large blocks
+    // which are kept between frames, so recording a frame does not allocate
+    // once the blocks have grown to the frame's size.
     class CommandBuffer final
     {
     public:
+        static constexpr std::size_t blockSize = 64U * 1024U;
+
         CommandBuffer() = default;
         explicit CommandBuffer(const std::string& initName) noexcept(false):
             name(initName)
         {
         }
 
+        ~CommandBuffer()
+        {
+            destroyCommands();
+        }
+
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        CommandBuffer(CommandBuffer&& other) noexcept:
+            name(std::move(other.name)),
+            blocks(std::move(other.blocks)),
+            writeBlock(other.writeBlock),
+            commandCount(other.commandCount),
+            readBlock(other.readBlock),
+            readOffset(other.readOffset),
+            readCount(other.readCount),
+            constants(std::move(other.constants)),
+            allocationCount(other.allocationCount)
+        {
+            other.blocks.clear();
+            other.constants.clear();
+            other.rewind();
+        }
+
+        CommandBuffer& operator=(CommandBuffer&& other) noexcept
+        {
+            if (&other == this) return *this;
+
+            destroyCommands();
+
+            name = std::move(other.name);
+            blocks = std::move(other.blocks);
+            writeBlock = other.writeBlock;
+            commandCount = other.commandCount;
+            readBlock = other.readBlock;
+            readOffset = other.readOffset;
+            readCount = other.readCount;
+            constants = std::move(other.constants);
+            allocationCount = other.allocationCount;
+
+            other.blocks.clear();
+            other.constants.clear();
+            other.rewind();
+
+            return *this;
+        }
+
         auto& getName() const noexcept { return name; }
 
-        auto isEmpty() const noexcept { return commands.empty(); }
+        auto isEmpty() const noexcept { return readCount == commandCount; }
+        auto getCommandCount() const noexcept { return commandCount; }
+
+        // number of blocks allocated since the last reset
+        auto getAllocationCount() const noexcept { return allocationCount; }
+
+        template <class T, class ...Args>
+        void pushCommand(Args&&... args)
+        {
+            static_assert(std::is_base_of_v<Command, T>);
+            static_assert(alignof(T) <= alignment);
+
+            constexpr auto entrySize = headerSize + alignSize(sizeof(T));
+            auto& block = reserve(entrySize);
+            auto entry = block.data.get() + block.size;
 
-        void pushCommand(std::unique_ptr<Command> command)
+            auto command = new (entry + headerSize) T(std::forward<Args>(args)...);
+            new (entry) Header{command, std::is_trivially_destructible_v<T> ? nullptr : &destroy<T>, entrySize};
+
+            block.size += entrySize;
+            ++commandCount;
+        }
+
+        const Command* popCommand() noexcept
         {
-            commands.push(std::move(command));
+            while (readOffset == blocks[readBlock].size)
+            {
+                ++readBlock;
+                readOffset = 0;
+            }
+
+            auto header = std::launder(reinterpret_cast<const Header*>(blocks[readBlock].data.get() + readOffset));
+            readOffset += header->size;
+            ++readCount;
+            return header->command;
         }
 
-        std::unique_ptr<Command> popCommand()
+        // appends shader constant values to the frame's staging memory and returns their offset
+        std::uint32_t pushConstants(const float* data, std::uint32_t size)
         {
-            auto result = std::move(commands.front());
-            commands.pop();
-            return result;
+            const auto offset = static_cast<std::uint32_t>(constants.size());
+            if (constants.size() + size > constants.capacity()) ++allocationCount;
+            constants.insert(constants.end(), data, data + size);
+            return offset;
         }
 
-        auto& getCommands() const
+        auto getConstantCount() const noexcept { return static_cast<std::uint32_t>(constants.size()); }
+        const float* getConstants(std::uint32_t offset) const noexcept { return constants.data() + offset; }
+
+        // destroys all of the commands but keeps the memory for the next frame
+        void reset() noexcept
         {
-            return commands;
+            destroyCommands();
+            for (auto& block : blocks) block.size = 0;
+            constants.clear();
+            rewind();
         }
 
     private:
+        static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+        static constexpr std::size_t alignSize(std::size_t size) noexcept
+        {
+            return (size + alignment - 1) & ~(alignment - 1);
+        }
+
+        struct Header final
+        {
+            Command* command;
+            void (*destructor)(Command*) noexcept;
+            std::size_t size;
+        };
+
+        static constexpr std::size_t headerSize = (sizeof(Header) + alignment - 1) & ~(alignment - 1);
+
+        struct Block final
+        {
+            explicit Block(std::size_t initCapacity):
+                data(new std::byte[initCapacity]), capacity(initCapacity)
+            {
+            }
+
+            std::unique_ptr<std::byte[]> data;
+            std::size_t capacity = 0;
+            std::size_t size = 0;
+        };
+
+        template <class T>
+        static void destroy(Command* command) noexcept
+        {
+            static_cast<T*>(command)->~T();
+        }
+
+        Block& reserve(std::size_t size)
+        {
+            for (; writeBlock < blocks.size(); ++writeBlock)
+                if (blocks[writeBlock].capacity - blocks[writeBlock].size >= size)
+                    return blocks[writeBlock];
+
+            blocks.emplace_back(size > blockSize ? size : blockSize);
+            ++allocationCount;
+            writeBlock = blocks.size() - 1;
+            return blocks.back();
+        }
+
+        void destroyCommands() noexcept
+        {
+            for (auto& block : blocks)
+                for (std::size_t offset = 0; offset < block.size;)
+                {
+                    auto header = std::launder(reinterpret_cast<Header*>(block.data.get() + offset));
+                    if (header->destructor) header->destructor(header->command);
+                    offset += header->size;
+                }
+        }
+
+        void rewind() noexcept
+        {
+            writeBlock = 0;
+            commandCount = 0;
+            readBlock = 0;
+            readOffset = 0;
+            readCount = 0;
+            allocationCount = 0;
+        }
+
         std::string name;
-        std::queue<std::unique_ptr<Command>> commands;
+        std::vector<Block> blocks;
+        std::size_t writeBlock = 0;
+        std::size_t commandCount = 0;
+        std::size_t readBlock = 0;
+        std::size_t readOffset = 0;
+        std::size_t readCount = 0;
+        std::vector<float> constants;
+        std::uint32_t allocationCount = 0;
     };
 }
 
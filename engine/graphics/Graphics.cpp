@@ -159,8 +159,6 @@ namespace ouzel::graphics
         if (event.type == RenderDevice::Event::Type::frame)
         {
             std::unique_lock lock(frameMutex);
-            newFrame = true;
-            refillQueue = true;
             lock.unlock();
             frameCondition.notify_all();
         }
@@ -170,7 +168,7 @@ namespace ouzel::graphics
     {
         size = newSize;
 
-        addCommand(std::make_unique<ResizeCommand>(newSize));
+        addCommand<ResizeCommand>(newSize);
     }
 
     void Graphics::saveScreenshot(const std::string& filename)
@@ -180,7 +178,7 @@ namespace ouzel::graphics
 
     void Graphics::setRenderTarget(std::size_t renderTarget)
     {
-        addCommand(std::make_unique<SetRenderTargetCommand>(renderTarget));
+        addCommand<SetRenderTargetCommand>(renderTarget);
     }
 
     void Graphics::clearRenderTarget(bool clearColorBuffer,
@@ -190,29 +188,29 @@ namespace ouzel::graphics
                                      float clearDepth,
                                      std::uint32_t clearStencil)
     {
-        addCommand(std::make_unique<ClearRenderTargetCommand>(clearColorBuffer,
-                                                              clearDepthBuffer,
-                                                              clearStencilBuffer,
-                                                              clearColor,
-                                                              clearDepth,
-                                                              clearStencil));
+        addCommand<ClearRenderTargetCommand>(clearColorBuffer,
+                                             clearDepthBuffer,
+                                             clearStencilBuffer,
+                                             clearColor,
+                                             clearDepth,
+                                             clearStencil);
     }
 
     void Graphics::setScissorTest(bool enabled, const RectF& rectangle)
     {
-        addCommand(std::make_unique<SetScissorTestCommand>(enabled, rectangle));
+        addCommand<SetScissorTestCommand>(enabled, rectangle);
     }
 
     void Graphics::setViewport(const RectF& viewport)
     {
-        addCommand(std::make_unique<SetViewportCommand>(viewport));
+        addCommand<SetViewportCommand>(viewport);
     }
 
     void Graphics::setDepthStencilState(std::size_t depthStencilState,
                                         std::uint32_t stencilReferenceValue)
     {
-        addCommand(std::make_unique<SetDepthStencilStateCommand>(depthStencilState,
-                                                                 stencilReferenceValue));
+        addCommand<SetDepthStencilStateCommand>(depthStencilState,
+                                                stencilReferenceValue);
     }
 
     void Graphics::setPipelineState(std::size_t blendState,
@@ -220,10 +218,10 @@ namespace ouzel::graphics
                                     CullMode cullMode,
                                     FillMode fillMode)
     {
-        addCommand(std::make_unique<SetPipelineStateCommand>(blendState,
-                                                             shader,
-                                                             cullMode,
-                                                             fillMode));
+        addCommand<SetPipelineStateCommand>(blendState,
+                                            shader,
+                                            cullMode,
+                                            fillMode);
     }
 
     void Graphics::draw(std::size_t indexBuffer,
@@ -236,38 +234,62 @@ namespace ouzel::graphics
         if (!indexBuffer || !vertexBuffer)
             throw std::runtime_error("Invalid mesh buffer passed to render queue");
 
-        addCommand(std::make_unique<DrawCommand>(indexBuffer,
-                                                 indexCount,
-                                                 indexSize,
-                                                 vertexBuffer,
-                                                 drawMode,
-                                                 startIndex));
+        addCommand<DrawCommand>(indexBuffer,
+                                indexCount,
+                                indexSize,
+                                vertexBuffer,
+                                drawMode,
+                                startIndex);
     }
 
-    void Graphics::setShaderConstants(const std::vector<std::vector<float>>& fragmentShaderConstants,
-                                      const std::vector<std::vector<float>>& vertexShaderConstants)
+    namespace
+    {
+        SetShaderConstantsCommand::Block pushConstants(CommandBuffer& commandBuffer,
+                                                       std::initializer_list<Graphics::ShaderConstant> constants)
+        {
+            SetShaderConstantsCommand::Block block;
+            block.offset = commandBuffer.getConstantCount();
+            block.constantCount = static_cast<std::uint32_t>(constants.size());
+
+            for (const auto& constant : constants)
+            {
+                commandBuffer.pushConstants(constant.data, constant.size);
+                block.size += constant.size;
+            }
+
+            return block;
+        }
+    }
+
+    void Graphics::setShaderConstants(std::initializer_list<ShaderConstant> fragmentShaderConstants,
+                                      std::initializer_list<ShaderConstant> vertexShaderConstants)
     {
-        addCommand(std::make_unique<SetShaderConstantsCommand>(fragmentShaderConstants,
-                                                               vertexShaderConstants));
+        const auto fragmentShaderBlock = pushConstants(commandBuffer, fragmentShaderConstants);
+        const auto vertexShaderBlock = pushConstants(commandBuffer, vertexShaderConstants);
+
+        addCommand<SetShaderConstantsCommand>(fragmentShaderBlock,
+                                              vertexShaderBlock);
     }
 
     void Graphics::setTextures(const std::vector<std::size_t>& textures)
     {
-        addCommand(std::make_unique<SetTexturesCommand>(textures));
+        if (textures.size() > SetTexturesCommand::maxTextures)
+            throw std::runtime_error("Too many textures");
+
+        addCommand<SetTexturesCommand>(textures);
     }
 
     void Graphics::present()
     {
-        refillQueue = false;
-        addCommand(std::make_unique<PresentCommand>());
-        device->submitCommandBuffer(std::move(commandBuffer));
-        commandBuffer = CommandBuffer();
+        addCommand<PresentCommand>();
+        batcher.finishFrame();
+        commandAllocationCount = commandBuffer.getAllocationCount();
+        device->submitCommandBuffer(commandBuffer);
     }
 
     void Graphics::waitForNextFrame()
     {
         std::unique_lock lock(frameMutex);
-        while (!newFrame) frameCondition.wait(lock);
-        newFrame = false;
+        while (!device->canSubmitFrame()) frameCondition.wait(lock);
     }
 }
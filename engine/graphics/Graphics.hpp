@@ -3,14 +3,17 @@
 #ifndef OUZEL_GRAPHICS_GRAPHICS_HPP
 #define OUZEL_GRAPHICS_GRAPHICS_HPP
 
+#include <array>
 #include <cstdint>
 #include <functional>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <vector>
 #include <queue>
 #include <set>
 #include <atomic>
+#include "Batcher.hpp"
 #include "Commands.hpp"
 #include "Driver.hpp"
 #include "RenderDevice.hpp"
@@ -27,6 +30,31 @@ namespace ouzel::graphics
     {
         friend core::Window;
     public:
+        // view of the values of a single shader constant
+        class ShaderConstant final
+        {
+        public:
+            template <std::size_t n>
+            constexpr ShaderConstant(const float (&initData)[n]) noexcept:
+                data(initData), size(static_cast<std::uint32_t>(n))
+            {
+            }
+
+            template <std::size_t n>
+            constexpr ShaderConstant(const std::array<float, n>& initData) noexcept:
+                data(initData.data()), size(static_cast<std::uint32_t>(n))
+            {
+            }
+
+            constexpr ShaderConstant(const float* initData, std::uint32_t initSize) noexcept:
+                data(initData), size(initSize)
+            {
+            }
+
+            const float* data;
+            std::uint32_t size;
+        };
+
         Graphics(Driver driver,
                  core::Window& initWindow,
                  const Settings& settings);
@@ -64,18 +92,27 @@ namespace ouzel::graphics
                   std::size_t vertexBuffer,
                   DrawMode drawMode,
                   std::uint32_t startIndex);
-        void setShaderConstants(const std::vector<std::vector<float>>& fragmentShaderConstants,
-                                const std::vector<std::vector<float>>& vertexShaderConstants);
+        void setShaderConstants(std::initializer_list<ShaderConstant> fragmentShaderConstants,
+                                std::initializer_list<ShaderConstant> vertexShaderConstants);
         void setTextures(const std::vector<std::size_t>& textures);
 
-        void addCommand(std::unique_ptr<Command> command)
+        template <class T, class ...Args>
+        void addCommand(Args&&... args)
         {
-            commandBuffer.pushCommand(std::move(command));
+            // any other command ends the pending batch
+            if (batcher.isPending()) batcher.flush();
+            commandBuffer.pushCommand<T>(std::forward<Args>(args)...);
         }
         void present();
 
+        auto& getBatcher() noexcept { return batcher; }
+
+        // number of command stream block allocations during the last recorded frame
+        auto getCommandAllocationCount() const noexcept { return commandAllocationCount; }
+
+        // waits until the render thread frees a slot for the next frame
         void waitForNextFrame();
-        bool getRefillQueue() const noexcept { return refillQueue; }
+        bool getRefillQueue() const noexcept { return device->canSubmitFrame(); }
 
         Vector2F convertScreenToNormalizedLocation(const Vector2F& position)
         {
@@ -98,14 +135,14 @@ namespace ouzel::graphics
 
         Size2U size;
         CommandBuffer commandBuffer;
+        std::uint32_t commandAllocationCount = 0;
 
-        bool newFrame = false;
         std::mutex frameMutex;
         std::condition_variable frameCondition;
-        std::atomic_bool refillQueue{true};
 
         std::unique_ptr<RenderDevice> device;
         renderer::Renderer renderer;
+        Batcher batcher{*this};
     };
 }
 
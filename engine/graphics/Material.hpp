@@ -25,6 +25,20 @@ namespace ouzel::graphics
         Material(Material&&) = delete;
         Material& operator=(Material&&) = delete;
 
+        // folds the render state into 16 bits for sorting draws by state
+        std::uint16_t getStateKey() const noexcept
+        {
+            std::size_t key = static_cast<std::size_t>(cullMode);
+            key = key * 31U + (blendState ? blendState->getResource() : 0);
+            key = key * 31U + (shader ? shader->getResource() : 0);
+            for (const auto& texture : textures)
+                key = key * 31U + (texture ? texture->getResource() : 0);
+
+            return static_cast<std::uint16_t>(key ^ (key >> 16));
+        }
+
+        auto isBlended() const noexcept { return blendState && blendState->isBlendingEnabled(); }
+
         const BlendState* blendState = nullptr;
         const Shader* shader = nullptr;
         std::shared_ptr<Texture> textures[textureLayers];
@@ -1,6 +1,8 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
 #include <algorithm>
+#include <stdexcept>
+#include <thread>
 #include "RenderDevice.hpp"
 
 namespace ouzel::graphics
@@ -24,12 +26,23 @@ namespace ouzel::graphics
         clampToBorderSupported(false),
         multisamplingSupported(false),
         uintIndicesSupported(false),
+        framesInFlight(settings.framesInFlight),
         previousFrameTime(std::chrono::steady_clock::now())
     {
+        if (framesInFlight < 1 || framesInFlight > Settings::maxFramesInFlight)
+            throw std::runtime_error("Invalid frames in flight count");
     }
 
     void RenderDevice::process()
     {
+        // release the slot of the previous frame
+        if (renderCommandBuffer)
+        {
+            renderCommandBuffer->reset();
+            renderCommandBuffer = nullptr;
+            completedFrames.fetch_add(1, std::memory_order_release);
+        }
+
         Event event;
         event.type = Event::Type::frame;
         callback(event);
@@ -54,6 +67,68 @@ namespace ouzel::graphics
         }
     }
 
+    void RenderDevice::submitCommandBuffer(CommandBuffer& commandBuffer)
+    {
+        const auto frame = submittedFrames.load(std::memory_order_relaxed);
+
+        // the caller should check canSubmitFrame, but wait for a free slot if it did not
+        while (frame - completedFrames.load(std::memory_order_acquire) >= framesInFlight)
+            std::this_thread::yield();
+
+        const auto slot = static_cast<std::size_t>(frame % framesInFlight);
+        std::swap(frameCommandBuffers[slot], commandBuffer);
+        frameSubmitTimes[slot] = std::chrono::steady_clock::now();
+
+        submittedFrames.store(frame + 1);
+
+        if (renderThreadWaiting.load())
+        {
+            std::unique_lock lock(frameMutex);
+            lock.unlock();
+            frameCondition.notify_all();
+        }
+    }
+
+    bool RenderDevice::waitForCommandBuffer()
+    {
+        if (submittedFrames.load(std::memory_order_acquire) == acquiredFrames)
+        {
+            std::unique_lock lock(frameMutex);
+            renderThreadWaiting = true;
+            while (submittedFrames.load() == acquiredFrames && !processingInterrupted)
+                frameCondition.wait(lock);
+            renderThreadWaiting = false;
+
+            // the wait consumes the interruption, so that it does not end the next wait early
+            if (processingInterrupted.exchange(false) &&
+                submittedFrames.load() == acquiredFrames)
+                return false;
+        }
+        else
+        {
+            // an interruption that came while the render thread was not waiting is consumed by this frame
+            processingInterrupted = false;
+        }
+
+        const auto slot = static_cast<std::size_t>(acquiredFrames % framesInFlight);
+        ++acquiredFrames;
+
+        const auto latency = std::chrono::steady_clock::now() - frameSubmitTimes[slot];
+        handoffLatency.store(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(),
+                             std::memory_order_relaxed);
+
+        renderCommandBuffer = &frameCommandBuffers[slot];
+        return true;
+    }
+
+    void RenderDevice::interruptProcessing()
+    {
+        std::unique_lock lock(frameMutex);
+        processingInterrupted = true;
+        lock.unlock();
+        frameCondition.notify_all();
+    }
+
     std::vector<Size2U> RenderDevice::getSupportedResolutions() const
     {
         return std::vector<Size2U>();
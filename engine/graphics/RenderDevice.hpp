@@ -5,6 +5,7 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -93,12 +94,29 @@ namespace ouzel::graphics
 
         virtual std::vector<Size2U> getSupportedResolutions() const;
 
-        void submitCommandBuffer(CommandBuffer&& commandBuffer)
+        // Hands the recorded command buffer over to the render thread and
+        // replaces it with the (reset) buffer of a completed frame.
+        // Must be called only from the thread that records the frames.
+        void submitCommandBuffer(CommandBuffer& commandBuffer);
+
+        // true if there is a free slot for a new frame
+        bool canSubmitFrame() const noexcept
         {
-            std::unique_lock lock(commandQueueMutex);
-            commandQueue.push(std::move(commandBuffer));
-            lock.unlock();
-            commandQueueCondition.notify_all();
+            return submittedFrames.load(std::memory_order_relaxed) -
+                completedFrames.load(std::memory_order_acquire) < framesInFlight;
+        }
+
+        auto getMaxFramesInFlight() const noexcept { return framesInFlight; }
+        auto getFramesInFlight() const noexcept
+        {
+            return static_cast<std::uint32_t>(submittedFrames.load(std::memory_order_relaxed) -
+                                              completedFrames.load(std::memory_order_relaxed));
+        }
+
+        // time between the submission of the last frame and the start of its execution
+        auto getHandoffLatency() const noexcept
+        {
+            return std::chrono::nanoseconds(handoffLatency.load(std::memory_order_relaxed));
         }
 
         auto getDrawCallCount() const noexcept { return drawCallCount; }
@@ -168,6 +186,12 @@ namespace ouzel::graphics
     protected:
         void executeAll();
 
+        // waits for the next submitted frame, returns false if interrupted
+        bool waitForCommandBuffer();
+
+        // wakes up the render thread waiting in waitForCommandBuffer, the interruption is consumed by the next wait
+        void interruptProcessing();
+
         virtual void generateScreenshot(const std::string& filename);
 
         Driver driver;
@@ -197,9 +221,21 @@ namespace ouzel::graphics
 
         std::uint32_t drawCallCount = 0;
 
-        std::queue<CommandBuffer> commandQueue;
-        std::mutex commandQueueMutex;
-        std::condition_variable commandQueueCondition;
+        // single-producer single-consumer ring of frames
+        std::uint32_t framesInFlight = 2;
+        std::array<CommandBuffer, Settings::maxFramesInFlight> frameCommandBuffers;
+        std::array<std::chrono::steady_clock::time_point, Settings::maxFramesInFlight> frameSubmitTimes;
+        std::atomic<std::uint64_t> submittedFrames{0};
+        std::atomic<std::uint64_t> completedFrames{0};
+        std::uint64_t acquiredFrames = 0; // accessed only by the render thread
+        CommandBuffer* renderCommandBuffer = nullptr;
+        std::atomic<std::chrono::nanoseconds::rep> handoffLatency{0};
+
+        // used only when the render thread runs out of frames
+        std::mutex frameMutex;
+        std::condition_variable frameCondition;
+        std::atomic_bool renderThreadWaiting{false};
+        std::atomic_bool processingInterrupted{false};
 
         std::atomic<float> currentFPS{0.0F};
         std::chrono::steady_clock::time_point previousFrameTime;
@@ -10,6 +10,8 @@ namespace ouzel::graphics
 {
     struct Settings final
     {
+        static constexpr std::uint32_t maxFramesInFlight = 3;
+
         std::uint32_t sampleCount = 1;
         SamplerFilter textureFilter = SamplerFilter::point;
         std::uint32_t maxAnisotropy = 1;
@@ -18,6 +20,7 @@ namespace ouzel::graphics
         bool depth = false;
         bool stencil = false;
         bool debugRenderer = false;
+        std::uint32_t framesInFlight = 2;
     };
 }
 
@@ -21,13 +21,13 @@ namespace ouzel::graphics
         resource(*initGraphics.getDevice()),
         vertexAttributes(initVertexAttributes)
     {
-        initGraphics.addCommand(std::make_unique<InitShaderCommand>(resource,
-                                                                    initFragmentShader,
-                                                                    initVertexShader,
-                                                                    initVertexAttributes,
-                                                                    initFragmentShaderConstantInfo,
-                                                                    initVertexShaderConstantInfo,
-                                                                    fragmentShaderFunction,
-                                                                    vertexShaderFunction));
+        initGraphics.addCommand<InitShaderCommand>(resource,
+                                                   initFragmentShader,
+                                                   initVertexShader,
+                                                   initVertexAttributes,
+                                                   initFragmentShaderConstantInfo,
+                                                   initVertexShaderConstantInfo,
+                                                   fragmentShaderFunction,
+                                                   vertexShaderFunction);
     }
 }
@@ -43,6 +43,13 @@ namespace ouzel::graphics
                 Flags initFlags = Flags::none,
                 PixelFormat initPixelFormat = PixelFormat::rgba8UnsignedNorm);
 
+        // the image and its mip levels (all of them if mipmaps is 0) for the constructor that takes the levels,
+        // it does not use the graphics, so that it can be called on any thread
+        static std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> generateLevels(const Size2U& size,
+                                                                                        const std::vector<std::uint8_t>& data,
+                                                                                        std::uint32_t mipmaps,
+                                                                                        PixelFormat pixelFormat);
+
         auto& getResource() const noexcept { return resource; }
 
         auto& getSize() const noexcept { return size; }
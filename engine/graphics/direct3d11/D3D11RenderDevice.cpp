@@ -301,9 +301,7 @@ namespace ouzel::graphics::d3d11
     RenderDevice::~RenderDevice()
     {
         running = false;
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (renderThread.isJoinable()) renderThread.join();
     }
@@ -321,8 +319,6 @@ namespace ouzel::graphics::d3d11
         graphics::RenderDevice::process();
         executeAll();
 
-        std::vector<float> shaderData;
-
         std::uint32_t fillModeIndex = 0;
         std::uint32_t scissorEnableIndex = 0;
         std::uint32_t cullModeIndex = 0;
@@ -332,26 +328,21 @@ namespace ouzel::graphics::d3d11
         std::vector<ID3D11ShaderResourceView*> currentResourceViews;
         std::vector<ID3D11SamplerState*> currentSamplerStates;
 
-        CommandBuffer commandBuffer;
-        std::unique_ptr<Command> command;
+        const Command* command;
 
         for (;;)
         {
-            std::unique_lock lock(commandQueueMutex);
-            while (commandQueue.empty()) commandQueueCondition.wait(lock);
-            commandBuffer = std::move(commandQueue.front());
-            commandQueue.pop();
-            lock.unlock();
+            if (!waitForCommandBuffer()) return;
 
-            while (!commandBuffer.isEmpty())
+            while (!renderCommandBuffer->isEmpty())
             {
-                command = commandBuffer.popCommand();
+                command = renderCommandBuffer->popCommand();
 
                 switch (command->type)
                 {
                     case Command::Type::resize:
                     {
-                        auto resizeCommand = static_cast<const ResizeCommand*>(command.get());
+                        auto resizeCommand = static_cast<const ResizeCommand*>(command);
                         resizeBackBuffer(static_cast<UINT>(resizeCommand->size.v[0]),
                                             static_cast<UINT>(resizeCommand->size.v[1]));
                         break;
@@ -368,14 +359,14 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::deleteResource:
                     {
-                        auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
+                        auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
                         resources[deleteResourceCommand->resource - 1].reset();
                         break;
                     }
 
                     case Command::Type::initRenderTarget:
                     {
-                        auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command.get());
+                        auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command);
 
                         std::set<Texture*> colorTextures;
                         for (const auto colorTextureId : initRenderTargetCommand->colorTextures)
@@ -393,7 +384,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setRenderTarget:
                     {
-                        auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                        auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                         if (currentRenderTarget)
                             currentRenderTarget->resolve();
@@ -417,7 +408,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::clearRenderTarget:
                     {
-                        auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                        auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                         FLOAT frameBufferClearColor[4]{clearCommand->clearColor.normR(),
                             clearCommand->clearColor.normG(),
@@ -454,7 +445,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setScissorTest:
                     {
-                        auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                        auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                         if (setScissorTestCommand->enabled)
                         {
@@ -476,7 +467,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setViewport:
                     {
-                        auto setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                        auto setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                         D3D11_VIEWPORT viewport;
                         viewport.MinDepth = 0.0F;
@@ -492,7 +483,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initDepthStencilState:
                     {
-                        auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                        auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                         auto depthStencilState = std::make_unique<DepthStencilState>(*this,
                                                                                         initDepthStencilStateCommand->depthTest,
                                                                                         initDepthStencilStateCommand->depthWrite,
@@ -517,7 +508,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setDepthStencilState:
                     {
-                        auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                        auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                         if (setDepthStencilStateCommand->depthStencilState)
                         {
@@ -534,7 +525,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setPipelineState:
                     {
-                        auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                        auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
                         auto blendState = getResource<BlendState>(setPipelineStateCommand->blendState);
                         auto shader = getResource<Shader>(setPipelineStateCommand->shader);
@@ -584,7 +575,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::draw:
                     {
-                        auto drawCommand = static_cast<const DrawCommand*>(command.get());
+                        auto drawCommand = static_cast<const DrawCommand*>(command);
 
                         // draw mesh buffer
                         auto indexBuffer = getResource<Buffer>(drawCommand->indexBuffer);
@@ -614,7 +605,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initBlendState:
                     {
-                        auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                        auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                         auto blendState = std::make_unique<BlendState>(*this,
                                                                         initBlendStateCommand->enableBlending,
@@ -634,7 +625,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initBuffer:
                     {
-                        auto initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                        auto initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                         auto buffer = std::make_unique<Buffer>(*this,
                                                                 initBufferCommand->bufferType,
@@ -650,7 +641,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setBufferData:
                     {
-                        auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                        auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
                         auto buffer = getResource<Buffer>(setBufferDataCommand->buffer);
                         buffer->setData(setBufferDataCommand->data);
@@ -659,7 +650,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initShader:
                     {
-                        auto initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                        auto initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                         auto shader = std::make_unique<Shader>(*this,
                                                                 initShaderCommand->fragmentShader,
@@ -678,7 +669,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setShaderConstants:
                     {
-                        auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                        auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                         if (!currentShader)
                             throw std::runtime_error("No shader set");
@@ -686,25 +677,23 @@ namespace ouzel::graphics::d3d11
                         // pixel shader constants
                         const std::vector<Shader::Location>& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
 
-                        if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
-                            throw std::runtime_error("Invalid pixel shader constant size");
+                        const auto& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
 
-                        shaderData.clear();
+                        if (fragmentShaderConstants.constantCount > fragmentShaderConstantLocations.size())
+                            throw std::runtime_error("Invalid pixel shader constant size");
 
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
-                        {
-                            const Shader::Location& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                            const std::vector<float>& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
+                        std::uint32_t fragmentShaderDataSize = 0;
+                        for (std::size_t i = 0; i < fragmentShaderConstants.constantCount; ++i)
+                            fragmentShaderDataSize += fragmentShaderConstantLocations[i].size;
 
-                            if (sizeof(float) * fragmentShaderConstant.size() != fragmentShaderConstantLocation.size)
-                                throw std::runtime_error("Invalid pixel shader constant size");
+                        if (fragmentShaderDataSize != sizeof(float) * fragmentShaderConstants.size)
+                            throw std::runtime_error("Invalid pixel shader constant size");
 
-                            shaderData.insert(shaderData.end(), fragmentShaderConstant.begin(), fragmentShaderConstant.end());
-                        }
+                        const float* fragmentShaderData = renderCommandBuffer->getConstants(fragmentShaderConstants.offset);
 
                         uploadBuffer(currentShader->getFragmentShaderConstantBuffer().get(),
-                                        shaderData.data(),
-                                        static_cast<std::uint32_t>(sizeof(float) * shaderData.size()));
+                                     fragmentShaderData,
+                                     fragmentShaderDataSize);
 
                         ID3D11Buffer* fragmentShaderConstantBuffers[1] = {currentShader->getFragmentShaderConstantBuffer().get()};
                         context->PSSetConstantBuffers(0, 1, fragmentShaderConstantBuffers);
@@ -712,25 +701,23 @@ namespace ouzel::graphics::d3d11
                         // vertex shader constants
                         const std::vector<Shader::Location>& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
 
-                        if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
-                            throw std::runtime_error("Invalid vertex shader constant size");
+                        const auto& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
 
-                        shaderData.clear();
+                        if (vertexShaderConstants.constantCount > vertexShaderConstantLocations.size())
+                            throw std::runtime_error("Invalid vertex shader constant size");
 
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
-                        {
-                            const Shader::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                            const std::vector<float>& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
+                        std::uint32_t vertexShaderDataSize = 0;
+                        for (std::size_t i = 0; i < vertexShaderConstants.constantCount; ++i)
+                            vertexShaderDataSize += vertexShaderConstantLocations[i].size;
 
-                            if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
-                                throw std::runtime_error("Invalid vertex shader constant size");
+                        if (vertexShaderDataSize != sizeof(float) * vertexShaderConstants.size)
+                            throw std::runtime_error("Invalid vertex shader constant size");
 
-                            shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
-                        }
+                        const float* vertexShaderData = renderCommandBuffer->getConstants(vertexShaderConstants.offset);
 
                         uploadBuffer(currentShader->getVertexShaderConstantBuffer().get(),
-                                        shaderData.data(),
-                                        static_cast<std::uint32_t>(sizeof(float) * shaderData.size()));
+                                     vertexShaderData,
+                                     vertexShaderDataSize);
 
                         ID3D11Buffer* vertexShaderConstantBuffers[1] = {currentShader->getVertexShaderConstantBuffer().get()};
                         context->VSSetConstantBuffers(0, 1, vertexShaderConstantBuffers);
@@ -740,7 +727,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::initTexture:
                     {
-                        auto initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                        auto initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                         auto texture = std::make_unique<Texture>(*this,
                                                                     initTextureCommand->levels,
@@ -759,7 +746,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setTextureData:
                     {
-                        auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                        auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
                         auto texture = getResource<Texture>(setTextureDataCommand->texture);
                         texture->setData(setTextureDataCommand->levels);
@@ -769,7 +756,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setTextureParameters:
                     {
-                        auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                        auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
                         auto texture = getResource<Texture>(setTextureParametersCommand->texture);
                         texture->setFilter(setTextureParametersCommand->filter);
@@ -783,7 +770,7 @@ namespace ouzel::graphics::d3d11
 
                     case Command::Type::setTextures:
                     {
-                        auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                        auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                         currentResourceViews.clear();
                         currentSamplerStates.clear();
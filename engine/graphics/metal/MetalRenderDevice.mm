@@ -249,7 +249,6 @@ namespace ouzel::graphics::metal
         MTLRenderPassDescriptorPtr currentRenderPassDescriptor = nil;
         id<MTLRenderCommandEncoder> currentRenderCommandEncoder = nil;
         PipelineStateDesc currentPipelineStateDesc;
-        std::vector<float> shaderData;
 
         if (++shaderConstantBufferIndex >= bufferCount) shaderConstantBufferIndex = 0;
         ShaderConstantBuffer& shaderConstantBuffer = shaderConstantBuffers[shaderConstantBufferIndex];
@@ -258,26 +257,21 @@ namespace ouzel::graphics::metal
         const RenderTarget* currentRenderTarget = nullptr;
         const Shader* currentShader = nullptr;
 
-        CommandBuffer commandBuffer;
-        std::unique_ptr<Command> command;
+        const Command* command;
 
         for (;;)
         {
-            std::unique_lock lock(commandQueueMutex);
-            while (commandQueue.empty()) commandQueueCondition.wait(lock);
-            commandBuffer = std::move(commandQueue.front());
-            commandQueue.pop();
-            lock.unlock();
+            if (!waitForCommandBuffer()) return;
 
-            while (!commandBuffer.isEmpty())
+            while (!renderCommandBuffer->isEmpty())
             {
-                command = commandBuffer.popCommand();
+                command = renderCommandBuffer->popCommand();
 
                 switch (command->type)
                 {
                     case Command::Type::resize:
                     {
-                        auto resizeCommand = static_cast<const ResizeCommand*>(command.get());
+                        auto resizeCommand = static_cast<const ResizeCommand*>(command);
                         const CGSize drawableSize = CGSizeMake(resizeCommand->size.v[0],
                                                                resizeCommand->size.v[1]);
                         metalLayer.drawableSize = drawableSize;
@@ -299,14 +293,14 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::deleteResource:
                     {
-                        auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
+                        auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
                         resources[deleteResourceCommand->resource - 1].reset();
                         break;
                     }
 
                     case Command::Type::initRenderTarget:
                     {
-                        auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command.get());
+                        auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command);
 
                         std::set<Texture*> colorTextures;
                         for (const auto colorTextureId : initRenderTargetCommand->colorTextures)
@@ -324,7 +318,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setRenderTarget:
                     {
-                        auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                        auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                         MTLRenderPassDescriptorPtr newRenderPassDescriptor;
 
@@ -370,7 +364,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::clearRenderTarget:
                     {
-                        auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                        auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                         if (currentRenderCommandEncoder)
                             [currentRenderCommandEncoder endEncoding];
@@ -406,7 +400,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setScissorTest:
                     {
-                        auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                        auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                         // create a new render command encoder to set up a new scissor rect
                         if (currentRenderCommandEncoder)
@@ -428,7 +422,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setViewport:
                     {
-                        auto setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                        auto setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error("Metal render command encoder not initialized");
@@ -448,7 +442,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::initDepthStencilState:
                     {
-                        auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                        auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                         auto depthStencilState = std::make_unique<DepthStencilState>(*this,
                                                                                      initDepthStencilStateCommand->depthTest,
                                                                                      initDepthStencilStateCommand->depthWrite,
@@ -474,7 +468,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setDepthStencilState:
                     {
-                        auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                        auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error("Metal render command encoder not initialized");
@@ -495,7 +489,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setPipelineState:
                     {
-                        auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                        auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error("Metal render command encoder not initialized");
@@ -518,7 +512,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::draw:
                     {
-                        auto drawCommand = static_cast<const DrawCommand*>(command.get());
+                        auto drawCommand = static_cast<const DrawCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error("Metal render command encoder not initialized");
@@ -550,7 +544,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::initBlendState:
                     {
-                        auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                        auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                         auto blendState = std::make_unique<BlendState>(*this,
                                                                        initBlendStateCommand->enableBlending,
@@ -570,7 +564,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::initBuffer:
                     {
-                        auto initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                        auto initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                         auto buffer = std::make_unique<Buffer>(*this,
                                                                 initBufferCommand->bufferType,
@@ -586,7 +580,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setBufferData:
                     {
-                        auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                        auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
                         auto buffer = getResource<Buffer>(setBufferDataCommand->buffer);
                         buffer->setData(setBufferDataCommand->data);
@@ -595,7 +589,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::initShader:
                     {
-                        auto initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                        auto initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                         auto shader = std::make_unique<Shader>(*this,
                                                                initShaderCommand->fragmentShader,
@@ -614,7 +608,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setShaderConstants:
                     {
-                        auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                        auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error("Metal render command encoder not initialized");
@@ -625,26 +619,24 @@ namespace ouzel::graphics::metal
                         // pixel shader constants
                         const std::vector<Shader::Location>& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
 
-                        if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
-                            throw Error("Invalid pixel shader constant size");
+                        const auto& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
 
-                        shaderData.clear();
+                        if (fragmentShaderConstants.constantCount > fragmentShaderConstantLocations.size())
+                            throw Error("Invalid pixel shader constant size");
 
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
-                        {
-                            const Shader::Location& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                            const std::vector<float>& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
+                        std::uint32_t fragmentShaderDataSize = 0;
+                        for (std::size_t i = 0; i < fragmentShaderConstants.constantCount; ++i)
+                            fragmentShaderDataSize += fragmentShaderConstantLocations[i].size;
 
-                            if (sizeof(float) * fragmentShaderConstant.size() != fragmentShaderConstantLocation.size)
-                                throw Error("Invalid pixel shader constant size");
+                        if (fragmentShaderDataSize != sizeof(float) * fragmentShaderConstants.size)
+                            throw Error("Invalid pixel shader constant size");
 
-                            shaderData.insert(shaderData.end(), fragmentShaderConstant.begin(), fragmentShaderConstant.end());
-                        }
+                        const float* fragmentShaderData = renderCommandBuffer->getConstants(fragmentShaderConstants.offset);
 
                         shaderConstantBuffer.offset = ((shaderConstantBuffer.offset + currentShader->getFragmentShaderAlignment() - 1) /
                                                        currentShader->getFragmentShaderAlignment()) * currentShader->getFragmentShaderAlignment(); // round up to nearest aligned pointer
 
-                        if (shaderConstantBuffer.offset + getVectorSize(shaderData) > bufferSize)
+                        if (shaderConstantBuffer.offset + fragmentShaderDataSize > bufferSize)
                         {
                             ++shaderConstantBuffer.index;
                             shaderConstantBuffer.offset = 0;
@@ -663,39 +655,37 @@ namespace ouzel::graphics::metal
 
                         MTLBufferPtr currentBuffer = shaderConstantBuffer.buffers[shaderConstantBuffer.index].get();
 
-                        std::copy(reinterpret_cast<const char*>(shaderData.data()),
-                                  reinterpret_cast<const char*>(shaderData.data()) + sizeof(float) * shaderData.size(),
+                        std::copy(reinterpret_cast<const char*>(fragmentShaderData),
+                                  reinterpret_cast<const char*>(fragmentShaderData) + fragmentShaderDataSize,
                                   static_cast<char*>([currentBuffer contents]) + shaderConstantBuffer.offset);
 
                         [currentRenderCommandEncoder setFragmentBuffer:currentBuffer
                                                                 offset:shaderConstantBuffer.offset
                                                                atIndex:1];
 
-                        shaderConstantBuffer.offset += static_cast<std::uint32_t>(getVectorSize(shaderData));
+                        shaderConstantBuffer.offset += fragmentShaderDataSize;
 
                         // vertex shader constants
                         const std::vector<Shader::Location>& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
 
-                        if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
-                            throw Error("Invalid vertex shader constant size");
+                        const auto& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
 
-                        shaderData.clear();
+                        if (vertexShaderConstants.constantCount > vertexShaderConstantLocations.size())
+                            throw Error("Invalid vertex shader constant size");
 
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
-                        {
-                            const Shader::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                            const std::vector<float>& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
+                        std::uint32_t vertexShaderDataSize = 0;
+                        for (std::size_t i = 0; i < vertexShaderConstants.constantCount; ++i)
+                            vertexShaderDataSize += vertexShaderConstantLocations[i].size;
 
-                            if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
-                                throw Error("Invalid vertex shader constant size");
+                        if (vertexShaderDataSize != sizeof(float) * vertexShaderConstants.size)
+                            throw Error("Invalid vertex shader constant size");
 
-                            shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
-                        }
+                        const float* vertexShaderData = renderCommandBuffer->getConstants(vertexShaderConstants.offset);
 
                         shaderConstantBuffer.offset = ((shaderConstantBuffer.offset + currentShader->getVertexShaderAlignment() - 1) /
                                                        currentShader->getVertexShaderAlignment()) * currentShader->getVertexShaderAlignment(); // round up to nearest aligned pointer
 
-                        if (shaderConstantBuffer.offset + getVectorSize(shaderData) > bufferSize)
+                        if (shaderConstantBuffer.offset + vertexShaderDataSize > bufferSize)
                         {
                             ++shaderConstantBuffer.index;
                             shaderConstantBuffer.offset = 0;
@@ -714,22 +704,22 @@ namespace ouzel::graphics::metal
 
                         currentBuffer = shaderConstantBuffer.buffers[shaderConstantBuffer.index].get();
 
-                        std::copy(reinterpret_cast<const char*>(shaderData.data()),
-                                  reinterpret_cast<const char*>(shaderData.data()) + sizeof(float) * shaderData.size(),
+                        std::copy(reinterpret_cast<const char*>(vertexShaderData),
+                                  reinterpret_cast<const char*>(vertexShaderData) + vertexShaderDataSize,
                                   static_cast<char*>([currentBuffer contents]) + shaderConstantBuffer.offset);
 
                         [currentRenderCommandEncoder setVertexBuffer:currentBuffer
                                                               offset:shaderConstantBuffer.offset
                                                              atIndex:1];
 
-                        shaderConstantBuffer.offset += static_cast<std::uint32_t>(getVectorSize(shaderData));
+                        shaderConstantBuffer.offset += vertexShaderDataSize;
 
                         break;
                     }
 
                     case Command::Type::initTexture:
                     {
-                        auto initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                        auto initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                         auto texture = std::make_unique<Texture>(*this,
                                                                  initTextureCommand->levels,
@@ -748,7 +738,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setTextureData:
                     {
-                        auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                        auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
                         auto texture = getResource<Texture>(setTextureDataCommand->texture);
                         texture->setData(setTextureDataCommand->levels);
@@ -758,7 +748,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setTextureParameters:
                     {
-                        auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                        auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
                         auto texture = getResource<Texture>(setTextureParametersCommand->texture);
                         texture->setFilter(setTextureParametersCommand->filter);
@@ -772,7 +762,7 @@ namespace ouzel::graphics::metal
 
                     case Command::Type::setTextures:
                     {
-                        auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                        auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                         if (!currentRenderCommandEncoder)
                             throw Error("Metal render command encoder not initialized");
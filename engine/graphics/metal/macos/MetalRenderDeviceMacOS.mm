@@ -80,9 +80,7 @@ namespace ouzel::graphics::metal::macos
     RenderDevice::~RenderDevice()
     {
         running = false;
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (displayLink)
         {
@@ -118,9 +116,7 @@ namespace ouzel::graphics::metal::macos
             engine->executeOnMainThread([this, event]() {
                 running = false;
 
-                CommandBuffer commandBuffer;
-                commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-                submitCommandBuffer(std::move(commandBuffer));
+                interruptProcessing();
 
                 if (displayLink)
                 {
@@ -727,28 +727,23 @@ namespace ouzel::graphics::opengl
         executeAll();
 
         const RenderTarget* currentRenderTarget = nullptr;
-        const Shader* currentShader = nullptr;
+        Shader* currentShader = nullptr;
 
-        CommandBuffer commandBuffer;
-        std::unique_ptr<Command> command;
+        const Command* command;
 
         for (;;)
         {
-            std::unique_lock lock(commandQueueMutex);
-            while (commandQueue.empty()) commandQueueCondition.wait(lock);
-            commandBuffer = std::move(commandQueue.front());
-            commandQueue.pop();
-            lock.unlock();
+            if (!waitForCommandBuffer()) return;
 
-            while (!commandBuffer.isEmpty())
+            while (!renderCommandBuffer->isEmpty())
             {
-                command = commandBuffer.popCommand();
+                command = renderCommandBuffer->popCommand();
 
                 switch (command->type)
                 {
                     case Command::Type::resize:
                     {
-                        auto resizeCommand = static_cast<const ResizeCommand*>(command.get());
+                        auto resizeCommand = static_cast<const ResizeCommand*>(command);
                         frameBufferWidth = static_cast<GLsizei>(resizeCommand->size.v[0]);
                         frameBufferHeight = static_cast<GLsizei>(resizeCommand->size.v[1]);
                         resizeFrameBuffer();
@@ -763,14 +758,14 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::deleteResource:
                     {
-                        auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
+                        auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
                         resources[deleteResourceCommand->resource - 1].reset();
                         break;
                     }
 
                     case Command::Type::initRenderTarget:
                     {
-                        auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command.get());
+                        auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command);
 
                         std::set<Texture*> colorTextures;
                         for (const auto colorTextureId : initRenderTargetCommand->colorTextures)
@@ -788,7 +783,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setRenderTarget:
                     {
-                        auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                        auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                         if (setRenderTargetCommand->renderTarget)
                         {
@@ -809,7 +804,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::clearRenderTarget:
                     {
-                        auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                        auto clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                         const GLbitfield clearMask = (clearCommand->clearColorBuffer ? GL_COLOR_BUFFER_BIT : 0) |
                             (clearCommand->clearDepthBuffer ? GL_DEPTH_BUFFER_BIT : 0 |
@@ -863,7 +858,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setScissorTest:
                     {
-                        auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                        auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                         setScissorTest(setScissorTestCommand->enabled,
                                        static_cast<GLint>(setScissorTestCommand->rectangle.position.v[0]),
@@ -876,7 +871,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setViewport:
                     {
-                        auto setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                        auto setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                         setViewport(static_cast<GLint>(setViewportCommand->viewport.position.v[0]),
                                     static_cast<GLint>(setViewportCommand->viewport.position.v[1]),
@@ -888,7 +883,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::initDepthStencilState:
                     {
-                        auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                        auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                         auto depthStencilState = std::make_unique<DepthStencilState>(*this,
                                                                                      initDepthStencilStateCommand->depthTest,
                                                                                      initDepthStencilStateCommand->depthWrite,
@@ -913,7 +908,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setDepthStencilState:
                     {
-                        auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                        auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                         if (setDepthStencilStateCommand->depthStencilState)
                         {
@@ -958,7 +953,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setPipelineState:
                     {
-                        auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                        auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
                         auto blendState = getResource<BlendState>(setPipelineStateCommand->blendState);
                         auto shader = getResource<Shader>(setPipelineStateCommand->shader);
@@ -1008,7 +1003,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::draw:
                     {
-                        auto drawCommand = static_cast<const DrawCommand*>(command.get());
+                        auto drawCommand = static_cast<const DrawCommand*>(command);
 
                         // mesh buffer
                         auto indexBuffer = getResource<Buffer>(drawCommand->indexBuffer);
@@ -1063,7 +1058,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::initBlendState:
                     {
-                        auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                        auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                         auto blendState = std::make_unique<BlendState>(*this,
                                                                        initBlendStateCommand->enableBlending,
@@ -1083,7 +1078,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::initBuffer:
                     {
-                        auto initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                        auto initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                         auto buffer = std::make_unique<Buffer>(*this,
                                                                initBufferCommand->bufferType,
@@ -1099,7 +1094,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setBufferData:
                     {
-                        auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                        auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
                         auto buffer = getResource<Buffer>(setBufferDataCommand->buffer);
                         buffer->setData(setBufferDataCommand->data);
@@ -1108,7 +1103,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::initShader:
                     {
-                        auto initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                        auto initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                         auto shader = std::make_unique<Shader>(*this,
                                                                initShaderCommand->fragmentShader,
@@ -1127,49 +1122,94 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setShaderConstants:
                     {
-                        auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                        auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                         if (!currentShader)
                             throw Error("No shader set");
 
                         // pixel shader constants
-                        const std::vector<Shader::Location>& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
+                        std::vector<Shader::Location>& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
+                        const auto& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
 
-                        if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
+                        if (fragmentShaderConstants.constantCount > fragmentShaderConstantLocations.size())
                             throw Error("Invalid pixel shader constant size");
 
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
+                        const float* fragmentShaderData = renderCommandBuffer->getConstants(fragmentShaderConstants.offset);
+                        std::uint32_t fragmentShaderDataOffset = 0;
+
+                        for (std::size_t i = 0; i < fragmentShaderConstants.constantCount; ++i)
                         {
-                            const auto& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                            const auto& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
+                            auto& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
+                            const auto size = static_cast<std::uint32_t>(fragmentShaderConstantLocation.value.size());
+
+                            if (fragmentShaderDataOffset + size > fragmentShaderConstants.size)
+                                throw Error("Invalid pixel shader constant size");
+
+                            const float* fragmentShaderConstant = fragmentShaderData + fragmentShaderDataOffset;
+                            fragmentShaderDataOffset += size;
+
+                            // skip the upload if the program already has this value
+                            if (fragmentShaderConstantLocation.uploaded &&
+                                std::equal(fragmentShaderConstant, fragmentShaderConstant + size,
+                                           fragmentShaderConstantLocation.value.begin()))
+                                continue;
 
                             setUniform(fragmentShaderConstantLocation.location,
                                        fragmentShaderConstantLocation.dataType,
-                                       fragmentShaderConstant.data());
+                                       fragmentShaderConstant);
+
+                            std::copy(fragmentShaderConstant, fragmentShaderConstant + size,
+                                      fragmentShaderConstantLocation.value.begin());
+                            fragmentShaderConstantLocation.uploaded = true;
                         }
 
+                        if (fragmentShaderDataOffset != fragmentShaderConstants.size)
+                            throw Error("Invalid pixel shader constant size");
+
                         // vertex shader constants
-                        const std::vector<Shader::Location>& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
+                        std::vector<Shader::Location>& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
+                        const auto& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
 
-                        if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                        if (vertexShaderConstants.constantCount > vertexShaderConstantLocations.size())
                             throw Error("Invalid vertex shader constant size");
 
-                        for (std::size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
+                        const float* vertexShaderData = renderCommandBuffer->getConstants(vertexShaderConstants.offset);
+                        std::uint32_t vertexShaderDataOffset = 0;
+
+                        for (std::size_t i = 0; i < vertexShaderConstants.constantCount; ++i)
                         {
-                            const auto& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                            const auto& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
+                            auto& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
+                            const auto size = static_cast<std::uint32_t>(vertexShaderConstantLocation.value.size());
+
+                            if (vertexShaderDataOffset + size > vertexShaderConstants.size)
+                                throw Error("Invalid vertex shader constant size");
+
+                            const float* vertexShaderConstant = vertexShaderData + vertexShaderDataOffset;
+                            vertexShaderDataOffset += size;
+
+                            if (vertexShaderConstantLocation.uploaded &&
+                                std::equal(vertexShaderConstant, vertexShaderConstant + size,
+                                           vertexShaderConstantLocation.value.begin()))
+                                continue;
 
                             setUniform(vertexShaderConstantLocation.location,
                                        vertexShaderConstantLocation.dataType,
-                                       vertexShaderConstant.data());
+                                       vertexShaderConstant);
+
+                            std::copy(vertexShaderConstant, vertexShaderConstant + size,
+                                      vertexShaderConstantLocation.value.begin());
+                            vertexShaderConstantLocation.uploaded = true;
                         }
 
+                        if (vertexShaderDataOffset != vertexShaderConstants.size)
+                            throw Error("Invalid vertex shader constant size");
+
                         break;
                     }
 
                     case Command::Type::initTexture:
                     {
-                        auto initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                        auto initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                         auto texture = std::make_unique<Texture>(*this,
                                                                  initTextureCommand->levels,
@@ -1188,7 +1228,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setTextureData:
                     {
-                        auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                        auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
                         auto texture = getResource<Texture>(setTextureDataCommand->texture);
                         texture->setData(setTextureDataCommand->levels);
@@ -1198,7 +1238,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setTextureParameters:
                     {
-                        auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                        auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
                         auto texture = getResource<Texture>(setTextureParametersCommand->texture);
                         texture->setFilter(setTextureParametersCommand->filter);
@@ -1211,7 +1251,7 @@ namespace ouzel::graphics::opengl
 
                     case Command::Type::setTextures:
                     {
-                        auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                        auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                         for (std::uint32_t layer = 0; layer < setTexturesCommand->textures.size(); ++layer)
                         {
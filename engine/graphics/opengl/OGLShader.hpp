@@ -47,18 +47,23 @@ namespace ouzel::graphics::opengl
         struct Location final
         {
             Location(GLint initLocation, DataType initDataType):
-                location(initLocation), dataType(initDataType)
+                location(initLocation), dataType(initDataType),
+                value(getDataTypeSize(initDataType) / sizeof(float))
             {
             }
 
             GLint location;
             DataType dataType;
+            std::vector<float> value; // last uploaded value
+            bool uploaded = false;
         };
 
         auto& getVertexAttributes() const noexcept { return vertexAttributes; }
 
         auto& getFragmentShaderConstantLocations() const noexcept { return fragmentShaderConstantLocations; }
+        auto& getFragmentShaderConstantLocations() noexcept { return fragmentShaderConstantLocations; }
         auto& getVertexShaderConstantLocations() const noexcept { return vertexShaderConstantLocations; }
+        auto& getVertexShaderConstantLocations() noexcept { return vertexShaderConstantLocations; }
 
         auto getProgramId() const noexcept { return programId; }
 
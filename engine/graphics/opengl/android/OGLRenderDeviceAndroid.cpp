@@ -184,9 +184,7 @@ namespace ouzel::graphics::opengl::android
     RenderDevice::~RenderDevice()
     {
         running = false;
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (renderThread.isJoinable()) renderThread.join();
 
@@ -208,9 +206,7 @@ namespace ouzel::graphics::opengl::android
     void RenderDevice::reload()
     {
         running = false;
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (renderThread.isJoinable()) renderThread.join();
 
@@ -336,9 +332,7 @@ namespace ouzel::graphics::opengl::android
     void RenderDevice::destroy()
     {
         running = false;
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (renderThread.isJoinable()) renderThread.join();
 
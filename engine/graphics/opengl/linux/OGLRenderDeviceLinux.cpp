@@ -169,9 +169,7 @@ namespace ouzel::graphics::opengl::linux
     RenderDevice::~RenderDevice()
     {
         running = false;
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (renderThread.isJoinable()) renderThread.join();
 
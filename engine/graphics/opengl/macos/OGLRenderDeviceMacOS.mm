@@ -132,9 +132,7 @@ namespace ouzel::graphics::opengl::macos
     RenderDevice::~RenderDevice()
     {
         running = false;
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (displayLink)
         {
@@ -87,9 +87,7 @@ namespace ouzel::graphics::opengl::tvos
     RenderDevice::~RenderDevice()
     {
         displayLink.stop();
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (msaaColorRenderBufferId) glDeleteRenderbuffersProc(1, &msaaColorRenderBufferId);
         if (msaaFrameBufferId) glDeleteFramebuffersProc(1, &msaaFrameBufferId);
@@ -311,9 +311,7 @@ namespace ouzel::graphics::opengl::windows
     RenderDevice::~RenderDevice()
     {
         running = false;
-        CommandBuffer commandBuffer;
-        commandBuffer.pushCommand(std::make_unique<PresentCommand>());
-        submitCommandBuffer(std::move(commandBuffer));
+        interruptProcessing();
 
         if (renderThread.isJoinable()) renderThread.join();
 
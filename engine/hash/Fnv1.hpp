@@ -4,6 +4,7 @@
 #define OUZEL_HASH_FNV1_HPP
 
 #include <cstdint>
+#include <string_view>
 
 namespace ouzel::hash::fnv1
 {
@@ -30,6 +31,17 @@ namespace ouzel::hash::fnv1
     {
         return (i < sizeof(Value)) ? hash<Result>(value, i + 1, (result * Constants<Result>::prime) ^ ((value >> (i * 8)) & 0xFF)) : result;
     }
+
+    template <typename Result>
+    constexpr Result hashString(const std::string_view str) noexcept
+    {
+        Result result = Constants<Result>::offsetBasis;
+
+        for (const char c : str)
+            result = (result * Constants<Result>::prime) ^ static_cast<std::uint8_t>(c);
+
+        return result;
+    }
 }
 
 #endif // OUZEL_HASH_FNV1_HPP
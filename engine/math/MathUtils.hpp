@@ -3,10 +3,12 @@
 #ifndef OUZEL_MATH_MATHUTILS_HPP
 #define OUZEL_MATH_MATHUTILS_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <cmath>
 #include <limits>
 #include <type_traits>
+#include "Constants.hpp"
 #if defined(__ANDROID__)
 #  include <cpu-features.h>
 #endif
@@ -41,6 +43,30 @@ namespace ouzel
         return x * T(57.2957795130823208767);
     }
 
+    // wraps the angle in radians to [-pi, pi], the angle must be less than 2^31 turns
+    inline float wrapAngle(const float angle) noexcept
+    {
+        const float turns = angle / tau<float>;
+        return angle - tau<float> * static_cast<float>(static_cast<std::int32_t>(turns + std::copysign(0.5F, turns)));
+    }
+
+    // sine and cosine of an angle in [-pi, pi] with errors under 2e-7, from the Taylor series on [0, pi / 2];
+    // it does not branch, so that the loops calling it can be vectorized, unlike std::sin and std::cos
+    inline void fastSinCos(const float angle, float& sine, float& cosine) noexcept
+    {
+        const float absAngle = std::fabs(angle);
+        const float x = std::min(absAngle, pi<float> - absAngle);
+        const float x2 = x * x;
+
+        const float sinX = x * (1.0F + x2 * (-1.0F / 6.0F + x2 * (1.0F / 120.0F + x2 * (-1.0F / 5040.0F +
+            x2 * (1.0F / 362880.0F - x2 * (1.0F / 39916800.0F))))));
+        sine = std::copysign(sinX, angle);
+
+        const float cosX = 1.0F + x2 * (-0.5F + x2 * (1.0F / 24.0F + x2 * (-1.0F / 720.0F +
+            x2 * (1.0F / 40320.0F + x2 * (-1.0F / 3628800.0F + x2 * (1.0F / 479001600.0F))))));
+        cosine = std::copysign(cosX, pi<float> / 2.0F - absAngle);
+    }
+
     template <typename T>
     constexpr auto isNearlyEqual(const T a, const T b,
                                  const T tolerance = std::numeric_limits<T>::min()) noexcept
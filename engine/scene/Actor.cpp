@@ -120,6 +120,7 @@ namespace ouzel::scene
         {
             if (entered) actor->leave();
             actor->parent = nullptr;
+            actor->setLayer(nullptr);
         }
 
         children.clear();
@@ -245,7 +246,7 @@ namespace ouzel::scene
             component->setActor(nullptr);
     }
 
-    void Actor::visit(std::vector<Actor*>& drawQueue,
+    void Actor::visit(DrawQueue& drawQueue,
                       const Matrix4F& newParentTransform,
                       bool parentTransformDirty,
                       Camera* camera,
@@ -255,21 +256,31 @@ namespace ouzel::scene
         worldOrder = parentOrder + order;
         worldHidden = parentHidden || hidden;
 
-        if (parentTransformDirty) updateTransform(newParentTransform);
-        if (transformDirty) calculateTransform();
+        // with a transform store the world transforms are updated by the layer before the visit
+        if (!transformStore)
+        {
+            if (parentTransformDirty) updateTransform(newParentTransform);
+            if (transformDirty) calculateTransform();
+        }
 
         if (!worldHidden)
         {
             const auto boundingBox = getBoundingBox();
 
-            if (cullDisabled || (!boundingBox.isEmpty() && camera->checkVisibility(getTransform(), boundingBox)))
+            if (const auto spatialIndex = layer ? layer->getSpatialIndex() : nullptr)
             {
-                const auto upperBound = std::upper_bound(drawQueue.begin(), drawQueue.end(), this,
-                                                         [](const auto a, const auto b) noexcept {
-                                                             return a->worldOrder > b->worldOrder;
-                                                         });
+                // the layer finds the visible actors in the spatial index after the visit,
+                // so their keys are built from the visit sequence to keep their order
+                visitSequence = drawQueue.nextVisit();
+                drawKey = DrawQueue::makeKey(worldOrder, visitSequence);
+                updateSpatialProxy(*spatialIndex, boundingBox);
 
-                drawQueue.insert(upperBound, this);
+                if (cullDisabled) drawQueue.push(getDrawKey(drawQueue, *camera, visitSequence), this);
+            }
+            else if (cullDisabled || (!boundingBox.isEmpty() && camera->checkVisibility(getTransform(), boundingBox)))
+            {
+                drawKey = getDrawKey(drawQueue, *camera, 0);
+                drawQueue.push(drawKey, this);
             }
         }
 
@@ -279,14 +290,121 @@ namespace ouzel::scene
         updateChildrenTransform = false;
     }
 
+    void Actor::prepareDraw(std::vector<std::pair<Actor*, Box3F>>& visibleActors,
+                            const Matrix4F& newParentTransform,
+                            bool parentTransformDirty,
+                            Order parentOrder,
+                            bool parentHidden)
+    {
+        worldOrder = parentOrder + order;
+        worldHidden = parentHidden || hidden;
+
+        if (!transformStore)
+        {
+            if (parentTransformDirty) updateTransform(newParentTransform);
+            if (transformDirty) calculateTransform();
+        }
+
+        if (!worldHidden)
+        {
+            const auto boundingBox = getBoundingBox();
+
+            visitSequence = static_cast<std::uint32_t>(visibleActors.size());
+            visibleActors.emplace_back(this, boundingBox);
+
+            if (const auto spatialIndex = layer ? layer->getSpatialIndex() : nullptr)
+            {
+                // picking only needs the order and the visit sequence
+                drawKey = DrawQueue::makeKey(worldOrder, visitSequence);
+                updateSpatialProxy(*spatialIndex, boundingBox);
+            }
+        }
+
+        for (const auto actor : children)
+            actor->prepareDraw(visibleActors, transform, updateChildrenTransform, worldOrder, worldHidden);
+
+        updateChildrenTransform = false;
+    }
+
+    std::uint64_t Actor::getDrawKey(const DrawQueue& drawQueue, const Camera& camera, std::uint32_t sequence) const
+    {
+        if (!drawQueue.isStateSortingEnabled())
+            return DrawQueue::makeKey(worldOrder, sequence);
+
+        // blended actors have to keep the scene order, so only the opaque ones are sorted by state and depth
+        const auto stateKey = getRenderStateKey();
+        if (!stateKey)
+            return DrawQueue::makeBlendedKey(worldOrder, sequence);
+
+        // project the origin of the actor to get its depth
+        Vector3F worldOrigin;
+        getTransform().transformPoint(worldOrigin);
+        Vector4F clipPosition{worldOrigin.v[0], worldOrigin.v[1], worldOrigin.v[2], 1.0F};
+        camera.getViewProjection().transformVector(clipPosition);
+
+        const auto depth = (clipPosition.v[3] != 0.0F) ? clipPosition.v[2] / clipPosition.v[3] : 0.0F;
+        const auto depthKey = static_cast<std::uint16_t>(std::clamp((depth + 1.0F) / 2.0F, 0.0F, 1.0F) * 65535.0F);
+
+        return DrawQueue::makeKey(worldOrder, stateKey, depthKey);
+    }
+
+    void Actor::updateSpatialProxy(SpatialIndex& spatialIndex, const Box3F& boundingBox)
+    {
+        if (boundingBox.isEmpty())
+        {
+            removeSpatialProxy(spatialIndex);
+            return;
+        }
+
+        if (spatialProxy != SpatialIndex::nullProxy &&
+            !spatialBoxDirty &&
+            boundingBox.min == spatialBox.min &&
+            boundingBox.max == spatialBox.max)
+            return;
+
+        const Vector3F corners[] = {
+            Vector3F{boundingBox.min.v[0], boundingBox.min.v[1], boundingBox.min.v[2]},
+            Vector3F{boundingBox.max.v[0], boundingBox.min.v[1], boundingBox.min.v[2]},
+            Vector3F{boundingBox.min.v[0], boundingBox.max.v[1], boundingBox.min.v[2]},
+            Vector3F{boundingBox.max.v[0], boundingBox.max.v[1], boundingBox.min.v[2]},
+            Vector3F{boundingBox.min.v[0], boundingBox.min.v[1], boundingBox.max.v[2]},
+            Vector3F{boundingBox.max.v[0], boundingBox.min.v[1], boundingBox.max.v[2]},
+            Vector3F{boundingBox.min.v[0], boundingBox.max.v[1], boundingBox.max.v[2]},
+            Vector3F{boundingBox.max.v[0], boundingBox.max.v[1], boundingBox.max.v[2]}
+        };
+
+        Box3F worldBox;
+        for (auto corner : corners)
+        {
+            getTransform().transformPoint(corner);
+            worldBox.insertPoint(corner);
+        }
+
+        if (spatialProxy == SpatialIndex::nullProxy)
+            spatialProxy = spatialIndex.createProxy(worldBox, this);
+        else
+            spatialIndex.moveProxy(spatialProxy, worldBox);
+
+        spatialBox = boundingBox;
+        spatialBoxDirty = false;
+    }
+
+    void Actor::removeSpatialProxy(SpatialIndex& spatialIndex)
+    {
+        if (spatialProxy != SpatialIndex::nullProxy)
+        {
+            spatialIndex.destroyProxy(spatialProxy);
+            spatialProxy = SpatialIndex::nullProxy;
+        }
+    }
+
     void Actor::draw(Camera* camera, bool wireframe)
     {
-        if (transformDirty)
-            calculateTransform();
+        const auto& currentTransform = getTransform();
 
         for (const auto component : components)
             if (!component->isHidden())
-                component->draw(transform,
+                component->draw(currentTransform,
                                 opacity,
                                 camera->getRenderViewProjection(),
                                 wireframe);
@@ -420,6 +538,18 @@ namespace ouzel::scene
     void Actor::updateLocalTransform()
     {
         localTransformDirty = transformDirty = inverseTransformDirty = true;
+
+        if (transformStore)
+        {
+            const auto finalScale = Vector3F{scale.v[0] * (flipX ? -1.0F : 1.0F),
+                                             scale.v[1] * (flipY ? -1.0F : 1.0F),
+                                             scale.v[2]};
+
+            // components are notified when the store recalculates the world transform
+            transformStore->setLocalTransform(transformHandle, position, rotation, finalScale);
+            return;
+        }
+
         for (const auto component : components)
             component->updateTransform();
     }
@@ -428,10 +558,67 @@ namespace ouzel::scene
     {
         parentTransform = newParentTransform;
         transformDirty = inverseTransformDirty = true;
+
+        if (transformStore)
+        {
+            transformStore->setDirty(transformHandle);
+            return;
+        }
+
+        for (const auto component : components)
+            component->updateTransform();
+    }
+
+    void Actor::createTransformHandle(TransformStore& store)
+    {
+        const auto parentActor = (parent && parent != layer) ? static_cast<Actor*>(parent) : nullptr;
+        const auto parentHandle = (parentActor && parentActor->transformStore == &store) ?
+            parentActor->transformHandle : TransformStore::nullHandle;
+
+        transformStore = &store;
+        transformHandle = store.create(*this, parentHandle);
+        updateLocalTransform();
+    }
+
+    void Actor::destroyTransformHandle()
+    {
+        if (transformStore)
+        {
+            transformStore->destroy(transformHandle);
+            transformStore = nullptr;
+            transformHandle = TransformStore::nullHandle;
+
+            // the transforms have to be recalculated without the store
+            localTransformDirty = transformDirty = inverseTransformDirty = true;
+            updateChildrenTransform = true;
+        }
+    }
+
+    void Actor::updateWorldTransform()
+    {
+        inverseTransformDirty = true;
+        spatialBoxDirty = true;
+
         for (const auto component : components)
             component->updateTransform();
     }
 
+    std::uint16_t Actor::getRenderStateKey() const
+    {
+        std::uint16_t key = 0;
+
+        for (const auto component : components)
+            if (!component->isHidden())
+            {
+                // one blended component keeps the whole actor in the scene order
+                const auto componentKey = component->getRenderStateKey();
+                if (!componentKey) return 0;
+                if (!key) key = componentKey;
+            }
+
+        return key;
+    }
+
     Vector3F Actor::getWorldPosition() const
     {
         auto result = position;
@@ -486,6 +673,7 @@ namespace ouzel::scene
     {
         transform = parentTransform * getLocalTransform();
         transformDirty = false;
+        spatialBoxDirty = true;
 
         updateChildrenTransform = true;
     }
@@ -550,6 +738,19 @@ namespace ouzel::scene
 
     void Actor::setLayer(Layer* newLayer)
     {
+        if (layer)
+            if (const auto spatialIndex = layer->getSpatialIndex())
+                removeSpatialProxy(*spatialIndex);
+
+        destroyTransformHandle();
+
+        layer = newLayer;
+
+        // the parent already has its handle, because the children are attached after it
+        if (newLayer)
+            if (const auto store = newLayer->getTransformStore())
+                createTransformHandle(*store);
+
         ActorContainer::setLayer(newLayer);
 
         for (const auto component : components)
@@ -5,6 +5,9 @@
 
 #include <memory>
 #include <vector>
+#include "DrawQueue.hpp"
+#include "SpatialIndex.hpp"
+#include "TransformStore.hpp"
 #include "../math/Box.hpp"
 #include "../math/Color.hpp"
 #include "../math/Matrix.hpp"
@@ -64,13 +67,14 @@ namespace ouzel::scene
     {
         friend ActorContainer;
         friend Layer;
+        friend TransformStore;
     public:
         using Order = std::int32_t;
 
         Actor() = default;
         ~Actor() override;
 
-        virtual void visit(std::vector<Actor*>& drawQueue,
+        virtual void visit(DrawQueue& drawQueue,
                            const Matrix4F& newParentTransform,
                            bool parentTransformDirty,
                            Camera* camera,
@@ -123,8 +127,14 @@ namespace ouzel::scene
             return localTransform;
         }
 
-        auto& getTransform() const
+        const Matrix4F& getTransform() const
         {
+            if (transformStore)
+            {
+                transformStore->update();
+                return transformStore->getWorldTransform(transformHandle);
+            }
+
             if (transformDirty) calculateTransform();
 
             return transform;
@@ -157,12 +167,30 @@ namespace ouzel::scene
 
         Box3F getBoundingBox() const;
 
+        // identifies the render state of the components, used for sorting the draw queue, 0 if any of them is blended
+        std::uint16_t getRenderStateKey() const;
+
     protected:
         void setLayer(Layer* newLayer) override;
 
+        // updates the transforms and collects the visible actors without culling, used by the parallel traversal
+        void prepareDraw(std::vector<std::pair<Actor*, Box3F>>& visibleActors,
+                         const Matrix4F& newParentTransform,
+                         bool parentTransformDirty,
+                         Order parentOrder,
+                         bool parentHidden);
+
+        std::uint64_t getDrawKey(const DrawQueue& drawQueue, const Camera& camera, std::uint32_t sequence) const;
+        void updateSpatialProxy(SpatialIndex& spatialIndex, const Box3F& boundingBox);
+        void removeSpatialProxy(SpatialIndex& spatialIndex);
+
         void updateLocalTransform();
         void updateTransform(const Matrix4F& newParentTransform);
 
+        void createTransformHandle(TransformStore& store);
+        void destroyTransformHandle();
+        void updateWorldTransform();
+
         virtual void calculateLocalTransform() const;
         virtual void calculateTransform() const;
 
@@ -193,6 +221,15 @@ namespace ouzel::scene
         Order order = 0;
         Order worldOrder = 0;
 
+        std::uint64_t drawKey = 0;
+        std::uint32_t visitSequence = 0;
+        SpatialIndex::ProxyId spatialProxy = SpatialIndex::nullProxy;
+        Box3F spatialBox;
+        mutable bool spatialBoxDirty = true;
+
+        TransformStore* transformStore = nullptr;
+        TransformStore::Handle transformHandle = TransformStore::nullHandle;
+
         ActorContainer* parent = nullptr;
 
         std::vector<Component*> components;
@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <limits>
 #include "Camera.hpp"
 #include "Actor.hpp"
 #include "Layer.hpp"
@@ -198,6 +199,34 @@ namespace ouzel::scene
                         1.0F - ((result.v[1] / 2.0F + 0.5F) * viewport.size.v[1] + viewport.position.v[1]));
     }
 
+    Box3F Camera::getViewBoundingBox() const
+    {
+        Box3F result;
+        const auto& currentInverseViewProjection = getInverseViewProjection();
+
+        for (const auto x : {-1.0F, 1.0F})
+            for (const auto y : {-1.0F, 1.0F})
+                for (const auto z : {-1.0F, 1.0F})
+                {
+                    Vector4F corner{x, y, z, 1.0F};
+                    currentInverseViewProjection.transformVector(corner);
+
+                    if (corner.v[3] != 0.0F)
+                        result.insertPoint(Vector3F{corner.v[0] / corner.v[3],
+                                                    corner.v[1] / corner.v[3],
+                                                    corner.v[2] / corner.v[3]});
+                }
+
+        // orthographic visibility checks ignore the depth
+        if (projectionMode == ProjectionMode::orthographic)
+        {
+            result.min.v[2] = std::numeric_limits<float>::lowest();
+            result.max.v[2] = std::numeric_limits<float>::max();
+        }
+
+        return result;
+    }
+
     bool Camera::checkVisibility(const Matrix4F& boxTransform, const Box3F& box) const
     {
         if (projectionMode == ProjectionMode::orthographic)
@@ -63,6 +63,9 @@ namespace ouzel::scene
 
         bool checkVisibility(const Matrix4F& boxTransform, const Box3F& box) const;
 
+        // world space box that encloses everything the camera can see
+        Box3F getViewBoundingBox() const;
+
         auto& getViewport() const noexcept { return viewport; }
         auto& getRenderViewport() const noexcept { return renderViewport; }
         void setViewport(const RectF& newViewport);
@@ -37,6 +37,10 @@ namespace ouzel::scene
         virtual const Box3F& getBoundingBox() const noexcept { return boundingBox; }
         virtual void setBoundingBox(const Box3F& newBoundingBox) { boundingBox = newBoundingBox; }
 
+        // components with equal keys can be drawn without changing the render state,
+        // blended components return 0, because they have to be drawn in the scene order
+        virtual std::uint16_t getRenderStateKey() const noexcept { return 0; }
+
         virtual bool pointOn(const Vector2F& position) const;
         virtual bool shapeOverlaps(const std::vector<Vector2F>& edges) const;
 
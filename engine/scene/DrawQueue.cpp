@@ -0,0 +1,47 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <array>
+#include "DrawQueue.hpp"
+
+namespace ouzel::scene
+{
+    void DrawQueue::sort()
+    {
+        constexpr std::size_t radixBits = 8;
+        constexpr std::size_t bucketCount = 1U << radixBits;
+        constexpr std::size_t passCount = sizeof(std::uint64_t) * 8 / radixBits;
+
+        if (entries.size() < 2) return;
+
+        std::array<std::array<std::size_t, bucketCount>, passCount> histograms{};
+
+        for (const auto& entry : entries)
+            for (std::size_t pass = 0; pass < passCount; ++pass)
+                ++histograms[pass][(entry.key >> (pass * radixBits)) & (bucketCount - 1)];
+
+        sortedEntries.resize(entries.size());
+
+        for (std::size_t pass = 0; pass < passCount; ++pass)
+        {
+            auto& histogram = histograms[pass];
+            const auto shift = pass * radixBits;
+
+            // all keys fall into the same bucket, so this pass would not move anything
+            if (histogram[(entries.front().key >> shift) & (bucketCount - 1)] == entries.size())
+                continue;
+
+            std::size_t offset = 0;
+            for (auto& count : histogram)
+            {
+                const auto bucketSize = count;
+                count = offset;
+                offset += bucketSize;
+            }
+
+            for (const auto& entry : entries)
+                sortedEntries[histogram[(entry.key >> shift) & (bucketCount - 1)]++] = entry;
+
+            entries.swap(sortedEntries);
+        }
+    }
+}
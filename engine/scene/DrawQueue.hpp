@@ -0,0 +1,69 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_DRAWQUEUE_HPP
+#define OUZEL_SCENE_DRAWQUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace ouzel::scene
+{
+    class Actor;
+
+    // Actors to draw, ordered by a 64-bit sort key:
+    // bits 63-32 - world order (higher orders are drawn first)
+    // bits 31-0 - visit sequence, or with state sorting:
+    //   opaque actors: bit 31 - 0, bits 30-16 - render state, bits 15-0 - depth (front to back)
+    //   blended actors: bit 31 - 1, bits 30-0 - visit sequence (after the opaque ones, in the scene order)
+    // Actors with equal keys are drawn in the order they were pushed, so the visit sequence can be
+    // zero when the actors are pushed in the visit order.
+    class DrawQueue final
+    {
+    public:
+        struct Entry final
+        {
+            std::uint64_t key;
+            Actor* actor;
+        };
+
+        static constexpr std::uint64_t makeKey(std::int32_t order, std::uint32_t sequence = 0) noexcept
+        {
+            // flip the sign bit to order signed values as unsigned and invert to draw higher orders first
+            const auto orderBits = ~(static_cast<std::uint32_t>(order) ^ 0x80000000U);
+            return (static_cast<std::uint64_t>(orderBits) << 32) | static_cast<std::uint64_t>(sequence);
+        }
+
+        static constexpr std::uint64_t makeKey(std::int32_t order, std::uint16_t state, std::uint16_t depth) noexcept
+        {
+            return makeKey(order, ((static_cast<std::uint32_t>(state) & 0x7FFFU) << 16) | static_cast<std::uint32_t>(depth));
+        }
+
+        static constexpr std::uint64_t makeBlendedKey(std::int32_t order, std::uint32_t sequence) noexcept
+        {
+            return makeKey(order, 0x80000000U | (sequence & 0x7FFFFFFFU));
+        }
+
+        auto isStateSortingEnabled() const noexcept { return stateSorting; }
+        void setStateSortingEnabled(bool newStateSorting) noexcept { stateSorting = newStateSorting; }
+
+        void clear() noexcept { entries.clear(); visitCount = 0; }
+        auto nextVisit() noexcept { return visitCount++; }
+        void push(std::uint64_t key, Actor* actor) { entries.push_back(Entry{key, actor}); }
+
+        // stable LSD radix sort, skipping bytes that are equal in all keys
+        void sort();
+
+        auto begin() const noexcept { return entries.begin(); }
+        auto end() const noexcept { return entries.end(); }
+        auto size() const noexcept { return entries.size(); }
+        auto isEmpty() const noexcept { return entries.empty(); }
+
+    private:
+        bool stateSorting = false;
+        std::uint32_t visitCount = 0;
+        std::vector<Entry> entries;
+        std::vector<Entry> sortedEntries;
+    };
+}
+
+#endif // OUZEL_SCENE_DRAWQUEUE_HPP
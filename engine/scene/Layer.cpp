@@ -2,6 +2,8 @@
 
 #include <cassert>
 #include <algorithm>
+#include <limits>
+#include <queue>
 #include "Layer.hpp"
 #include "Actor.hpp"
 #include "Camera.hpp"
@@ -21,27 +23,103 @@ namespace ouzel::scene
     Layer::~Layer()
     {
         if (scene) scene->removeLayer(*this);
+
+        // detach the actors while the spatial index and the transform store still exist
+        for (const auto actor : children)
+            actor->setLayer(nullptr);
     }
 
     void Layer::draw()
     {
+        if (transformStore) transformStore->update();
+
         for (const auto camera : cameras)
         {
-            std::vector<Actor*> drawQueue;
+            drawQueue.clear();
 
             for (const auto actor : children)
                 actor->visit(drawQueue, Matrix4F::identity(), false, camera, 0, false);
 
-            engine->getGraphics()->setRenderTarget(camera->getRenderTarget() ? camera->getRenderTarget()->getResource() : 0);
-            engine->getGraphics()->setViewport(camera->getRenderViewport());
-            engine->getGraphics()->setDepthStencilState(camera->getDepthStencilState() ? camera->getDepthStencilState()->getResource() : 0,
-                                                        camera->getStencilReferenceValue());
+            if (spatialIndex)
+                spatialIndex->query(camera->getViewBoundingBox(), [this, camera](Actor* actor) {
+                    // actors with culling disabled were added during the visit
+                    if (!actor->isWorldHidden() && !actor->isCullDisabled() &&
+                        camera->checkVisibility(actor->getTransform(), actor->getBoundingBox()))
+                        drawQueue.push(actor->getDrawKey(drawQueue, *camera, actor->visitSequence), actor);
+                });
+
+            drawQueue.sort();
 
-            for (const auto actor : drawQueue)
-                actor->draw(camera, camera->getWireframe());
+            drawActors(*camera, drawQueue);
         }
     }
 
+    void Layer::prepareDraw()
+    {
+        if (transformStore) transformStore->update();
+
+        visibleActors.clear();
+
+        for (const auto actor : children)
+            actor->prepareDraw(visibleActors, Matrix4F::identity(), false, 0, false);
+
+        // the camera matrices are calculated lazily, so they must be ready before the workers read them
+        for (const auto camera : cameras)
+            camera->getInverseViewProjection();
+
+        cameraDrawQueues.resize(cameras.size());
+        for (auto& queue : cameraDrawQueues)
+            queue.setStateSortingEnabled(drawQueue.isStateSortingEnabled());
+    }
+
+    void Layer::buildDrawQueue(std::size_t cameraIndex)
+    {
+        const Camera& camera = *cameras[cameraIndex];
+        DrawQueue& queue = cameraDrawQueues[cameraIndex];
+
+        queue.clear();
+
+        // the actors are pushed in the same order as in the serial visit, so the sorted queues are identical
+        if (spatialIndex)
+        {
+            for (const auto& [actor, boundingBox] : visibleActors)
+                if (actor->isCullDisabled())
+                    queue.push(actor->getDrawKey(queue, camera, actor->visitSequence), actor);
+
+            spatialIndex->query(camera.getViewBoundingBox(), [&queue, &camera](Actor* actor) {
+                if (!actor->isWorldHidden() && !actor->isCullDisabled() &&
+                    camera.checkVisibility(actor->getTransform(), actor->getBoundingBox()))
+                    queue.push(actor->getDrawKey(queue, camera, actor->visitSequence), actor);
+            });
+        }
+        else
+        {
+            for (const auto& [actor, boundingBox] : visibleActors)
+                if (actor->isCullDisabled() ||
+                    (!boundingBox.isEmpty() && camera.checkVisibility(actor->getTransform(), boundingBox)))
+                    queue.push(actor->getDrawKey(queue, camera, 0), actor);
+        }
+
+        queue.sort();
+    }
+
+    void Layer::submitDrawQueues()
+    {
+        for (std::size_t i = 0; i < cameras.size() && i < cameraDrawQueues.size(); ++i)
+            drawActors(*cameras[i], cameraDrawQueues[i]);
+    }
+
+    void Layer::drawActors(Camera& camera, const DrawQueue& queue)
+    {
+        engine->getGraphics()->setRenderTarget(camera.getRenderTarget() ? camera.getRenderTarget()->getResource() : 0);
+        engine->getGraphics()->setViewport(camera.getRenderViewport());
+        engine->getGraphics()->setDepthStencilState(camera.getDepthStencilState() ? camera.getDepthStencilState()->getResource() : 0,
+                                                    camera.getStencilReferenceValue());
+
+        for (const auto& entry : queue)
+            entry.actor->draw(&camera, camera.getWireframe());
+    }
+
     void Layer::addChild(Actor& actor)
     {
         ActorContainer::addChild(actor);
@@ -84,7 +162,7 @@ namespace ouzel::scene
             if (renderTargets || !camera->getRenderTarget())
             {
                 const auto worldPosition = Vector2F(camera->convertNormalizedToWorld(position));
-                const auto actors = findActors(worldPosition);
+                const auto actors = spatialIndex ? findIndexedActors(worldPosition) : findActors(worldPosition);
                 if (!actors.empty()) return actors.front();
             }
         }
@@ -103,7 +181,7 @@ namespace ouzel::scene
             if (renderTargets || !camera->getRenderTarget())
             {
                 const auto worldPosition = Vector2F(camera->convertNormalizedToWorld(position));
-                const auto actors = findActors(worldPosition);
+                const auto actors = spatialIndex ? findIndexedActors(worldPosition) : findActors(worldPosition);
                 result.insert(result.end(), actors.begin(), actors.end());
             }
         }
@@ -127,7 +205,7 @@ namespace ouzel::scene
                 for (const auto& edge : edges)
                     worldEdges.emplace_back(camera->convertNormalizedToWorld(edge));
 
-                const auto actors = findActors(worldEdges);
+                const auto actors = spatialIndex ? findIndexedActors(worldEdges) : findActors(worldEdges);
                 result.insert(result.end(), actors.begin(), actors.end());
             }
         }
@@ -135,6 +213,107 @@ namespace ouzel::scene
         return result;
     }
 
+    void Layer::setSpatialIndexEnabled(bool enabled)
+    {
+        if (enabled == (spatialIndex != nullptr)) return;
+
+        if (enabled)
+            spatialIndex = std::make_unique<SpatialIndex>();
+        else
+        {
+            std::vector<Actor*> actors(children.begin(), children.end());
+
+            while (!actors.empty())
+            {
+                const auto actor = actors.back();
+                actors.pop_back();
+
+                actor->spatialProxy = SpatialIndex::nullProxy;
+                actors.insert(actors.end(), actor->children.begin(), actor->children.end());
+            }
+
+            spatialIndex.reset();
+        }
+    }
+
+    void Layer::setTransformStoreEnabled(bool enabled)
+    {
+        if (enabled == (transformStore != nullptr)) return;
+
+        if (enabled) transformStore = std::make_unique<TransformStore>();
+
+        // parents must be attached before their children
+        std::queue<Actor*> actors;
+        for (const auto actor : children)
+            actors.push(actor);
+
+        while (!actors.empty())
+        {
+            const auto actor = actors.front();
+            actors.pop();
+
+            if (enabled)
+                actor->createTransformHandle(*transformStore);
+            else
+                actor->destroyTransformHandle();
+
+            for (const auto child : actor->children)
+                actors.push(child);
+        }
+
+        if (!enabled) transformStore.reset();
+    }
+
+    namespace
+    {
+        // picked actors are sorted in the reverse draw order, so the top-most actor is first
+        template <class T, class F>
+        void sortPickedActors(std::vector<T>& actors, F getKey)
+        {
+            std::sort(actors.begin(), actors.end(), [getKey](const auto& a, const auto& b) noexcept {
+                return getKey(a) > getKey(b);
+            });
+        }
+    }
+
+    std::vector<std::pair<Actor*, Vector3F>> Layer::findIndexedActors(const Vector2F& position) const
+    {
+        std::vector<std::pair<Actor*, Vector3F>> actors;
+
+        const Box3F box(Vector3F{position.v[0], position.v[1], std::numeric_limits<float>::lowest()},
+                        Vector3F{position.v[0], position.v[1], std::numeric_limits<float>::max()});
+
+        spatialIndex->query(box, [&actors, &position](Actor* actor) {
+            if (!actor->isWorldHidden() && actor->isPickable() && actor->pointOn(position))
+                actors.emplace_back(actor, actor->convertWorldToLocal(Vector3F(position)));
+        });
+
+        sortPickedActors(actors, [](const auto& result) noexcept { return result.first->drawKey; });
+
+        return actors;
+    }
+
+    std::vector<Actor*> Layer::findIndexedActors(const std::vector<Vector2F>& edges) const
+    {
+        std::vector<Actor*> actors;
+
+        Box3F box;
+        for (const auto& edge : edges)
+            box.insertPoint(Vector3F(edge));
+
+        box.min.v[2] = std::numeric_limits<float>::lowest();
+        box.max.v[2] = std::numeric_limits<float>::max();
+
+        spatialIndex->query(box, [&actors, &edges](Actor* actor) {
+            if (!actor->isWorldHidden() && actor->isPickable() && actor->shapeOverlaps(edges))
+                actors.push_back(actor);
+        });
+
+        sortPickedActors(actors, [](const auto actor) noexcept { return actor->drawKey; });
+
+        return actors;
+    }
+
     void Layer::setOrder(std::int32_t newOrder)
     {
         order = newOrder;
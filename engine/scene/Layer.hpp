@@ -4,8 +4,12 @@
 #define OUZEL_SCENE_LAYER_HPP
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include "../scene/Actor.hpp"
+#include "../scene/DrawQueue.hpp"
+#include "../scene/SpatialIndex.hpp"
+#include "../scene/TransformStore.hpp"
 #include "../math/Vector.hpp"
 
 namespace ouzel::scene
@@ -35,6 +39,21 @@ namespace ouzel::scene
         std::vector<std::pair<Actor*, Vector3F>> pickActors(const Vector2F& position, bool renderTargets = false) const;
         std::vector<Actor*> pickActors(const std::vector<Vector2F>& edges, bool renderTargets = false) const;
 
+        // sort opaque actors with the same order by render state and depth instead of keeping the scene order,
+        // blended actors are drawn after them in the scene order
+        auto isStateSortingEnabled() const noexcept { return drawQueue.isStateSortingEnabled(); }
+        void setStateSortingEnabled(bool newStateSorting) { drawQueue.setStateSortingEnabled(newStateSorting); }
+
+        // keep the actors in a bounding volume hierarchy, which is used for culling and picking
+        auto isSpatialIndexEnabled() const noexcept { return spatialIndex != nullptr; }
+        void setSpatialIndexEnabled(bool enabled);
+        auto getSpatialIndex() const noexcept { return spatialIndex.get(); }
+
+        // keep the actor transforms in contiguous arrays, which are updated in one pass before drawing
+        auto isTransformStoreEnabled() const noexcept { return transformStore != nullptr; }
+        void setTransformStoreEnabled(bool enabled);
+        auto getTransformStore() const noexcept { return transformStore.get(); }
+
         auto getOrder() const noexcept { return order; }
         void setOrder(Order newOrder);
 
@@ -48,6 +67,17 @@ namespace ouzel::scene
         void addLight(Light& light);
         void removeLight(Light& light);
 
+        std::vector<std::pair<Actor*, Vector3F>> findIndexedActors(const Vector2F& position) const;
+        std::vector<Actor*> findIndexedActors(const std::vector<Vector2F>& edges) const;
+
+        // parallel traversal, the draw queues of the cameras are built on worker threads between the
+        // prepare and the submit calls, which are made on the thread that draws the scene
+        void prepareDraw();
+        void buildDrawQueue(std::size_t cameraIndex);
+        void submitDrawQueues();
+
+        void drawActors(Camera& camera, const DrawQueue& queue);
+
         virtual void recalculateProjection();
         void enter() override;
 
@@ -56,6 +86,13 @@ namespace ouzel::scene
         std::vector<Camera*> cameras;
         std::vector<Light*> lights;
 
+        DrawQueue drawQueue;
+        std::unique_ptr<SpatialIndex> spatialIndex;
+        std::unique_ptr<TransformStore> transformStore;
+
+        std::vector<std::pair<Actor*, Box3F>> visibleActors;
+        std::vector<DrawQueue> cameraDrawQueues;
+
         Order order = 0;
     };
 }
@@ -0,0 +1,260 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include "ParticleStore.hpp"
+#include "../math/MathUtils.hpp"
+
+namespace ouzel::scene
+{
+    namespace
+    {
+        // the steps and the quads of a chunk are computed while its fields are still in the cache
+        constexpr std::uint32_t chunkSize = 256;
+
+        constexpr std::vector<float> ParticleStore::* fields[] = {
+            &ParticleStore::life,
+            &ParticleStore::positionX,
+            &ParticleStore::positionY,
+            &ParticleStore::colorRed,
+            &ParticleStore::colorGreen,
+            &ParticleStore::colorBlue,
+            &ParticleStore::colorAlpha,
+            &ParticleStore::deltaColorRed,
+            &ParticleStore::deltaColorGreen,
+            &ParticleStore::deltaColorBlue,
+            &ParticleStore::deltaColorAlpha,
+            &ParticleStore::size,
+            &ParticleStore::deltaSize,
+            &ParticleStore::rotation,
+            &ParticleStore::deltaRotation,
+            &ParticleStore::directionX,
+            &ParticleStore::directionY,
+            &ParticleStore::radialAcceleration,
+            &ParticleStore::tangentialAcceleration,
+            &ParticleStore::angle,
+            &ParticleStore::degreesPerSecond,
+            &ParticleStore::radius,
+            &ParticleStore::deltaRadius
+        };
+
+        // the clamping, the scaling and the conversion are vectorized only in separate loops
+        void toColorComponents(const float* values, std::uint8_t* components, std::uint32_t particleCount) noexcept
+        {
+            float scaled[chunkSize];
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                scaled[i] = std::min(std::max(values[i], 0.0F), 1.0F);
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                scaled[i] *= 255.0F;
+
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                components[i] = static_cast<std::uint8_t>(static_cast<std::int32_t>(scaled[i]));
+        }
+    }
+
+    void ParticleStore::setCapacity(std::uint32_t newCapacity)
+    {
+        for (const auto field : fields)
+            (this->*field).resize(newCapacity);
+
+        capacity = newCapacity;
+        count = std::min(count, capacity);
+    }
+
+    void ParticleStore::updateGravity(float step, const Vector2F& gravity, float positionFactor,
+                                      graphics::Vertex* vertices)
+    {
+        update(step, [this, step, gravity, positionFactor](std::uint32_t first, std::uint32_t particleCount) noexcept {
+            float* x = positionX.data() + first;
+            float* y = positionY.data() + first;
+            float* dx = directionX.data() + first;
+            float* dy = directionY.data() + first;
+            const float* ra = radialAcceleration.data() + first;
+            const float* ta = tangentialAcceleration.data() + first;
+            const float gravityX = gravity.v[0];
+            const float gravityY = gravity.v[1];
+            const float positionStep = step * positionFactor;
+
+            // the radial acceleration only acts on the particles on the axes, the normalized position
+            // is the sign of the other coordinate then
+            float radialX[chunkSize];
+            float radialY[chunkSize];
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+            {
+                radialX[i] = (y[i] == 0.0F && x[i] != 0.0F) ? std::copysign(1.0F, x[i]) : 0.0F;
+                radialY[i] = (x[i] == 0.0F && y[i] != 0.0F) ? std::copysign(1.0F, y[i]) : 0.0F;
+            }
+
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                dx[i] += (radialX[i] * ra[i] + radialY[i] * -ta[i] + gravityX) * step;
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                dy[i] += (radialY[i] * ra[i] + radialX[i] * ta[i] + gravityY) * step;
+
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                x[i] += dx[i] * positionStep;
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                y[i] += dy[i] * positionStep;
+        }, vertices);
+    }
+
+    void ParticleStore::updateRadius(float step, float positionFactor, graphics::Vertex* vertices)
+    {
+        update(step, [this, step, positionFactor](std::uint32_t first, std::uint32_t particleCount) noexcept {
+            float* x = positionX.data() + first;
+            float* y = positionY.data() + first;
+            float* a = angle.data() + first;
+            float* r = radius.data() + first;
+            const float* dps = degreesPerSecond.data() + first;
+            const float* dr = deltaRadius.data() + first;
+
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                a[i] += dps[i] * step;
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                r[i] += dr[i] * step;
+
+            float sines[chunkSize];
+            float cosines[chunkSize];
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                fastSinCos(wrapAngle(a[i]), sines[i], cosines[i]);
+
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                x[i] = -cosines[i] * r[i];
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                y[i] = -sines[i] * r[i] * positionFactor;
+        }, vertices);
+    }
+
+    template <class Step>
+    void ParticleStore::update(float step, Step emitterStep, graphics::Vertex* vertices)
+    {
+        // every loop writes only one array, so that the compiler does not have to check all of the arrays
+        // against each other before vectorizing it
+        const auto advance = [step](float* values, const float* deltas, std::uint32_t particleCount) noexcept {
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                values[i] += deltas[i] * step;
+        };
+
+        for (std::uint32_t first = 0; first < count; first += chunkSize)
+        {
+            const auto particleCount = std::min(chunkSize, count - first);
+
+            emitterStep(first, particleCount);
+
+            float* l = life.data() + first;
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                l[i] -= step;
+
+            advance(colorRed.data() + first, deltaColorRed.data() + first, particleCount);
+            advance(colorGreen.data() + first, deltaColorGreen.data() + first, particleCount);
+            advance(colorBlue.data() + first, deltaColorBlue.data() + first, particleCount);
+            advance(colorAlpha.data() + first, deltaColorAlpha.data() + first, particleCount);
+            advance(rotation.data() + first, deltaRotation.data() + first, particleCount);
+
+            float* s = size.data() + first;
+            const float* ds = deltaSize.data() + first;
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+                s[i] = std::max(0.0F, s[i] + ds[i] * step);
+
+            if (vertices) writeQuads(first, particleCount, vertices);
+        }
+
+        removeDead(vertices);
+    }
+
+    void ParticleStore::writeQuads(std::uint32_t first, std::uint32_t particleCount,
+                                   graphics::Vertex* vertices) const noexcept
+    {
+        // half of the rotated diagonals, the corners are the position plus or minus them
+        float diagonalX[chunkSize];
+        float diagonalY[chunkSize];
+        std::uint8_t red[chunkSize];
+        std::uint8_t green[chunkSize];
+        std::uint8_t blue[chunkSize];
+        std::uint8_t alpha[chunkSize];
+
+        const float* x = positionX.data() + first;
+        const float* y = positionY.data() + first;
+        const float* s = size.data() + first;
+        const float* r = rotation.data() + first;
+
+        for (std::uint32_t i = 0; i < particleCount; ++i)
+        {
+            float sine;
+            float cosine;
+            fastSinCos(wrapAngle(-degToRad(r[i])), sine, cosine);
+
+            const float halfSize = s[i] / 2.0F;
+            const float c = halfSize * cosine;
+            const float d = halfSize * sine;
+            diagonalX[i] = d - c;
+            diagonalY[i] = -d - c;
+        }
+
+        toColorComponents(colorRed.data() + first, red, particleCount);
+        toColorComponents(colorGreen.data() + first, green, particleCount);
+        toColorComponents(colorBlue.data() + first, blue, particleCount);
+        toColorComponents(colorAlpha.data() + first, alpha, particleCount);
+
+        graphics::Vertex* quad = vertices + first * 4;
+        for (std::uint32_t i = 0; i < particleCount; ++i, quad += 4)
+        {
+            // the bottom left, the bottom right, the top left and the top right corner, the second diagonal
+            // is the first one rotated by 90 degrees
+            const Color color(red[i], green[i], blue[i], alpha[i]);
+
+            quad[0].position = Vector3F{x[i] + diagonalX[i], y[i] + diagonalY[i], 0.0F};
+            quad[1].position = Vector3F{x[i] - diagonalY[i], y[i] + diagonalX[i], 0.0F};
+            quad[2].position = Vector3F{x[i] + diagonalY[i], y[i] - diagonalX[i], 0.0F};
+            quad[3].position = Vector3F{x[i] - diagonalX[i], y[i] - diagonalY[i], 0.0F};
+
+            quad[0].color = color;
+            quad[1].color = color;
+            quad[2].color = color;
+            quad[3].color = color;
+        }
+    }
+
+    void ParticleStore::removeDead(graphics::Vertex* vertices) noexcept
+    {
+        for (std::uint32_t counter = count; counter > 0; --counter)
+        {
+            const auto i = counter - 1;
+
+            if (!(life[i] >= 0.0F))
+            {
+                const auto last = count - 1;
+
+                for (const auto field : fields)
+                    (this->*field)[i] = (this->*field)[last];
+
+                if (vertices)
+                    std::copy(vertices + last * 4, vertices + last * 4 + 4, vertices + i * 4);
+
+                --count;
+            }
+        }
+    }
+
+    bool ParticleStore::getBounds(Vector2F& min, Vector2F& max) const noexcept
+    {
+        if (!count) return false;
+
+        float minX = positionX[0];
+        float minY = positionY[0];
+        float maxX = positionX[0];
+        float maxY = positionY[0];
+
+        for (std::uint32_t i = 1; i < count; ++i)
+        {
+            minX = std::min(minX, positionX[i]);
+            minY = std::min(minY, positionY[i]);
+            maxX = std::max(maxX, positionX[i]);
+            maxY = std::max(maxY, positionY[i]);
+        }
+
+        min = Vector2F{minX, minY};
+        max = Vector2F{maxX, maxY};
+
+        return true;
+    }
+}
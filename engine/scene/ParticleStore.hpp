@@ -0,0 +1,88 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_PARTICLESTORE_HPP
+#define OUZEL_SCENE_PARTICLESTORE_HPP
+
+#include <cstdint>
+#include <vector>
+#include "../graphics/Vertex.hpp"
+#include "../math/Vector.hpp"
+
+namespace ouzel::scene
+{
+    // Particles of a particle system stored as structure of arrays, so that every step of the simulation
+    // runs over contiguous floats without branches and is vectorized by the compiler. The emitter fills
+    // the fields of the particles it adds, the fields of the other emitter type are not used.
+    class ParticleStore final
+    {
+    public:
+        auto getCount() const noexcept { return count; }
+        auto getCapacity() const noexcept { return capacity; }
+
+        // keeps the first newCapacity particles
+        void setCapacity(std::uint32_t newCapacity);
+        void clear() noexcept { count = 0; }
+
+        // appends particleCount particles and returns the index of the first one, the emitter has to set their fields
+        std::uint32_t add(std::uint32_t particleCount) noexcept
+        {
+            const auto first = count;
+            count += particleCount;
+            return first;
+        }
+
+        // advance all particles by one step of the gravity or the radius emitter and remove the particles
+        // whose life ended; if vertices is not null, the quads of the remaining particles are written to it
+        // in the same pass, four vertices per particle
+        void updateGravity(float step, const Vector2F& gravity, float positionFactor, graphics::Vertex* vertices);
+        void updateRadius(float step, float positionFactor, graphics::Vertex* vertices);
+
+        // bounds of the particle positions, false if there are no particles
+        bool getBounds(Vector2F& min, Vector2F& max) const noexcept;
+
+        std::vector<float> life;
+        std::vector<float> positionX;
+        std::vector<float> positionY;
+
+        std::vector<float> colorRed;
+        std::vector<float> colorGreen;
+        std::vector<float> colorBlue;
+        std::vector<float> colorAlpha;
+        std::vector<float> deltaColorRed;
+        std::vector<float> deltaColorGreen;
+        std::vector<float> deltaColorBlue;
+        std::vector<float> deltaColorAlpha;
+
+        std::vector<float> size;
+        std::vector<float> deltaSize;
+        std::vector<float> rotation; // degrees
+        std::vector<float> deltaRotation;
+
+        // gravity emitter
+        std::vector<float> directionX;
+        std::vector<float> directionY;
+        std::vector<float> radialAcceleration;
+        std::vector<float> tangentialAcceleration;
+
+        // radius emitter
+        std::vector<float> angle; // radians
+        std::vector<float> degreesPerSecond; // radians, despite the name
+        std::vector<float> radius;
+        std::vector<float> deltaRadius;
+
+    private:
+        template <class Step>
+        void update(float step, Step emitterStep, graphics::Vertex* vertices);
+
+        void writeQuads(std::uint32_t first, std::uint32_t particleCount, graphics::Vertex* vertices) const noexcept;
+
+        // replaces the dead particles with the last ones, like the particle systems always did, so that
+        // the order of the particles does not depend on the vectorization
+        void removeDead(graphics::Vertex* vertices) noexcept;
+
+        std::uint32_t count = 0;
+        std::uint32_t capacity = 0;
+    };
+}
+
+#endif // OUZEL_SCENE_PARTICLESTORE_HPP
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 #include <stdexcept>
 #include "ParticleSystem.hpp"
 #include "SceneManager.hpp"
@@ -19,6 +20,25 @@ namespace ouzel::scene
     namespace
     {
         constexpr float updateStep = 1.0F / 60.0F;
+
+        template <typename T>
+        std::vector<T> createIndices(std::uint32_t particleCount)
+        {
+            std::vector<T> indices;
+            indices.reserve(particleCount * 6);
+
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+            {
+                indices.push_back(static_cast<T>(i * 4 + 0));
+                indices.push_back(static_cast<T>(i * 4 + 1));
+                indices.push_back(static_cast<T>(i * 4 + 2));
+                indices.push_back(static_cast<T>(i * 4 + 1));
+                indices.push_back(static_cast<T>(i * 4 + 3));
+                indices.push_back(static_cast<T>(i * 4 + 2));
+            }
+
+            return indices;
+        }
     }
 
     ParticleSystem::ParticleSystem():
@@ -49,40 +69,40 @@ namespace ouzel::scene
                         renderViewProjection,
                         wireframe);
 
-        if (particleCount)
+        if (particles.getCount() && actor)
         {
             if (needsMeshUpdate)
             {
-                updateParticleMesh();
+                // the quads are written by the last update step, only the ones of the live particles are uploaded
+                vertexBuffer->setData(vertices.data(),
+                                      static_cast<std::uint32_t>(particles.getCount() * 4 * sizeof(graphics::Vertex)));
                 needsMeshUpdate = false;
             }
 
+            // the particles of the parent position type are relative to the position of the actor
+            Matrix4F parentTranslation;
+            parentTranslation.setTranslation(actor->getPosition().v[0], actor->getPosition().v[1], 0.0F);
+
             const Matrix4F transform =
-                (particleSystemData.positionType == ParticleSystemData::PositionType::free ||
-                 particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
+                (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
                 renderViewProjection :
+                (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
+                renderViewProjection * parentTranslation :
                 (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
                 renderViewProjection * transformMatrix :
                 throw std::runtime_error("Invalid position type");
 
             const float colorVector[] = {1.0F, 1.0F, 1.0F, opacity};
 
-            std::vector<std::vector<float>> pixelShaderConstants(1);
-            pixelShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(transform.m), std::end(transform.m)};
-
             engine->getGraphics()->setPipelineState(blendState->getResource(),
                                                     shader->getResource(),
                                                     graphics::CullMode::none,
                                                     wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-            engine->getGraphics()->setShaderConstants(pixelShaderConstants,
-                                                      vertexShaderConstants);
+            engine->getGraphics()->setShaderConstants({colorVector}, {transform.m});
             engine->getGraphics()->setTextures({wireframe ? whitePixelTexture->getResource() : texture->getResource()});
             engine->getGraphics()->draw(indexBuffer->getResource(),
-                                        particleCount * 6,
-                                        sizeof(std::uint16_t),
+                                        particles.getCount() * 6,
+                                        indexSize,
                                         vertexBuffer->getResource(),
                                         graphics::DrawMode::triangleList,
                                         0);
@@ -103,14 +123,14 @@ namespace ouzel::scene
             {
                 const float rate = 1.0F / particleSystemData.emissionRate;
 
-                if (particleCount < particleSystemData.maxParticles)
+                if (particles.getCount() < particleSystemData.maxParticles)
                 {
                     emitCounter += updateStep;
                     if (emitCounter < 0.0F)
                         emitCounter = 0.0F;
                 }
 
-                const auto emitCount = static_cast<std::uint32_t>(std::min(static_cast<float>(particleSystemData.maxParticles - particleCount), emitCounter / rate));
+                const auto emitCount = static_cast<std::uint32_t>(std::min(static_cast<float>(particleSystemData.maxParticles - particles.getCount()), emitCounter / rate));
                 emitParticles(emitCount);
                 emitCounter -= rate * emitCount;
 
@@ -123,7 +143,7 @@ namespace ouzel::scene
                     stop();
                 }
             }
-            else if (active && !particleCount)
+            else if (active && !particles.getCount())
             {
                 active = false;
                 updateHandler.remove();
@@ -138,71 +158,14 @@ namespace ouzel::scene
 
             if (active)
             {
-                for (std::uint32_t counter = particleCount; counter > 0; --counter)
-                {
-                    const std::size_t i = counter - 1;
+                // the quads are only written by the last step of the update
+                graphics::Vertex* stepVertices = (timeSinceUpdate < updateStep) ? vertices.data() : nullptr;
+                const float positionFactor = particleSystemData.yCoordFlipped ? 1.0F : 0.0F;
 
-                    particles[i].life -= updateStep;
-
-                    if (particles[i].life >= 0.0F)
-                    {
-                        if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
-                        {
-                            Vector2F tmp;
-                            Vector2F radial;
-                            Vector2F tangential;
-
-                            // radial acceleration
-                            if (particles[i].position.v[0] == 0.0F || particles[i].position.v[1] == 0.0F)
-                                radial = particles[i].position.normalized();
-
-                            tangential = radial;
-                            radial *= particles[i].radialAcceleration;
-
-                            // tangential acceleration
-                            std::swap(tangential.v[0], tangential.v[1]);
-                            tangential.v[0] *= - particles[i].tangentialAcceleration;
-                            tangential.v[1] *= particles[i].tangentialAcceleration;
-
-                            // (gravity + radial + tangential) * updateStep
-                            tmp.v[0] = radial.v[0] + tangential.v[0] + particleSystemData.gravity.v[0];
-                            tmp.v[1] = radial.v[1] + tangential.v[1] + particleSystemData.gravity.v[1];
-                            tmp *= updateStep;
-
-                            particles[i].direction.v[0] += tmp.v[0];
-                            particles[i].direction.v[1] += tmp.v[1];
-                            tmp.v[0] = particles[i].direction.v[0] * updateStep * (particleSystemData.yCoordFlipped ? 1.0F : 0.0F);
-                            tmp.v[1] = particles[i].direction.v[1] * updateStep * (particleSystemData.yCoordFlipped ? 1.0F : 0.0F);
-                            particles[i].position.v[0] += tmp.v[0];
-                            particles[i].position.v[1] += tmp.v[1];
-                        }
-                        else
-                        {
-                            particles[i].angle += particles[i].degreesPerSecond * updateStep;
-                            particles[i].radius += particles[i].deltaRadius * updateStep;
-                            particles[i].position.v[0] = -std::cos(particles[i].angle) * particles[i].radius;
-                            particles[i].position.v[1] = -std::sin(particles[i].angle) * particles[i].radius * (particleSystemData.yCoordFlipped ? 1.0F : 0.0F);
-                        }
-
-                        // color r,g,b,a
-                        particles[i].colorRed += particles[i].deltaColorRed * updateStep;
-                        particles[i].colorGreen += particles[i].deltaColorGreen * updateStep;
-                        particles[i].colorBlue += particles[i].deltaColorBlue * updateStep;
-                        particles[i].colorAlpha += particles[i].deltaColorAlpha * updateStep;
-
-                        // size
-                        particles[i].size += (particles[i].deltaSize * updateStep);
-                        particles[i].size = std::max(0.0F, particles[i].size);
-
-                        // angle
-                        particles[i].rotation += particles[i].deltaRotation * updateStep;
-                    }
-                    else
-                    {
-                        particles[i] = particles[particleCount - 1];
-                        --particleCount;
-                    }
-                }
+                if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
+                    particles.updateGravity(updateStep, particleSystemData.gravity, positionFactor, stepVertices);
+                else
+                    particles.updateRadius(updateStep, positionFactor, stepVertices);
 
                 needsMeshUpdate = true;
                 needsBoundingBoxUpdate = true;
@@ -214,25 +177,34 @@ namespace ouzel::scene
             // Update bounding box
             boundingBox.reset();
 
-            if (particleSystemData.positionType == ParticleSystemData::PositionType::free ||
-                particleSystemData.positionType == ParticleSystemData::PositionType::parent)
+            Vector2F min;
+            Vector2F max;
+
+            if (particles.getBounds(min, max))
             {
-                if (actor)
+                if (particleSystemData.positionType == ParticleSystemData::PositionType::free ||
+                    particleSystemData.positionType == ParticleSystemData::PositionType::parent)
                 {
-                    const auto& inverseTransform = actor->getInverseTransform();
-
-                    for (std::uint32_t i = 0; i < particleCount; ++i)
+                    if (actor)
                     {
-                        auto position = Vector3F(particles[i].position);
-                        inverseTransform.transformPoint(position);
-                        boundingBox.insertPoint(position);
+                        const auto& inverseTransform = actor->getInverseTransform();
+
+                        for (const auto& corner : {Vector3F{min.v[0], min.v[1], 0.0F},
+                                                   Vector3F{max.v[0], min.v[1], 0.0F},
+                                                   Vector3F{min.v[0], max.v[1], 0.0F},
+                                                   Vector3F{max.v[0], max.v[1], 0.0F}})
+                        {
+                            auto position = corner;
+                            inverseTransform.transformPoint(position);
+                            boundingBox.insertPoint(position);
+                        }
                     }
                 }
-            }
-            else if (particleSystemData.positionType == ParticleSystemData::PositionType::grouped)
-            {
-                for (std::uint32_t i = 0; i < particleCount; ++i)
-                    boundingBox.insertPoint(Vector3F(particles[i].position));
+                else if (particleSystemData.positionType == ParticleSystemData::PositionType::grouped)
+                {
+                    boundingBox.insertPoint(Vector3F(min));
+                    boundingBox.insertPoint(Vector3F(max));
+                }
             }
         }
     }
@@ -263,7 +235,7 @@ namespace ouzel::scene
                 engine->getEventDispatcher().addEventHandler(updateHandler);
             }
 
-            if (particleCount == 0)
+            if (particles.getCount() == 0)
             {
                 auto startEvent = std::make_unique<AnimationEvent>();
                 startEvent->type = Event::Type::animationStart;
@@ -283,24 +255,19 @@ namespace ouzel::scene
         emitCounter = 0.0F;
         elapsed = 0.0F;
         timeSinceUpdate = 0.0F;
-        particleCount = 0;
+        particles.clear();
         finished = false;
     }
 
     void ParticleSystem::createParticleMesh()
     {
-        indices.reserve(particleSystemData.maxParticles * 6);
-        vertices.reserve(particleSystemData.maxParticles * 4);
+        const auto maxParticles = particleSystemData.maxParticles;
 
-        for (std::uint16_t i = 0; i < particleSystemData.maxParticles; ++i)
-        {
-            indices.push_back(i * 4 + 0);
-            indices.push_back(i * 4 + 1);
-            indices.push_back(i * 4 + 2);
-            indices.push_back(i * 4 + 1);
-            indices.push_back(i * 4 + 3);
-            indices.push_back(i * 4 + 2);
+        vertices.clear();
+        vertices.reserve(maxParticles * 4);
 
+        for (std::uint32_t i = 0; i < maxParticles; ++i)
+        {
             vertices.emplace_back(Vector3F{-1.0F, -1.0F, 0.0F}, Color::white(),
                                   Vector2F{0.0F, 1.0F}, Vector3F{0.0F, 0.0F, -1.0F});
             vertices.emplace_back(Vector3F{1.0F, -1.0F, 0.0F}, Color::white(),
@@ -311,11 +278,27 @@ namespace ouzel::scene
                                   Vector2F{1.0F, 0.0F}, Vector3F{0.0F, 0.0F, -1.0F});
         }
 
-        indexBuffer = std::make_unique<graphics::Buffer>(*engine->getGraphics(),
-                                                         graphics::BufferType::index,
-                                                         graphics::Flags::none,
-                                                         indices.data(),
-                                                         static_cast<std::uint32_t>(getVectorSize(indices)));
+        // 16-bit indices can address the vertices of up to 16384 particles
+        if (maxParticles * 4 > std::numeric_limits<std::uint16_t>::max() + 1U)
+        {
+            const auto indices = createIndices<std::uint32_t>(maxParticles);
+            indexSize = sizeof(std::uint32_t);
+            indexBuffer = std::make_unique<graphics::Buffer>(*engine->getGraphics(),
+                                                             graphics::BufferType::index,
+                                                             graphics::Flags::none,
+                                                             indices.data(),
+                                                             static_cast<std::uint32_t>(getVectorSize(indices)));
+        }
+        else
+        {
+            const auto indices = createIndices<std::uint16_t>(maxParticles);
+            indexSize = sizeof(std::uint16_t);
+            indexBuffer = std::make_unique<graphics::Buffer>(*engine->getGraphics(),
+                                                             graphics::BufferType::index,
+                                                             graphics::Flags::none,
+                                                             indices.data(),
+                                                             static_cast<std::uint32_t>(getVectorSize(indices)));
+        }
 
         vertexBuffer = std::make_unique<graphics::Buffer>(*engine->getGraphics(),
                                                           graphics::BufferType::vertex,
@@ -323,64 +306,13 @@ namespace ouzel::scene
                                                           vertices.data(),
                                                           static_cast<std::uint32_t>(getVectorSize(vertices)));
 
-        particles.resize(particleSystemData.maxParticles);
-    }
-
-    void ParticleSystem::updateParticleMesh()
-    {
-        if (actor)
-        {
-            for (std::uint32_t counter = particleCount; counter > 0; --counter)
-            {
-                const std::size_t i = counter - 1;
-
-                const Vector2F position = (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
-                    particles[i].position :
-                    (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
-                    Vector2F(actor->getPosition()) + particles[i].position :
-                    (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
-                    Vector2F() :
-                    throw std::runtime_error("Invalid position type");
-
-                const float halfSize = particles[i].size / 2.0F;
-                Vector2F v1(-halfSize, -halfSize);
-                Vector2F v2(halfSize, halfSize);
-
-                const float r = -degToRad(particles[i].rotation);
-                const float cr = std::cos(r);
-                const float sr = std::sin(r);
-
-                const Vector2F a(v1.v[0] * cr - v1.v[1] * sr, v1.v[0] * sr + v1.v[1] * cr);
-                const Vector2F b(v2.v[0] * cr - v1.v[1] * sr, v2.v[0] * sr + v1.v[1] * cr);
-                const Vector2F c(v2.v[0] * cr - v2.v[1] * sr, v2.v[0] * sr + v2.v[1] * cr);
-                const Vector2F d(v1.v[0] * cr - v2.v[1] * sr, v1.v[0] * sr + v2.v[1] * cr);
-
-                const Color color(particles[i].colorRed,
-                                  particles[i].colorGreen,
-                                  particles[i].colorBlue,
-                                  particles[i].colorAlpha);
-
-                vertices[i * 4 + 0].position = Vector3F(a + position);
-                vertices[i * 4 + 0].color = color;
-
-                vertices[i * 4 + 1].position = Vector3F(b + position);
-                vertices[i * 4 + 1].color = color;
-
-                vertices[i * 4 + 2].position = Vector3F(d + position);
-                vertices[i * 4 + 2].color = color;
-
-                vertices[i * 4 + 3].position = Vector3F(c + position);
-                vertices[i * 4 + 3].color = color;
-            }
-
-            vertexBuffer->setData(vertices.data(), static_cast<std::uint32_t>(getVectorSize(vertices)));
-        }
+        particles.setCapacity(maxParticles);
     }
 
     void ParticleSystem::emitParticles(std::uint32_t count)
     {
-        if (particleCount + count > particleSystemData.maxParticles)
-            count = particleSystemData.maxParticles - particleCount;
+        if (particles.getCount() + count > particleSystemData.maxParticles)
+            count = particleSystemData.maxParticles - particles.getCount();
 
         if (count && actor)
         {
@@ -392,42 +324,46 @@ namespace ouzel::scene
                 Vector2F() :
                 throw std::runtime_error("Invalid position type");
 
-            for (std::uint32_t i = particleCount; i < particleCount + count; ++i)
+            const auto first = particles.add(count);
+
+            for (std::uint32_t i = first; i < first + count; ++i)
             {
                 if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
                 {
-                    particles[i].life = std::max(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F);
+                    particles.life[i] = std::max(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F);
 
-                    particles[i].position = particleSystemData.sourcePosition + position + Vector2F(particleSystemData.sourcePositionVariance.v[0] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine),
-                                                                                                    particleSystemData.sourcePositionVariance.v[1] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
+                    const auto particlePosition = particleSystemData.sourcePosition + position + Vector2F(particleSystemData.sourcePositionVariance.v[0] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine),
+                                                                                                         particleSystemData.sourcePositionVariance.v[1] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
+                    particles.positionX[i] = particlePosition.v[0];
+                    particles.positionY[i] = particlePosition.v[1];
 
-                    particles[i].size = std::max(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F);
+                    particles.size[i] = std::max(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F);
 
                     const float finishSize = std::max(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F);
-                    particles[i].deltaSize = (finishSize - particles[i].size) / particles[i].life;
+                    particles.deltaSize[i] = (finishSize - particles.size[i]) / particles.life[i];
 
-                    particles[i].colorRed = std::clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    particles[i].colorGreen = std::clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    particles[i].colorBlue = std::clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
-                    particles[i].colorAlpha = std::clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
+                    particles.colorRed[i] = std::clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
+                    particles.colorGreen[i] = std::clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
+                    particles.colorBlue[i] = std::clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
+                    particles.colorAlpha[i] = std::clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
 
                     const float finishColorRed = std::clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
                     const float finishColorGreen = std::clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
                     const float finishColorBlue = std::clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
                     const float finishColorAlpha = std::clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine), 0.0F, 1.0F);
 
-                    particles[i].deltaColorRed = (finishColorRed - particles[i].colorRed) / particles[i].life;
-                    particles[i].deltaColorGreen = (finishColorGreen - particles[i].colorGreen) / particles[i].life;
-                    particles[i].deltaColorBlue = (finishColorBlue - particles[i].colorBlue) / particles[i].life;
-                    particles[i].deltaColorAlpha = (finishColorAlpha - particles[i].colorAlpha) / particles[i].life;
+                    particles.deltaColorRed[i] = (finishColorRed - particles.colorRed[i]) / particles.life[i];
+                    particles.deltaColorGreen[i] = (finishColorGreen - particles.colorGreen[i]) / particles.life[i];
+                    particles.deltaColorBlue[i] = (finishColorBlue - particles.colorBlue[i]) / particles.life[i];
+                    particles.deltaColorAlpha[i] = (finishColorAlpha - particles.colorAlpha[i]) / particles.life[i];
 
-                    particles[i].rotation = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
+                    particles.rotation[i] = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
 
                     const float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                    particles[i].deltaRotation = (finishRotation - particles[i].rotation) / particles[i].life;
+                    particles.deltaRotation[i] = (finishRotation - particles.rotation[i]) / particles.life[i];
 
-                    particles[i].radialAcceleration = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                    particles[i].tangentialAcceleration = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
+                    particles.radialAcceleration[i] = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
+                    particles.tangentialAcceleration[i] = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
 
                     if (particleSystemData.rotationIsDir)
                     {
@@ -435,8 +371,9 @@ namespace ouzel::scene
                         const Vector2F v(std::cos(a), std::sin(a));
                         const float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
                         const auto dir = v * s;
-                        particles[i].direction = dir;
-                        particles[i].rotation = -radToDeg(dir.getAngle());
+                        particles.directionX[i] = dir.v[0];
+                        particles.directionY[i] = dir.v[1];
+                        particles.rotation[i] = -radToDeg(dir.getAngle());
                     }
                     else
                     {
@@ -444,21 +381,20 @@ namespace ouzel::scene
                         const Vector2F v(std::cos(a), std::sin(a));
                         const float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
                         const auto dir = v * s;
-                        particles[i].direction = dir;
+                        particles.directionX[i] = dir.v[0];
+                        particles.directionY[i] = dir.v[1];
                     }
                 }
                 else
                 {
-                    particles[i].radius = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                    particles[i].angle = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
-                    particles[i].degreesPerSecond = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
+                    particles.radius[i] = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
+                    particles.angle[i] = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
+                    particles.degreesPerSecond[i] = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine));
 
                     const float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(core::randomEngine);
-                    particles[i].deltaRadius = (endRadius - particles[i].radius) / particles[i].life;
+                    particles.deltaRadius[i] = (endRadius - particles.radius[i]) / particles.life[i];
                 }
             }
-
-            particleCount += count;
         }
     }
 }
@@ -7,6 +7,7 @@
 #include <vector>
 #include <functional>
 #include "Component.hpp"
+#include "ParticleStore.hpp"
 #include "../math/Color.hpp"
 #include "../math/Vector.hpp"
 #include "../events/EventHandler.hpp"
@@ -147,7 +148,6 @@ namespace ouzel::scene
         void update(float delta);
 
         void createParticleMesh();
-        void updateParticleMesh();
 
         void emitParticles(std::uint32_t count);
 
@@ -158,49 +158,13 @@ namespace ouzel::scene
         std::shared_ptr<graphics::Texture> texture;
         std::shared_ptr<graphics::Texture> whitePixelTexture;
 
-        struct Particle final
-        {
-            float life = 0.0F;
-
-            Vector2F position;
-
-            float colorRed = 0.0F;
-            float colorGreen = 0.0F;
-            float colorBlue = 0.0F;
-            float colorAlpha = 0.0F;
-
-            float deltaColorRed = 0.0F;
-            float deltaColorGreen = 0.0F;
-            float deltaColorBlue = 0.0F;
-            float deltaColorAlpha = 0.0F;
-
-            float angle = 0.0F;
-            float speed = 0.0F;
-
-            float size = 0.0F;
-            float deltaSize = 0.0F;
-
-            float rotation = 0.0F;
-            float deltaRotation = 0.0F;
-
-            float radialAcceleration = 0.0F;
-            float tangentialAcceleration = 0.0F;
-
-            Vector2F direction;
-            float radius = 0.0F;
-            float degreesPerSecond = 0.0F;
-            float deltaRadius = 0.0F;
-        };
-
-        std::vector<Particle> particles;
+        ParticleStore particles;
 
         std::unique_ptr<graphics::Buffer> indexBuffer;
         std::unique_ptr<graphics::Buffer> vertexBuffer;
 
-        std::vector<std::uint16_t> indices;
         std::vector<graphics::Vertex> vertices;
-
-        std::uint32_t particleCount = 0;
+        std::uint32_t indexSize = sizeof(std::uint16_t);
 
         float emitCounter = 0.0F;
         float elapsed = 0.0F;
@@ -36,6 +36,23 @@ namespace ouzel::scene
             return a->getOrder() > b->getOrder();
         });
 
+        if (parallelTraversal)
+        {
+            // transforms and spatial indices are updated serially, only the culling is parallel
+            drawJobs.clear();
+            for (Layer* layer : layers)
+            {
+                layer->prepareDraw();
+
+                for (std::size_t i = 0; i < layer->getCameras().size(); ++i)
+                    drawJobs.emplace_back(layer, i);
+            }
+
+            engine->getJobSystem().parallelFor(drawJobs.size(), [this](std::size_t i) {
+                drawJobs[i].first->buildDrawQueue(drawJobs[i].second);
+            });
+        }
+
         std::set<graphics::RenderTarget*> clearedRenderTargets;
 
         for (Layer* layer : layers)
@@ -56,7 +73,10 @@ namespace ouzel::scene
                 }
             }
 
-            layer->draw();
+            if (parallelTraversal)
+                layer->submitDrawQueues();
+            else
+                layer->draw();
         }
 
         engine->getGraphics()->present();
@@ -45,6 +45,11 @@ namespace ouzel::scene
 
         virtual void recalculateProjection();
 
+        // cull and build the draw queues of all the layer cameras with the engine job system,
+        // the draw calls are still submitted in the layer and camera order
+        auto isParallelTraversalEnabled() const noexcept { return parallelTraversal; }
+        void setParallelTraversalEnabled(bool enabled) noexcept { parallelTraversal = enabled; }
+
         std::pair<Actor*, Vector3F> pickActor(const Vector2F& position, bool renderTargets = false) const;
         std::vector<std::pair<Actor*, Vector3F>> pickActors(const Vector2F& position, bool renderTargets = false) const;
         std::vector<Actor*> pickActors(const std::vector<Vector2F>& edges, bool renderTargets = false) const;
@@ -72,7 +77,10 @@ namespace ouzel::scene
 
         std::unordered_map<std::uint64_t, std::pair<Actor*, Vector3F>> pointerDownOnActors;
 
+        std::vector<std::pair<Layer*, std::size_t>> drawJobs;
+
         bool entered = false;
+        bool parallelTraversal = false;
     };
 }
 
@@ -44,18 +44,11 @@ namespace ouzel::scene
 
         for (const DrawCommand& drawCommand : drawCommands)
         {
-            std::vector<std::vector<float>> fragmentShaderConstants(1);
-            fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
-
             engine->getGraphics()->setPipelineState(blendState->getResource(),
                                                     shader->getResource(),
                                                     graphics::CullMode::none,
                                                     wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-            engine->getGraphics()->setShaderConstants(fragmentShaderConstants,
-                                                      vertexShaderConstants);
+            engine->getGraphics()->setShaderConstants({colorVector}, {modelViewProj.m});
             engine->getGraphics()->draw(indexBuffer.getResource(),
                                         drawCommand.indexCount,
                                         sizeof(std::uint16_t),
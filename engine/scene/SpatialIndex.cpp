@@ -0,0 +1,329 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cassert>
+#include "SpatialIndex.hpp"
+
+namespace ouzel::scene
+{
+    namespace
+    {
+        // fraction of the box size added on each side of the enlarged boxes
+        constexpr float boxMargin = 0.1F;
+
+        Box3F combine(const Box3F& a, const Box3F& b) noexcept
+        {
+            Box3F result = a;
+            result.merge(b);
+            return result;
+        }
+
+        // sum of the box extents, well defined also for flat (2D) boxes
+        float getCost(const Box3F& box) noexcept
+        {
+            return (box.max.v[0] - box.min.v[0]) +
+                (box.max.v[1] - box.min.v[1]) +
+                (box.max.v[2] - box.min.v[2]);
+        }
+
+        bool contains(const Box3F& outer, const Box3F& inner) noexcept
+        {
+            for (std::size_t i = 0; i < 3; ++i)
+                if (inner.min.v[i] < outer.min.v[i] || inner.max.v[i] > outer.max.v[i]) return false;
+            return true;
+        }
+
+        Box3F enlarge(const Box3F& box) noexcept
+        {
+            Box3F result = box;
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const auto margin = (box.max.v[i] - box.min.v[i]) * boxMargin;
+                result.min.v[i] -= margin;
+                result.max.v[i] += margin;
+            }
+            return result;
+        }
+    }
+
+    SpatialIndex::ProxyId SpatialIndex::createProxy(const Box3F& box, Actor* actor)
+    {
+        const auto proxy = allocateNode();
+        Node& node = nodes[static_cast<std::size_t>(proxy)];
+        node.box = enlarge(box);
+        node.actor = actor;
+        node.height = 0;
+
+        insertLeaf(proxy);
+        ++proxyCount;
+
+        return proxy;
+    }
+
+    void SpatialIndex::destroyProxy(ProxyId proxy)
+    {
+        assert(nodes[static_cast<std::size_t>(proxy)].isLeaf());
+
+        removeLeaf(proxy);
+        freeNode(proxy);
+        --proxyCount;
+    }
+
+    bool SpatialIndex::moveProxy(ProxyId proxy, const Box3F& box)
+    {
+        Node& node = nodes[static_cast<std::size_t>(proxy)];
+        assert(node.isLeaf());
+
+        if (contains(node.box, box)) return false;
+
+        removeLeaf(proxy);
+        nodes[static_cast<std::size_t>(proxy)].box = enlarge(box);
+        insertLeaf(proxy);
+
+        return true;
+    }
+
+    void SpatialIndex::clear() noexcept
+    {
+        nodes.clear();
+        root = nullNode;
+        freeList = nullNode;
+        proxyCount = 0;
+    }
+
+    std::int32_t SpatialIndex::getHeight() const noexcept
+    {
+        return (root == nullNode) ? 0 : nodes[static_cast<std::size_t>(root)].height;
+    }
+
+    SpatialIndex::NodeId SpatialIndex::allocateNode()
+    {
+        if (freeList == nullNode)
+        {
+            nodes.emplace_back();
+            return static_cast<NodeId>(nodes.size() - 1);
+        }
+
+        const auto nodeId = freeList;
+        Node& node = nodes[static_cast<std::size_t>(nodeId)];
+        freeList = node.parent;
+        node = Node();
+
+        return nodeId;
+    }
+
+    void SpatialIndex::freeNode(NodeId nodeId) noexcept
+    {
+        Node& node = nodes[static_cast<std::size_t>(nodeId)];
+        node.actor = nullptr;
+        node.child1 = nullNode;
+        node.child2 = nullNode;
+        node.height = -1;
+        node.parent = freeList;
+        freeList = nodeId;
+    }
+
+    void SpatialIndex::insertLeaf(NodeId leaf)
+    {
+        if (root == nullNode)
+        {
+            root = leaf;
+            nodes[static_cast<std::size_t>(root)].parent = nullNode;
+            return;
+        }
+
+        // find the best sibling by descending towards the cheapest child
+        const Box3F leafBox = nodes[static_cast<std::size_t>(leaf)].box;
+        NodeId index = root;
+        while (!nodes[static_cast<std::size_t>(index)].isLeaf())
+        {
+            const Node& node = nodes[static_cast<std::size_t>(index)];
+            const auto cost = getCost(node.box);
+            const auto combinedCost = getCost(combine(node.box, leafBox));
+
+            // cost of creating a new parent for this node and the new leaf
+            const auto siblingCost = 2.0F * combinedCost;
+
+            // minimum cost of pushing the leaf further down the tree
+            const auto inheritanceCost = 2.0F * (combinedCost - cost);
+
+            const auto getChildCost = [this, &leafBox, inheritanceCost](NodeId child) {
+                const Node& childNode = nodes[static_cast<std::size_t>(child)];
+                const auto childCombinedCost = getCost(combine(childNode.box, leafBox));
+                return childNode.isLeaf() ?
+                    childCombinedCost + inheritanceCost :
+                    childCombinedCost - getCost(childNode.box) + inheritanceCost;
+            };
+
+            const auto cost1 = getChildCost(node.child1);
+            const auto cost2 = getChildCost(node.child2);
+
+            if (siblingCost < cost1 && siblingCost < cost2) break;
+
+            index = (cost1 < cost2) ? node.child1 : node.child2;
+        }
+
+        const auto sibling = index;
+
+        // create a new parent
+        const auto oldParent = nodes[static_cast<std::size_t>(sibling)].parent;
+        const auto newParent = allocateNode();
+        Node& parentNode = nodes[static_cast<std::size_t>(newParent)];
+        parentNode.parent = oldParent;
+        parentNode.box = combine(leafBox, nodes[static_cast<std::size_t>(sibling)].box);
+        parentNode.height = nodes[static_cast<std::size_t>(sibling)].height + 1;
+        parentNode.child1 = sibling;
+        parentNode.child2 = leaf;
+
+        if (oldParent != nullNode)
+        {
+            Node& oldParentNode = nodes[static_cast<std::size_t>(oldParent)];
+            if (oldParentNode.child1 == sibling)
+                oldParentNode.child1 = newParent;
+            else
+                oldParentNode.child2 = newParent;
+        }
+        else
+            root = newParent;
+
+        nodes[static_cast<std::size_t>(sibling)].parent = newParent;
+        nodes[static_cast<std::size_t>(leaf)].parent = newParent;
+
+        // walk back up the tree fixing heights and boxes
+        index = nodes[static_cast<std::size_t>(leaf)].parent;
+        while (index != nullNode)
+        {
+            index = balance(index);
+
+            Node& node = nodes[static_cast<std::size_t>(index)];
+            const Node& child1 = nodes[static_cast<std::size_t>(node.child1)];
+            const Node& child2 = nodes[static_cast<std::size_t>(node.child2)];
+
+            node.height = 1 + std::max(child1.height, child2.height);
+            node.box = combine(child1.box, child2.box);
+
+            index = node.parent;
+        }
+    }
+
+    void SpatialIndex::removeLeaf(NodeId leaf)
+    {
+        if (leaf == root)
+        {
+            root = nullNode;
+            return;
+        }
+
+        const auto parent = nodes[static_cast<std::size_t>(leaf)].parent;
+        const auto grandParent = nodes[static_cast<std::size_t>(parent)].parent;
+        const auto sibling = (nodes[static_cast<std::size_t>(parent)].child1 == leaf) ?
+            nodes[static_cast<std::size_t>(parent)].child2 :
+            nodes[static_cast<std::size_t>(parent)].child1;
+
+        if (grandParent != nullNode)
+        {
+            // connect the sibling to the grand parent and destroy the parent
+            Node& grandParentNode = nodes[static_cast<std::size_t>(grandParent)];
+            if (grandParentNode.child1 == parent)
+                grandParentNode.child1 = sibling;
+            else
+                grandParentNode.child2 = sibling;
+
+            nodes[static_cast<std::size_t>(sibling)].parent = grandParent;
+            freeNode(parent);
+
+            auto index = grandParent;
+            while (index != nullNode)
+            {
+                index = balance(index);
+
+                Node& node = nodes[static_cast<std::size_t>(index)];
+                const Node& child1 = nodes[static_cast<std::size_t>(node.child1)];
+                const Node& child2 = nodes[static_cast<std::size_t>(node.child2)];
+
+                node.box = combine(child1.box, child2.box);
+                node.height = 1 + std::max(child1.height, child2.height);
+
+                index = node.parent;
+            }
+        }
+        else
+        {
+            root = sibling;
+            nodes[static_cast<std::size_t>(sibling)].parent = nullNode;
+            freeNode(parent);
+        }
+    }
+
+    // performs a left or right rotation if node a is imbalanced, returns the new root of the subtree
+    SpatialIndex::NodeId SpatialIndex::balance(NodeId a)
+    {
+        Node& nodeA = nodes[static_cast<std::size_t>(a)];
+        if (nodeA.isLeaf() || nodeA.height < 2) return a;
+
+        const auto b = nodeA.child1;
+        const auto c = nodeA.child2;
+        Node& nodeB = nodes[static_cast<std::size_t>(b)];
+        Node& nodeC = nodes[static_cast<std::size_t>(c)];
+
+        const auto heightDifference = nodeC.height - nodeB.height;
+
+        const auto rotate = [this, a, &nodeA](NodeId up, NodeId down, bool upIsChild2) {
+            Node& upNode = nodes[static_cast<std::size_t>(up)];
+            const auto f = upNode.child1;
+            const auto g = upNode.child2;
+            Node& nodeF = nodes[static_cast<std::size_t>(f)];
+            Node& nodeG = nodes[static_cast<std::size_t>(g)];
+            Node& downNode = nodes[static_cast<std::size_t>(down)];
+
+            // swap a and up
+            upNode.child1 = a;
+            upNode.parent = nodeA.parent;
+            nodeA.parent = up;
+
+            if (upNode.parent != nullNode)
+            {
+                Node& upParent = nodes[static_cast<std::size_t>(upNode.parent)];
+                if (upParent.child1 == a)
+                    upParent.child1 = up;
+                else
+                    upParent.child2 = up;
+            }
+            else
+                root = up;
+
+            // keep the taller grandchild under up and move the other one under a
+            const auto keep = (nodeF.height > nodeG.height) ? f : g;
+            const auto move = (nodeF.height > nodeG.height) ? g : f;
+            Node& keepNode = nodes[static_cast<std::size_t>(keep)];
+            Node& moveNode = nodes[static_cast<std::size_t>(move)];
+
+            upNode.child2 = keep;
+            if (upIsChild2)
+                nodeA.child2 = move;
+            else
+                nodeA.child1 = move;
+            moveNode.parent = a;
+
+            nodeA.box = combine(downNode.box, moveNode.box);
+            upNode.box = combine(nodeA.box, keepNode.box);
+
+            nodeA.height = 1 + std::max(downNode.height, moveNode.height);
+            upNode.height = 1 + std::max(nodeA.height, keepNode.height);
+        };
+
+        if (heightDifference > 1)
+        {
+            rotate(c, b, true);
+            return c;
+        }
+
+        if (heightDifference < -1)
+        {
+            rotate(b, c, false);
+            return b;
+        }
+
+        return a;
+    }
+}
@@ -0,0 +1,102 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_SPATIALINDEX_HPP
+#define OUZEL_SCENE_SPATIALINDEX_HPP
+
+#include <cstdint>
+#include <vector>
+#include "../math/Box.hpp"
+
+namespace ouzel::scene
+{
+    class Actor;
+
+    // Dynamic bounding volume hierarchy of actor bounding boxes.
+    // Leaves store enlarged boxes, so actors can move a little without
+    // touching the tree, and the tree is kept balanced with rotations.
+    class SpatialIndex final
+    {
+    public:
+        using ProxyId = std::int32_t;
+        static constexpr ProxyId nullProxy = -1;
+
+        ProxyId createProxy(const Box3F& box, Actor* actor);
+        void destroyProxy(ProxyId proxy);
+
+        // returns true if the proxy had to be reinserted
+        bool moveProxy(ProxyId proxy, const Box3F& box);
+
+        auto getActor(ProxyId proxy) const noexcept { return nodes[static_cast<std::size_t>(proxy)].actor; }
+        auto& getEnlargedBox(ProxyId proxy) const noexcept { return nodes[static_cast<std::size_t>(proxy)].box; }
+
+        // calls the callback for every actor whose enlarged box overlaps the given box,
+        // can be called from multiple threads while the tree is not modified
+        template <class F>
+        void query(const Box3F& box, F callback) const
+        {
+            if (root == nullNode) return;
+
+            // the stack never holds more nodes than the height of the tree plus one
+            std::vector<NodeId> stack;
+            stack.reserve(static_cast<std::size_t>(nodes[static_cast<std::size_t>(root)].height) + 1);
+            stack.push_back(root);
+
+            while (!stack.empty())
+            {
+                const Node& node = nodes[static_cast<std::size_t>(stack.back())];
+                stack.pop_back();
+
+                if (!overlaps(node.box, box)) continue;
+
+                if (node.isLeaf())
+                    callback(node.actor);
+                else
+                {
+                    stack.push_back(node.child1);
+                    stack.push_back(node.child2);
+                }
+            }
+        }
+
+        void clear() noexcept;
+
+        auto getProxyCount() const noexcept { return proxyCount; }
+        std::int32_t getHeight() const noexcept;
+
+    private:
+        using NodeId = std::int32_t;
+        static constexpr NodeId nullNode = -1;
+
+        struct Node final
+        {
+            bool isLeaf() const noexcept { return child1 == nullNode; }
+
+            Box3F box;
+            Actor* actor = nullptr;
+            NodeId parent = nullNode; // next free node when the node is not used
+            NodeId child1 = nullNode;
+            NodeId child2 = nullNode;
+            std::int32_t height = -1; // -1 for free nodes, 0 for leaves
+        };
+
+        static bool overlaps(const Box3F& a, const Box3F& b) noexcept
+        {
+            for (std::size_t i = 0; i < 3; ++i)
+                if (a.max.v[i] < b.min.v[i] || a.min.v[i] > b.max.v[i]) return false;
+            return true;
+        }
+
+        NodeId allocateNode();
+        void freeNode(NodeId nodeId) noexcept;
+        void insertLeaf(NodeId leaf);
+        void removeLeaf(NodeId leaf);
+        NodeId balance(NodeId a);
+
+        std::vector<Node> nodes;
+        NodeId root = nullNode;
+        NodeId freeList = nullNode;
+        std::size_t proxyCount = 0;
+    };
+}
+
+#endif // OUZEL_SCENE_SPATIALINDEX_HPP
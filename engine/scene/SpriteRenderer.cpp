@@ -21,7 +21,7 @@ namespace ouzel::scene
                              const Vector2F& pivot):
         name(frameName)
     {
-        const std::vector<std::uint16_t> indices = {0, 1, 2, 1, 3, 2};
+        indices = {0, 1, 2, 1, 3, 2};
         indexCount = static_cast<std::uint32_t>(indices.size());
 
         Vector2F textCoords[4];
@@ -55,7 +55,7 @@ namespace ouzel::scene
             textCoords[3] = Vector2F(rightBottom.v[0], rightBottom.v[1]);
         }
 
-        const std::vector<graphics::Vertex> vertices{
+        vertices = {
             graphics::Vertex(Vector3F{finalOffset.v[0], finalOffset.v[1], 0.0F}, Color::white(),
                              textCoords[0], Vector3F{0.0F, 0.0F, -1.0F}),
             graphics::Vertex(Vector3F{finalOffset.v[0] + frameRectangle.size.v[0], finalOffset.v[1], 0.0F}, Color::white(),
@@ -83,9 +83,11 @@ namespace ouzel::scene
     }
 
     SpriteData::Frame::Frame(const std::string& frameName,
-                             const std::vector<std::uint16_t>& indices,
-                             const std::vector<graphics::Vertex>& vertices):
-        name(frameName)
+                             const std::vector<std::uint16_t>& initIndices,
+                             const std::vector<graphics::Vertex>& initVertices):
+        name(frameName),
+        indices(initIndices),
+        vertices(initVertices)
     {
         indexCount = static_cast<std::uint32_t>(indices.size());
 
@@ -106,13 +108,15 @@ namespace ouzel::scene
     }
 
     SpriteData::Frame::Frame(const std::string& frameName,
-                             const std::vector<std::uint16_t>& indices,
-                             const std::vector<graphics::Vertex>& vertices,
+                             const std::vector<std::uint16_t>& initIndices,
+                             const std::vector<graphics::Vertex>& initVertices,
                              const RectF& frameRectangle,
                              const Size2F& sourceSize,
                              const Vector2F& sourceOffset,
                              const Vector2F& pivot):
-        name(frameName)
+        name(frameName),
+        indices(initIndices),
+        vertices(initVertices)
     {
         indexCount = static_cast<std::uint32_t>(indices.size());
 
@@ -342,41 +346,29 @@ namespace ouzel::scene
             if (currentFrame >= currentAnimation->animation->frames.size())
                 currentFrame = currentAnimation->animation->frames.size() - 1;
 
-            const auto modelViewProj = renderViewProjection * transformMatrix * offsetMatrix;
-            const float colorVector[] = {
+            graphics::Batcher::State state;
+            state.blendState = material->blendState->getResource();
+            state.shader = material->shader->getResource();
+            state.cullMode = graphics::CullMode::none;
+            state.fillMode = wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid;
+            static_assert(graphics::Material::textureLayers <= std::tuple_size_v<graphics::Batcher::Textures>);
+            for (std::size_t i = 0; i < graphics::Material::textureLayers; ++i)
+                state.textures[i] = material->textures[i] ? material->textures[i]->getResource() : 0;
+            state.color = {
                 material->diffuseColor.normR(),
                 material->diffuseColor.normG(),
                 material->diffuseColor.normB(),
                 material->diffuseColor.normA() * opacity * material->opacity
             };
 
-            std::vector<std::vector<float>> fragmentShaderConstants(1);
-            fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
-
-            std::vector<std::size_t> textures;
-            textures.reserve(graphics::Material::textureLayers);
-            for (const std::shared_ptr<graphics::Texture>& texture : material->textures)
-                textures.push_back(texture ? texture->getResource() : 0);
-
-            engine->getGraphics()->setPipelineState(material->blendState->getResource(),
-                                                    material->shader->getResource(),
-                                                    graphics::CullMode::none,
-                                                    wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-            engine->getGraphics()->setShaderConstants(fragmentShaderConstants,
-                                                      vertexShaderConstants);
-            engine->getGraphics()->setTextures(textures);
-
             const auto& frame = currentAnimation->animation->frames[currentFrame];
 
-            engine->getGraphics()->draw(frame.getIndexBuffer()->getResource(),
-                                        frame.getIndexCount(),
-                                        sizeof(std::uint16_t),
-                                        frame.getVertexBuffer()->getResource(),
-                                        graphics::DrawMode::triangleList,
-                                        0);
+            // sprites sharing the material state are merged into a single draw call
+            engine->getGraphics()->getBatcher().draw(state,
+                                                     renderViewProjection,
+                                                     transformMatrix * offsetMatrix,
+                                                     frame.getVertices(),
+                                                     frame.getIndices());
         }
     }
 
@@ -37,12 +37,12 @@ namespace ouzel::scene
                   const Vector2F& pivot);
 
             Frame(const std::string& frameName,
-                  const std::vector<std::uint16_t>& indices,
-                  const std::vector<graphics::Vertex>& vertices);
+                  const std::vector<std::uint16_t>& initIndices,
+                  const std::vector<graphics::Vertex>& initVertices);
 
             Frame(const std::string& frameName,
-                  const std::vector<std::uint16_t>& indices,
-                  const std::vector<graphics::Vertex>& vertices,
+                  const std::vector<std::uint16_t>& initIndices,
+                  const std::vector<graphics::Vertex>& initVertices,
                   const RectF& frameRectangle,
                   const Size2F& sourceSize,
                   const Vector2F& sourceOffset,
@@ -54,6 +54,8 @@ namespace ouzel::scene
             auto getIndexCount() const noexcept { return indexCount; }
             auto& getIndexBuffer() const noexcept { return indexBuffer; }
             auto& getVertexBuffer() const noexcept { return vertexBuffer; }
+            auto& getIndices() const noexcept { return indices; }
+            auto& getVertices() const noexcept { return vertices; }
 
         private:
             std::string name;
@@ -61,6 +63,8 @@ namespace ouzel::scene
             std::uint32_t indexCount = 0;
             std::shared_ptr<graphics::Buffer> indexBuffer;
             std::shared_ptr<graphics::Buffer> vertexBuffer;
+            std::vector<std::uint16_t> indices;
+            std::vector<graphics::Vertex> vertices;
         };
 
         struct Animation final
@@ -99,6 +103,11 @@ namespace ouzel::scene
                   const Matrix4F& renderViewProjection,
                   bool wireframe) override;
 
+        std::uint16_t getRenderStateKey() const noexcept override
+        {
+            return (material && !material->isBlended()) ? material->getStateKey() : 0;
+        }
+
         auto& getMaterial() const noexcept { return material; }
         void setMaterial(const std::shared_ptr<graphics::Material>& newMaterial) { material = newMaterial; }
 
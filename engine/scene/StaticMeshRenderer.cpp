@@ -86,12 +86,6 @@ namespace ouzel::scene
             material->diffuseColor.normA() * opacity * material->opacity
         };
 
-        std::vector<std::vector<float>> fragmentShaderConstants(1);
-        fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-        std::vector<std::vector<float>> vertexShaderConstants(1);
-        vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
-
         std::vector<std::size_t> textures;
         for (const std::shared_ptr<graphics::Texture>& texture : material->textures)
             textures.push_back(texture ? texture->getResource() : 0);
@@ -100,8 +94,7 @@ namespace ouzel::scene
                                                 material->shader->getResource(),
                                                 material->cullMode,
                                                 wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-        engine->getGraphics()->setShaderConstants(fragmentShaderConstants,
-                                                  vertexShaderConstants);
+        engine->getGraphics()->setShaderConstants({colorVector}, {modelViewProj.m});
         engine->getGraphics()->setTextures(textures);
         engine->getGraphics()->draw(indexBuffer->getResource(),
                                     indexCount,
@@ -41,6 +41,11 @@ namespace ouzel::scene
                   const Matrix4F& renderViewProjection,
                   bool wireframe) override;
 
+        std::uint16_t getRenderStateKey() const noexcept override
+        {
+            return (material && !material->isBlended()) ? material->getStateKey() : 0;
+        }
+
         auto& getMaterial() const noexcept { return material; }
         void setMaterial(const graphics::Material* newMaterial)
         {
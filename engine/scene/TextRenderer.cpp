@@ -76,18 +76,11 @@ namespace ouzel::scene
         const auto modelViewProj = renderViewProjection * transformMatrix;
         const float colorVector[] = {color.normR(), color.normG(), color.normB(), color.normA() * opacity};
 
-        std::vector<std::vector<float>> fragmentShaderConstants(1);
-        fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-        std::vector<std::vector<float>> vertexShaderConstants(1);
-        vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
-
         engine->getGraphics()->setPipelineState(blendState->getResource(),
                                                 shader->getResource(),
                                                 graphics::CullMode::none,
                                                 wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-        engine->getGraphics()->setShaderConstants(fragmentShaderConstants,
-                                                  vertexShaderConstants);
+        engine->getGraphics()->setShaderConstants({colorVector}, {modelViewProj.m});
         engine->getGraphics()->setTextures({wireframe ? whitePixelTexture->getResource() : texture ? texture->getResource() : 0U});
         engine->getGraphics()->draw(indexBuffer.getResource(),
                                     static_cast<std::uint32_t>(indices.size()),
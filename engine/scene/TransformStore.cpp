@@ -0,0 +1,193 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include "TransformStore.hpp"
+#include "Actor.hpp"
+
+namespace ouzel::scene
+{
+    TransformStore::Handle TransformStore::create(Actor& owner, Handle parent)
+    {
+        const auto slot = static_cast<Slot>(owners.size());
+        const auto parentSlot = (parent == nullHandle) ? nullSlot : handleSlots[parent];
+
+        Handle handle;
+        if (freeHandles.empty())
+        {
+            handle = static_cast<Handle>(handleSlots.size());
+            handleSlots.push_back(slot);
+        }
+        else
+        {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+            handleSlots[handle] = slot;
+        }
+
+        positions.emplace_back();
+        rotations.push_back(QuaternionF::identity());
+        scales.push_back(Vector3F{1.0F, 1.0F, 1.0F});
+        localTransforms.push_back(Matrix4F::identity());
+        worldTransforms.push_back(Matrix4F::identity());
+        parents.push_back(parentSlot);
+        depths.push_back((parentSlot == nullSlot) ? 0 : depths[parentSlot] + 1);
+        flags.push_back(0);
+        owners.push_back(&owner);
+        slotHandles.push_back(handle);
+
+        // new slots are appended, so they have to be sorted by depth
+        structureDirty = true;
+        markDirty(slot, localDirty);
+
+        return handle;
+    }
+
+    void TransformStore::destroy(Handle handle)
+    {
+        const auto slot = handleSlots[handle];
+        owners[slot] = nullptr;
+        handleSlots[handle] = nullSlot;
+        freeHandles.push_back(handle);
+
+        structureDirty = true;
+        dirty = true;
+    }
+
+    void TransformStore::setLocalTransform(Handle handle,
+                                           const Vector3F& position,
+                                           const QuaternionF& rotation,
+                                           const Vector3F& scale)
+    {
+        const auto slot = handleSlots[handle];
+        positions[slot] = position;
+        rotations[slot] = rotation;
+        scales[slot] = scale;
+
+        markDirty(slot, localDirty);
+    }
+
+    void TransformStore::setDirty(Handle handle)
+    {
+        markDirty(handleSlots[handle], worldDirty);
+    }
+
+    void TransformStore::markDirty(Slot slot, std::uint8_t flag) noexcept
+    {
+        flags[slot] |= flag;
+        dirty = true;
+        if (firstDirtySlot == nullSlot || slot < firstDirtySlot) firstDirtySlot = slot;
+    }
+
+    void TransformStore::update()
+    {
+        // owners can query their transforms while being notified
+        if (!dirty || updating) return;
+
+        if (structureDirty) rebuild();
+
+        const auto startSlot = firstDirtySlot;
+        const auto slotCount = static_cast<Slot>(owners.size());
+
+        dirty = false;
+        firstDirtySlot = nullSlot;
+        updating = true;
+
+        // slots before the first dirty one can not be affected, because parents precede their children
+        for (Slot slot = startSlot; slot < slotCount; ++slot)
+        {
+            const auto parent = parents[slot];
+            auto slotFlags = flags[slot];
+
+            if (parent != nullSlot && (flags[parent] & updated)) slotFlags |= worldDirty;
+
+            if (slotFlags & localDirty)
+            {
+                Matrix4F& localTransform = localTransforms[slot];
+                localTransform.setTranslation(positions[slot]);
+
+                Matrix4F rotationMatrix;
+                rotationMatrix.setRotation(rotations[slot]);
+                localTransform *= rotationMatrix;
+
+                Matrix4F scaleMatrix;
+                scaleMatrix.setScale(scales[slot]);
+                localTransform *= scaleMatrix;
+            }
+
+            if (slotFlags & (localDirty | worldDirty))
+            {
+                if (parent == nullSlot)
+                    worldTransforms[slot] = localTransforms[slot];
+                else
+                    worldTransforms[parent].multiply(localTransforms[slot], worldTransforms[slot]);
+
+                flags[slot] = updated;
+                if (owners[slot]) owners[slot]->updateWorldTransform();
+            }
+        }
+
+        for (Slot slot = startSlot; slot < slotCount; ++slot)
+            flags[slot] &= ~updated;
+
+        updating = false;
+    }
+
+    void TransformStore::rebuild()
+    {
+        // counting sort of the live slots by depth
+        std::vector<std::size_t> depthOffsets;
+        for (std::size_t slot = 0; slot < owners.size(); ++slot)
+            if (owners[slot])
+            {
+                if (depths[slot] >= depthOffsets.size()) depthOffsets.resize(depths[slot] + 1);
+                ++depthOffsets[depths[slot]];
+            }
+
+        std::size_t liveCount = 0;
+        for (auto& offset : depthOffsets)
+        {
+            const auto count = offset;
+            offset = liveCount;
+            liveCount += count;
+        }
+
+        std::vector<Slot> newSlots(owners.size(), nullSlot);
+        for (std::size_t slot = 0; slot < owners.size(); ++slot)
+            if (owners[slot])
+                newSlots[slot] = static_cast<Slot>(depthOffsets[depths[slot]]++);
+
+        const auto permute = [&newSlots, liveCount](auto& values) {
+            std::remove_reference_t<decltype(values)> result(liveCount);
+            for (std::size_t slot = 0; slot < newSlots.size(); ++slot)
+                if (newSlots[slot] != nullSlot)
+                    result[newSlots[slot]] = std::move(values[slot]);
+            values.swap(result);
+        };
+
+        for (std::size_t slot = 0; slot < owners.size(); ++slot)
+            if (owners[slot] && parents[slot] != nullSlot)
+            {
+                assert(newSlots[parents[slot]] != nullSlot); // children must be destroyed with their parents
+                parents[slot] = newSlots[parents[slot]];
+            }
+
+        permute(positions);
+        permute(rotations);
+        permute(scales);
+        permute(localTransforms);
+        permute(worldTransforms);
+        permute(parents);
+        permute(depths);
+        permute(flags);
+        permute(owners);
+        permute(slotHandles);
+
+        for (std::size_t slot = 0; slot < slotHandles.size(); ++slot)
+            handleSlots[slotHandles[slot]] = static_cast<Slot>(slot);
+
+        structureDirty = false;
+        firstDirtySlot = 0;
+    }
+}
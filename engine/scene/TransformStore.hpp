@@ -0,0 +1,93 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_TRANSFORMSTORE_HPP
+#define OUZEL_SCENE_TRANSFORMSTORE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "../math/Matrix.hpp"
+#include "../math/Quaternion.hpp"
+#include "../math/Vector.hpp"
+
+namespace ouzel::scene
+{
+    class Actor;
+
+    // Transform hierarchy stored as structure of arrays. The slots are sorted by
+    // depth, so parents always come before their children and all dirty subtrees
+    // are updated in one linear pass. Actors refer to their slot through a
+    // stable handle.
+    class TransformStore final
+    {
+    public:
+        using Handle = std::uint32_t;
+        static constexpr Handle nullHandle = std::numeric_limits<Handle>::max();
+
+        TransformStore() = default;
+
+        TransformStore(const TransformStore&) = delete;
+        TransformStore& operator=(const TransformStore&) = delete;
+
+        TransformStore(TransformStore&&) = delete;
+        TransformStore& operator=(TransformStore&&) = delete;
+
+        Handle create(Actor& owner, Handle parent);
+        void destroy(Handle handle);
+
+        void setLocalTransform(Handle handle,
+                               const Vector3F& position,
+                               const QuaternionF& rotation,
+                               const Vector3F& scale);
+
+        // forces the world transform of the subtree to be recalculated
+        void setDirty(Handle handle);
+
+        auto isDirty() const noexcept { return dirty; }
+
+        // recalculates the world transforms of all dirty subtrees
+        void update();
+
+        auto& getWorldTransform(Handle handle) const noexcept
+        {
+            return worldTransforms[handleSlots[handle]];
+        }
+
+        auto getSize() const noexcept { return owners.size(); }
+
+    private:
+        using Slot = std::uint32_t;
+        static constexpr Slot nullSlot = std::numeric_limits<Slot>::max();
+
+        enum Flags: std::uint8_t
+        {
+            localDirty = 0x01,
+            worldDirty = 0x02,
+            updated = 0x04
+        };
+
+        void markDirty(Slot slot, std::uint8_t flag) noexcept;
+        void rebuild();
+
+        std::vector<Vector3F> positions;
+        std::vector<QuaternionF> rotations;
+        std::vector<Vector3F> scales;
+        std::vector<Matrix4F> localTransforms;
+        std::vector<Matrix4F> worldTransforms;
+        std::vector<Slot> parents;
+        std::vector<std::uint32_t> depths;
+        std::vector<std::uint8_t> flags;
+        std::vector<Actor*> owners; // nullptr for destroyed slots
+        std::vector<Handle> slotHandles;
+
+        std::vector<Slot> handleSlots;
+        std::vector<Handle> freeHandles;
+
+        bool dirty = false;
+        bool structureDirty = false;
+        bool updating = false;
+        Slot firstDirtySlot = nullSlot;
+    };
+}
+
+#endif // OUZEL_SCENE_TRANSFORMSTORE_HPP
@@ -4,93 +4,159 @@
 #define OUZEL_STORAGE_ARCHIVE_HPP
 
 #include <cstdint>
-#include <fstream>
+#include <istream>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
+#include "Inflate.hpp"
+#include "MappedFile.hpp"
 #include "Path.hpp"
 #include "../utils/Utils.hpp"
 
 namespace ouzel::storage
 {
+    // ZIP archive, it is mapped into memory once and the stored files are views of the mapping, so they can be
+    // read from several threads without copying them. The deflated files are decompressed by the thread that
+    // reads them (the workers of Bundle::loadAssetsAsync decompress them in parallel).
     class Archive final
     {
     public:
         Archive() = default;
 
         explicit Archive(const Path& path):
-            file{path, std::ios::binary}
+            file{std::make_shared<MappedFile>(path)}
         {
-            constexpr std::uint32_t centralDirectory = 0x02014B50U;
+            constexpr std::uint32_t endOfCentralDirectorySignature = 0x06054B50U;
+            constexpr std::uint32_t centralDirectorySignature = 0x02014B50U;
             constexpr std::uint32_t headerSignature = 0x04034B50U;
+            constexpr std::size_t endOfCentralDirectorySize = 22;
+            constexpr std::size_t centralDirectoryHeaderSize = 46;
+            constexpr std::size_t headerSize = 30;
 
-            for (;;)
+            const std::byte* data = file->getData();
+            const std::size_t size = file->getSize();
+
+            const auto at = [data, size](std::size_t offset, std::size_t count) {
+                if (offset > size || size - offset < count)
+                    throw std::runtime_error("Invalid archive");
+
+                return data + offset;
+            };
+
+            // the end of central directory record is followed by a comment of up to 65535 bytes
+            if (size < endOfCentralDirectorySize)
+                throw std::runtime_error("Invalid archive");
+
+            std::size_t endOfCentralDirectory = size - endOfCentralDirectorySize;
+            while (decodeLittleEndian<std::uint32_t>(data + endOfCentralDirectory) != endOfCentralDirectorySignature)
             {
-                std::uint8_t signatureData[4];
-                file.read(reinterpret_cast<char*>(signatureData), sizeof(signatureData));
+                if (endOfCentralDirectory == 0 || size - endOfCentralDirectory > endOfCentralDirectorySize + 0xFFFF)
+                    throw std::runtime_error("Invalid archive");
 
-                if (decodeLittleEndian<std::uint32_t>(signatureData) == centralDirectory)
-                    break;
+                --endOfCentralDirectory;
+            }
 
-                if (decodeLittleEndian<std::uint32_t>(signatureData) != headerSignature)
-                    throw std::runtime_error("Bad signature");
+            const std::byte* record = data + endOfCentralDirectory;
+            const std::size_t entryCount = decodeLittleEndian<std::uint16_t>(record + 10);
+            std::size_t offset = decodeLittleEndian<std::uint32_t>(record + 16);
 
-                file.seekg(2, std::ios::cur); // skip version
-                file.seekg(2, std::ios::cur); // skip flags
+            // the central directory has the sizes also for the files that are followed by data descriptors
+            for (std::size_t i = 0; i < entryCount; ++i)
+            {
+                const std::byte* header = at(offset, centralDirectoryHeaderSize);
 
-                std::uint8_t compressionData[2];
-                file.read(reinterpret_cast<char*>(&compressionData), sizeof(compressionData));
+                if (decodeLittleEndian<std::uint32_t>(header) != centralDirectorySignature)
+                    throw std::runtime_error("Bad signature");
 
-                if (decodeLittleEndian<std::uint16_t>(compressionData) != 0x00)
-                    throw std::runtime_error("Unsupported compression");
+                if (decodeLittleEndian<std::uint16_t>(header + 8) & 0x01)
+                    throw std::runtime_error("Encrypted files are not supported");
 
-                file.seekg(2, std::ios::cur); // skip modification time
-                file.seekg(2, std::ios::cur); // skip modification date
-                file.seekg(4, std::ios::cur); // skip CRC-32
+                Entry entry;
 
-                std::uint8_t compressedSizeData[4];
-                file.read(reinterpret_cast<char*>(compressedSizeData), sizeof(compressedSizeData));
+                switch (decodeLittleEndian<std::uint16_t>(header + 10))
+                {
+                    case 0: entry.compression = Compression::none; break;
+                    case 8: entry.compression = Compression::deflate; break;
+                    default: throw std::runtime_error("Unsupported compression");
+                }
 
-                std::uint8_t uncompressedSizeData[4];
-                file.read(reinterpret_cast<char*>(uncompressedSizeData), sizeof(uncompressedSizeData));
-                const size_t uncompressedSize = decodeLittleEndian<std::uint32_t>(uncompressedSizeData);
+                entry.compressedSize = decodeLittleEndian<std::uint32_t>(header + 20);
+                entry.size = decodeLittleEndian<std::uint32_t>(header + 24);
+                const std::size_t fileNameLength = decodeLittleEndian<std::uint16_t>(header + 28);
+                const std::size_t extraFieldLength = decodeLittleEndian<std::uint16_t>(header + 30);
+                const std::size_t commentLength = decodeLittleEndian<std::uint16_t>(header + 32);
+                const std::size_t headerOffset = decodeLittleEndian<std::uint32_t>(header + 42);
 
-                std::uint8_t fileNameLengthData[2];
-                file.read(reinterpret_cast<char*>(fileNameLengthData), sizeof(fileNameLengthData));
-                const size_t fileNameLength = decodeLittleEndian<std::uint16_t>(fileNameLengthData);
+                if (entry.compressedSize == 0xFFFFFFFFU || entry.size == 0xFFFFFFFFU || headerOffset == 0xFFFFFFFFU)
+                    throw std::runtime_error("ZIP64 archives are not supported");
 
-                std::uint8_t extraFieldLengthData[2];
-                file.read(reinterpret_cast<char*>(extraFieldLengthData), sizeof(extraFieldLengthData));
-                const size_t extraFieldLength = decodeLittleEndian<std::uint16_t>(extraFieldLengthData);
+                const auto name = reinterpret_cast<const char*>(at(offset + centralDirectoryHeaderSize, fileNameLength));
 
-                auto name = std::make_unique<char[]>(fileNameLength + 1); // +1 for null character
+                // the lengths of the name and of the extra field in the local header can differ
+                const std::byte* localHeader = at(headerOffset, headerSize);
+                if (decodeLittleEndian<std::uint32_t>(localHeader) != headerSignature)
+                    throw std::runtime_error("Bad signature");
 
-                file.read(name.get(), static_cast<std::streamsize>(fileNameLength));
+                entry.offset = headerOffset + headerSize +
+                    decodeLittleEndian<std::uint16_t>(localHeader + 26) +
+                    decodeLittleEndian<std::uint16_t>(localHeader + 28);
 
-                file.seekg(static_cast<std::streamoff>(extraFieldLength),
-                           std::ios::cur); // skip extra field
+                if (entry.compression == Compression::none && entry.compressedSize != entry.size)
+                    throw std::runtime_error("Invalid archive");
 
-                entries[name.get()] = {file.tellg(), uncompressedSize};
+                at(entry.offset, entry.compressedSize);
 
-                file.seekg(static_cast<std::streamoff>(uncompressedSize),
-                           std::ios::cur); // skip uncompressed size
+                entries[std::string(name, fileNameLength)] = entry;
+
+                offset += centralDirectoryHeaderSize + fileNameLength + extraFieldLength + commentLength;
             }
         }
 
-        std::vector<std::byte> readFile(const std::string& filename)
+        // Decompressed files are kept until their total size exceeds the limit, the least recently used ones are
+        // removed first. The views that were returned stay valid. Zero (the default) disables the cache.
+        void setCacheSize(std::size_t size)
+        {
+            cache->setMaxSize(size);
+        }
+
+        // the view shares the ownership of the mapping or of the decompressed data
+        FileView mapFile(const std::string& filename) const
         {
             const auto i = entries.find(filename);
 
             if (i == entries.end())
                 throw std::runtime_error("File " + filename + " does not exist");
 
-            file.seekg(i->second.offset, std::ios::beg);
+            const Entry& entry = i->second;
+
+            if (entry.compression == Compression::none)
+                return FileView{file}.subview(entry.offset, entry.size);
 
-            std::vector<std::byte> data(i->second.size);
-            file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(i->second.size));
+            if (auto data = cache->get(filename))
+                return FileView{data};
 
-            return data;
+            auto data = std::make_shared<std::vector<std::byte>>(entry.size);
+            inflate(file->getData() + entry.offset, entry.compressedSize, data->data(), data->size());
+
+            cache->add(filename, data);
+
+            return FileView{std::shared_ptr<const std::vector<std::byte>>(std::move(data))};
+        }
+
+        std::vector<std::byte> readFile(const std::string& filename) const
+        {
+            const auto view = mapFile(filename);
+            return std::vector<std::byte>(view.begin(), view.end());
+        }
+
+        std::unique_ptr<std::istream> openFile(const std::string& filename) const
+        {
+            return std::make_unique<FileViewStream>(mapFile(filename));
         }
 
         bool fileExists(const std::string& filename) const
@@ -99,15 +165,79 @@ namespace ouzel::storage
         }
 
     private:
-        std::ifstream file;
+        enum class Compression
+        {
+            none,
+            deflate
+        };
 
         struct Entry final
         {
-            std::streamoff offset;
-            std::size_t size;
+            std::size_t offset = 0;
+            std::size_t compressedSize = 0;
+            std::size_t size = 0;
+            Compression compression = Compression::none;
+        };
+
+        class Cache final
+        {
+        public:
+            using Data = std::shared_ptr<const std::vector<std::byte>>;
+
+            void setMaxSize(std::size_t newMaxSize)
+            {
+                std::lock_guard lock(mutex);
+                maxSize = newMaxSize;
+                trim();
+            }
+
+            Data get(const std::string& filename)
+            {
+                std::lock_guard lock(mutex);
+
+                const auto i = index.find(filename);
+                if (i == index.end()) return nullptr;
+
+                // the most recently used file is at the front
+                files.splice(files.begin(), files, i->second);
+                return i->second->second;
+            }
+
+            void add(const std::string& filename, const Data& data)
+            {
+                std::lock_guard lock(mutex);
+
+                // another thread could have decompressed the same file
+                if (maxSize == 0 || data->size() > maxSize || index.find(filename) != index.end()) return;
+
+                files.emplace_front(filename, data);
+                index[filename] = files.begin();
+                size += data->size();
+                trim();
+            }
+
+        private:
+            void trim()
+            {
+                while (size > maxSize)
+                {
+                    size -= files.back().second->size();
+                    index.erase(files.back().first);
+                    files.pop_back();
+                }
+            }
+
+            std::mutex mutex;
+            std::size_t maxSize = 0;
+            std::size_t size = 0;
+            std::list<std::pair<std::string, Data>> files;
+            std::map<std::string, std::list<std::pair<std::string, Data>>::iterator> index;
         };
 
+        std::shared_ptr<const MappedFile> file;
         std::map<std::string, Entry> entries;
+        // created with the archive, because the workers that map files do not synchronize with setCacheSize
+        std::unique_ptr<Cache> cache = std::make_unique<Cache>();
     };
 }
 
@@ -41,6 +41,83 @@
 
 namespace ouzel::storage
 {
+#if defined(__ANDROID__)
+    namespace
+    {
+        class AssetBuffer final: public std::streambuf
+        {
+        public:
+            explicit AssetBuffer(AAsset* initAsset) noexcept:
+                asset{initAsset}
+            {
+            }
+
+            ~AssetBuffer() override
+            {
+                AAsset_close(asset);
+            }
+
+            AssetBuffer(const AssetBuffer&) = delete;
+            AssetBuffer& operator=(const AssetBuffer&) = delete;
+
+        protected:
+            int_type underflow() override
+            {
+                const int bytesRead = AAsset_read(asset, buffer, sizeof(buffer));
+
+                if (bytesRead < 0)
+                    throw std::runtime_error("Failed to read from file");
+                else if (bytesRead == 0)
+                    return traits_type::eof();
+
+                setg(buffer, buffer, buffer + bytesRead);
+                return traits_type::to_int_type(buffer[0]);
+            }
+
+            pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override
+            {
+                int whence = SEEK_SET;
+                switch (dir)
+                {
+                    case std::ios_base::beg: whence = SEEK_SET; break;
+                    case std::ios_base::cur: whence = SEEK_CUR; off -= egptr() - gptr(); break;
+                    case std::ios_base::end: whence = SEEK_END; break;
+                    default: return pos_type(off_type(-1));
+                }
+
+                const auto result = AAsset_seek(asset, off, whence);
+                if (result == -1) return pos_type(off_type(-1));
+
+                setg(buffer, buffer, buffer);
+                return pos_type(result);
+            }
+
+            pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+            {
+                return seekoff(off_type(pos), std::ios_base::beg, which);
+            }
+
+        private:
+            AAsset* asset;
+            char buffer[16384];
+        };
+
+        class AssetStream final: public std::istream
+        {
+        public:
+            explicit AssetStream(AAsset* asset):
+                std::istream{nullptr},
+                buffer{asset}
+            {
+                rdbuf(&buffer);
+            }
+
+        private:
+            AssetBuffer buffer;
+        };
+    }
+#endif
+
     FileSystem::FileSystem(core::Engine& initEngine):
         engine(initEngine)
     {
@@ -354,17 +431,95 @@ namespace ouzel::storage
             throw std::runtime_error("Failed to open file " + std::string(filename));
 
         std::vector<std::byte> data;
-        std::byte buffer[1024];
 
-        while (!file.eof())
+        // the size is only a hint, the pipes can't seek and tellg returns -1 for them, the generated files
+        // (e.g. in /proc) report zero, they are read in chunks until the end of the file
+        if (file.seekg(0, std::ios::end))
+            if (const auto size = file.tellg(); size > 0 && file.seekg(0, std::ios::beg))
+                data.resize(static_cast<std::size_t>(size));
+        file.clear();
+
+        std::size_t offset = 0;
+
+        for (;;)
         {
-            file.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
-            data.insert(data.end(), buffer, buffer + file.gcount());
+            if (offset == data.size())
+            {
+                // a file with the size of the hint is read with one call
+                if (file.peek() == std::ifstream::traits_type::eof()) break;
+                data.resize(std::max(data.size() * 2, std::size_t{4096}));
+            }
+
+            file.read(reinterpret_cast<char*>(data.data() + offset), static_cast<std::streamsize>(data.size() - offset));
+            offset += static_cast<std::size_t>(file.gcount());
+
+            if (!file) break;
         }
 
+        if (file.bad())
+            throw std::runtime_error("Failed to read file " + std::string(filename));
+
+        data.resize(offset);
+
         return data;
     }
 
+    FileView FileSystem::mapFile(const Path& filename, const bool searchResources)
+    {
+        if (searchResources)
+            for (auto& archive : archives)
+                if (archive.second.fileExists(filename))
+                    return archive.second.mapFile(filename);
+
+#if defined(__ANDROID__)
+        // the files in the APK are not mapped
+        if (!filename.isAbsolute())
+            return FileView{readFile(filename, searchResources)};
+#endif
+
+        const auto path = getPath(filename, searchResources);
+
+        // file does not exist
+        if (path.isEmpty())
+            throw std::runtime_error("Failed to find file " + std::string(filename));
+
+        return FileView{std::make_shared<const MappedFile>(path)};
+    }
+
+    std::unique_ptr<std::istream> FileSystem::openFile(const Path& filename, const bool searchResources)
+    {
+        if (searchResources)
+            for (auto& archive : archives)
+                if (archive.second.fileExists(filename))
+                    return archive.second.openFile(filename);
+
+#if defined(__ANDROID__)
+        if (!filename.isAbsolute())
+        {
+            auto& engineAndroid = static_cast<core::android::Engine&>(engine);
+
+            auto asset = AAssetManager_open(engineAndroid.getAssetManager(), filename.getNative().c_str(), AASSET_MODE_STREAMING);
+
+            if (!asset)
+                throw std::runtime_error("Failed to open file " + std::string(filename));
+
+            return std::make_unique<AssetStream>(asset);
+        }
+#endif
+
+        const auto path = getPath(filename, searchResources);
+
+        // file does not exist
+        if (path.isEmpty())
+            throw std::runtime_error("Failed to find file " + std::string(filename));
+
+        auto file = std::make_unique<std::ifstream>(path, std::ios::binary);
+        if (!*file)
+            throw std::runtime_error("Failed to open file " + std::string(filename));
+
+        return file;
+    }
+
     bool FileSystem::resourceFileExists(const Path& filename) const
     {
         if (filename.isAbsolute())
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <istream>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -31,6 +32,7 @@
 #  include <unistd.h>
 #endif
 #include "Archive.hpp"
+#include "MappedFile.hpp"
 #include "Path.hpp"
 
 namespace ouzel::core
@@ -235,6 +237,12 @@ namespace ouzel::storage
 
         std::vector<std::byte> readFile(const Path& filename, const bool searchResources = true);
 
+        // maps the file into memory instead of copying it, the files in the archives are views of their mappings
+        FileView mapFile(const Path& filename, const bool searchResources = true);
+
+        // opens the file for reading in chunks instead of loading all of it into memory
+        std::unique_ptr<std::istream> openFile(const Path& filename, const bool searchResources = true);
+
         bool resourceFileExists(const Path& filename) const;
 
         Path getPath(const Path& filename, const bool searchResources = true) const
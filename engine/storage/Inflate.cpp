@@ -0,0 +1,385 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include "Inflate.hpp"
+
+namespace ouzel::storage
+{
+    namespace
+    {
+        constexpr std::uint32_t maxCodeLength = 15;
+
+        // codes up to this length are decoded with one table lookup, the longer ones bit by bit
+        constexpr std::uint32_t fastBits = 10;
+
+        constexpr std::uint16_t lengthBases[] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        constexpr std::uint8_t lengthExtraBits[] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+        constexpr std::uint16_t distanceBases[] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+        };
+        constexpr std::uint8_t distanceExtraBits[] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+        };
+        constexpr std::uint8_t codeLengthOrder[] = {
+            16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+        };
+
+        // the bits are read from the least significant bit of every byte
+        class BitReader final
+        {
+        public:
+            BitReader(const std::byte* initData, std::size_t initSize) noexcept:
+                data(initData), size(initSize)
+            {
+            }
+
+            void refill() noexcept
+            {
+                // zeros are read past the end, finish checks that none of them were used
+                while (bitCount <= 56)
+                {
+                    const auto byte = position < size ? static_cast<std::uint64_t>(data[position]) : 0U;
+                    buffer |= byte << bitCount;
+                    bitCount += 8;
+                    ++position;
+                }
+            }
+
+            std::uint32_t peek(std::uint32_t count) noexcept
+            {
+                if (bitCount < count) refill();
+                return static_cast<std::uint32_t>(buffer & ((std::uint64_t(1) << count) - 1U));
+            }
+
+            void skip(std::uint32_t count) noexcept
+            {
+                buffer >>= count;
+                bitCount -= count;
+            }
+
+            std::uint32_t read(std::uint32_t count) noexcept
+            {
+                const auto result = peek(count);
+                skip(count);
+                return result;
+            }
+
+            // the whole bytes in the buffer are returned to the input
+            const std::byte* alignToByte() noexcept
+            {
+                skip(bitCount % 8);
+                position -= bitCount / 8;
+                buffer = 0;
+                bitCount = 0;
+                return data + position;
+            }
+
+            std::size_t getRemaining() const noexcept
+            {
+                return position <= size ? size - position : 0;
+            }
+
+            void advance(std::size_t count) noexcept
+            {
+                position += count;
+            }
+
+            void finish() const
+            {
+                if (position - bitCount / 8 > size)
+                    throw std::runtime_error("Unexpected end of deflate data");
+            }
+
+        private:
+            const std::byte* data;
+            std::size_t size;
+            std::size_t position = 0;
+            std::uint64_t buffer = 0;
+            std::uint32_t bitCount = 0;
+        };
+
+        class Huffman final
+        {
+        public:
+            Huffman(const std::uint8_t* lengths, std::uint32_t count)
+            {
+                for (std::uint32_t i = 0; i < count; ++i)
+                    ++counts[lengths[i]];
+                counts[0] = 0;
+
+                // the codes must not be oversubscribed, incomplete codes are allowed (a single distance code)
+                std::int32_t left = 1;
+                for (std::uint32_t length = 1; length <= maxCodeLength; ++length)
+                {
+                    left = left * 2 - counts[length];
+                    if (left < 0) throw std::runtime_error("Invalid deflate code lengths");
+                }
+
+                std::uint16_t offsets[maxCodeLength + 1]{};
+                for (std::uint32_t length = 1; length < maxCodeLength; ++length)
+                    offsets[length + 1] = offsets[length] + counts[length];
+
+                // the canonical codes of every length are consecutive and in the order of the symbols
+                std::uint32_t code = 0;
+                std::uint32_t nextCodes[maxCodeLength + 1]{};
+                for (std::uint32_t length = 1; length <= maxCodeLength; ++length)
+                {
+                    code = (code + counts[length - 1]) << 1;
+                    nextCodes[length] = code;
+                }
+
+                for (std::uint32_t symbol = 0; symbol < count; ++symbol)
+                {
+                    const std::uint32_t length = lengths[symbol];
+                    if (!length) continue;
+
+                    symbols[offsets[length]++] = static_cast<std::uint16_t>(symbol);
+
+                    if (length <= fastBits)
+                    {
+                        // the codes are stored with the most significant bit first, but read from the least
+                        const auto reversed = reverse(nextCodes[length], length);
+                        for (auto i = reversed; i < (1U << fastBits); i += 1U << length)
+                            fast[i] = static_cast<std::uint16_t>((symbol << 4) | length);
+                    }
+
+                    ++nextCodes[length];
+                }
+            }
+
+            std::uint32_t decode(BitReader& reader) const
+            {
+                const auto entry = fast[reader.peek(fastBits)];
+                if (entry)
+                {
+                    reader.skip(entry & 0x0F);
+                    return entry >> 4;
+                }
+
+                // the longer codes are decoded one bit at a time (from the canonical code counts)
+                const auto bits = reader.peek(maxCodeLength);
+                std::int32_t code = 0;
+                std::int32_t first = 0;
+                std::int32_t index = 0;
+
+                for (std::uint32_t length = 1; length <= maxCodeLength; ++length)
+                {
+                    code |= static_cast<std::int32_t>((bits >> (length - 1)) & 1U);
+                    const std::int32_t count = counts[length];
+
+                    if (code - count < first)
+                    {
+                        reader.skip(length);
+                        return symbols[static_cast<std::size_t>(index + (code - first))];
+                    }
+
+                    index += count;
+                    first = (first + count) << 1;
+                    code <<= 1;
+                }
+
+                throw std::runtime_error("Invalid deflate code");
+            }
+
+        private:
+            static std::uint32_t reverse(std::uint32_t code, std::uint32_t length) noexcept
+            {
+                std::uint32_t result = 0;
+                for (std::uint32_t i = 0; i < length; ++i, code >>= 1)
+                    result = (result << 1) | (code & 1U);
+                return result;
+            }
+
+            std::uint16_t fast[1U << fastBits]{}; // (symbol << 4) | length, zero for the longer codes
+            std::uint16_t counts[maxCodeLength + 1]{};
+            std::uint16_t symbols[288]{};
+        };
+
+        const Huffman& getFixedLiterals()
+        {
+            static const Huffman literals = []() {
+                std::uint8_t lengths[288];
+                std::fill(lengths, lengths + 144, std::uint8_t(8));
+                std::fill(lengths + 144, lengths + 256, std::uint8_t(9));
+                std::fill(lengths + 256, lengths + 280, std::uint8_t(7));
+                std::fill(lengths + 280, lengths + 288, std::uint8_t(8));
+                return Huffman(lengths, 288);
+            }();
+
+            return literals;
+        }
+
+        const Huffman& getFixedDistances()
+        {
+            static const Huffman distances = []() {
+                std::uint8_t lengths[30];
+                std::fill(lengths, lengths + 30, std::uint8_t(5));
+                return Huffman(lengths, 30);
+            }();
+
+            return distances;
+        }
+
+        void inflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances,
+                          std::byte* output, std::size_t outputSize, std::size_t& written)
+        {
+            for (;;)
+            {
+                const auto symbol = literals.decode(reader);
+
+                if (symbol < 256)
+                {
+                    if (written == outputSize)
+                        throw std::runtime_error("Deflate data is larger than expected");
+
+                    output[written++] = static_cast<std::byte>(symbol);
+                }
+                else if (symbol == 256)
+                    return;
+                else
+                {
+                    const auto lengthIndex = symbol - 257;
+                    if (lengthIndex >= std::size(lengthBases))
+                        throw std::runtime_error("Invalid deflate length");
+
+                    const std::size_t length = lengthBases[lengthIndex] + reader.read(lengthExtraBits[lengthIndex]);
+
+                    const auto distanceIndex = distances.decode(reader);
+                    if (distanceIndex >= std::size(distanceBases))
+                        throw std::runtime_error("Invalid deflate distance");
+
+                    const std::size_t distance = distanceBases[distanceIndex] + reader.read(distanceExtraBits[distanceIndex]);
+
+                    if (distance > written)
+                        throw std::runtime_error("Invalid deflate distance");
+                    if (length > outputSize - written)
+                        throw std::runtime_error("Deflate data is larger than expected");
+
+                    std::byte* destination = output + written;
+                    const std::byte* source = destination - distance;
+
+                    // overlapping copies repeat the last distance bytes
+                    if (distance >= length)
+                        std::memcpy(destination, source, length);
+                    else
+                        for (std::size_t i = 0; i < length; ++i)
+                            destination[i] = source[i];
+
+                    written += length;
+                }
+            }
+        }
+    }
+
+    void inflate(const std::byte* input, std::size_t inputSize, std::byte* output, std::size_t outputSize)
+    {
+        BitReader reader(input, inputSize);
+        std::size_t written = 0;
+
+        for (bool last = false; !last;)
+        {
+            last = reader.read(1) != 0;
+            const auto type = reader.read(2);
+
+            switch (type)
+            {
+                case 0: // stored
+                {
+                    const std::byte* data = reader.alignToByte();
+                    if (reader.getRemaining() < 4)
+                        throw std::runtime_error("Unexpected end of deflate data");
+
+                    const std::size_t length = static_cast<std::size_t>(data[0]) | (static_cast<std::size_t>(data[1]) << 8);
+                    const std::size_t complement = static_cast<std::size_t>(data[2]) | (static_cast<std::size_t>(data[3]) << 8);
+                    if (length != (~complement & 0xFFFFU))
+                        throw std::runtime_error("Invalid stored deflate block");
+
+                    if (reader.getRemaining() - 4 < length)
+                        throw std::runtime_error("Unexpected end of deflate data");
+                    if (length > outputSize - written)
+                        throw std::runtime_error("Deflate data is larger than expected");
+
+                    if (length) std::memcpy(output + written, data + 4, length);
+                    written += length;
+                    reader.advance(4 + length);
+                    break;
+                }
+                case 1: // fixed Huffman codes
+                    inflateBlock(reader, getFixedLiterals(), getFixedDistances(), output, outputSize, written);
+                    break;
+                case 2: // dynamic Huffman codes
+                {
+                    const auto literalCount = reader.read(5) + 257;
+                    const auto distanceCount = reader.read(5) + 1;
+                    const auto codeLengthCount = reader.read(4) + 4;
+
+                    std::uint8_t codeLengthLengths[19]{};
+                    for (std::uint32_t i = 0; i < codeLengthCount; ++i)
+                        codeLengthLengths[codeLengthOrder[i]] = static_cast<std::uint8_t>(reader.read(3));
+
+                    const Huffman codeLengths(codeLengthLengths, 19);
+
+                    // the literal and the distance code lengths are one sequence, the repeats can cross from one to the other
+                    std::uint8_t lengths[288 + 32]{};
+                    for (std::uint32_t i = 0; i < literalCount + distanceCount;)
+                    {
+                        const auto symbol = codeLengths.decode(reader);
+
+                        if (symbol < 16)
+                        {
+                            lengths[i++] = static_cast<std::uint8_t>(symbol);
+                            continue;
+                        }
+
+                        std::uint8_t value = 0;
+                        std::uint32_t repeat;
+
+                        if (symbol == 16)
+                        {
+                            if (i == 0) throw std::runtime_error("Invalid deflate code lengths");
+                            value = lengths[i - 1];
+                            repeat = 3 + reader.read(2);
+                        }
+                        else if (symbol == 17)
+                            repeat = 3 + reader.read(3);
+                        else
+                            repeat = 11 + reader.read(7);
+
+                        if (repeat > literalCount + distanceCount - i)
+                            throw std::runtime_error("Invalid deflate code lengths");
+
+                        std::fill(lengths + i, lengths + i + repeat, value);
+                        i += repeat;
+                    }
+
+                    if (!lengths[256])
+                        throw std::runtime_error("Missing end of deflate block code");
+
+                    const Huffman literals(lengths, literalCount);
+                    const Huffman distances(lengths + literalCount, distanceCount);
+                    inflateBlock(reader, literals, distances, output, outputSize, written);
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Invalid deflate block type");
+            }
+
+            reader.finish();
+        }
+
+        if (written != outputSize)
+            throw std::runtime_error("Deflate data is smaller than expected");
+    }
+}
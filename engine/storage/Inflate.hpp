@@ -0,0 +1,14 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_STORAGE_INFLATE_HPP
+#define OUZEL_STORAGE_INFLATE_HPP
+
+#include <cstddef>
+
+namespace ouzel::storage
+{
+    // decompresses raw deflate data (RFC 1951) whose decompressed size is known, like the files in ZIP archives
+    void inflate(const std::byte* input, std::size_t inputSize, std::byte* output, std::size_t outputSize);
+}
+
+#endif // OUZEL_STORAGE_INFLATE_HPP
@@ -0,0 +1,267 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_STORAGE_MAPPEDFILE_HPP
+#define OUZEL_STORAGE_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+#include <vector>
+#if defined(_WIN32)
+#  pragma push_macro("WIN32_LEAN_AND_MEAN")
+#  pragma push_macro("NOMINMAX")
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#  pragma pop_macro("WIN32_LEAN_AND_MEAN")
+#  pragma pop_macro("NOMINMAX")
+#elif defined(__unix__) || defined(__APPLE__)
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#else
+#  include <fstream>
+#endif
+#include "Path.hpp"
+
+namespace ouzel::storage
+{
+    // read-only memory mapping of a whole file, the pages are read by the system when they are accessed
+    class MappedFile final
+    {
+    public:
+        explicit MappedFile(const Path& path)
+        {
+#if defined(_WIN32)
+            file = CreateFileW(path.getNative().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                throw std::system_error(GetLastError(), std::system_category(), "Failed to open file");
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize))
+            {
+                const auto error = GetLastError();
+                CloseHandle(file);
+                throw std::system_error(error, std::system_category(), "Failed to get file size");
+            }
+
+            size = static_cast<std::size_t>(fileSize.QuadPart);
+
+            // empty files can not be mapped
+            if (size)
+            {
+                mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!mapping)
+                {
+                    const auto error = GetLastError();
+                    CloseHandle(file);
+                    throw std::system_error(error, std::system_category(), "Failed to map file");
+                }
+
+                address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (!address)
+                {
+                    const auto error = GetLastError();
+                    CloseHandle(mapping);
+                    CloseHandle(file);
+                    throw std::system_error(error, std::system_category(), "Failed to map file");
+                }
+            }
+#elif defined(__unix__) || defined(__APPLE__)
+            int fileDescriptor = open(path.getNative().c_str(), O_RDONLY);
+            while (fileDescriptor == -1 && errno == EINTR)
+                fileDescriptor = open(path.getNative().c_str(), O_RDONLY);
+
+            if (fileDescriptor == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to open file");
+
+            struct stat s;
+            if (fstat(fileDescriptor, &s) == -1)
+            {
+                const auto error = errno;
+                close(fileDescriptor);
+                throw std::system_error(error, std::system_category(), "Failed to get file status");
+            }
+
+            size = static_cast<std::size_t>(s.st_size);
+
+            // empty files can not be mapped
+            if (size)
+            {
+                address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+                if (address == MAP_FAILED)
+                {
+                    const auto error = errno;
+                    close(fileDescriptor);
+                    throw std::system_error(error, std::system_category(), "Failed to map file");
+                }
+            }
+
+            // the mapping stays valid after the file is closed
+            close(fileDescriptor);
+#else
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file)
+                throw std::runtime_error("Failed to open file " + std::string(path));
+
+            buffer.resize(static_cast<std::size_t>(file.tellg()));
+            file.seekg(0, std::ios::beg);
+            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            size = buffer.size();
+            address = buffer.data();
+#endif
+        }
+
+        ~MappedFile()
+        {
+#if defined(_WIN32)
+            if (address) UnmapViewOfFile(address);
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(file);
+#elif defined(__unix__) || defined(__APPLE__)
+            if (size) munmap(address, size);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&&) = delete;
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        auto getData() const noexcept { return static_cast<const std::byte*>(address); }
+        auto getSize() const noexcept { return size; }
+
+    private:
+#if defined(_WIN32)
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#elif !defined(__unix__) && !defined(__APPLE__)
+        std::vector<std::byte> buffer;
+#endif
+        void* address = nullptr;
+        std::size_t size = 0;
+    };
+
+    // Read-only view of the contents of a file or of a part of it. It shares the ownership of the memory that
+    // it points to (a mapping or a buffer), so the view stays valid after the file system or the archive is gone.
+    class FileView final
+    {
+    public:
+        FileView() = default;
+
+        explicit FileView(const std::shared_ptr<const MappedFile>& file):
+            owner(file),
+            first(file->getData()),
+            count(file->getSize())
+        {
+        }
+
+        explicit FileView(const std::shared_ptr<const std::vector<std::byte>>& buffer):
+            owner(buffer),
+            first(buffer->data()),
+            count(buffer->size())
+        {
+        }
+
+        explicit FileView(std::vector<std::byte>&& data):
+            FileView(std::make_shared<const std::vector<std::byte>>(std::move(data)))
+        {
+        }
+
+        // does not own the memory, it has to stay valid while the view is used
+        FileView(const std::byte* initData, std::size_t initSize) noexcept:
+            first(initData),
+            count(initSize)
+        {
+        }
+
+        auto data() const noexcept { return first; }
+        auto size() const noexcept { return count; }
+        auto empty() const noexcept { return count == 0; }
+
+        auto begin() const noexcept { return first; }
+        auto end() const noexcept { return first + count; }
+
+        const std::byte& operator[](std::size_t index) const noexcept { return first[index]; }
+
+        FileView subview(std::size_t offset, std::size_t subviewSize) const
+        {
+            if (offset > count || subviewSize > count - offset)
+                throw std::out_of_range("Invalid file view range");
+
+            FileView result;
+            result.owner = owner;
+            result.first = first + offset;
+            result.count = subviewSize;
+            return result;
+        }
+
+    private:
+        std::shared_ptr<const void> owner;
+        const std::byte* first = nullptr;
+        std::size_t count = 0;
+    };
+
+    // stream buffer that reads from a view without copying it
+    class FileViewBuffer final: public std::streambuf
+    {
+    public:
+        explicit FileViewBuffer(const FileView& initView):
+            view(initView)
+        {
+            char* begin = const_cast<char*>(reinterpret_cast<const char*>(view.data()));
+            setg(begin, begin, begin + view.size());
+        }
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+        {
+            switch (dir)
+            {
+                case std::ios_base::beg: return seekpos(off, which);
+                case std::ios_base::cur: return seekpos(static_cast<off_type>(gptr() - eback()) + off, which);
+                case std::ios_base::end: return seekpos(static_cast<off_type>(view.size()) + off, which);
+                default: return pos_type(off_type(-1));
+            }
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode) override
+        {
+            if (pos < 0 || static_cast<std::size_t>(pos) > view.size()) return pos_type(off_type(-1));
+
+            setg(eback(), eback() + static_cast<std::ptrdiff_t>(pos), egptr());
+            return pos;
+        }
+
+    private:
+        FileView view;
+    };
+
+    class FileViewStream final: public std::istream
+    {
+    public:
+        explicit FileViewStream(const FileView& view):
+            std::istream{nullptr},
+            buffer{view}
+        {
+            rdbuf(&buffer);
+        }
+
+    private:
+        FileViewBuffer buffer;
+    };
+}
+
+#endif // OUZEL_STORAGE_MAPPEDFILE_HPP
@@ -0,0 +1,278 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <utility>
+#include "JobSystem.hpp"
+#include "../utils/Log.hpp"
+
+namespace ouzel::thread
+{
+    namespace
+    {
+        // the queue of the current thread, threads that are not workers share the last queue
+        thread_local const JobSystem* currentJobSystem = nullptr;
+        thread_local std::size_t currentQueue = 0;
+    }
+
+    std::size_t JobSystem::getDefaultWorkerCount() noexcept
+    {
+#if defined(__EMSCRIPTEN__)
+        return 0;
+#else
+        // leave one core for the thread that schedules the jobs
+        return std::max(std::thread::hardware_concurrency(), 2U) - 1;
+#endif
+    }
+
+    JobSystem::JobSystem(std::size_t workerCount)
+    {
+        queues.reserve(workerCount + 1);
+        for (std::size_t i = 0; i < workerCount + 1; ++i)
+            queues.push_back(std::make_unique<Queue>());
+
+        workers.reserve(workerCount);
+        for (std::size_t i = 0; i < workerCount; ++i)
+            workers.emplace_back(&JobSystem::work, this, i);
+    }
+
+    JobSystem::~JobSystem()
+    {
+        std::unique_lock lock(sleepMutex);
+        running = false;
+        lock.unlock();
+        sleepCondition.notify_all();
+
+        for (auto& worker : workers)
+            if (worker.isJoinable()) worker.join();
+    }
+
+    void JobSystem::run(Job job, Counter* counter, Counter* dependency)
+    {
+        schedule(std::move(job), counter, dependency, false);
+    }
+
+    void JobSystem::runOnMainThread(Job job, Counter* counter, Counter* dependency)
+    {
+        schedule(std::move(job), counter, dependency, true);
+    }
+
+    void JobSystem::executeMainThreadJobs()
+    {
+        mainThreadId = std::this_thread::get_id();
+        executeMainThreadTasks();
+    }
+
+    void JobSystem::wait(Counter& counter)
+    {
+        const auto queueIndex = (currentJobSystem == this) ? currentQueue : workers.size();
+        const auto mainThread = (mainThreadId.load() == std::this_thread::get_id());
+
+        while (!counter.isDone())
+        {
+            // jobs for the main thread would never finish if it did not run them while waiting
+            if (mainThread) executeMainThreadTasks();
+
+            if (!executeTask(queueIndex)) std::this_thread::yield();
+        }
+
+        // the thread that finished the last job may still be holding the mutex
+        std::unique_lock lock(counter.mutex);
+        const auto exception = std::exchange(counter.exception, nullptr);
+        lock.unlock();
+
+        if (exception) std::rethrow_exception(exception);
+    }
+
+    void JobSystem::parallelFor(std::size_t count, const std::function<void(std::size_t)>& function)
+    {
+        std::atomic<std::size_t> nextIndex{0};
+        Counter counter;
+
+        const auto job = [&nextIndex, count, &function]() {
+            for (auto index = nextIndex.fetch_add(1, std::memory_order_relaxed); index < count;
+                 index = nextIndex.fetch_add(1, std::memory_order_relaxed))
+                function(index);
+        };
+
+        const auto jobCount = std::min(count, workers.size() + 1);
+        for (std::size_t i = 0; i < jobCount; ++i)
+            run(job, &counter);
+
+        wait(counter);
+    }
+
+    void JobSystem::schedule(Job job, Counter* counter, Counter* dependency, bool mainThread)
+    {
+        if (counter) counter->value.fetch_add(1, std::memory_order_acq_rel);
+
+        if (dependency)
+        {
+            std::lock_guard lock(dependency->mutex);
+            if (dependency->value.load(std::memory_order_acquire) != 0)
+            {
+                dependency->dependents.push_back(Counter::Dependent{std::move(job), counter, mainThread});
+                return;
+            }
+        }
+
+        push(Task{std::move(job), counter}, mainThread);
+    }
+
+    void JobSystem::push(Task task, bool mainThread)
+    {
+        if (mainThread)
+        {
+            std::lock_guard lock(mainThreadMutex);
+            mainThreadTasks.push_back(std::move(task));
+            return;
+        }
+
+        // without workers nobody else would run the job
+        if (workers.empty())
+        {
+            execute(task);
+            return;
+        }
+
+        const auto queueIndex = (currentJobSystem == this) ? currentQueue : workers.size();
+
+        // counted before it is visible, so that the counter never underflows
+        queuedTasks.fetch_add(1, std::memory_order_release);
+
+        Queue& queue = *queues[queueIndex];
+        std::unique_lock queueLock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        queueLock.unlock();
+
+        // taking the mutex makes sure that a worker is either waiting or sees the new job
+        std::unique_lock sleepLock(sleepMutex);
+        sleepLock.unlock();
+        sleepCondition.notify_one();
+    }
+
+    bool JobSystem::executeTask(std::size_t queueIndex)
+    {
+        Task task;
+        bool found = false;
+
+        // own jobs are taken from the back, so the most recent (cache hot) job runs first
+        {
+            Queue& queue = *queues[queueIndex];
+            std::lock_guard lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                found = true;
+            }
+        }
+
+        // other queues are stolen from the front
+        for (std::size_t i = 1; !found && i < queues.size(); ++i)
+        {
+            Queue& queue = *queues[(queueIndex + i) % queues.size()];
+            std::lock_guard lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                found = true;
+            }
+        }
+
+        if (!found) return false;
+
+        queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        execute(task);
+
+        return true;
+    }
+
+    void JobSystem::executeMainThreadTasks()
+    {
+        std::vector<Task> tasks;
+
+        std::unique_lock lock(mainThreadMutex);
+        tasks.swap(mainThreadTasks);
+        lock.unlock();
+
+        for (auto& task : tasks)
+            execute(task);
+    }
+
+    void JobSystem::execute(Task& task)
+    {
+        // nobody waits for the jobs without a counter, so their exceptions are logged
+        if (!task.counter)
+        {
+            try
+            {
+                task.job();
+            }
+            catch (const std::exception& e)
+            {
+                logger.log(Log::Level::error) << e.what();
+            }
+            catch (...)
+            {
+                logger.log(Log::Level::error) << "Unknown exception in a job";
+            }
+
+            return;
+        }
+
+        try
+        {
+            task.job();
+        }
+        catch (...)
+        {
+            std::lock_guard lock(task.counter->mutex);
+            if (!task.counter->exception) task.counter->exception = std::current_exception();
+        }
+
+        finish(*task.counter);
+    }
+
+    void JobSystem::finish(Counter& counter)
+    {
+        std::vector<Counter::Dependent> dependents;
+
+        {
+            std::lock_guard lock(counter.mutex);
+            if (counter.value.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            dependents.swap(counter.dependents);
+        }
+
+        for (auto& dependent : dependents)
+            push(Task{std::move(dependent.job), dependent.counter}, dependent.mainThread);
+    }
+
+    void JobSystem::work(std::size_t index)
+    {
+        currentJobSystem = this;
+        currentQueue = index;
+
+        try
+        {
+            setCurrentThreadName("Worker " + std::to_string(index));
+        }
+        catch (...)
+        {
+        }
+
+        for (;;)
+        {
+            if (executeTask(index)) continue;
+
+            std::unique_lock lock(sleepMutex);
+            sleepCondition.wait(lock, [this]() noexcept {
+                return !running || queuedTasks.load(std::memory_order_acquire) > 0;
+            });
+
+            if (!running) break;
+        }
+    }
+}
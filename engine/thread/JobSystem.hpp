@@ -0,0 +1,121 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_THREAD_JOBSYSTEM_HPP
+#define OUZEL_THREAD_JOBSYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Thread.hpp"
+
+namespace ouzel::thread
+{
+    // Work-stealing job scheduler. Every worker owns a deque, it runs its own
+    // jobs in LIFO order and steals the oldest jobs of the other workers when
+    // its deque is empty. Threads waiting for a counter execute jobs too.
+    class JobSystem final
+    {
+    public:
+        using Job = std::function<void()>;
+
+        // number of unfinished jobs, a job can depend on a counter to run only after it reaches zero
+        class Counter final
+        {
+            friend JobSystem;
+        public:
+            Counter() = default;
+
+            Counter(const Counter&) = delete;
+            Counter& operator=(const Counter&) = delete;
+
+            Counter(Counter&&) = delete;
+            Counter& operator=(Counter&&) = delete;
+
+            auto isDone() const noexcept { return value.load(std::memory_order_acquire) == 0; }
+
+        private:
+            struct Dependent final
+            {
+                Job job;
+                Counter* counter;
+                bool mainThread;
+            };
+
+            std::atomic<std::size_t> value{0};
+            std::mutex mutex;
+            std::vector<Dependent> dependents;
+            std::exception_ptr exception;
+        };
+
+        static std::size_t getDefaultWorkerCount() noexcept;
+
+        explicit JobSystem(std::size_t workerCount = getDefaultWorkerCount());
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        JobSystem(JobSystem&&) = delete;
+        JobSystem& operator=(JobSystem&&) = delete;
+
+        auto getWorkerCount() const noexcept { return workers.size(); }
+
+        // schedules the job on a worker, the counter is decremented when the job finishes
+        void run(Job job, Counter* counter = nullptr, Counter* dependency = nullptr);
+
+        // schedules the job on the thread calling executeMainThreadJobs (the engine update thread)
+        void runOnMainThread(Job job, Counter* counter = nullptr, Counter* dependency = nullptr);
+        void executeMainThreadJobs();
+
+        // makes the calling thread run the main thread jobs while it waits, before it calls executeMainThreadJobs
+        void setMainThread() noexcept { mainThreadId = std::this_thread::get_id(); }
+
+        // executes other jobs until the counter reaches zero and rethrows the first exception of its jobs
+        void wait(Counter& counter);
+
+        // calls the function for every index in [0, count) across the workers and waits for them to finish
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)>& function);
+
+    private:
+        struct Task final
+        {
+            Job job;
+            Counter* counter = nullptr;
+        };
+
+        struct Queue final
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void schedule(Job job, Counter* counter, Counter* dependency, bool mainThread);
+        void push(Task task, bool mainThread);
+        bool executeTask(std::size_t queueIndex);
+        void executeMainThreadTasks();
+        void execute(Task& task);
+        void finish(Counter& counter);
+        void work(std::size_t index);
+
+        std::vector<std::unique_ptr<Queue>> queues; // one per worker and one for the other threads
+        std::vector<Thread> workers;
+
+        std::atomic<std::size_t> queuedTasks{0};
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        bool running = true;
+
+        std::mutex mainThreadMutex;
+        std::vector<Task> mainThreadTasks;
+        std::atomic<std::thread::id> mainThreadId{std::thread::id{}};
+    };
+}
+
+#endif // OUZEL_THREAD_JOBSYSTEM_HPP
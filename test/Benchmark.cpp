@@ -0,0 +1,57 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Benchmark.hpp"
+#include "core/Engine.hpp"
+
+// the engines of the tests are never started, so the application is never created
+std::unique_ptr<ouzel::Application> ouzel::main(const std::vector<std::string>&)
+{
+    return nullptr;
+}
+
+// runs all the benchmarks or only the ones named in the arguments
+int main(int argc, char* argv[])
+{
+    const std::pair<const char*, void(*)()> benchmarks[] = {
+        {"archive", ouzel::test::benchmarkArchive},
+        {"bundle", ouzel::test::benchmarkBundle},
+        {"cache", ouzel::test::benchmarkCache},
+        {"culling", ouzel::test::benchmarkCulling},
+        {"effects", ouzel::test::benchmarkEffects},
+        {"events", ouzel::test::benchmarkEvents},
+        {"mixer", ouzel::test::benchmarkMixer},
+        {"particles", ouzel::test::benchmarkParticles},
+        {"pitch", ouzel::test::benchmarkPitch},
+        {"resampler", ouzel::test::benchmarkResampler}
+    };
+
+    for (const auto& [name, benchmark] : benchmarks)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            if (std::strcmp(argv[i], name) == 0) selected = true;
+
+        if (!selected) continue;
+
+        try
+        {
+            benchmark();
+            std::cout << '\n';
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << name << " failed: " << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_TEST_BENCHMARK_HPP
+#define OUZEL_TEST_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+
+namespace ouzel::test
+{
+    // runs the function until the given time has passed and returns the average duration of a run in seconds
+    template <class F>
+    double measure(F function, std::chrono::steady_clock::duration minimumTime = std::chrono::milliseconds(500))
+    {
+        function(); // warm up
+
+        std::size_t runs = 0;
+        const auto start = std::chrono::steady_clock::now();
+        auto now = start;
+
+        do
+        {
+            function();
+            ++runs;
+            now = std::chrono::steady_clock::now();
+        }
+        while (now - start < minimumTime);
+
+        return std::chrono::duration<double>(now - start).count() / static_cast<double>(runs);
+    }
+
+    void benchmarkArchive();
+    void benchmarkBundle();
+    void benchmarkCache();
+    void benchmarkCulling();
+    void benchmarkEffects();
+    void benchmarkEvents();
+    void benchmarkMixer();
+    void benchmarkParticles();
+    void benchmarkPitch();
+    void benchmarkResampler();
+}
+
+#endif // OUZEL_TEST_BENCHMARK_HPP
@@ -0,0 +1,178 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "TestEngine.hpp"
+#include "assets/Bundle.hpp"
+#include "assets/Cache.hpp"
+#include "graphics/Texture.hpp"
+#include "storage/FileSystem.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr std::size_t assetCount = 500;
+        constexpr std::uint32_t imageSize = 256;
+
+        // loads raw RGBA images and generates their mip levels like the image loader does after decoding,
+        // the "upload" on the main thread only sums the levels, because the test engine has no renderer
+        class RawImageLoader final: public assets::Loader
+        {
+        public:
+            explicit RawImageLoader(assets::Cache& initCache):
+                Loader(initCache, Type::image)
+            {
+            }
+
+            bool loadAsset(assets::Bundle& bundle,
+                           const std::string& name,
+                           const std::vector<std::byte>& data,
+                           bool mipmaps) final
+            {
+                return prepareAsset(name, storage::FileView{data.data(), data.size()}, mipmaps)(bundle);
+            }
+
+            std::function<bool(assets::Bundle&)> prepareAsset(const std::string&,
+                                                               const storage::FileView& data,
+                                                               bool mipmaps) final
+            {
+                if (data.size() != imageSize * imageSize * 4)
+                    throw std::runtime_error("Invalid image size");
+
+                auto levels = graphics::Texture::generateLevels(Size2U{imageSize, imageSize},
+                                                                std::vector<std::uint8_t>(reinterpret_cast<const std::uint8_t*>(data.data()),
+                                                                                          reinterpret_cast<const std::uint8_t*>(data.data()) + data.size()),
+                                                                mipmaps ? 0 : 1,
+                                                                graphics::PixelFormat::rgba8UnsignedNorm);
+
+                return [this, levels = std::move(levels)](assets::Bundle&) {
+                    for (const auto& level : levels)
+                        for (const auto value : level.second)
+                            checksum += value;
+                    ++loadedCount;
+                    return true;
+                };
+            }
+
+            std::uint64_t checksum = 0;
+            std::size_t loadedCount = 0;
+        };
+
+        struct Result final
+        {
+            double wallTime = 0.0; // seconds until all of the assets were in the bundle
+            double mainThreadTime = 0.0; // seconds the main thread was busy with the load
+            double longestFrame = 0.0; // seconds of the longest call on the main thread
+            std::uint64_t checksum = 0;
+        };
+
+        Result load(const std::vector<assets::Asset>& assetList, bool async)
+        {
+            TestEngine testEngine;
+            auto& cache = testEngine.getCache();
+            auto& jobSystem = testEngine.getJobSystem();
+            jobSystem.setMainThread();
+
+            auto loader = std::make_unique<RawImageLoader>(cache);
+            auto& rawImageLoader = *loader;
+            cache.addLoader(std::move(loader));
+
+            Result result;
+
+            {
+                assets::Bundle bundle(cache, testEngine.getFileSystem());
+
+                const auto start = std::chrono::steady_clock::now();
+
+                if (async)
+                {
+                    const auto asyncLoad = bundle.loadAssetsAsync(assetList);
+
+                    // the main thread runs a frame whenever it gets the processor back from the workers
+                    while (!asyncLoad->isDone())
+                    {
+                        const auto frameStart = std::chrono::steady_clock::now();
+                        jobSystem.executeMainThreadJobs();
+                        const auto frameTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count();
+
+                        result.mainThreadTime += frameTime;
+                        result.longestFrame = std::max(result.longestFrame, frameTime);
+                        std::this_thread::yield();
+                    }
+
+                    asyncLoad->wait(); // rethrows the errors
+                }
+                else
+                    bundle.loadAssets(assetList);
+
+                result.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                if (!async)
+                {
+                    result.mainThreadTime = result.wallTime;
+                    result.longestFrame = result.wallTime;
+                }
+
+                if (rawImageLoader.loadedCount != assetList.size())
+                    throw std::runtime_error("Loaded " + std::to_string(rawImageLoader.loadedCount) +
+                                             " of " + std::to_string(assetList.size()) + " assets");
+
+                result.checksum = rawImageLoader.checksum;
+            }
+
+            cache.removeLoader(&rawImageLoader);
+
+            return result;
+        }
+    }
+
+    void benchmarkBundle()
+    {
+        std::vector<std::string> paths;
+        std::vector<assets::Asset> assetList;
+
+        for (std::size_t i = 0; i < assetCount; ++i)
+        {
+            const auto& path = paths.emplace_back(storage::FileSystem::getTempPath() /
+                                                  ("ouzel_benchmark_image" + std::to_string(i) + ".rgba"));
+
+            std::vector<char> pixels(imageSize * imageSize * 4);
+            for (std::size_t pixel = 0; pixel < pixels.size(); ++pixel)
+                pixels[pixel] = static_cast<char>((pixel * 7 + i * 13 + pixel / 1024) & 0xFF);
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+
+            assetList.emplace_back(assets::Loader::Type::image, "image" + std::to_string(i), path);
+        }
+
+        std::printf("%zu %ux%u RGBA images with mip levels, %u hardware threads\n",
+                    assetCount, imageSize, imageSize, std::thread::hardware_concurrency());
+        std::printf("%-8s %10s %14s %16s\n", "load", "wall ms", "main busy ms", "longest frame ms");
+
+        const auto serial = load(assetList, false);
+        const auto async = load(assetList, true);
+
+        for (const auto& [name, result] : {std::pair{"serial", serial}, std::pair{"async", async}})
+            std::printf("%-8s %10.1f %14.1f %16.2f\n", name,
+                        result.wallTime * 1000.0,
+                        result.mainThreadTime * 1000.0,
+                        result.longestFrame * 1000.0);
+
+        for (const auto& path : paths)
+            std::remove(path.c_str());
+
+        if (serial.checksum != async.checksum)
+            throw std::runtime_error("The async load produced different mip levels");
+    }
+}
@@ -0,0 +1,87 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
+#include "TestEngine.hpp"
+#include "assets/Cache.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr std::size_t assetsPerBundle = 200;
+        constexpr std::size_t lookupCount = 1024;
+    }
+
+    void benchmarkCache()
+    {
+        std::printf("Cache lookups of sprite data, %zu assets per bundle, the scan is the lookup from before the table\n",
+                    assetsPerBundle);
+        std::printf("%-8s %7s %10s %10s %10s\n", "bundles", "assets", "scan ns", "name ns", "id ns");
+
+        for (const std::size_t bundleCount : {1U, 4U, 16U, 64U})
+        {
+            TestEngine testEngine;
+            auto& cache = testEngine.getCache();
+
+            std::vector<std::unique_ptr<assets::Bundle>> bundles;
+            std::vector<std::string> names;
+
+            for (std::size_t i = 0; i < bundleCount; ++i)
+            {
+                auto& bundle = *bundles.emplace_back(std::make_unique<assets::Bundle>(cache, testEngine.getFileSystem()));
+
+                for (std::size_t j = 0; j < assetsPerBundle; ++j)
+                {
+                    const auto& name = names.emplace_back("sprites/bundle" + std::to_string(i) + "/asset" + std::to_string(j) + ".png");
+                    bundle.setSpriteData(name, scene::SpriteData());
+                }
+            }
+
+            std::mt19937 generator(1);
+            std::uniform_int_distribution<std::size_t> distribution(0, names.size() - 1);
+
+            std::vector<std::string> lookupNames;
+            std::vector<assets::AssetId> lookupIds;
+            for (std::size_t i = 0; i < lookupCount; ++i)
+            {
+                const auto& name = lookupNames.emplace_back(names[distribution(generator)]);
+                lookupIds.emplace_back(name);
+            }
+
+            // the results are summed, so that the lookups are not optimized out
+            std::size_t found = 0;
+
+            const double scanTime = measure([&cache, &lookupNames, &found]() {
+                for (const auto& name : lookupNames)
+                    for (const assets::Bundle* bundle : cache.getBundles())
+                        if (bundle->getSpriteData(name))
+                        {
+                            ++found;
+                            break;
+                        }
+            });
+
+            const double nameTime = measure([&cache, &lookupNames, &found]() {
+                for (const auto& name : lookupNames)
+                    if (cache.getSpriteData(name)) ++found;
+            });
+
+            const double idTime = measure([&cache, &lookupIds, &found]() {
+                for (const auto id : lookupIds)
+                    if (cache.getSpriteData(id)) ++found;
+            });
+
+            if (found == 0) std::printf("No assets were found\n");
+
+            std::printf("%-8zu %7zu %10.1f %10.1f %10.1f\n", bundleCount, names.size(),
+                        scanTime * 1000000000.0 / lookupCount,
+                        nameTime * 1000000000.0 / lookupCount,
+                        idTime * 1000000000.0 / lookupCount);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Test.hpp"
+#include "TestEngine.hpp"
+#include "assets/Cache.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        // the lookup that the cache did before the table, the first bundle that has the asset wins
+        template <class Get>
+        auto scanBundles(const assets::Cache& cache, Get get) -> decltype(get(*cache.getBundles().front()))
+        {
+            for (const assets::Bundle* bundle : cache.getBundles())
+                if (const auto asset = get(*bundle)) return asset;
+
+            return nullptr;
+        }
+
+        void checkLookups(const assets::Cache& cache, const std::string& name)
+        {
+            const auto spriteData = scanBundles(cache, [&name](const assets::Bundle& bundle) {
+                return bundle.getSpriteData(name);
+            });
+            const auto particleSystemData = scanBundles(cache, [&name](const assets::Bundle& bundle) {
+                return bundle.getParticleSystemData(name);
+            });
+
+            expect(cache.getSpriteData(name) == spriteData, "Cache returned the wrong sprite data " + name);
+            expect(cache.getSpriteData(assets::AssetId(name)) == spriteData,
+                   "Cache returned the wrong sprite data for the id of " + name);
+            expect(cache.getParticleSystemData(name) == particleSystemData,
+                   "Cache returned the wrong particle system data " + name);
+            expect(cache.getShader(name) == nullptr, "Cache returned a shader that was set to null " + name);
+        }
+    }
+
+    // random changes of the bundles, every lookup of the cache must match the scan of the bundles
+    void testCache()
+    {
+        TestEngine testEngine;
+        auto& cache = testEngine.getCache();
+        auto& fileSystem = testEngine.getFileSystem();
+
+        std::vector<std::unique_ptr<assets::Bundle>> bundles;
+        for (int i = 0; i < 4; ++i)
+            bundles.push_back(std::make_unique<assets::Bundle>(cache, fileSystem));
+
+        std::vector<std::string> names;
+        for (int i = 0; i < 64; ++i)
+            names.push_back("asset" + std::to_string(i));
+
+        std::mt19937 generator(1);
+        std::uniform_int_distribution<std::size_t> nameDistribution(0, names.size() - 1);
+        std::uniform_int_distribution<int> operationDistribution(0, 99);
+
+        for (int step = 0; step < 20000; ++step)
+        {
+            std::uniform_int_distribution<std::size_t> bundleDistribution(0, bundles.size() - 1);
+            auto& bundle = *bundles[bundleDistribution(generator)];
+            const auto& name = names[nameDistribution(generator)];
+            const auto operation = operationDistribution(generator);
+
+            if (operation < 40)
+                bundle.setSpriteData(name, scene::SpriteData());
+            else if (operation < 70)
+                bundle.setParticleSystemData(name, scene::ParticleSystemData());
+            else if (operation < 85)
+                bundle.setShader(name, nullptr); // a null asset is not in the cache
+            else if (operation < 95)
+                bundle.releaseSpriteData();
+            else if (operation < 98)
+                bundle.releaseParticleSystemData();
+            else
+            {
+                // the new bundle is the last one that the cache searches
+                const auto index = bundleDistribution(generator);
+                bundles.erase(bundles.begin() + static_cast<std::ptrdiff_t>(index));
+                bundles.push_back(std::make_unique<assets::Bundle>(cache, fileSystem));
+            }
+
+            checkLookups(cache, names[nameDistribution(generator)]);
+        }
+
+        for (const auto& name : names)
+            checkLookups(cache, name);
+    }
+}
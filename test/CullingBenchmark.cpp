@@ -0,0 +1,149 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
+#include "scene/Actor.hpp"
+#include "scene/Component.hpp"
+#include "scene/Layer.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr float actorSize = 32.0F;
+        constexpr float viewWidth = 1280.0F;
+        constexpr float viewHeight = 720.0F;
+
+        class BenchmarkLayer final: public scene::Layer
+        {
+        public:
+            using Layer::prepareDraw;
+            using Layer::findIndexedActors;
+            using Layer::visibleActors;
+        };
+
+        // the test of the orthographic camera in world space, the cameras need graphics to calculate their matrices
+        bool isVisible(const scene::Actor& actor, const Box3F& boundingBox, const Box3F& viewBox) noexcept
+        {
+            Box3F worldBox;
+            for (const auto x : {boundingBox.min.v[0], boundingBox.max.v[0]})
+                for (const auto y : {boundingBox.min.v[1], boundingBox.max.v[1]})
+                {
+                    Vector3F corner{x, y, 0.0F};
+                    actor.getTransform().transformPoint(corner);
+                    worldBox.insertPoint(corner);
+                }
+
+            return worldBox.intersects(viewBox);
+        }
+    }
+
+    void benchmarkCulling()
+    {
+        std::printf("Culling %.0fx%.0f actors at constant density in a %.0fx%.0f view, the visit is shared by both paths,\n"
+                    "moved is the cost of moving a tenth of the actors and querying the index on top of the visit\n",
+                    static_cast<double>(actorSize), static_cast<double>(actorSize),
+                    static_cast<double>(viewWidth), static_cast<double>(viewHeight));
+        std::printf("%-8s %10s %12s %12s %12s %12s %12s\n",
+                    "actors", "visit us", "linear us", "index us", "moved us", "lin pick us", "idx pick us");
+
+        for (const std::size_t actorCount : {1000U, 10000U, 100000U})
+        {
+            BenchmarkLayer layer;
+            layer.setSpatialIndexEnabled(true);
+
+            // the world grows with the actor count, so that about the same number of actors is visible
+            const float worldSize = std::sqrt(static_cast<float>(actorCount)) * actorSize * 2.0F;
+            std::mt19937 generator(1);
+            std::uniform_real_distribution<float> coordinate(-worldSize / 2.0F, worldSize / 2.0F);
+            std::uniform_real_distribution<float> offset(-4.0F, 4.0F);
+
+            std::vector<std::unique_ptr<scene::Actor>> actors;
+            for (std::size_t i = 0; i < actorCount; ++i)
+            {
+                auto& actor = *actors.emplace_back(std::make_unique<scene::Actor>());
+                actor.setPickable(true);
+                actor.setPosition(Vector2F{coordinate(generator), coordinate(generator)});
+
+                auto component = std::make_unique<scene::Component>();
+                component->setBoundingBox(Box3F{Vector3F{-actorSize / 2.0F, -actorSize / 2.0F, 0.0F},
+                                                Vector3F{actorSize / 2.0F, actorSize / 2.0F, 0.0F}});
+                actor.addComponent(std::move(component));
+
+                layer.addChild(actor);
+            }
+
+            const Box3F viewBox{Vector3F{-viewWidth / 2.0F, -viewHeight / 2.0F, std::numeric_limits<float>::lowest()},
+                                Vector3F{viewWidth / 2.0F, viewHeight / 2.0F, std::numeric_limits<float>::max()}};
+
+            // the counts are compared, so that the culling is not optimized out
+            std::size_t linearVisible = 0;
+            std::size_t indexVisible = 0;
+
+            const double visitTime = measure([&layer]() {
+                layer.prepareDraw();
+            });
+
+            const double linearTime = measure([&layer, &viewBox, &linearVisible]() {
+                linearVisible = 0;
+                for (const auto& [actor, boundingBox] : layer.visibleActors)
+                    if (isVisible(*actor, boundingBox, viewBox)) ++linearVisible;
+            });
+
+            const double indexTime = measure([&layer, &viewBox, &indexVisible]() {
+                indexVisible = 0;
+                layer.getSpatialIndex()->query(viewBox, [&viewBox, &indexVisible](scene::Actor* actor) {
+                    if (isVisible(*actor, actor->getBoundingBox(), viewBox)) ++indexVisible;
+                });
+            });
+
+            if (linearVisible != indexVisible)
+                throw std::runtime_error("The index found " + std::to_string(indexVisible) +
+                                         " actors instead of " + std::to_string(linearVisible));
+
+            // a tenth of the actors move a little every frame, some of them leave their enlarged boxes
+            std::size_t next = 0;
+            const double movedTime = measure([&layer, &actors, &generator, &offset, &viewBox, &indexVisible, &next]() {
+                for (std::size_t i = 0; i < actors.size() / 10; ++i, next = (next + 1) % actors.size())
+                {
+                    auto& actor = *actors[next];
+                    actor.setPosition(Vector2F(actor.getPosition()) + Vector2F{offset(generator), offset(generator)});
+                }
+
+                layer.prepareDraw();
+
+                indexVisible = 0;
+                layer.getSpatialIndex()->query(viewBox, [&viewBox, &indexVisible](scene::Actor* actor) {
+                    if (isVisible(*actor, actor->getBoundingBox(), viewBox)) ++indexVisible;
+                });
+            }) - visitTime;
+
+            std::size_t picked = 0;
+            const Vector2F pickPosition(actors.front()->getPosition());
+
+            const double linearPickTime = measure([&layer, &pickPosition, &picked]() {
+                for (const auto& [actor, boundingBox] : layer.visibleActors)
+                    if (actor->isPickable() && actor->pointOn(pickPosition)) ++picked;
+            });
+
+            const double indexPickTime = measure([&layer, &pickPosition, &picked]() {
+                picked += layer.findIndexedActors(pickPosition).size();
+            });
+
+            std::printf("%-8zu %10.1f %12.1f %12.1f %12.1f %12.2f %12.2f\n", actorCount,
+                        visitTime * 1000000.0, linearTime * 1000000.0, indexTime * 1000000.0,
+                        movedTime * 1000000.0, linearPickTime * 1000000.0, indexPickTime * 1000000.0);
+
+            if (picked == 0) std::printf("No actor was picked\n");
+
+            layer.removeAllChildren();
+        }
+    }
+}
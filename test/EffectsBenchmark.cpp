@@ -0,0 +1,77 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Benchmark.hpp"
+#include "Tone.hpp"
+#include "audio/Audio.hpp"
+#include "audio/Effects.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr std::uint32_t bufferSize = 512;
+        constexpr std::uint32_t channels = 2;
+        constexpr std::uint32_t sampleRate = 44100;
+    }
+
+    void benchmarkEffects()
+    {
+        // the Panner is not measured, because its processor does not process the samples yet
+        const std::pair<const char*, std::function<std::unique_ptr<audio::Effect>(audio::Audio&)>> effects[] = {
+            {"Delay", [](audio::Audio& audio) { return std::make_unique<audio::Delay>(audio, 0.1F); }},
+            {"Gain", [](audio::Audio& audio) { return std::make_unique<audio::Gain>(audio, -6.0F); }},
+            {"PitchScale", [](audio::Audio& audio) { return std::make_unique<audio::PitchScale>(audio, 1.5F); }},
+            {"PitchShift", [](audio::Audio& audio) { return std::make_unique<audio::PitchShift>(audio, 1.5F); }},
+            {"Reverb", [](audio::Audio& audio) { return std::make_unique<audio::Reverb>(audio, 0.1F, 0.5F); }},
+            {"LowPass", [](audio::Audio& audio) { return std::make_unique<audio::LowPass>(audio, 1000.0F); }},
+            {"HighPass", [](audio::Audio& audio) { return std::make_unique<audio::HighPass>(audio, 1000.0F); }}
+        };
+
+        audio::Settings settings;
+        settings.bufferSize = bufferSize;
+        settings.sampleRate = sampleRate;
+        settings.channels = channels;
+        settings.mixerBufferCount = 0; // mixed on the calling thread
+        settings.mixerWorkerCount = 0;
+
+        audio::Audio audio(audio::Driver::empty, settings);
+
+        // the tone has the sample rate of the device, so that only the effect and the mixing of the tone are measured
+        const auto dataId = audio.initData(std::make_unique<ToneData>(channels, sampleRate));
+        const auto streamId = audio.initStream(dataId);
+        audio.addCommand(std::make_unique<audio::mixer::SetStreamOutputCommand>(streamId, audio.getMasterMix().getBusId()));
+        audio.addCommand(std::make_unique<audio::mixer::PlayStreamCommand>(streamId));
+        audio.update();
+
+        std::vector<float> samples;
+        const auto render = [&audio, &samples]() {
+            audio.getMixer().getSamples(bufferSize, channels, sampleRate, samples);
+        };
+
+        std::printf("Effects on the master mix, %u frame stereo blocks at %u Hz, without the cost of mixing the tone\n",
+                    bufferSize, sampleRate);
+        std::printf("%-11s %10s\n", "effect", "ns/sample");
+
+        for (const auto& [name, createEffect] : effects)
+        {
+            const auto effect = createEffect(audio);
+            audio.getMasterMix().addEffect(effect.get());
+            audio.update();
+
+            const double blockTime = measure(render);
+
+            // the baseline is measured right after the effect, so that the clock changes of the CPU affect both the same
+            effect->setEnabled(false);
+            audio.update();
+
+            const double baseline = measure(render);
+
+            std::printf("%-11s %10.2f\n", name, (blockTime - baseline) * 1000000000.0 / (bufferSize * channels));
+        }
+    }
+}
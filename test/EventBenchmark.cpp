@@ -0,0 +1,99 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "events/EventDispatcher.hpp"
+#include "events/EventHandler.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        // eight producers stay below the capacity of the event queue even if the dispatching falls behind
+        constexpr std::uint32_t eventsPerProducer = 100000;
+
+        enum class Mode
+        {
+            post,
+            queue,
+            mixed // every other event is posted
+        };
+
+        // returns the events per second, the producer and the sequence number are sent in the position of the
+        // event and every producer's events have to arrive in the order they were sent
+        double measureEvents(std::size_t producerCount, Mode mode)
+        {
+            EventDispatcher dispatcher;
+            EventHandler handler;
+
+            std::vector<std::uint32_t> nextSequences(producerCount, 0);
+            std::size_t received = 0;
+
+            handler.mouseHandler = [&nextSequences, &received](const MouseEvent& event) {
+                const auto producer = static_cast<std::size_t>(event.position.v[0]);
+                const auto sequence = static_cast<std::uint32_t>(event.position.v[1]);
+
+                if (sequence != nextSequences[producer]++)
+                    throw std::runtime_error("Event " + std::to_string(sequence) + " of producer " +
+                                             std::to_string(producer) + " arrived out of order");
+                ++received;
+                return true;
+            };
+            dispatcher.addEventHandler(handler);
+
+            std::atomic_bool start{false};
+            std::vector<std::thread> producers;
+
+            for (std::size_t producer = 0; producer < producerCount; ++producer)
+                producers.emplace_back([&dispatcher, &start, producer, mode]() {
+                    while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+
+                    for (std::uint32_t sequence = 0; sequence < eventsPerProducer; ++sequence)
+                    {
+                        MouseEvent event;
+                        event.type = Event::Type::mouseMove;
+                        event.position = Vector2F{static_cast<float>(producer), static_cast<float>(sequence)};
+
+                        if (mode == Mode::post || (mode == Mode::mixed && sequence % 2 == 0))
+                            dispatcher.postEvent(std::make_unique<MouseEvent>(event));
+                        else
+                            dispatcher.queueEvent(event);
+                    }
+                });
+
+            const auto total = producerCount * eventsPerProducer;
+            const auto startTime = std::chrono::steady_clock::now();
+            start.store(true, std::memory_order_release);
+
+            while (received < total)
+                dispatcher.dispatchEvents();
+
+            const auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+            for (auto& thread : producers)
+                thread.join();
+
+            return static_cast<double>(total) / time;
+        }
+    }
+
+    void benchmarkEvents()
+    {
+        std::printf("%u mouse events per producer, dispatched on this thread while the producers send them\n",
+                    eventsPerProducer);
+        std::printf("%-10s %14s %14s %14s\n", "producers", "post M/s", "queue M/s", "mixed M/s");
+
+        for (const std::size_t producerCount : {1U, 2U, 4U, 8U})
+            std::printf("%-10zu %14.2f %14.2f %14.2f\n", producerCount,
+                        measureEvents(producerCount, Mode::post) / 1000000.0,
+                        measureEvents(producerCount, Mode::queue) / 1000000.0,
+                        measureEvents(producerCount, Mode::mixed) / 1000000.0);
+    }
+}
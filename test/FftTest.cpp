@@ -0,0 +1,122 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "Test.hpp"
+#include "audio/mixer/Fft.hpp"
+#include "audio/mixer/PhaseVocoder.hpp"
+#include "math/Constants.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        std::vector<float> randomSamples(std::mt19937& generator, std::size_t count)
+        {
+            std::uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+            std::vector<float> result(count);
+            for (float& sample : result) sample = distribution(generator);
+            return result;
+        }
+
+        // the FFT must give the same bins as the definition of the DFT, computed in double precision
+        void testTransform(std::mt19937& generator)
+        {
+            for (std::uint32_t size = 8; size <= 4096; size *= 2)
+            {
+                const auto input = randomSamples(generator, size);
+                const std::uint32_t binCount = size / 2 + 1;
+
+                audio::mixer::Fft fft(size);
+                std::vector<float> real(binCount);
+                std::vector<float> imag(binCount);
+                fft.forward(input.data(), real.data(), imag.data());
+
+                // the rounding errors grow with the square root of the size like the magnitudes of the random bins
+                const double tolerance = 1e-5 * std::sqrt(static_cast<double>(size));
+
+                for (std::uint32_t bin = 0; bin < binCount; ++bin)
+                {
+                    double expectedReal = 0.0;
+                    double expectedImag = 0.0;
+                    for (std::uint32_t i = 0; i < size; ++i)
+                    {
+                        // the index product is reduced first, so that the angle stays exact for the large sizes
+                        const double angle = tau<double> * static_cast<double>((std::uint64_t{bin} * i) % size) / size;
+                        expectedReal += static_cast<double>(input[i]) * std::cos(angle);
+                        expectedImag -= static_cast<double>(input[i]) * std::sin(angle);
+                    }
+
+                    expect(std::abs(static_cast<double>(real[bin]) - expectedReal) <= tolerance &&
+                           std::abs(static_cast<double>(imag[bin]) - expectedImag) <= tolerance,
+                           "FFT of size " + std::to_string(size) + " differs from the DFT in bin " + std::to_string(bin));
+                }
+
+                // the inverse is scaled by the size
+                std::vector<float> output(size);
+                fft.inverse(real.data(), imag.data(), output.data());
+
+                for (std::uint32_t i = 0; i < size; ++i)
+                    expect(std::abs(static_cast<double>(output[i]) / size - static_cast<double>(input[i])) <= 1e-5,
+                           "Inverse FFT of size " + std::to_string(size) + " does not restore sample " + std::to_string(i));
+            }
+        }
+
+        // without a pitch change the phase vocoder only delays the samples by its latency, the input is a chord, because
+        // the phase errors of the approximated trigonometry add up over the hops in the quiet bins of a noise
+        void testPhaseVocoder()
+        {
+            constexpr std::uint32_t channels = 2;
+            constexpr std::uint32_t blockSize = 512;
+            constexpr std::uint32_t blockCount = 16;
+
+            audio::mixer::PhaseVocoder phaseVocoder;
+            phaseVocoder.prepare(channels);
+            const std::uint32_t latency = phaseVocoder.getLatency();
+
+            std::vector<float> input(blockSize * blockCount * channels);
+            for (std::uint32_t i = 0; i < blockCount; ++i)
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    for (std::uint32_t frame = 0; frame < blockSize; ++frame)
+                    {
+                        const double time = static_cast<double>(i * blockSize + frame) / 44100.0;
+                        input[(i * channels + channel) * blockSize + frame] =
+                            static_cast<float>(0.3 * std::sin(tau<double> * 440.0 * time) +
+                                               0.3 * std::sin(tau<double> * 1234.5 * time + channel) +
+                                               0.3 * std::sin(tau<double> * 5000.0 * time));
+                    }
+
+            std::vector<float> output; // interleaved by blocks like the input, every block is planar
+            std::vector<float> block(blockSize * channels);
+
+            for (std::uint32_t i = 0; i < blockCount; ++i)
+            {
+                std::copy(input.begin() + i * blockSize * channels, input.begin() + (i + 1) * blockSize * channels, block.begin());
+                phaseVocoder.process(1.0F, blockSize, channels, block.data());
+                output.insert(output.end(), block.begin(), block.end());
+            }
+
+            const auto sample = [](const std::vector<float>& samples, std::uint32_t channel, std::uint32_t frame) {
+                const auto blockIndex = frame / blockSize;
+                return samples[blockIndex * blockSize * channels + channel * blockSize + frame % blockSize];
+            };
+
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                for (std::uint32_t frame = latency; frame < blockSize * blockCount; ++frame)
+                    expect(std::abs(sample(output, channel, frame) - sample(input, channel, frame - latency)) <= 1e-4F,
+                           "Phase vocoder changed frame " + std::to_string(frame) + " of channel " +
+                           std::to_string(channel) + " without a pitch change");
+        }
+    }
+
+    void testFft()
+    {
+        std::mt19937 generator(1);
+        testTransform(generator);
+        testPhaseVocoder();
+    }
+}
@@ -0,0 +1,59 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Test.hpp"
+#include "TestEngine.hpp"
+#include "storage/FileSystem.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        void testRegularFiles(storage::FileSystem& fileSystem)
+        {
+            const auto path = storage::FileSystem::getTempPath() / "ouzel_test_file.bin";
+
+            // the sizes around the first chunk of the files of unknown size
+            for (const std::size_t size : {0U, 1U, 4095U, 4096U, 4097U, 100000U})
+            {
+                std::vector<std::byte> expected(size);
+                for (std::size_t i = 0; i < size; ++i)
+                    expected[i] = static_cast<std::byte>(i * 7 + i / 256);
+
+                {
+                    std::ofstream file(std::string(path), std::ios::binary | std::ios::trunc);
+                    file.write(reinterpret_cast<const char*>(expected.data()), static_cast<std::streamsize>(size));
+                }
+
+                expect(fileSystem.readFile(path, false) == expected,
+                       "Read file of " + std::to_string(size) + " bytes does not match the written data");
+            }
+
+            std::remove(std::string(path).c_str());
+        }
+
+        // the generated files report the size zero
+        void testGeneratedFiles(storage::FileSystem& fileSystem)
+        {
+#if defined(__linux__) && !defined(__ANDROID__)
+            const auto data = fileSystem.readFile(storage::Path{"/proc/self/status"}, false);
+            const std::string status(reinterpret_cast<const char*>(data.data()), data.size());
+            expect(status.find("Name:") == 0, "Generated file was not read");
+#else
+            static_cast<void>(fileSystem);
+#endif
+        }
+    }
+
+    void testFileSystem()
+    {
+        TestEngine testEngine;
+        auto& fileSystem = testEngine.getFileSystem();
+
+        testRegularFiles(fileSystem);
+        testGeneratedFiles(fileSystem);
+    }
+}
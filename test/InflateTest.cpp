@@ -0,0 +1,187 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Test.hpp"
+#include "storage/Inflate.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        // raw deflate streams of getText(600) made by zlib 1.2.13 at level 9, with the Z_FIXED strategy for the first one
+        constexpr std::uint8_t fixedBlock[] = {
+            0x4B, 0x2A, 0xCD, 0x4B, 0xC9, 0x49, 0x55, 0x48, 0x49, 0x4D, 0xCB, 0x49, 0x2C, 0x41, 0xD0, 0x89,
+            0xC5, 0xC5, 0xA9, 0x25, 0x0A, 0xF9, 0xA5, 0x55, 0xA9, 0x39, 0x50, 0x12, 0x59, 0x24, 0x35, 0x2F,
+            0x3D, 0x33, 0x0F, 0x53, 0x13, 0x17, 0x8C, 0x01, 0xD5, 0x51, 0x94, 0x9C, 0x91, 0x59, 0x06, 0x33,
+            0x0B, 0x99, 0x84, 0xEA, 0x4F, 0x82, 0xD8, 0x0D, 0xA5, 0x20, 0x52, 0x5C, 0x10, 0xBD, 0x5C, 0x50,
+            0x41, 0x4C, 0x17, 0x60, 0x77, 0x29, 0x36, 0xA3, 0x90, 0xF5, 0xC2, 0xCC, 0x83, 0x1A, 0x0F, 0xD7,
+            0x0C, 0x75, 0x22, 0x17, 0xD4, 0x75, 0x28, 0x2E, 0xE6, 0xC2, 0xE1, 0x1F, 0x08, 0x0F, 0x66, 0x15,
+            0x54, 0x10, 0xAB, 0x73, 0xB8, 0x50, 0x95, 0xA2, 0xB8, 0x1F, 0x2A, 0x08, 0x0D, 0x0A, 0x2E, 0x94,
+            0x80, 0xC1, 0x08, 0x50, 0x54, 0xAB, 0x91, 0x49, 0x54, 0x7B, 0xD1, 0x0C, 0x47, 0xA5, 0xE0, 0x56,
+            0x41, 0x0D, 0x4B, 0x42, 0x8D, 0x7A, 0x34, 0xBB, 0x61, 0xAA, 0xD1, 0x8C, 0x44, 0xB6, 0x1B, 0xAA,
+            0x04, 0x9B, 0xE3, 0x92, 0x00
+        };
+        constexpr std::uint8_t dynamicBlock[] = {
+            0x75, 0x51, 0x49, 0x0E, 0x80, 0x20, 0x0C, 0xBC, 0xF7, 0x15, 0x7E, 0x4D, 0xB4, 0x2A, 0x09, 0xC1,
+            0x44, 0xD1, 0x83, 0xAF, 0xF7, 0xC0, 0x14, 0x5B, 0xC0, 0x4B, 0x2B, 0x43, 0x67, 0xA1, 0xBA, 0x2B,
+            0xCE, 0x81, 0x87, 0x99, 0x97, 0x30, 0xA6, 0xAF, 0x8F, 0xE7, 0xC9, 0x69, 0xD8, 0xAF, 0x87, 0x03,
+            0xAA, 0x46, 0x38, 0xAE, 0x3E, 0xB6, 0x24, 0x92, 0x0F, 0x30, 0x8E, 0x69, 0xF3, 0xB7, 0x68, 0xE9,
+            0x0A, 0xBE, 0xCB, 0xDE, 0x68, 0xF9, 0x8A, 0x32, 0x97, 0x00, 0xB6, 0x09, 0xFA, 0x49, 0x7B, 0x52,
+            0x9A, 0x2B, 0x7A, 0x90, 0x2F, 0x64, 0x44, 0x24, 0xA4, 0x33, 0x89, 0xE9, 0xE7, 0x3D, 0xF9, 0x24,
+            0x56, 0x00, 0xBB, 0x71, 0xC8, 0x8E, 0x9A, 0xFC, 0x00, 0xB1, 0x0A, 0x32, 0x8B, 0x69, 0x16, 0x6A,
+            0xAD, 0x75, 0xB5, 0xBE, 0x95, 0xB8, 0x6D, 0xC5, 0x0A, 0x62, 0xCE, 0xFE, 0xFA, 0xCA, 0x5B, 0xA6,
+            0x2B, 0x49, 0xED, 0x8D, 0x91, 0x5E, 0x38, 0xF7, 0x02
+        };
+
+        // the text that the blocks were made from, the same generator is used to make them
+        std::vector<std::byte> getText(std::size_t size)
+        {
+            static const std::string words[] = {"ouzel ", "engine ", "asset ", "bundle ", "archive ", "deflate ", "\n"};
+
+            std::string text;
+            std::uint32_t state = 1;
+
+            while (text.size() < size)
+            {
+                state = state * 1103515245U + 12345U;
+                text += words[(state >> 16) % 7];
+            }
+
+            std::vector<std::byte> result(size);
+            for (std::size_t i = 0; i < size; ++i)
+                result[i] = static_cast<std::byte>(text[i]);
+            return result;
+        }
+
+        template <std::size_t size>
+        std::vector<std::byte> toBytes(const std::uint8_t (&data)[size])
+        {
+            std::vector<std::byte> result(size);
+            for (std::size_t i = 0; i < size; ++i)
+                result[i] = static_cast<std::byte>(data[i]);
+            return result;
+        }
+
+        void appendStoredBlock(std::vector<std::byte>& stream, const std::byte* data, std::uint16_t size, bool final)
+        {
+            const auto complement = static_cast<std::uint16_t>(~size);
+            stream.push_back(static_cast<std::byte>(final ? 1 : 0));
+            stream.push_back(static_cast<std::byte>(size & 0xFF));
+            stream.push_back(static_cast<std::byte>(size >> 8));
+            stream.push_back(static_cast<std::byte>(complement & 0xFF));
+            stream.push_back(static_cast<std::byte>(complement >> 8));
+            stream.insert(stream.end(), data, data + size);
+        }
+
+        std::vector<std::byte> inflate(const std::vector<std::byte>& input, std::size_t outputSize)
+        {
+            std::vector<std::byte> output(outputSize);
+            storage::inflate(input.data(), input.size(), output.data(), output.size());
+            return output;
+        }
+
+        bool failsToInflate(const std::vector<std::byte>& input, std::size_t outputSize)
+        {
+            try
+            {
+                inflate(input, outputSize);
+                return false;
+            }
+            catch (const std::runtime_error&)
+            {
+                return true;
+            }
+        }
+
+        void testStoredBlocks()
+        {
+            expect(inflate({std::byte{0x01}, std::byte{0x00}, std::byte{0x00}, std::byte{0xFF}, std::byte{0xFF}}, 0).empty(),
+                   "Empty stored block was not inflated");
+
+            // the largest stored block, an empty one and the rest
+            const auto text = getText(70000);
+            std::vector<std::byte> stream;
+            appendStoredBlock(stream, text.data(), 65535, false);
+            appendStoredBlock(stream, text.data() + 65535, 0, false);
+            appendStoredBlock(stream, text.data() + 65535, static_cast<std::uint16_t>(text.size() - 65535), true);
+            expect(inflate(stream, text.size()) == text, "Stored blocks were not inflated");
+        }
+
+        void testCompressedBlocks()
+        {
+            const auto text = getText(600);
+
+            expect(inflate(toBytes(fixedBlock), text.size()) == text, "Fixed Huffman block was not inflated");
+            expect(inflate(toBytes(dynamicBlock), text.size()) == text, "Dynamic Huffman block was not inflated");
+
+            // the compressed block starts at the byte after the stored one
+            std::vector<std::byte> stream;
+            appendStoredBlock(stream, text.data(), 100, false);
+            const auto fixed = toBytes(fixedBlock);
+            stream.insert(stream.end(), fixed.begin(), fixed.end());
+
+            auto expected = std::vector<std::byte>(text.begin(), text.begin() + 100);
+            expected.insert(expected.end(), text.begin(), text.end());
+            expect(inflate(stream, expected.size()) == expected, "Stored block followed by a fixed block was not inflated");
+
+            // a literal followed by a match that overlaps the output
+            expect(inflate({std::byte{0x4B}, std::byte{0x04}, std::byte{0x02}, std::byte{0x00}}, 4) ==
+                   std::vector<std::byte>(4, std::byte{'a'}), "Overlapping match was not inflated");
+        }
+
+        void testMalformedData()
+        {
+            const auto text = getText(600);
+            const auto fixed = toBytes(fixedBlock);
+            const auto dynamic = toBytes(dynamicBlock);
+
+            expect(failsToInflate({}, 0), "Empty data was inflated");
+            expect(failsToInflate({std::byte{0x07}}, 0), "Block of the reserved type was inflated");
+            expect(failsToInflate({std::byte{0x01}, std::byte{0x05}, std::byte{0x00}, std::byte{0xFF}, std::byte{0xFF},
+                                   std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}, std::byte{5}}, 5),
+                   "Stored block with a wrong complement of the length was inflated");
+            expect(failsToInflate({std::byte{0x01}, std::byte{0x05}, std::byte{0x00}, std::byte{0xFA}, std::byte{0xFF},
+                                   std::byte{1}, std::byte{2}}, 5),
+                   "Truncated stored block was inflated");
+
+            // a match with the distance 2 after one literal
+            expect(failsToInflate({std::byte{0x4B}, std::byte{0x04}, std::byte{0x42}, std::byte{0x00}}, 4),
+                   "Match before the start of the output was inflated");
+
+            // four code length codes of the length 1
+            expect(failsToInflate({std::byte{0x05}, std::byte{0x00}, std::byte{0x92}, std::byte{0x04}, std::byte{0x00},
+                                   std::byte{0x00}}, 0),
+                   "Over-subscribed code lengths were inflated");
+
+            for (const auto& block : {fixed, dynamic})
+            {
+                expect(failsToInflate(std::vector<std::byte>(block.begin(), block.end() - 10), text.size()),
+                       "Truncated block was inflated");
+                expect(failsToInflate(block, text.size() - 1), "Block was inflated into a smaller output");
+                expect(failsToInflate(block, text.size() + 1), "Block was inflated into a larger output");
+            }
+
+            // the corrupted blocks must throw or decode into the output without reading or writing past the ends,
+            // which the runs with the sanitizers check
+            std::mt19937 generator(1);
+            for (int i = 0; i < 10000; ++i)
+            {
+                auto corrupted = (i % 2) ? fixed : dynamic;
+                std::uniform_int_distribution<std::size_t> position(0, corrupted.size() - 1);
+                corrupted[position(generator)] ^= static_cast<std::byte>(1U << (generator() % 8));
+                failsToInflate(corrupted, text.size());
+            }
+        }
+    }
+
+    void testInflate()
+    {
+        testStoredBlocks();
+        testCompressedBlocks();
+        testMalformedData();
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <atomic>
+#include <stdexcept>
+#include "Test.hpp"
+#include "thread/JobSystem.hpp"
+
+namespace ouzel::test
+{
+    void testJobSystem()
+    {
+        thread::JobSystem jobSystem(2);
+
+        // a job without a counter must not take the worker down with it
+        for (int i = 0; i < 8; ++i)
+            jobSystem.run([]() { throw std::runtime_error("Test exception"); });
+
+        std::atomic<int> executed{0};
+        thread::JobSystem::Counter counter;
+        for (int i = 0; i < 64; ++i)
+            jobSystem.run([&executed]() { ++executed; }, &counter);
+
+        jobSystem.wait(counter);
+        expect(executed == 64, "Jobs were not executed after a job threw");
+
+        // the engine sets the main thread before the application can wait for a load, which is before the first update
+        jobSystem.setMainThread();
+
+        bool finished = false;
+        thread::JobSystem::Counter mainThreadCounter;
+        jobSystem.run([&jobSystem, &finished, &mainThreadCounter]() {
+            jobSystem.runOnMainThread([&finished]() { finished = true; }, &mainThreadCounter);
+        }, &mainThreadCounter);
+
+        jobSystem.wait(mainThreadCounter);
+        expect(finished, "A main thread job was not executed while the main thread waited");
+    }
+}
@@ -0,0 +1,201 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "Test.hpp"
+#include "audio/mixer/Kernels.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        // the vectorized loops must give exactly the same results as these scalar loops
+        constexpr std::size_t maxLength = 1024;
+        constexpr std::size_t maxOffset = 4;
+        constexpr std::uint32_t channelCounts[] = {1, 2, 3, 6};
+
+        std::vector<float> randomSamples(std::mt19937& generator, std::size_t count)
+        {
+            std::uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+            std::vector<float> result(count);
+            for (float& sample : result) sample = distribution(generator);
+            return result;
+        }
+
+        template <class T>
+        bool equal(const std::vector<T>& a, const std::vector<T>& b)
+        {
+            return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+        }
+
+        std::string describe(const char* kernel, std::size_t length, std::size_t offset)
+        {
+            return std::string(kernel) + " differs from the scalar code for " + std::to_string(length) +
+                " samples at offset " + std::to_string(offset);
+        }
+
+        void testArithmetic(std::mt19937& generator)
+        {
+            for (std::size_t length = 0; length < maxLength; ++length)
+                for (std::size_t offset = 0; offset < maxOffset; ++offset)
+                {
+                    const auto source = randomSamples(generator, length + maxOffset);
+                    const auto destination = randomSamples(generator, length + maxOffset);
+                    const float* input = source.data() + offset;
+                    // the source and the destination are misaligned differently
+                    const std::size_t outputOffset = (offset + 1) % maxOffset;
+
+                    auto expected = destination;
+                    auto result = destination;
+                    for (std::size_t i = 0; i < length; ++i) expected[outputOffset + i] += input[i];
+                    audio::mixer::add(input, result.data() + outputOffset, length);
+                    expect(equal(result, expected), describe("add", length, offset));
+
+                    expected = destination;
+                    result = destination;
+                    for (std::size_t i = 0; i < length; ++i) expected[outputOffset + i] += input[i] * 0.37F;
+                    audio::mixer::addScaled(input, result.data() + outputOffset, length, 0.37F);
+                    expect(equal(result, expected), describe("addScaled", length, offset));
+
+                    expected = destination;
+                    result = destination;
+                    for (std::size_t i = 0; i < length; ++i) expected[outputOffset + i] = input[i] * -1.5F;
+                    audio::mixer::scale(input, result.data() + outputOffset, length, -1.5F);
+                    expect(equal(result, expected), describe("scale", length, offset));
+
+                    expected = destination;
+                    result = destination;
+                    for (std::size_t i = 0; i < length; ++i) expected[outputOffset + i] = std::clamp(input[i], -0.5F, 0.5F);
+                    audio::mixer::clamp(input, result.data() + outputOffset, length, -0.5F, 0.5F);
+                    expect(equal(result, expected), describe("clamp", length, offset));
+
+                    // in place
+                    expected = destination;
+                    result = destination;
+                    for (std::size_t i = 0; i < length; ++i) expected[offset + i] *= 2.0F;
+                    audio::mixer::scale(result.data() + offset, result.data() + offset, length, 2.0F);
+                    expect(equal(result, expected), describe("in-place scale", length, offset));
+
+                    // the vectorized dot product adds in a different order, so it is only exact for integers
+                    std::vector<float> a(length + maxOffset);
+                    std::vector<float> b(length + maxOffset);
+                    std::uniform_int_distribution<int> distribution(-64, 64);
+                    for (std::size_t i = 0; i < a.size(); ++i)
+                    {
+                        a[i] = static_cast<float>(distribution(generator));
+                        b[i] = static_cast<float>(distribution(generator));
+                    }
+
+                    float sum = 0.0F;
+                    for (std::size_t i = 0; i < length; ++i) sum += a[offset + i] * b[outputOffset + i];
+                    expect(audio::mixer::dot(a.data() + offset, b.data() + outputOffset, length) == sum,
+                           describe("dot", length, offset));
+                }
+        }
+
+        void testInterleaving(std::mt19937& generator)
+        {
+            for (const auto channels : channelCounts)
+                for (std::size_t frames = 0; frames < maxLength; ++frames)
+                {
+                    const std::size_t offset = frames % maxOffset;
+                    const std::size_t stride = frames + 3; // the channels do not start at aligned addresses
+                    auto planar = randomSamples(generator, stride * channels + offset);
+                    // the full scale samples must convert to the limits of the 16-bit range
+                    if (frames > 1)
+                    {
+                        planar[offset] = 1.0F;
+                        planar[offset + 1] = -1.0F;
+                    }
+
+                    const auto interleaved = randomSamples(generator, frames * channels + offset);
+
+                    std::vector<float> expected(frames * channels + offset);
+                    auto result = expected;
+                    for (std::size_t frame = 0; frame < frames; ++frame)
+                        for (std::uint32_t channel = 0; channel < channels; ++channel)
+                            expected[offset + frame * channels + channel] = planar[offset + channel * stride + frame];
+                    audio::mixer::interleave(planar.data() + offset, stride, channels, frames, result.data() + offset);
+                    expect(equal(result, expected), describe("interleave", frames, offset) + " with " +
+                           std::to_string(channels) + " channels");
+
+                    std::vector<std::int16_t> expectedShorts(frames * channels + offset);
+                    auto resultShorts = expectedShorts;
+                    for (std::size_t frame = 0; frame < frames; ++frame)
+                        for (std::uint32_t channel = 0; channel < channels; ++channel)
+                            expectedShorts[offset + frame * channels + channel] =
+                                static_cast<std::int16_t>(planar[offset + channel * stride + frame] * 32767.0F);
+                    audio::mixer::interleave(planar.data() + offset, stride, channels, frames, resultShorts.data() + offset);
+                    expect(equal(resultShorts, expectedShorts), describe("16-bit interleave", frames, offset) + " with " +
+                           std::to_string(channels) + " channels");
+
+                    std::vector<float> expectedPlanar(stride * channels + offset);
+                    auto resultPlanar = expectedPlanar;
+                    for (std::size_t frame = 0; frame < frames; ++frame)
+                        for (std::uint32_t channel = 0; channel < channels; ++channel)
+                            expectedPlanar[offset + channel * stride + frame] = interleaved[offset + frame * channels + channel];
+                    audio::mixer::deinterleave(interleaved.data() + offset, channels, frames, resultPlanar.data() + offset, stride);
+                    expect(equal(resultPlanar, expectedPlanar), describe("deinterleave", frames, offset) + " with " +
+                           std::to_string(channels) + " channels");
+                }
+        }
+
+        void testBiquad(std::mt19937& generator)
+        {
+            // low-pass at 1 kHz, 44.1 kHz sample rate, Q 0.707
+            audio::mixer::BiquadCoefficients coefficients;
+            coefficients.b0 = 0.0046039F;
+            coefficients.b1 = 0.0092078F;
+            coefficients.b2 = 0.0046039F;
+            coefficients.a1 = -1.7990964F;
+            coefficients.a2 = 0.8175120F;
+
+            for (std::uint32_t channels = 1; channels <= 8; ++channels)
+                for (std::size_t frames = 0; frames < maxLength; ++frames)
+                {
+                    const std::size_t offset = frames % maxOffset;
+                    const std::size_t stride = frames + 1;
+                    const auto samples = randomSamples(generator, stride * channels + offset);
+                    const auto state = randomSamples(generator, channels * 2);
+
+                    auto expected = samples;
+                    auto expectedState = state;
+                    for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    {
+                        float& z1 = expectedState[channel * 2];
+                        float& z2 = expectedState[channel * 2 + 1];
+
+                        for (std::size_t frame = 0; frame < frames; ++frame)
+                        {
+                            float& sample = expected[offset + channel * stride + frame];
+                            const float input = sample;
+                            const float output = coefficients.b0 * input + z1;
+                            z1 = coefficients.b1 * input - coefficients.a1 * output + z2;
+                            z2 = coefficients.b2 * input - coefficients.a2 * output;
+                            sample = output;
+                        }
+                    }
+
+                    auto result = samples;
+                    auto resultState = state;
+                    audio::mixer::biquad(coefficients, result.data() + offset, stride, channels, frames, resultState.data());
+
+                    expect(equal(result, expected) && equal(resultState, expectedState),
+                           describe("biquad", frames, offset) + " with " + std::to_string(channels) + " channels");
+                }
+        }
+    }
+
+    void testKernels()
+    {
+        std::mt19937 generator(1);
+
+        testArithmetic(generator);
+        testInterleaving(generator);
+        testBiquad(generator);
+    }
+}
@@ -0,0 +1,119 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "Tone.hpp"
+#include "audio/mixer/Mixer.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr std::uint32_t bufferSize = 256;
+        constexpr std::uint32_t sampleRate = 48000;
+        constexpr std::uint32_t voiceCount = 256;
+        constexpr std::uint32_t busCount = 16;
+
+        // mono 44.1 kHz voices, so that every voice is resampled and upmixed, spread over the sub-buses of the master bus
+        audio::mixer::CommandBuffer createVoices(audio::mixer::Mixer& mixer)
+        {
+            using namespace audio::mixer;
+
+            CommandBuffer commandBuffer;
+
+            const auto masterBusId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitBusCommand>(masterBusId));
+            commandBuffer.pushCommand(std::make_unique<SetMasterBusCommand>(masterBusId));
+
+            const auto dataId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitDataCommand>(dataId, std::make_unique<ToneData>(1, 44100)));
+
+            for (std::uint32_t bus = 0; bus < busCount; ++bus)
+            {
+                const auto busId = mixer.getObjectId();
+                commandBuffer.pushCommand(std::make_unique<InitBusCommand>(busId));
+                commandBuffer.pushCommand(std::make_unique<SetBusOutputCommand>(busId, masterBusId));
+
+                for (std::uint32_t voice = 0; voice < voiceCount / busCount; ++voice)
+                {
+                    const auto streamId = mixer.getObjectId();
+                    commandBuffer.pushCommand(std::make_unique<InitStreamCommand>(streamId, dataId));
+                    commandBuffer.pushCommand(std::make_unique<SetStreamOutputCommand>(streamId, busId));
+                    commandBuffer.pushCommand(std::make_unique<SetStreamGainCommand>(streamId, 1.0F / voiceCount));
+                    commandBuffer.pushCommand(std::make_unique<PlayStreamCommand>(streamId));
+                }
+            }
+
+            return commandBuffer;
+        }
+
+        void printResult(const char* mode, std::uint32_t workers, double blockTime)
+        {
+            const double blockDuration = static_cast<double>(bufferSize) / sampleRate;
+            const double realtime = blockDuration / blockTime;
+            const auto cores = std::min(workers + 1, std::max(std::thread::hardware_concurrency(), 1U));
+
+            std::printf("%-9s %7u %10.1f %9.1fx %16.0f\n", mode, workers, blockTime * 1000000.0,
+                        realtime, voiceCount * realtime / cores);
+        }
+
+        // the mixer thread renders ahead and the workers mix the buses, the device is read as fast as the
+        // mixer fills the buffer, so the rate of the blocks that were not starved is the mixing throughput
+        double measureMixerThread(std::uint32_t workers)
+        {
+            audio::mixer::Mixer mixer(bufferSize, 2, sampleRate, 4, workers, audio::mixer::Resampler::Quality::medium,
+                                      [](const audio::mixer::Mixer::Event&) {});
+            mixer.submitCommandBuffer(createVoices(mixer));
+
+            std::vector<float> samples;
+            std::size_t blocks = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            auto now = start;
+
+            while (now - start < std::chrono::seconds(1))
+            {
+                const auto starvationCount = mixer.getStarvationCount();
+                mixer.getSamples(bufferSize, 2, sampleRate, samples);
+
+                if (mixer.getStarvationCount() == starvationCount)
+                    ++blocks;
+                else
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+                now = std::chrono::steady_clock::now();
+            }
+
+            return std::chrono::duration<double>(now - start).count() / static_cast<double>(std::max(blocks, std::size_t{1}));
+        }
+    }
+
+    void benchmarkMixer()
+    {
+        std::printf("Mixer, %u mono 44.1 kHz voices on %u buses, %u frame stereo blocks at %u Hz\n",
+                    voiceCount, busCount, bufferSize, sampleRate);
+        std::printf("%-9s %7s %10s %10s %16s\n", "mode", "workers", "us/block", "realtime", "voices per core");
+
+        {
+            // without a buffer the samples are mixed in the device callback on the calling thread
+            audio::mixer::Mixer mixer(bufferSize, 2, sampleRate, 0, 0, audio::mixer::Resampler::Quality::medium,
+                                      [](const audio::mixer::Mixer::Event&) {});
+            mixer.submitCommandBuffer(createVoices(mixer));
+
+            std::vector<float> samples;
+            const double blockTime = measure([&mixer, &samples]() {
+                mixer.getSamples(bufferSize, 2, sampleRate, samples);
+            });
+
+            printResult("callback", 0, blockTime);
+        }
+
+        for (std::uint32_t workers = 0; workers <= 3; ++workers)
+            printResult("thread", workers, measureMixerThread(workers));
+    }
+}
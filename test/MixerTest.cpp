@@ -0,0 +1,320 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+#include "Test.hpp"
+#include "Tone.hpp"
+#include "audio/mixer/Mixer.hpp"
+
+namespace
+{
+    std::atomic<bool> countAllocations{false};
+    std::atomic<std::size_t> allocationCount{0};
+}
+
+// the mixing must not allocate, so every allocation is counted while the mixer renders
+void* operator new(std::size_t size)
+{
+    if (countAllocations.load(std::memory_order_relaxed))
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* result = std::malloc(size ? size : 1)) return result;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace ouzel::test
+{
+    namespace
+    {
+        class GainProcessor final: public audio::mixer::Processor
+        {
+        public:
+            void prepare(std::uint32_t, std::uint32_t, std::uint32_t) final
+            {
+                ++prepareCount; // on every compilation of the graph
+            }
+
+            void process(std::uint32_t, std::uint32_t, std::uint32_t,
+                         std::vector<float>& samples) final
+            {
+                for (float& sample : samples) sample *= 0.5F;
+            }
+
+            std::size_t prepareCount = 0;
+        };
+
+        // the commands that change only the parameters do not recompile the graph and do not allocate
+        void testGainCommands()
+        {
+            using namespace audio::mixer;
+
+            constexpr std::uint32_t bufferSize = 256;
+
+            Mixer mixer(bufferSize, 2, 44100, 0, 0, Resampler::Quality::medium, [](const Mixer::Event&) {});
+
+            CommandBuffer commandBuffer;
+
+            const auto busId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitBusCommand>(busId));
+            commandBuffer.pushCommand(std::make_unique<SetMasterBusCommand>(busId));
+
+            auto processor = std::make_unique<GainProcessor>();
+            const GainProcessor* gainProcessor = processor.get();
+            const auto processorId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitProcessorCommand>(processorId, std::move(processor)));
+            commandBuffer.pushCommand(std::make_unique<AddProcessorCommand>(busId, processorId));
+
+            const auto dataId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitDataCommand>(dataId, std::make_unique<ToneData>(2, 48000)));
+
+            const auto streamId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitStreamCommand>(streamId, dataId));
+            commandBuffer.pushCommand(std::make_unique<SetStreamOutputCommand>(streamId, busId));
+            commandBuffer.pushCommand(std::make_unique<PlayStreamCommand>(streamId));
+
+            mixer.submitCommandBuffer(std::move(commandBuffer));
+
+            std::vector<float> samples;
+            samples.reserve(bufferSize * 2);
+            mixer.getSamples(bufferSize, 2, 44100, samples);
+
+            const auto prepareCount = gainProcessor->prepareCount;
+            allocationCount = 0;
+
+            for (std::uint32_t i = 0; i < 100; ++i)
+            {
+                // the command buffers are built and submitted by the game thread, so their allocations are not counted
+                commandBuffer = CommandBuffer();
+                commandBuffer.pushCommand(std::make_unique<SetStreamGainCommand>(streamId, static_cast<float>(i % 10) / 10.0F));
+                mixer.submitCommandBuffer(std::move(commandBuffer));
+
+                countAllocations = true;
+                mixer.getSamples(bufferSize, 2, 44100, samples);
+                countAllocations = false;
+            }
+
+            expect(allocationCount == 0, "Mixer allocated " + std::to_string(allocationCount) + " times while applying gain commands");
+            expect(gainProcessor->prepareCount == prepareCount, "Gain commands recompiled the graph");
+        }
+
+        // the streams that reach their end are reported once for every play, the virtual ones too
+        void testStoppedStreams()
+        {
+            using namespace audio::mixer;
+
+            constexpr std::uint32_t bufferSize = 256;
+
+            Mixer mixer(bufferSize, 2, 44100, 0, 0, Resampler::Quality::medium, [](const Mixer::Event&) {});
+
+            CommandBuffer commandBuffer;
+
+            const auto busId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitBusCommand>(busId));
+            commandBuffer.pushCommand(std::make_unique<SetMasterBusCommand>(busId));
+
+            const auto dataId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitDataCommand>(dataId, std::make_unique<ToneData>(1, 48000, 1000)));
+
+            const auto realStreamId = mixer.getObjectId();
+            const auto virtualStreamId = mixer.getObjectId();
+            for (const auto streamId : {realStreamId, virtualStreamId})
+            {
+                commandBuffer.pushCommand(std::make_unique<InitStreamCommand>(streamId, dataId));
+                commandBuffer.pushCommand(std::make_unique<SetStreamOutputCommand>(streamId, busId));
+                commandBuffer.pushCommand(std::make_unique<PlayStreamCommand>(streamId));
+            }
+            commandBuffer.pushCommand(std::make_unique<SetStreamVirtualCommand>(virtualStreamId, true));
+
+            mixer.submitCommandBuffer(std::move(commandBuffer));
+
+            std::vector<float> samples;
+            std::vector<Mixer::StoppedStream> stoppedStreams;
+
+            const auto render = [&]() {
+                stoppedStreams.clear();
+                for (std::uint32_t i = 0; i < 10; ++i)
+                {
+                    mixer.getSamples(bufferSize, 2, 44100, samples);
+                    mixer.getStoppedStreams(stoppedStreams);
+                }
+            };
+
+            render();
+
+            expect(stoppedStreams.size() == 2, "Mixer reported " + std::to_string(stoppedStreams.size()) + " stopped streams instead of 2");
+            for (const auto& stoppedStream : stoppedStreams)
+            {
+                expect(stoppedStream.streamId == realStreamId || stoppedStream.streamId == virtualStreamId, "Mixer reported a wrong stream");
+                expect(stoppedStream.playCount == 1, "Wrong play count of a stopped stream");
+            }
+
+            commandBuffer = CommandBuffer();
+            commandBuffer.pushCommand(std::make_unique<PlayStreamCommand>(realStreamId));
+            mixer.submitCommandBuffer(std::move(commandBuffer));
+
+            render();
+
+            expect(stoppedStreams.size() == 1 && stoppedStreams.front().streamId == realStreamId &&
+                   stoppedStreams.front().playCount == 2, "Replayed stream was not reported");
+        }
+
+        // the workers mix the buses of a level together with the mixer thread without allocating
+        // and produce the same samples as the mixing on a single thread
+        void testWorkers()
+        {
+            using namespace audio::mixer;
+
+            constexpr std::uint32_t bufferSize = 256;
+            constexpr std::uint32_t bufferCount = 3;
+            constexpr std::uint32_t blockCount = 200;
+            constexpr std::uint32_t busCount = 4;
+
+            const auto build = [](Mixer& mixer) {
+                CommandBuffer commandBuffer;
+
+                const auto masterBusId = mixer.getObjectId();
+                commandBuffer.pushCommand(std::make_unique<InitBusCommand>(masterBusId));
+                commandBuffer.pushCommand(std::make_unique<SetMasterBusCommand>(masterBusId));
+
+                // sibling buses with a processor and a stream of a different format each
+                for (std::uint32_t i = 0; i < busCount; ++i)
+                {
+                    const auto busId = mixer.getObjectId();
+                    commandBuffer.pushCommand(std::make_unique<InitBusCommand>(busId));
+                    commandBuffer.pushCommand(std::make_unique<SetBusOutputCommand>(busId, masterBusId));
+
+                    const auto processorId = mixer.getObjectId();
+                    commandBuffer.pushCommand(std::make_unique<InitProcessorCommand>(processorId, std::make_unique<GainProcessor>()));
+                    commandBuffer.pushCommand(std::make_unique<AddProcessorCommand>(busId, processorId));
+
+                    const auto dataId = mixer.getObjectId();
+                    commandBuffer.pushCommand(std::make_unique<InitDataCommand>(dataId, std::make_unique<ToneData>(i % 2 + 1, 22050 * (i + 1))));
+
+                    const auto streamId = mixer.getObjectId();
+                    commandBuffer.pushCommand(std::make_unique<InitStreamCommand>(streamId, dataId));
+                    commandBuffer.pushCommand(std::make_unique<SetStreamOutputCommand>(streamId, busId));
+                    commandBuffer.pushCommand(std::make_unique<PlayStreamCommand>(streamId));
+                }
+
+                mixer.submitCommandBuffer(std::move(commandBuffer));
+            };
+
+            Mixer serialMixer(bufferSize, 2, 44100, 0, 0, Resampler::Quality::medium, [](const Mixer::Event&) {});
+            build(serialMixer);
+
+            std::vector<float> samples;
+            samples.reserve(bufferSize * 2);
+
+            std::vector<float> expected;
+            for (std::uint32_t i = 0; i < blockCount; ++i)
+            {
+                serialMixer.getSamples(bufferSize, 2, 44100, samples);
+                expected.insert(expected.end(), samples.begin(), samples.end());
+            }
+
+            Mixer mixer(bufferSize, 2, 44100, bufferCount, 2, Resampler::Quality::medium, [](const Mixer::Event&) {});
+            build(mixer);
+
+            // the mixer thread starts with a full buffer of silence
+            std::vector<float> result;
+            result.reserve(bufferSize * 2 * (blockCount + bufferCount));
+            allocationCount = 0;
+
+            for (std::uint32_t i = 0; i < blockCount + bufferCount; ++i)
+            {
+                // the first blocks compile the graph
+                if (i == bufferCount + 2) countAllocations = true;
+
+                // gives the mixer thread time to render the next block
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                mixer.getSamples(bufferSize, 2, 44100, samples);
+                result.insert(result.end(), samples.begin(), samples.end());
+            }
+
+            countAllocations = false;
+
+            expect(allocationCount == 0, "Mixer workers allocated " + std::to_string(allocationCount) + " times");
+            expect(mixer.getStarvationCount() == 0, "Mixer thread did not keep up with the device");
+            expect(std::equal(expected.begin(), expected.end(), result.begin() + bufferSize * 2 * bufferCount),
+                   "Mixer workers produced different samples than a single thread");
+        }
+    }
+
+    void testMixer()
+    {
+        using namespace audio::mixer;
+
+        constexpr std::uint32_t bufferSize = 512;
+
+        Mixer mixer(bufferSize, 2, 44100, 0, 0, Resampler::Quality::medium, [](const Mixer::Event&) {});
+
+        CommandBuffer commandBuffer;
+
+        const auto masterBusId = mixer.getObjectId();
+        commandBuffer.pushCommand(std::make_unique<InitBusCommand>(masterBusId));
+        commandBuffer.pushCommand(std::make_unique<SetMasterBusCommand>(masterBusId));
+
+        const auto submixBusId = mixer.getObjectId();
+        commandBuffer.pushCommand(std::make_unique<InitBusCommand>(submixBusId));
+        commandBuffer.pushCommand(std::make_unique<SetBusOutputCommand>(submixBusId, masterBusId));
+
+        const auto processorId = mixer.getObjectId();
+        commandBuffer.pushCommand(std::make_unique<InitProcessorCommand>(processorId, std::make_unique<GainProcessor>()));
+        commandBuffer.pushCommand(std::make_unique<AddProcessorCommand>(submixBusId, processorId));
+
+        // mono, stereo and 5.1 sources at different sample rates, so that the streams are resampled and converted
+        const std::pair<std::uint32_t, std::uint32_t> formats[] = {{1, 22050}, {2, 44100}, {6, 48000}};
+        for (const auto& [channels, sampleRate] : formats)
+        {
+            const auto dataId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitDataCommand>(dataId, std::make_unique<ToneData>(channels, sampleRate)));
+
+            const auto streamId = mixer.getObjectId();
+            commandBuffer.pushCommand(std::make_unique<InitStreamCommand>(streamId, dataId));
+            commandBuffer.pushCommand(std::make_unique<SetStreamOutputCommand>(streamId, channels == 2 ? masterBusId : submixBusId));
+            commandBuffer.pushCommand(std::make_unique<PlayStreamCommand>(streamId));
+        }
+
+        mixer.submitCommandBuffer(std::move(commandBuffer));
+
+        std::vector<float> samples;
+        samples.reserve(bufferSize * 2);
+
+        // the first block applies the commands and compiles the graph
+        mixer.getSamples(bufferSize, 2, 44100, samples);
+
+        bool silent = true;
+        for (const float sample : samples)
+            if (sample != 0.0F) silent = false;
+        expect(!silent, "Mixer rendered silence");
+
+        countAllocations = true;
+
+        for (std::uint32_t i = 0; i < 1000; ++i)
+            mixer.getSamples(bufferSize - (i * 37U) % 256U, 2, 44100, samples);
+
+        countAllocations = false;
+
+        expect(allocationCount == 0, "Mixer allocated " + std::to_string(allocationCount) + " times while rendering");
+
+        testStoppedStreams();
+        testGainCommands();
+        testWorkers();
+    }
+}
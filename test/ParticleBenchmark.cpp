@@ -0,0 +1,104 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+#include "Benchmark.hpp"
+#include "scene/ParticleStore.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr float step = 1.0F / 60.0F;
+
+        // random fields in the ranges of the usual particle systems, the particles live longer than the benchmark runs
+        void fillParticles(scene::ParticleStore& particles, std::uint32_t count)
+        {
+            std::mt19937 generator(1);
+            std::uniform_real_distribution<float> unit(-1.0F, 1.0F);
+
+            particles.setCapacity(count);
+            particles.clear();
+            particles.add(count);
+
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                particles.life[i] = 1000000.0F;
+                particles.positionX[i] = unit(generator) * 100.0F;
+                particles.positionY[i] = unit(generator) * 100.0F;
+
+                particles.colorRed[i] = 0.5F + unit(generator) * 0.5F;
+                particles.colorGreen[i] = 0.5F + unit(generator) * 0.5F;
+                particles.colorBlue[i] = 0.5F + unit(generator) * 0.5F;
+                particles.colorAlpha[i] = 1.0F;
+                particles.deltaColorRed[i] = unit(generator) * 0.001F;
+                particles.deltaColorGreen[i] = unit(generator) * 0.001F;
+                particles.deltaColorBlue[i] = unit(generator) * 0.001F;
+                particles.deltaColorAlpha[i] = -0.0001F;
+
+                particles.size[i] = 10.0F + unit(generator) * 5.0F;
+                particles.deltaSize[i] = unit(generator) * 0.01F;
+                particles.rotation[i] = unit(generator) * 180.0F;
+                particles.deltaRotation[i] = unit(generator) * 90.0F;
+
+                particles.directionX[i] = unit(generator) * 50.0F;
+                particles.directionY[i] = unit(generator) * 50.0F;
+                particles.radialAcceleration[i] = unit(generator) * 10.0F;
+                particles.tangentialAcceleration[i] = unit(generator) * 10.0F;
+
+                particles.angle[i] = unit(generator) * 3.14F;
+                particles.degreesPerSecond[i] = unit(generator) * 3.14F;
+                particles.radius[i] = 50.0F + unit(generator) * 50.0F;
+                particles.deltaRadius[i] = unit(generator) * 0.01F;
+            }
+        }
+
+        // returns the particles per millisecond of one step alone and of a frame, which is a step that writes
+        // the quads followed by the bounds, like the last step of ParticleSystem::update
+        template <class Update>
+        std::pair<double, double> measureParticles(std::uint32_t count, Update update)
+        {
+            scene::ParticleStore particles;
+            fillParticles(particles, count);
+            std::vector<graphics::Vertex> vertices(count * 4);
+
+            const double stepTime = measure([&particles, &update]() {
+                update(particles, nullptr);
+            });
+
+            const double frameTime = measure([&particles, &update, &vertices]() {
+                update(particles, vertices.data());
+
+                Vector2F min;
+                Vector2F max;
+                particles.getBounds(min, max);
+            });
+
+            return {count / stepTime / 1000.0, count / frameTime / 1000.0};
+        }
+    }
+
+    void benchmarkParticles()
+    {
+        const auto gravity = [](scene::ParticleStore& particles, graphics::Vertex* vertices) {
+            particles.updateGravity(step, Vector2F(0.0F, -100.0F), 1.0F, vertices);
+        };
+
+        const auto radius = [](scene::ParticleStore& particles, graphics::Vertex* vertices) {
+            particles.updateRadius(step, 1.0F, vertices);
+        };
+
+        std::printf("Particles per millisecond, a frame is a step with the quads and the bounds\n");
+        std::printf("%-10s %14s %14s %14s %14s\n", "particles", "gravity step", "gravity frame", "radius step", "radius frame");
+
+        for (const std::uint32_t count : {1000U, 10000U, 100000U, 1000000U})
+        {
+            const auto [gravityStep, gravityFrame] = measureParticles(count, gravity);
+            const auto [radiusStep, radiusFrame] = measureParticles(count, radius);
+
+            std::printf("%-10u %14.0f %14.0f %14.0f %14.0f\n", count, gravityStep, gravityFrame, radiusStep, radiusFrame);
+        }
+    }
+}
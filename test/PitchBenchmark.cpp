@@ -0,0 +1,128 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Benchmark.hpp"
+#include "audio/mixer/PhaseVocoder.hpp"
+#include "math/Constants.hpp"
+#include "smbPitchShift.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr std::uint32_t blockSize = 512;
+        constexpr std::uint32_t channels = 2;
+        constexpr std::uint32_t sampleRate = 44100;
+        constexpr std::uint32_t blockCount = 200;
+        constexpr double frequency = 440.0;
+
+        // processes a planar stereo block in place with the given pitch
+        using Shifter = std::function<void(float pitch, float* samples)>;
+
+        // the shifter that PitchScale used before the phase vocoder, one per channel
+        Shifter createSmb()
+        {
+            auto shifters = std::make_shared<std::vector<smb::PitchShift<1024, 4>>>(channels);
+            return [shifters, output = std::vector<float>(blockSize)](float pitch, float* samples) mutable {
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                {
+                    (*shifters)[channel].process(pitch, blockSize, sampleRate, samples + channel * blockSize, output.data());
+                    std::copy(output.begin(), output.end(), samples + channel * blockSize);
+                }
+            };
+        }
+
+        Shifter createPhaseVocoder()
+        {
+            auto phaseVocoder = std::make_shared<audio::mixer::PhaseVocoder>();
+            phaseVocoder->prepare(channels);
+            return [phaseVocoder](float pitch, float* samples) {
+                phaseVocoder->process(pitch, blockSize, channels, samples);
+            };
+        }
+
+        // amplitude of the given frequency in the first channel after the latency of the shifters has passed
+        double getAmplitude(const std::vector<float>& samples, double toneFrequency)
+        {
+            double sineSum = 0.0;
+            double cosineSum = 0.0;
+            std::size_t count = 0;
+
+            for (std::uint32_t block = 8; block < blockCount; ++block)
+                for (std::uint32_t frame = 0; frame < blockSize; ++frame)
+                {
+                    const auto sample = static_cast<double>(samples[block * blockSize * channels + frame]);
+                    const double angle = tau<double> * toneFrequency * (block * blockSize + frame) / sampleRate;
+                    sineSum += sample * std::sin(angle);
+                    cosineSum += sample * std::cos(angle);
+                    ++count;
+                }
+
+            return 2.0 * std::sqrt(sineSum * sineSum + cosineSum * cosineSum) / static_cast<double>(count);
+        }
+
+        // shifts a 0.5 amplitude sine and returns the levels of the shifted and the original frequency in dB
+        std::pair<double, double> measureLevels(const Shifter& shifter, float pitch)
+        {
+            std::vector<float> samples(blockSize * channels * blockCount);
+
+            for (std::uint32_t block = 0; block < blockCount; ++block)
+            {
+                float* blockSamples = &samples[block * blockSize * channels];
+
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    for (std::uint32_t frame = 0; frame < blockSize; ++frame)
+                        blockSamples[channel * blockSize + frame] =
+                            static_cast<float>(0.5 * std::sin(tau<double> * frequency * (block * blockSize + frame) / sampleRate));
+
+                shifter(pitch, blockSamples);
+            }
+
+            return {20.0 * std::log10(getAmplitude(samples, frequency * static_cast<double>(pitch)) / 0.5),
+                    20.0 * std::log10(getAmplitude(samples, frequency) / 0.5)};
+        }
+
+        double measureSampleTime(const Shifter& shifter)
+        {
+            std::vector<float> samples(blockSize * channels);
+            for (std::uint32_t i = 0; i < blockSize; ++i)
+                samples[i] = samples[blockSize + i] =
+                    static_cast<float>(0.5 * std::sin(tau<double> * frequency * i / sampleRate));
+
+            return measure([&shifter, &samples]() {
+                shifter(1.5F, samples.data());
+            }) / (blockSize * channels);
+        }
+    }
+
+    void benchmarkPitch()
+    {
+        const std::pair<const char*, Shifter(*)()> shifters[] = {
+            {"smb", createSmb},
+            {"vocoder", createPhaseVocoder}
+        };
+
+        std::printf("Pitch scaling, %u frame stereo blocks at %u Hz, smb is smbPitchShift that PitchScale used before\n",
+                    blockSize, sampleRate);
+        std::printf("%-8s %10s\n", "shifter", "ns/sample");
+
+        for (const auto& [name, create] : shifters)
+            std::printf("%-8s %10.1f\n", name, measureSampleTime(create()) * 1000000000.0);
+
+        std::printf("\nLevel in dB of the shifted tone and of the original %.0f Hz tone that is left\n", frequency);
+        std::printf("%-8s %6s %10s %10s\n", "shifter", "pitch", "shifted", "original");
+
+        for (const auto& [name, create] : shifters)
+            for (const float pitch : {0.75F, 1.5F, 2.0F})
+            {
+                const auto [shifted, original] = measureLevels(create(), pitch);
+                std::printf("%-8s %6.2f %10.1f %10.1f\n", name, static_cast<double>(pitch), shifted, original);
+            }
+    }
+}
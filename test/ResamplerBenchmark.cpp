@@ -0,0 +1,193 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include "Benchmark.hpp"
+#include "audio/mixer/Resampler.hpp"
+#include "math/Constants.hpp"
+#include "math/MathUtils.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        using Quality = audio::mixer::Resampler::Quality;
+
+        constexpr std::uint32_t blockSize = 256;
+
+        // the linear interpolation that the bus used before the polyphase resampler, every block was
+        // stretched from ceil(frames * ratio) source frames, so the position between the frames was lost
+        void resampleLinear(std::uint32_t channels, std::uint32_t sourceFrames, const float* sourceSamples,
+                            std::uint32_t frames, float* samples)
+        {
+            const auto sourceIncrement = static_cast<float>(sourceFrames - 1) / static_cast<float>(frames - 1);
+            auto sourcePosition = 0.0F;
+
+            for (std::uint32_t frame = 0; frame < frames - 1; ++frame)
+            {
+                const auto sourceCurrentFrame = static_cast<std::uint32_t>(sourcePosition);
+                const auto fraction = sourcePosition - static_cast<float>(sourceCurrentFrame);
+
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                    samples[channel * frames + frame] = lerp(sourceSamples[channel * sourceFrames + sourceCurrentFrame],
+                                                             sourceSamples[channel * sourceFrames + sourceCurrentFrame + 1],
+                                                             fraction);
+
+                sourcePosition += sourceIncrement;
+            }
+
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+                samples[channel * frames + frames - 1] = sourceSamples[channel * sourceFrames + sourceFrames - 1];
+        }
+
+        // a block resampler, takes the source frames that the next block needs from the given generator
+        using Block = std::function<void(const std::function<void(std::uint32_t, std::vector<float>&)>& read,
+                                         std::vector<float>& output)>;
+
+        Block createBlock(const Quality* quality, std::uint32_t sourceRate, std::uint32_t targetRate, std::uint32_t channels)
+        {
+            if (!quality)
+                return [sourceRate, targetRate, channels, source = std::vector<float>()](const auto& read, std::vector<float>& output) mutable {
+                    const std::uint32_t sourceFrames = (blockSize * sourceRate + targetRate - 1) / targetRate; // round up
+                    read(sourceFrames, source);
+                    output.resize(blockSize * channels);
+                    resampleLinear(channels, sourceFrames, source.data(), blockSize, output.data());
+                };
+
+            auto resampler = std::make_shared<audio::mixer::Resampler>();
+            resampler->prepare(sourceRate, targetRate, channels, blockSize, *quality);
+
+            return [resampler, channels, source = std::vector<float>()](const auto& read, std::vector<float>& output) mutable {
+                const auto sourceFrames = resampler->getSourceFrames(blockSize);
+                read(sourceFrames, source);
+                output.resize(blockSize * channels);
+                resampler->process(source.data(), sourceFrames, blockSize, output.data());
+            };
+        }
+
+        // fits a sine of the given frequency to the output with least squares, the rest is noise and distortion
+        double measureSnr(const Quality* quality, double frequency, std::uint32_t sourceRate, std::uint32_t targetRate)
+        {
+            auto block = createBlock(quality, sourceRate, targetRate, 1);
+
+            std::uint64_t position = 0;
+            const auto read = [&position, frequency, sourceRate](std::uint32_t frames, std::vector<float>& source) {
+                source.resize(frames);
+                for (std::uint32_t i = 0; i < frames; ++i)
+                    source[i] = static_cast<float>(0.5 * std::sin(tau<double> * frequency * static_cast<double>(position + i) / sourceRate));
+                position += frames;
+            };
+
+            std::vector<float> samples;
+            std::vector<float> output;
+            for (std::uint32_t i = 0; i < 200; ++i)
+            {
+                block(read, output);
+                samples.insert(samples.end(), output.begin(), output.end());
+            }
+
+            // the filter history fills up in the first blocks
+            const std::size_t skip = blockSize * 4;
+            double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+            for (std::size_t n = skip; n < samples.size(); ++n)
+            {
+                const double angle = tau<double> * frequency * static_cast<double>(n) / targetRate;
+                const double s = std::sin(angle);
+                const double c = std::cos(angle);
+                ss += s * s;
+                sc += s * c;
+                cc += c * c;
+                ys += static_cast<double>(samples[n]) * s;
+                yc += static_cast<double>(samples[n]) * c;
+            }
+
+            const double determinant = ss * cc - sc * sc;
+            const double a = (ys * cc - yc * sc) / determinant;
+            const double b = (yc * ss - ys * sc) / determinant;
+
+            double signal = 0.0, noise = 0.0;
+            for (std::size_t n = skip; n < samples.size(); ++n)
+            {
+                const double angle = tau<double> * frequency * static_cast<double>(n) / targetRate;
+                const double fit = a * std::sin(angle) + b * std::cos(angle);
+                signal += fit * fit;
+                const double error = static_cast<double>(samples[n]) - fit;
+                noise += error * error;
+            }
+
+            return 10.0 * std::log10(signal / noise);
+        }
+
+        // level of a tone above the target Nyquist frequency that is left after resampling, relative to the input
+        double measureAliasing(const Quality* quality, double frequency, std::uint32_t sourceRate, std::uint32_t targetRate)
+        {
+            auto block = createBlock(quality, sourceRate, targetRate, 1);
+
+            std::uint64_t position = 0;
+            const auto read = [&position, frequency, sourceRate](std::uint32_t frames, std::vector<float>& source) {
+                source.resize(frames);
+                for (std::uint32_t i = 0; i < frames; ++i)
+                    source[i] = static_cast<float>(0.5 * std::sin(tau<double> * frequency * static_cast<double>(position + i) / sourceRate));
+                position += frames;
+            };
+
+            std::vector<float> output;
+            double power = 0.0;
+            std::size_t count = 0;
+            for (std::uint32_t i = 0; i < 200; ++i)
+            {
+                block(read, output);
+                if (i < 4) continue;
+                for (const float sample : output) power += static_cast<double>(sample) * static_cast<double>(sample);
+                count += output.size();
+            }
+
+            return 10.0 * std::log10(power / static_cast<double>(count) / (0.5 * 0.5 / 2.0));
+        }
+
+        double measureThroughput(const Quality* quality)
+        {
+            auto block = createBlock(quality, 44100, 48000, 2);
+
+            // the content of the source does not change the speed
+            const auto read = [](std::uint32_t frames, std::vector<float>& source) {
+                source.resize(frames * 2, 0.25F);
+            };
+
+            std::vector<float> output;
+            const double blockTime = measure([&block, &read, &output]() {
+                block(read, output);
+            });
+
+            return blockSize / blockTime / 1000000.0;
+        }
+    }
+
+    void benchmarkResampler()
+    {
+        const Quality qualities[] = {Quality::low, Quality::medium, Quality::high};
+        const char* names[] = {"linear", "low", "medium", "high"};
+        const Quality* paths[] = {nullptr, &qualities[0], &qualities[1], &qualities[2]};
+
+        std::printf("Resampler, 44.1 -> 48 kHz in %u frame blocks, the linear path is the old block interpolation\n", blockSize);
+
+        std::printf("%-8s %18s\n", "path", "stereo Mframes/s");
+        for (std::size_t i = 0; i < 4; ++i)
+            std::printf("%-8s %18.1f\n", names[i], measureThroughput(paths[i]));
+
+        std::printf("\nSNR in dB of a 0.5 amplitude sine\n");
+        std::printf("%-8s %8s %8s %8s\n", "path", "1 kHz", "10 kHz", "15 kHz");
+        for (std::size_t i = 0; i < 4; ++i)
+            std::printf("%-8s %8.1f %8.1f %8.1f\n", names[i],
+                        measureSnr(paths[i], 1000.0, 44100, 48000),
+                        measureSnr(paths[i], 10000.0, 44100, 48000),
+                        measureSnr(paths[i], 15000.0, 44100, 48000));
+
+        std::printf("\nLevel in dB of a 30 kHz sine resampled from 96 to 44.1 kHz\n");
+        for (std::size_t i = 0; i < 4; ++i)
+            std::printf("%-8s %8.1f\n", names[i], measureAliasing(paths[i], 30000.0, 96000, 44100));
+    }
+}
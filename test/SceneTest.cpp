@@ -0,0 +1,124 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <memory>
+#include <string>
+#include "Test.hpp"
+#include "scene/Actor.hpp"
+#include "scene/Component.hpp"
+#include "scene/DrawQueue.hpp"
+#include "scene/Layer.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr std::size_t actorCount = 16;
+
+        class StateComponent final: public scene::Component
+        {
+        public:
+            explicit StateComponent(std::uint16_t initStateKey) noexcept: stateKey(initStateKey) {}
+
+            std::uint16_t getRenderStateKey() const noexcept override { return stateKey; }
+
+        private:
+            std::uint16_t stateKey;
+        };
+
+        class TestLayer final: public scene::Layer
+        {
+        public:
+            using Layer::prepareDraw;
+            using Layer::findIndexedActors;
+        };
+
+        // the unique_ptr overload of addChild is hidden in the actor and the layer
+        void addActors(scene::ActorContainer& layer)
+        {
+            for (std::size_t i = 0; i < actorCount; ++i)
+            {
+                auto actor = std::make_unique<scene::Actor>();
+                actor->setPickable(true);
+
+                auto component = std::make_unique<scene::Component>();
+                component->setBoundingBox(Box3F{Vector3F{-1.0F, -1.0F, 0.0F}, Vector3F{1.0F, 1.0F, 0.0F}});
+                actor->addComponent(std::move(component));
+
+                // a child, so that the layer has to detach the whole subtree
+                static_cast<scene::ActorContainer&>(*actor).addChild(std::make_unique<scene::Actor>());
+
+                layer.addChild(std::move(actor));
+            }
+        }
+
+        void testRemoveAllChildrenFromSpatialIndex()
+        {
+            TestLayer layer;
+            layer.setSpatialIndexEnabled(true);
+            addActors(layer);
+
+            layer.prepareDraw();
+            expect(layer.getSpatialIndex()->getProxyCount() == actorCount, "Actors were not indexed");
+            expect(layer.findIndexedActors(Vector2F{}).size() == actorCount, "Indexed actors were not found");
+
+            layer.removeAllChildren();
+            expect(layer.getSpatialIndex()->getProxyCount() == 0, "Removed actors were left in the spatial index");
+            expect(layer.findIndexedActors(Vector2F{}).empty(), "Removed actors were found");
+        }
+
+        void testRemoveAllChildrenFromTransformStore()
+        {
+            TestLayer layer;
+            layer.setTransformStoreEnabled(true);
+            addActors(layer);
+
+            layer.draw();
+            expect(layer.getTransformStore()->getSize() == actorCount * 2, "Actors were not added to the transform store");
+
+            // dirty transforms make the store visit the owners on the next update
+            for (const auto actor : layer.getChildren())
+                actor->setPosition(Vector3F{1.0F, 2.0F, 3.0F});
+
+            layer.removeAllChildren();
+            layer.draw();
+            expect(layer.getTransformStore()->getSize() == 0, "Removed actors were left in the transform store");
+        }
+
+        void testStateSortingKeepsBlendedOrder()
+        {
+            scene::DrawQueue queue;
+            scene::Actor actors[6];
+
+            // blended actors pushed in the reverse of the scene order, like the spatial index can return them
+            queue.push(scene::DrawQueue::makeBlendedKey(0, 2), &actors[0]);
+            queue.push(scene::DrawQueue::makeKey(0, 2, 100), &actors[1]);
+            queue.push(scene::DrawQueue::makeBlendedKey(0, 1), &actors[2]);
+            queue.push(scene::DrawQueue::makeKey(0, 1, 200), &actors[3]);
+            queue.push(scene::DrawQueue::makeKey(0, 1, 100), &actors[4]);
+            queue.push(scene::DrawQueue::makeBlendedKey(1, 3), &actors[5]);
+            queue.sort();
+
+            // higher orders first, then the opaque actors by state and depth, then the blended ones by sequence
+            const scene::Actor* expected[] = {&actors[5], &actors[4], &actors[3], &actors[1], &actors[2], &actors[0]};
+            std::size_t i = 0;
+            for (const auto& entry : queue)
+            {
+                expect(entry.actor == expected[i], "Actor " + std::to_string(i) + " is drawn out of order");
+                ++i;
+            }
+
+            scene::Actor actor;
+            actor.addComponent(std::make_unique<StateComponent>(5));
+            expect(actor.getRenderStateKey() == 5, "Opaque actor has no render state key");
+            actor.addComponent(std::make_unique<StateComponent>(0));
+            expect(actor.getRenderStateKey() == 0, "Actor with a blended component is sorted by state");
+        }
+    }
+
+    void testScene()
+    {
+        testStateSortingKeepsBlendedOrder();
+        testRemoveAllChildrenFromSpatialIndex();
+        testRemoveAllChildrenFromTransformStore();
+    }
+}
@@ -0,0 +1,27 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_TEST_TEST_HPP
+#define OUZEL_TEST_TEST_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace ouzel::test
+{
+    inline void expect(bool condition, const std::string& message)
+    {
+        if (!condition) throw std::runtime_error(message);
+    }
+
+    void testCache();
+    void testFft();
+    void testFileSystem();
+    void testInflate();
+    void testJobSystem();
+    void testKernels();
+    void testMixer();
+    void testScene();
+    void testVorbis();
+}
+
+#endif // OUZEL_TEST_TEST_HPP
@@ -0,0 +1,31 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_TEST_TESTENGINE_HPP
+#define OUZEL_TEST_TESTENGINE_HPP
+
+#include <functional>
+#include "core/Engine.hpp"
+
+namespace ouzel::test
+{
+    // an engine that is never started, it has the file system, the cache and the job system
+    // without a window, graphics or audio
+    class TestEngine final: public core::Engine
+    {
+    public:
+        TestEngine(): core::Engine({}) {}
+
+        ~TestEngine() override
+        {
+            engine = nullptr;
+        }
+
+    private:
+        void runOnMainThread(const std::function<void()>& func) final
+        {
+            func();
+        }
+    };
+}
+
+#endif // OUZEL_TEST_TESTENGINE_HPP
@@ -0,0 +1,78 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_TEST_TONE_HPP
+#define OUZEL_TEST_TONE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "audio/mixer/Data.hpp"
+#include "audio/mixer/Stream.hpp"
+
+namespace ouzel::test
+{
+    // a sawtooth that is cheap to generate, so that the benchmarks measure the mixing,
+    // it loops forever unless it has a length, so that the stream never stops while it is tested
+    class ToneStream final: public audio::mixer::Stream
+    {
+    public:
+        ToneStream(audio::mixer::Data& toneData, std::uint32_t initLength):
+            Stream(toneData),
+            length(initLength)
+        {
+        }
+
+        void reset() final
+        {
+            position = 0;
+        }
+
+        void getSamples(std::uint32_t frames, std::vector<float>& samples) final
+        {
+            samples.resize(frames * data.getChannels());
+
+            for (std::uint32_t channel = 0; channel < data.getChannels(); ++channel)
+                for (std::uint32_t frame = 0; frame < frames; ++frame)
+                    samples[channel * frames + frame] = (length == 0 || position + frame < length) ?
+                        static_cast<float>((position + frame) % 100U) / 50.0F - 1.0F : 0.0F;
+
+            skip(frames);
+        }
+
+        void skip(std::uint32_t frames) final
+        {
+            position += frames;
+
+            if (length != 0 && position >= length)
+            {
+                playing = false;
+                reset();
+            }
+        }
+
+    private:
+        std::uint32_t length;
+        std::uint32_t position = 0;
+    };
+
+    class ToneData final: public audio::mixer::Data
+    {
+    public:
+        ToneData(std::uint32_t initChannels, std::uint32_t initSampleRate, std::uint32_t initLength = 0):
+            length(initLength)
+        {
+            channels = initChannels;
+            sampleRate = initSampleRate;
+        }
+
+        std::unique_ptr<audio::mixer::Stream> createStream() final
+        {
+            return std::make_unique<ToneStream>(*this, length);
+        }
+
+    private:
+        std::uint32_t length; // in frames, zero loops forever
+    };
+}
+
+#endif // OUZEL_TEST_TONE_HPP
@@ -0,0 +1,376 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Test.hpp"
+#include "TestEngine.hpp"
+#include "audio/Audio.hpp"
+#include "audio/VorbisClip.hpp"
+#include "storage/FileSystem.hpp"
+
+namespace ouzel::test
+{
+    namespace
+    {
+        constexpr std::uint32_t sampleRate = 44100;
+        constexpr std::uint32_t packetCount = 600;
+        constexpr std::uint32_t blockFrames = 128; // the short and the long blocks have 256 samples
+        constexpr std::uint32_t bufferSize = 512;
+
+        // packs the values starting from the least significant bit, as Vorbis reads them
+        class BitWriter final
+        {
+        public:
+            void write(std::uint32_t value, std::uint32_t bits)
+            {
+                for (std::uint32_t i = 0; i < bits; ++i)
+                {
+                    if (bitCount % 8 == 0) bytes.push_back(0);
+                    bytes.back() |= static_cast<std::uint8_t>(((value >> i) & 1U) << (bitCount % 8));
+                    ++bitCount;
+                }
+            }
+
+            // the Huffman codewords are read one bit at a time from the most significant one
+            void writeCode(std::uint32_t code, std::uint32_t length)
+            {
+                for (std::uint32_t i = length; i-- > 0;)
+                    write((code >> i) & 1U, 1);
+            }
+
+            void writeBytes(const std::string& value)
+            {
+                for (const char c : value) write(static_cast<std::uint8_t>(c), 8);
+            }
+
+            auto& getBytes() const noexcept { return bytes; }
+
+        private:
+            std::vector<std::uint8_t> bytes;
+            std::uint32_t bitCount = 0;
+        };
+
+        void writeCodebook(BitWriter& writer, const std::vector<std::uint32_t>& lengths, bool lookup)
+        {
+            writer.write(0x564342, 24); // sync pattern
+            writer.write(1, 16); // dimensions
+            writer.write(static_cast<std::uint32_t>(lengths.size()), 24);
+            writer.write(0, 1); // not ordered
+            writer.write(0, 1); // not sparse
+            for (const auto length : lengths) writer.write(length - 1, 5);
+
+            if (lookup)
+            {
+                // the values -1.5, -0.5, 0.5 and 1.5
+                writer.write(1, 4);
+                writer.write(3U | (787U << 21) | (1U << 31), 32); // minimum -1.5
+                writer.write(1U | (788U << 21), 32); // delta 1.0
+                writer.write(4 - 1, 4); // value bits
+                writer.write(0, 1); // no sequence
+                for (std::uint32_t value = 0; value < 4; ++value) writer.write(value, 4);
+            }
+            else
+                writer.write(0, 4);
+        }
+
+        // the smallest Vorbis setup that decodes to noise: a floor with only its two end points and
+        // a residue of random values from a four-value codebook
+        std::vector<std::uint8_t> createSetupHeader()
+        {
+            BitWriter writer;
+            writer.write(5, 8);
+            writer.writeBytes("vorbis");
+
+            writer.write(2 - 1, 8); // codebooks
+            writeCodebook(writer, {1, 1}, false); // residue classes
+            writeCodebook(writer, {2, 2, 2, 2}, true); // residue values
+
+            writer.write(0, 6); // time domain transforms
+            writer.write(0, 16);
+
+            writer.write(0, 6); // floors
+            writer.write(1, 16); // floor 1
+            writer.write(0, 5); // no partitions
+            writer.write(1 - 1, 2); // multiplier
+            writer.write(8, 4); // range bits
+
+            writer.write(0, 6); // residues
+            writer.write(1, 16); // residue 1
+            writer.write(0, 24); // begin
+            writer.write(blockFrames, 24); // end
+            writer.write(32 - 1, 24); // partition size
+            writer.write(1 - 1, 6); // classifications
+            writer.write(0, 8); // class book
+            writer.write(1, 3); // the first pass of the class has a book
+            writer.write(0, 1);
+            writer.write(1, 8); // the values book
+
+            writer.write(0, 6); // mappings
+            writer.write(0, 16);
+            writer.write(0, 1); // one submap
+            writer.write(0, 1); // no coupling
+            writer.write(0, 2);
+            writer.write(0, 8); // time
+            writer.write(0, 8); // floor
+            writer.write(0, 8); // residue
+
+            writer.write(0, 6); // modes
+            writer.write(0, 1); // short blocks
+            writer.write(0, 16);
+            writer.write(0, 16);
+            writer.write(0, 8); // mapping
+
+            writer.write(1, 1); // framing
+            return writer.getBytes();
+        }
+
+        std::vector<std::uint8_t> createAudioPacket(std::mt19937& generator)
+        {
+            std::uniform_int_distribution<std::uint32_t> amplitude(150, 230);
+            std::uniform_int_distribution<std::uint32_t> value(0, 3);
+
+            BitWriter writer;
+            writer.write(0, 1); // audio packet
+            writer.write(1, 1); // the floor is used
+            writer.write(amplitude(generator), 8);
+            writer.write(amplitude(generator), 8);
+
+            for (std::uint32_t partition = 0; partition < blockFrames / 32; ++partition)
+            {
+                writer.writeCode(0, 1);
+                for (std::uint32_t i = 0; i < 32; ++i)
+                    writer.writeCode(value(generator), 2);
+            }
+
+            return writer.getBytes();
+        }
+
+        std::uint32_t getCrc(const std::vector<std::uint8_t>& data) noexcept
+        {
+            std::uint32_t result = 0;
+            for (const auto byte : data)
+            {
+                result ^= static_cast<std::uint32_t>(byte) << 24;
+                for (int bit = 0; bit < 8; ++bit)
+                    result = (result & 0x80000000U) ? (result << 1) ^ 0x04C11DB7U : result << 1;
+            }
+            return result;
+        }
+
+        void writePage(std::vector<std::uint8_t>& result, const std::vector<std::vector<std::uint8_t>>& packets,
+                       std::uint64_t granulePosition, std::uint8_t flags, std::uint32_t sequence)
+        {
+            std::vector<std::uint8_t> lacing;
+            std::vector<std::uint8_t> body;
+            for (const auto& packet : packets)
+            {
+                auto size = packet.size();
+                for (; size >= 255; size -= 255) lacing.push_back(255);
+                lacing.push_back(static_cast<std::uint8_t>(size));
+                body.insert(body.end(), packet.begin(), packet.end());
+            }
+
+            std::vector<std::uint8_t> page = {'O', 'g', 'g', 'S', 0, flags};
+            const auto writeValue = [&page](std::uint64_t value, std::uint32_t size) {
+                for (std::uint32_t i = 0; i < size; ++i)
+                    page.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+            };
+            writeValue(granulePosition, 8);
+            writeValue(1, 4); // serial number
+            writeValue(sequence, 4);
+            writeValue(0, 4); // checksum
+            page.push_back(static_cast<std::uint8_t>(lacing.size()));
+            page.insert(page.end(), lacing.begin(), lacing.end());
+            page.insert(page.end(), body.begin(), body.end());
+
+            const auto crc = getCrc(page);
+            for (std::uint32_t i = 0; i < 4; ++i)
+                page[22 + i] = static_cast<std::uint8_t>(crc >> (i * 8));
+
+            result.insert(result.end(), page.begin(), page.end());
+        }
+
+        // a mono Ogg Vorbis file of (packetCount - 1) * blockFrames frames of noise
+        std::vector<std::uint8_t> createVorbisFile()
+        {
+            BitWriter identification;
+            identification.write(1, 8);
+            identification.writeBytes("vorbis");
+            identification.write(0, 32); // version
+            identification.write(1, 8); // channels
+            identification.write(sampleRate, 32);
+            identification.write(0, 32); // bit rates
+            identification.write(0, 32);
+            identification.write(0, 32);
+            identification.write(8, 4); // block sizes of 256 samples
+            identification.write(8, 4);
+            identification.write(1, 1); // framing
+
+            BitWriter comment;
+            comment.write(3, 8);
+            comment.writeBytes("vorbis");
+            comment.write(4, 32);
+            comment.writeBytes("test");
+            comment.write(0, 32); // no comments
+            comment.write(1, 1); // framing
+
+            std::vector<std::uint8_t> result;
+            std::uint32_t sequence = 0;
+            writePage(result, {identification.getBytes()}, 0, 2, sequence++);
+            writePage(result, {comment.getBytes(), createSetupHeader()}, 0, 0, sequence++);
+
+            std::mt19937 generator(1);
+            constexpr std::uint32_t packetsPerPage = 16;
+
+            // the first packet only starts the overlap, so every page ends one block earlier
+            for (std::uint32_t first = 0; first < packetCount; first += packetsPerPage)
+            {
+                const auto last = std::min(first + packetsPerPage, packetCount);
+                std::vector<std::vector<std::uint8_t>> packets;
+                for (auto packet = first; packet < last; ++packet)
+                    packets.push_back(createAudioPacket(generator));
+
+                writePage(result, packets, (last - 1) * blockFrames, last == packetCount ? 4 : 0, sequence++);
+            }
+
+            return result;
+        }
+
+        struct Result final
+        {
+            std::vector<float> samples;
+            std::size_t endBlocks = 0; // blocks until the stream reached its end
+            std::size_t stopCount = 0;
+        };
+
+        // plays, skips, resets, plays to the end, repeats and deletes a stream of the clip, the streaming
+        // decoder gets time to fill its buffer before every block
+        Result play(audio::Audio& audio, const audio::VorbisClip& clip)
+        {
+            using namespace audio::mixer;
+
+            auto& mixer = audio.getMixer();
+            const auto streamId = mixer.getObjectId();
+            Result result;
+            std::vector<float> samples;
+            std::vector<Mixer::StoppedStream> stoppedStreams;
+
+            // the commands are applied before the next block is rendered, so that the decoder thread
+            // has time to fill the buffer of a new or a reset stream
+            const auto submit = [&mixer](std::unique_ptr<Command> command) {
+                CommandBuffer commandBuffer;
+                commandBuffer.pushCommand(std::move(command));
+                mixer.submitCommandBuffer(std::move(commandBuffer));
+                mixer.process();
+            };
+
+            const auto render = [&](std::size_t blocks) {
+                for (std::size_t i = 0; i < blocks; ++i)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    mixer.getSamples(bufferSize, 2, sampleRate, samples);
+                    result.samples.insert(result.samples.end(), samples.begin(), samples.end());
+
+                    stoppedStreams.clear();
+                    mixer.getStoppedStreams(stoppedStreams);
+                    result.stopCount += stoppedStreams.size();
+                }
+            };
+
+            submit(std::make_unique<InitStreamCommand>(streamId, clip.getSourceId()));
+            submit(std::make_unique<SetStreamOutputCommand>(streamId, audio.getMasterMix().getBusId()));
+            submit(std::make_unique<PlayStreamCommand>(streamId));
+            render(20);
+
+            // the virtual stream is skipped
+            submit(std::make_unique<SetStreamVirtualCommand>(streamId, true));
+            render(10);
+            submit(std::make_unique<SetStreamVirtualCommand>(streamId, false));
+            render(10);
+
+            submit(std::make_unique<StopStreamCommand>(streamId, true));
+            submit(std::make_unique<PlayStreamCommand>(streamId));
+            render(20);
+
+            while (result.stopCount == 0 && result.endBlocks < packetCount)
+            {
+                render(1);
+                ++result.endBlocks;
+            }
+
+            // the stream was reset at its end, so it repeats from the start
+            submit(std::make_unique<PlayStreamCommand>(streamId));
+            render(20);
+
+            // the stream is deleted while its decoder is running
+            submit(std::make_unique<DeleteObjectCommand>(streamId));
+            render(1);
+
+            return result;
+        }
+    }
+
+    void testVorbis()
+    {
+        TestEngine testEngine;
+        auto& fileSystem = testEngine.getFileSystem();
+
+        const auto path = storage::FileSystem::getTempPath() / "ouzel_test_sound.ogg";
+        const auto file = createVorbisFile();
+        {
+            std::ofstream stream(std::string(path), std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        }
+
+        audio::Settings settings;
+        settings.sampleRate = sampleRate;
+        settings.bufferSize = bufferSize;
+        settings.channels = 2;
+        settings.mixerBufferCount = 0; // the test renders the blocks
+        settings.mixerWorkerCount = 0;
+        audio::Audio audio(audio::Driver::empty, settings);
+
+        audio::VorbisClip memoryClip(audio, fileSystem.readFile(path, false));
+        // smaller than the file, so that the decoder thread wraps around the ring buffer
+        audio::VorbisClip streamingClip(audio, fileSystem, path, 4096);
+        audio.update();
+
+        const auto expected = play(audio, memoryClip);
+        const auto result = play(audio, streamingClip);
+
+        std::remove(std::string(path).c_str());
+
+        const auto statistics = streamingClip.getStatistics();
+        expect(statistics.underruns == 0, "Vorbis decoder did not keep up with " + std::to_string(statistics.underruns) + " blocks");
+        expect(statistics.decodedBlocks >= packetCount - 1, "Vorbis decoder decoded only " +
+               std::to_string(statistics.decodedBlocks) + " blocks");
+
+        const std::size_t fileBlocks = ((packetCount - 1) * blockFrames + bufferSize - 1) / bufferSize;
+        expect(expected.stopCount == 1 && expected.endBlocks < fileBlocks, "Vorbis stream did not reach its end");
+        expect(result.stopCount == 1 && result.endBlocks == expected.endBlocks,
+               "Streamed Vorbis stopped after " + std::to_string(result.endBlocks) + " blocks instead of " +
+               std::to_string(expected.endBlocks));
+
+        expect(result.samples.size() == expected.samples.size(), "Streamed Vorbis rendered a different number of samples");
+
+        bool silent = true;
+        for (std::size_t i = 0; i < expected.samples.size(); ++i)
+        {
+            if (expected.samples[i] != 0.0F) silent = false;
+
+            expect(std::fabs(result.samples[i] - expected.samples[i]) < 0.0001F,
+                   "Streamed Vorbis differs at frame " + std::to_string(i % bufferSize) +
+                   " of block " + std::to_string(i / (bufferSize * 2)));
+        }
+
+        expect(!silent, "Vorbis stream rendered silence");
+    }
+}
@@ -1,8 +1,50 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
-#include "cstdlib"
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Test.hpp"
+#include "core/Engine.hpp"
+
+// the engines of the tests are never started, so the application is never created
+std::unique_ptr<ouzel::Application> ouzel::main(const std::vector<std::string>&)
+{
+    return nullptr;
+}
 
 int main()
 {
-    return EXIT_SUCCESS;
+    const std::pair<const char*, void(*)()> tests[] = {
+        {"cache", ouzel::test::testCache},
+        {"fft", ouzel::test::testFft},
+        {"file system", ouzel::test::testFileSystem},
+        {"inflate", ouzel::test::testInflate},
+        {"job system", ouzel::test::testJobSystem},
+        {"kernels", ouzel::test::testKernels},
+        {"mixer", ouzel::test::testMixer},
+        {"scene", ouzel::test::testScene},
+        {"vorbis", ouzel::test::testVorbis}
+    };
+
+    int result = EXIT_SUCCESS;
+
+    for (const auto& [name, test] : tests)
+    {
+        try
+        {
+            test();
+            std::cout << name << " passed\n";
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << name << " failed: " << e.what() << '\n';
+            result = EXIT_FAILURE;
+        }
+    }
+
+    return result;
 }
@@ -0,0 +1,188 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "Cooker.hpp"
+#include "assets/CookedTexture.hpp"
+#include "graphics/Mipmaps.hpp"
+#include "utils/Utils.hpp"
+
+#if defined(_MSC_VER)
+#  pragma warning( push )
+#  pragma warning( disable : 4100 )
+#  pragma warning( disable : 4244 )
+#  pragma warning( disable : 4245 )
+#  pragma warning( disable : 4456 )
+#  pragma warning( disable : 4457 )
+#  pragma warning( disable : 4505 )
+#elif defined(__GNUC__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wconversion"
+#  pragma GCC diagnostic ignored "-Wdouble-promotion"
+#  pragma GCC diagnostic ignored "-Wold-style-cast"
+#  pragma GCC diagnostic ignored "-Wshadow"
+#  pragma GCC diagnostic ignored "-Wsign-conversion"
+#  pragma GCC diagnostic ignored "-Wtype-limits"
+#  pragma GCC diagnostic ignored "-Wunused-function"
+#  pragma GCC diagnostic ignored "-Wunused-parameter"
+#  pragma GCC diagnostic ignored "-Wunused-value"
+#  if defined(__clang__)
+#    pragma GCC diagnostic ignored "-Wcomma"
+#    pragma GCC diagnostic ignored "-Wconditional-uninitialized"
+#    pragma GCC diagnostic ignored "-Wmissing-prototypes"
+#  else
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#  endif
+#endif
+
+#define STBI_NO_PSD
+#define STBI_NO_HDR
+#define STBI_NO_PIC
+#define STBI_NO_GIF
+#define STBI_NO_PNM
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "stb_vorbis.c"
+
+#if defined(_MSC_VER)
+#  pragma warning( pop )
+#elif defined(__GNUC__)
+#  pragma GCC diagnostic pop
+#endif
+
+namespace ouzel
+{
+    namespace
+    {
+        std::vector<std::byte> cookTexture(const Asset& asset, const std::vector<std::byte>& data)
+        {
+            int width;
+            int height;
+            int comp;
+
+            // all the images are converted to RGBA like in the ImageLoader
+            stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(data.data()),
+                                                    static_cast<int>(data.size()),
+                                                    &width, &height,
+                                                    &comp, STBI_rgb_alpha);
+
+            if (!pixels)
+                throw std::runtime_error("Failed to load texture " + std::string(asset.path) +
+                                         ", reason: " + stbi_failure_reason());
+
+            const std::vector<std::uint8_t> image(pixels, pixels + static_cast<std::size_t>(width) *
+                                                  static_cast<std::size_t>(height) * 4);
+            stbi_image_free(pixels);
+
+            const Size2U size(static_cast<std::uint32_t>(width),
+                              static_cast<std::uint32_t>(height));
+
+            const auto levels = graphics::generateMipmaps(size, image, asset.mipmaps ? 0 : 1,
+                                                          graphics::PixelFormat::rgba8UnsignedNorm);
+
+            return assets::encodeCookedTexture(graphics::PixelFormat::rgba8UnsignedNorm, levels);
+        }
+
+        // maps the Vorbis channel order to the WAVE order (L, R, C, LFE, BL, BR, BC, SL, SR), the Vorbis
+        // files with more than 8 channels have an application defined order and are kept as they are
+        std::size_t getWaveChannel(std::size_t channels, std::size_t channel) noexcept
+        {
+            constexpr std::size_t threeChannels[] = {0, 2, 1}; // L, C, R
+            constexpr std::size_t fiveChannels[] = {0, 2, 1, 3, 4}; // L, C, R, BL, BR
+            constexpr std::size_t sixChannels[] = {0, 2, 1, 4, 5, 3}; // L, C, R, BL, BR, LFE
+            constexpr std::size_t sevenChannels[] = {0, 2, 1, 5, 6, 4, 3}; // L, C, R, SL, SR, BC, LFE
+            constexpr std::size_t eightChannels[] = {0, 2, 1, 6, 7, 4, 5, 3}; // L, C, R, SL, SR, BL, BR, LFE
+
+            switch (channels)
+            {
+                case 3: return threeChannels[channel];
+                case 5: return fiveChannels[channel];
+                case 6: return sixChannels[channel];
+                case 7: return sevenChannels[channel];
+                case 8: return eightChannels[channel];
+                default: return channel;
+            }
+        }
+
+        std::vector<std::byte> cookSound(const Asset& asset, const std::vector<std::byte>& data)
+        {
+            // the WAVE files are already decoded
+            if (data.size() < 4 || std::memcmp(data.data(), "OggS", 4) != 0)
+                return data;
+
+            int error;
+            stb_vorbis* vorbis = stb_vorbis_open_memory(reinterpret_cast<const unsigned char*>(data.data()),
+                                                        static_cast<int>(data.size()),
+                                                        &error, nullptr);
+
+            if (!vorbis)
+                throw std::runtime_error("Failed to load sound " + std::string(asset.path));
+
+            const stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+            const std::size_t channels = static_cast<std::size_t>(info.channels);
+            const std::size_t frames = stb_vorbis_stream_length_in_samples(vorbis);
+
+            if (frames > static_cast<std::size_t>(info.sample_rate) * maxDecodedSoundLength)
+            {
+                stb_vorbis_close(vorbis);
+                return data;
+            }
+
+            std::vector<short> samples(frames * channels);
+            std::size_t decodedFrames = 0;
+
+            while (decodedFrames < frames)
+            {
+                const int result = stb_vorbis_get_samples_short_interleaved(vorbis, info.channels,
+                                                                            samples.data() + decodedFrames * channels,
+                                                                            static_cast<int>((frames - decodedFrames) * channels));
+                if (result <= 0) break;
+                decodedFrames += static_cast<std::size_t>(result);
+            }
+
+            stb_vorbis_close(vorbis);
+
+            // 16-bit PCM WAVE file
+            constexpr std::size_t headerSize = 44;
+            const std::size_t dataSize = decodedFrames * channels * 2;
+            std::vector<std::byte> result(headerSize + dataSize);
+            auto buffer = reinterpret_cast<std::uint8_t*>(result.data());
+
+            std::memcpy(buffer, "RIFF", 4);
+            encodeLittleEndian<std::uint32_t>(buffer + 4, static_cast<std::uint32_t>(headerSize - 8 + dataSize));
+            std::memcpy(buffer + 8, "WAVE", 4);
+            std::memcpy(buffer + 12, "fmt ", 4);
+            encodeLittleEndian<std::uint32_t>(buffer + 16, 16);
+            encodeLittleEndian<std::uint16_t>(buffer + 20, 1); // PCM
+            encodeLittleEndian<std::uint16_t>(buffer + 22, static_cast<std::uint16_t>(channels));
+            encodeLittleEndian<std::uint32_t>(buffer + 24, info.sample_rate);
+            encodeLittleEndian<std::uint32_t>(buffer + 28, static_cast<std::uint32_t>(info.sample_rate * channels * 2));
+            encodeLittleEndian<std::uint16_t>(buffer + 32, static_cast<std::uint16_t>(channels * 2));
+            encodeLittleEndian<std::uint16_t>(buffer + 34, 16);
+            std::memcpy(buffer + 36, "data", 4);
+            encodeLittleEndian<std::uint32_t>(buffer + 40, static_cast<std::uint32_t>(dataSize));
+
+            for (std::size_t frame = 0; frame < decodedFrames; ++frame)
+                for (std::size_t channel = 0; channel < channels; ++channel)
+                    encodeLittleEndian<std::uint16_t>(buffer + headerSize + (frame * channels + getWaveChannel(channels, channel)) * 2,
+                                                      static_cast<std::uint16_t>(samples[frame * channels + channel]));
+
+            return result;
+        }
+    }
+
+    std::vector<std::byte> cookAsset(const Asset& asset, const std::vector<std::byte>& data)
+    {
+        switch (asset.type)
+        {
+            case Asset::Type::texture:
+                return cookTexture(asset, data);
+            case Asset::Type::sound:
+                return cookSound(asset, data);
+            default:
+                return data;
+        }
+    }
+}
@@ -0,0 +1,24 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_COOKER_HPP
+#define OUZEL_COOKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Asset.hpp"
+
+namespace ouzel
+{
+    // changed when the cooked assets change, so that the exported assets are cooked again
+    constexpr std::uint32_t cookerVersion = 1;
+
+    // the sounds that are longer are not decoded, because the decoded data would take too much space
+    constexpr std::uint32_t maxDecodedSoundLength = 10; // seconds
+
+    // Converts the asset to a format that the engine loads without decoding it. The images are stored with their
+    // mip levels and the short Vorbis sounds are decoded to WAVE files. The other assets are returned unchanged.
+    std::vector<std::byte> cookAsset(const Asset& asset, const std::vector<std::byte>& data);
+}
+
+#endif // OUZEL_COOKER_HPP
@@ -3,11 +3,22 @@
 #ifndef OUZEL_OUZELPROJECT_HPP
 #define OUZEL_OUZELPROJECT_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
 #include "Asset.hpp"
+#include "Cooker.hpp"
 #include "Target.hpp"
 #include "storage/FileSystem.hpp"
 #include "formats/Json.hpp"
+#include "hash/Fnv1.hpp"
 
 namespace ouzel
 {
@@ -58,7 +69,8 @@ namespace ouzel
 
             for (const auto& assetObject : j["assets"])
             {
-                const auto assetPath(assetsPath / assetObject["path"].as<std::string>());
+                // relative to the assets path
+                const storage::Path assetPath(assetObject["path"].as<std::string>());
                 const auto assetName = assetObject.hasMember("name") ?
                     assetObject["name"].as<std::string>() : std::string(assetPath.getStem());
 
@@ -82,31 +94,204 @@ namespace ouzel
         const storage::Path& getAssetsPath() const noexcept { return assetsPath; }
         const std::vector<Asset>& getAssets() const noexcept { return assets; }
 
+        // Cooks the assets for the target into build/<target name>/assets next to the project file. The exported
+        // files keep the names of the source files, the loaders of the engine recognize the cooked formats. The
+        // assets whose source files and settings did not change since the previous export are not cooked again.
         void exportAssets(const std::string& targetName) const
         {
+            const auto targetIterator = std::find_if(targets.begin(), targets.end(),
+                                                     [&targetName](const auto& target) noexcept {
+                return target.name == targetName;
+            });
+
+            if (targetIterator == targets.end())
+                throw std::runtime_error("Target not found");
+
+            const storage::Path directoryPath = path.getDirectory();
+            const storage::Path assetsDirectoryPath = assetsPath.isAbsolute() ? assetsPath : directoryPath / assetsPath;
+            const storage::Path buildPath = directoryPath / "build" / targetIterator->name;
+            const storage::Path exportDirectoryPath = buildPath / "assets";
+            const storage::Path statesPath = buildPath / "assets.json";
+
+            const auto previousStates = readExportStates(statesPath);
+            std::vector<std::optional<ExportState>> states(assets.size());
+
+            // the directories are created before the assets are exported on several threads
             for (const auto& asset : assets)
-            {
-                const storage::Path assetPath = assetsPath / asset.path;
+                createDirectories((exportDirectoryPath / asset.path).getDirectory());
 
-                storage::Path resourceName = asset.path;
-                resourceName.replaceExtension("otexture");
-                const storage::Path resourcePath = assetPath / resourceName;
+            std::atomic<std::size_t> nextAsset{0};
+            std::mutex errorMutex;
+            std::exception_ptr error;
 
-                const auto targetIterator = std::find_if(targets.begin(), targets.end(),
-                                                         [targetName](const auto& target) noexcept {
-                    return target.name == targetName;
-                });
+            const auto exportNextAssets = [&]() {
+                for (std::size_t i; (i = nextAsset++) < assets.size();)
+                {
+                    try
+                    {
+                        const auto& asset = assets[i];
+                        const auto previousState = previousStates.find(asset.path.getGeneric());
 
-                if (targetIterator == targets.end())
-                    throw std::runtime_error("Target not found");
+                        states[i] = exportAsset(asset, assetsDirectoryPath / asset.path, exportDirectoryPath / asset.path,
+                                                previousState != previousStates.end() ? &previousState->second : nullptr);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard lock(errorMutex);
+                        if (!error) error = std::current_exception();
+                        nextAsset = assets.size();
+                    }
+                }
+            };
 
-                // TODO: check if input file exists
-                // TODO: check if output file exists and is older than the input file
-                // TODO: export input file to output file
+            std::vector<std::thread> threads(std::max(std::thread::hardware_concurrency(), 1U) - 1);
+            for (auto& thread : threads)
+                thread = std::thread(exportNextAssets);
+
+            exportNextAssets();
+
+            for (auto& thread : threads)
+                thread.join();
+
+            // the assets that were exported before an error are not exported again, the assets that were removed
+            // from the project are forgotten
+            std::map<std::string, ExportState> newStates;
+            for (std::size_t i = 0; i < assets.size(); ++i)
+            {
+                const auto key = assets[i].path.getGeneric();
+
+                if (states[i])
+                    newStates[key] = *states[i];
+                else if (const auto previousState = previousStates.find(key); previousState != previousStates.end())
+                    newStates[key] = previousState->second;
             }
+
+            writeExportStates(statesPath, newStates);
+
+            if (error) std::rethrow_exception(error);
         }
 
     private:
+        struct ExportState final
+        {
+            std::uint64_t size = 0;
+            std::int64_t modifyTime = 0;
+            std::uint64_t contentHash = 0;
+            std::uint64_t settingsHash = 0;
+        };
+
+        static ExportState exportAsset(const Asset& asset,
+                                       const storage::Path& inputPath,
+                                       const storage::Path& outputPath,
+                                       const ExportState* previousState)
+        {
+            ExportState state;
+            state.size = storage::FileSystem::getFileSize(inputPath);
+            state.modifyTime = std::chrono::system_clock::time_point(storage::FileSystem::getModifyTime(inputPath)).time_since_epoch().count();
+            state.settingsHash = hash::fnv1::hash<std::uint64_t>(cookerVersion);
+            state.settingsHash = hash::fnv1::hash<std::uint64_t>(static_cast<std::uint32_t>(asset.type), 0, state.settingsHash);
+            state.settingsHash = hash::fnv1::hash<std::uint64_t>(static_cast<std::uint8_t>(asset.mipmaps), 0, state.settingsHash);
+
+            const bool exported = storage::FileSystem::getFileType(outputPath) == storage::FileType::regular;
+            const bool sameSettings = previousState && previousState->settingsHash == state.settingsHash;
+
+            // the source file is not read if its size and its modification time did not change
+            if (exported && sameSettings &&
+                previousState->size == state.size &&
+                previousState->modifyTime == state.modifyTime)
+                return *previousState;
+
+            std::ifstream inputFile(inputPath, std::ios::binary);
+            if (!inputFile)
+                throw std::runtime_error("Failed to open file " + std::string(inputPath));
+
+            std::vector<std::byte> data(state.size);
+            inputFile.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!inputFile)
+                throw std::runtime_error("Failed to read file " + std::string(inputPath));
+
+            state.contentHash = hash::fnv1::hashString<std::uint64_t>(std::string_view(reinterpret_cast<const char*>(data.data()), data.size()));
+
+            // the file was modified, but its contents are the same
+            if (exported && sameSettings && previousState->contentHash == state.contentHash)
+                return state;
+
+            const auto cookedData = cookAsset(asset, data);
+
+            std::ofstream outputFile(outputPath, std::ios::binary | std::ios::trunc);
+            outputFile.write(reinterpret_cast<const char*>(cookedData.data()), static_cast<std::streamsize>(cookedData.size()));
+            if (!outputFile)
+                throw std::runtime_error("Failed to write file " + std::string(outputPath));
+
+            return state;
+        }
+
+        // all the assets are exported again if the states can not be read
+        static std::map<std::string, ExportState> readExportStates(const storage::Path& statesPath)
+        {
+            std::map<std::string, ExportState> result;
+
+            std::ifstream f(statesPath, std::ios::binary);
+            if (!f) return result;
+
+            try
+            {
+                const std::vector<char> data{std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+                const json::Value j = json::parse(data);
+
+                for (const auto& stateObject : j["assets"])
+                {
+                    ExportState state;
+                    state.size = stateObject["size"].as<std::uint64_t>();
+                    state.modifyTime = stateObject["modifyTime"].as<std::int64_t>();
+                    state.contentHash = std::stoull(stateObject["contentHash"].as<std::string>());
+                    state.settingsHash = std::stoull(stateObject["settingsHash"].as<std::string>());
+                    result[stateObject["path"].as<std::string>()] = state;
+                }
+            }
+            catch (const std::exception&)
+            {
+                result.clear();
+            }
+
+            return result;
+        }
+
+        static void writeExportStates(const storage::Path& statesPath,
+                                      const std::map<std::string, ExportState>& states)
+        {
+            json::Value j;
+            auto& stateArray = j["assets"] = json::Value::Type::array;
+
+            for (const auto& [assetPath, state] : states)
+            {
+                json::Value stateObject;
+                stateObject["path"] = assetPath;
+                stateObject["size"] = state.size;
+                stateObject["modifyTime"] = state.modifyTime;
+                // the hashes do not fit into the signed integers of JSON
+                stateObject["contentHash"] = std::to_string(state.contentHash);
+                stateObject["settingsHash"] = std::to_string(state.settingsHash);
+                stateArray.pushBack(stateObject);
+            }
+
+            const auto data = json::encode(j, true);
+            std::ofstream f(statesPath, std::ios::binary | std::ios::trunc);
+            f.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!f)
+                throw std::runtime_error("Failed to write file " + std::string(statesPath));
+        }
+
+        static void createDirectories(const storage::Path& directoryPath)
+        {
+            if (directoryPath.isEmpty() ||
+                storage::FileSystem::getFileType(directoryPath) == storage::FileType::directory)
+                return;
+
+            createDirectories(directoryPath.getDirectory());
+            storage::FileSystem::createDirectory(directoryPath);
+        }
+
         const storage::Path path;
         std::string name;
         std::string identifier;